@@ -0,0 +1,30 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <google/protobuf/stubs/common.h>
+#include <spdlog/spdlog.h>
+
+int main(int argc, char *argv[]) {
+  /// storage and state machines log every operation at info level, which would be measured as well
+  spdlog::set_level(spdlog::level::warn);
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+  google::protobuf::ShutdownProtobufLibrary();
+  return 0;
+}
@@ -0,0 +1,130 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "../../src/app_ledger/v2/MemoryBackedAppStateMachine.h"
+#include "../../src/infra/util/Util.h"
+#include "SampleCommands.h"
+
+namespace gringofts::ledger::benchmark {
+
+namespace {
+constexpr const char *kDataDir = "../benchmark/data/app_ledger";
+constexpr uint64_t kDebitCode = 1000;
+constexpr uint64_t kCreditCode = 2000;
+/// commands are prepared in chunks with timing paused
+constexpr uint64_t kChunkSize = 1024;
+
+/// a memory-backed state machine for CPL and a RocksDB-backed one for EAL, both holding two accounts
+class LedgerStateMachines {
+ public:
+  LedgerStateMachines() {
+    Util::executeCmd(std::string("rm -rf ") + kDataDir + " && mkdir -p " + kDataDir);
+    mFactory = std::make_shared<PMRContainerFactory>(
+        "benchmarkFactory", std::make_unique<PoolPMRMemoryPool>("benchmarkPool"));
+    mRocksDBBacked = std::make_unique<v2::RocksDBBackedAppStateMachine>(kDataDir, kDataDir, 4, mFactory);
+    mMemoryBacked = std::make_unique<v2::MemoryBackedAppStateMachine>(mFactory);
+    mMemoryBacked->swapState(mRocksDBBacked.get());
+    mRocksDBBacked->recoverSelf();
+
+    /// both accounts only grow, so that no journal entry is rejected
+    constexpr uint64_t kInitialBalance = 1ull << 40;
+    process(*createSampleCreateAccountCommand(protos::AccountType::Asset, kDebitCode, kInitialBalance));
+    process(*createSampleCreateAccountCommand(protos::AccountType::Liability, kCreditCode, kInitialBalance));
+  }
+
+  ~LedgerStateMachines() {
+    mMemoryBacked.reset();
+    mRocksDBBacked.reset();
+    Util::executeCmd(std::string("rm -rf ") + kDataDir);
+  }
+
+  /// process on the memory-backed one, and apply the events to the RocksDB-backed one
+  void process(const Command &command) {
+    std::vector<std::shared_ptr<Event>> events;
+    mMemoryBacked->processCommandAndApply(command, &events);
+    for (const auto &event : events) {
+      mRocksDBBacked->applyEvent(*event);
+    }
+  }
+
+  std::vector<std::shared_ptr<RecordJournalEntryCommand>> nextCommands(uint32_t numLines) {
+    std::vector<std::shared_ptr<RecordJournalEntryCommand>> commands;
+    commands.reserve(kChunkSize);
+    for (uint64_t i = 0; i < kChunkSize; ++i) {
+      commands.push_back(createSampleRecordJournalEntryCommand(
+          "benchmark-" + std::to_string(mNextId++), kDebitCode, kCreditCode, 1, numLines));
+    }
+    return commands;
+  }
+
+  std::unique_ptr<v2::MemoryBackedAppStateMachine> mMemoryBacked;
+  std::unique_ptr<v2::RocksDBBackedAppStateMachine> mRocksDBBacked;
+
+ private:
+  std::shared_ptr<PMRContainerFactory> mFactory;
+  uint64_t mNextId = 0;
+};
+}  /// namespace
+
+/// CPL: validate a journal entry of range(0) lines and generate its event
+void BM_AppStateMachineProcess(::benchmark::State &state) {  // NOLINT[runtime/references]
+  LedgerStateMachines stateMachines;
+  auto numLines = static_cast<uint32_t>(state.range(0));
+  std::vector<std::shared_ptr<RecordJournalEntryCommand>> commands;
+  auto next = commands.end();
+  std::vector<std::shared_ptr<Event>> events;
+
+  for (auto _ : state) {
+    if (next == commands.end()) {
+      state.PauseTiming();
+      commands = stateMachines.nextCommands(numLines);
+      next = commands.begin();
+      state.ResumeTiming();
+    }
+    events.clear();
+    auto hint = stateMachines.mMemoryBacked->processCommandAndApply(**next++, &events);
+    ::benchmark::DoNotOptimize(hint);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AppStateMachineProcess)->Arg(2)->Arg(16)->Arg(128);
+
+/// EAL: apply the event of a journal entry of range(0) lines to RocksDB, flushed on commit
+void BM_AppStateMachineApply(::benchmark::State &state) {  // NOLINT[runtime/references]
+  LedgerStateMachines stateMachines;
+  auto numLines = static_cast<uint32_t>(state.range(0));
+  std::vector<std::shared_ptr<Event>> events;
+  auto next = events.end();
+  uint64_t appliedIndex = 0;
+
+  for (auto _ : state) {
+    if (next == events.end()) {
+      state.PauseTiming();
+      events.clear();
+      for (const auto &command : stateMachines.nextCommands(numLines)) {
+        stateMachines.mMemoryBacked->processCommandAndApply(*command, &events);
+      }
+      next = events.begin();
+      state.ResumeTiming();
+    }
+    stateMachines.mRocksDBBacked->applyEvent(**next++);
+    stateMachines.mRocksDBBacked->commit(++appliedIndex);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AppStateMachineApply)->Arg(2)->Arg(16)->Arg(128);
+
+}  /// namespace gringofts::ledger::benchmark
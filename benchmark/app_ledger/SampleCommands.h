@@ -0,0 +1,82 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef BENCHMARK_APP_LEDGER_SAMPLECOMMANDS_H_
+#define BENCHMARK_APP_LEDGER_SAMPLECOMMANDS_H_
+
+#include <memory>
+#include <string>
+
+#include "../../src/app_ledger/should_be_generated/domain/commands/CreateAccountCommand.h"
+#include "../../src/app_ledger/should_be_generated/domain/commands/RecordJournalEntryCommand.h"
+#include "../../src/app_ledger/should_be_generated/domain/TransactionType.h"
+#include "../../src/infra/util/TimeUtil.h"
+
+namespace gringofts::ledger::benchmark {
+
+/// currency of all sample accounts and journal lines, CNY
+constexpr uint64_t kSampleCurrencyCode = 156;
+
+inline std::shared_ptr<CreateAccountCommand> createSampleCreateAccountCommand(protos::AccountType type,
+                                                                              uint64_t nominalCode,
+                                                                              uint64_t balance) {
+  protos::CreateAccount::Request request;
+  request.mutable_account()->set_version(1);
+  request.mutable_account()->set_type(type);
+  request.mutable_account()->set_nominal_code(nominalCode);
+  request.mutable_account()->set_name("benchmark");
+  request.mutable_account()->set_desc("benchmark account");
+  request.mutable_account()->set_iso4217_currency_code(kSampleCurrencyCode);
+  request.mutable_account()->mutable_balance()->set_version(1);
+  request.mutable_account()->mutable_balance()->set_value(balance);
+  auto command = std::make_shared<CreateAccountCommand>(TimeUtil::currentTimeInNanos(), request);
+  command->setRequestHandle(nullptr);
+  return command;
+}
+
+/// journal lines alternately debit debitCode and credit creditCode by amount, balanced if numLines is even
+inline std::shared_ptr<RecordJournalEntryCommand> createSampleRecordJournalEntryCommand(const std::string &id,
+                                                                                        uint64_t debitCode,
+                                                                                        uint64_t creditCode,
+                                                                                        uint64_t amount,
+                                                                                        uint32_t numLines = 2) {
+  auto now = TimeUtil::currentTimeInNanos();
+  protos::RecordJournalEntry::Request request;
+  auto *journalEntry = request.mutable_journal_entry();
+  journalEntry->set_version(1);
+  journalEntry->set_id(id);
+  journalEntry->set_valid_time(now);
+  journalEntry->set_record_time(now);
+  journalEntry->set_purpose("benchmark");
+  for (uint32_t i = 0; i < numLines; ++i) {
+    auto isDebit = i % 2 == 0;
+    auto *journalLine = journalEntry->add_journal_lines();
+    journalLine->set_version(1);
+    journalLine->set_nominal_code(isDebit ? debitCode : creditCode);
+    journalLine->set_transaction_type(TransactionTypeUtil::toType(isDebit ? TransactionType::Debit
+                                                                          : TransactionType::Credit));
+    journalLine->mutable_amount()->set_version(1);
+    journalLine->mutable_amount()->set_value(amount);
+    journalLine->set_iso4217_currency_code(kSampleCurrencyCode);
+    journalLine->set_ref_data("benchmark");
+  }
+
+  auto command = std::make_shared<RecordJournalEntryCommand>(now, std::move(request));
+  command->setRequestHandle(nullptr);
+  return command;
+}
+
+}  /// namespace gringofts::ledger::benchmark
+
+#endif  // BENCHMARK_APP_LEDGER_SAMPLECOMMANDS_H_
@@ -0,0 +1,61 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "../../../src/infra/monitor/MonitorTypes.h"
+
+namespace gringofts::benchmark {
+
+/// what a per-call lookup costs, e.g., match_index of every peer in each raft loop
+void BM_GaugeLookupAndSet(::benchmark::State &state) {  // NOLINT[runtime/references]
+  const std::string address = "127.0.0.1:5253";
+  uint64_t value = 0;
+
+  for (auto _ : state) {
+    getGauge("bm_match_index", {{"address", address}}).set(++value);
+  }
+}
+BENCHMARK(BM_GaugeLookupAndSet)->ThreadRange(1, 4);
+
+/// the same update through a handle resolved once
+void BM_CachedGaugeSet(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto gauge = getGauge("bm_match_index", {{"address", "127.0.0.1:5253"}});
+  uint64_t value = 0;
+
+  for (auto _ : state) {
+    gauge.set(++value);
+  }
+}
+BENCHMARK(BM_CachedGaugeSet)->ThreadRange(1, 4);
+
+void BM_CachedSummaryObserve(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto summary = getSummary("bm_latency_summary_in_ms", {});
+
+  for (auto _ : state) {
+    summary.observe(1.5);
+  }
+}
+BENCHMARK(BM_CachedSummaryObserve)->ThreadRange(1, 4);
+
+void BM_CachedHistogramObserve(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto histogram = getHistogram("bm_latency_histogram_in_ms", {});
+
+  for (auto _ : state) {
+    histogram.observe(1.5);
+  }
+}
+BENCHMARK(BM_CachedHistogramObserve)->ThreadRange(1, 4);
+
+}  /// namespace gringofts::benchmark
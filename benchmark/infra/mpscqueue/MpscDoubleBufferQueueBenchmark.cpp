@@ -0,0 +1,71 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../../../src/infra/mpscqueue/MpscDoubleBufferQueue.h"
+
+namespace gringofts::benchmark {
+
+/// enqueue then dequeue on the same thread, the cost without contention
+void BM_MpscDoubleBufferQueueUncontended(::benchmark::State &state) {  // NOLINT[runtime/references]
+  MpscDoubleBufferQueue<uint64_t> queue;
+  uint64_t value = 0;
+
+  for (auto _ : state) {
+    queue.enqueue(value++);
+    ::benchmark::DoNotOptimize(queue.dequeue());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MpscDoubleBufferQueueUncontended);
+
+/// dequeue while range(0) producers keep the queue filled, like the command queue under load
+void BM_MpscDoubleBufferQueueProducers(::benchmark::State &state) {  // NOLINT[runtime/references]
+  /// producers back off beyond this many queued elements, so that memory stays bounded
+  constexpr uint64_t kMaxQueued = 100000;
+  MpscDoubleBufferQueue<uint64_t> queue;
+  std::atomic<bool> running = true;
+
+  std::vector<std::thread> producers;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    producers.emplace_back([&queue, &running] {
+      uint64_t value = 0;
+      while (running) {
+        if (queue.estimateTotalSize() < kMaxQueued) {
+          queue.enqueue(value++);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(queue.dequeue());
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  running = false;
+  for (auto &producer : producers) {
+    producer.join();
+  }
+}
+BENCHMARK(BM_MpscDoubleBufferQueueProducers)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+}  /// namespace gringofts::benchmark
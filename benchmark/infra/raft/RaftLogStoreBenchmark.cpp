@@ -0,0 +1,60 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "../../../src/app_ledger/should_be_generated/domain/events/JournalEntryRecordedEvent.h"
+#include "../../../src/infra/raft/RaftLogStore.h"
+#include "../../app_ledger/SampleCommands.h"
+
+namespace gringofts::raft::benchmark {
+
+/// encode a journal entry of range(0) lines and its event into a raft payload,
+/// the event is compact if range(1) is not 0
+void BM_RaftLogStoreEncode(::benchmark::State &state) {  // NOLINT[runtime/references]
+  /// the arena is reset per batch, as RaftLogStore does once a batch is sent
+  constexpr uint64_t kBatchSize = 100;
+  auto command = ledger::benchmark::createSampleRecordJournalEntryCommand(
+      "benchmark", 1000, 2000, 1, static_cast<uint32_t>(state.range(0)));
+  std::vector<std::shared_ptr<Event>> events{std::make_shared<ledger::JournalEntryRecordedEvent>(
+      TimeUtil::currentTimeInNanos(), *command->journalEntryOpt(), state.range(1) != 0)};
+
+  std::vector<char> initialBlock(1024 * 1024);
+  google::protobuf::ArenaOptions options;
+  options.initial_block = initialBlock.data();
+  options.initial_block_size = initialBlock.size();
+  google::protobuf::Arena arena(options);
+
+  LogEntry entry;
+  uint64_t numEncoded = 0;
+  uint64_t payloadBytes = 0;
+  for (auto _ : state) {
+    RaftLogStore::encodePayload(*command, events, &arena, &entry);
+    payloadBytes += entry.payload().size();
+    if (++numEncoded % kBatchSize == 0) {
+      arena.Reset();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(payloadBytes);
+}
+BENCHMARK(BM_RaftLogStoreEncode)
+    ->Args({2, 0})
+    ->Args({2, 1})
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->Args({128, 0})
+    ->Args({128, 1});
+
+}  /// namespace gringofts::raft::benchmark
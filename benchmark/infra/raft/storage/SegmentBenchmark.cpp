@@ -0,0 +1,124 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "../../../../src/infra/raft/storage/Segment.h"
+#include "../../../../src/infra/util/Util.h"
+
+namespace gringofts::storage::benchmark {
+
+namespace {
+constexpr const char *kLogDir = "../benchmark/data/segment";
+constexpr uint64_t kDataSizeLimit = 64 * 1024 * 1024;
+constexpr uint64_t kMetaSizeLimit = 4 * 1024 * 1024;
+constexpr SecKeyVersion kSecKeyVersion = 1;
+
+void resetLogDir() {
+  Util::executeCmd(std::string("rm -rf ") + kLogDir + " && mkdir -p " + kLogDir);
+}
+
+std::shared_ptr<CryptoUtil> createCrypto(bool hmacEnabled) {
+  auto crypto = std::make_shared<CryptoUtil>();
+  if (hmacEnabled) {
+    crypto->init(kSecKeyVersion, "01234567890123456789012345678901");
+  }
+  return crypto;
+}
+
+std::vector<raft::LogEntry> createEntries(uint64_t firstIndex, uint64_t num,
+                                          uint64_t payloadSize, const CryptoUtil &crypto) {
+  std::vector<raft::LogEntry> entries(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    entries[i].mutable_version()->set_secret_key_version(crypto.getLatestSecKeyVersion());
+    entries[i].set_term(1);
+    entries[i].set_index(firstIndex + i);
+    entries[i].set_payload(std::string(payloadSize, 'a'));
+  }
+  return entries;
+}
+}  /// namespace
+
+/// append batches of range(1) entries of range(0) bytes, with HMAC if range(2) is not 0
+void BM_SegmentAppendEntries(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto payloadSize = static_cast<uint64_t>(state.range(0));
+  auto batchSize = static_cast<uint64_t>(state.range(1));
+  auto crypto = createCrypto(state.range(2) != 0);
+
+  resetLogDir();
+  auto segment = std::make_unique<Segment>(kLogDir, 1, kDataSizeLimit, kMetaSizeLimit, crypto);
+  auto entries = createEntries(1, batchSize, payloadSize, *crypto);
+
+  for (auto _ : state) {
+    if (segment->shouldRoll(entries)) {
+      /// start over in an empty dir instead of rolling, it is what SegmentLog benchmarks measure
+      state.PauseTiming();
+      auto firstIndex = segment->getLastIndex() + 1;
+      segment.reset();
+      resetLogDir();
+      segment = std::make_unique<Segment>(kLogDir, firstIndex, kDataSizeLimit, kMetaSizeLimit, crypto);
+      state.ResumeTiming();
+    }
+    segment->appendEntries(entries);
+    for (auto &entry : entries) {
+      entry.set_index(entry.index() + batchSize);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+  state.SetBytesProcessed(state.iterations() * batchSize * payloadSize);
+
+  segment.reset();
+  Util::executeCmd(std::string("rm -rf ") + kLogDir);
+}
+BENCHMARK(BM_SegmentAppendEntries)
+    ->Args({1024, 1, 0})
+    ->Args({1024, 100, 0})
+    ->Args({1024, 100, 1})
+    ->Args({16 * 1024, 100, 1});
+
+/// read batches of at most range(1) entries of range(0) bytes, with HMAC verified if range(2) is not 0
+void BM_SegmentGetEntries(::benchmark::State &state) {  // NOLINT[runtime/references]
+  constexpr uint64_t kNumEntries = 10000;
+  constexpr uint64_t kMaxLenInBytes = 4 * 1024 * 1024;
+  auto payloadSize = static_cast<uint64_t>(state.range(0));
+  auto batchSize = static_cast<uint64_t>(state.range(1));
+  auto crypto = createCrypto(state.range(2) != 0);
+
+  resetLogDir();
+  auto segment = std::make_unique<Segment>(kLogDir, 1, kDataSizeLimit * 4, kMetaSizeLimit, crypto);
+  segment->appendEntries(createEntries(1, kNumEntries, payloadSize, *crypto));
+
+  std::vector<raft::LogEntry> entries;
+  uint64_t startIndex = 1;
+  uint64_t numRead = 0;
+  for (auto _ : state) {
+    numRead += segment->getEntries(startIndex, kMaxLenInBytes, batchSize, &entries);
+    startIndex += batchSize;
+    if (startIndex + batchSize > kNumEntries) {
+      startIndex = 1;
+    }
+  }
+  state.SetItemsProcessed(numRead);
+  state.SetBytesProcessed(numRead * payloadSize);
+
+  segment.reset();
+  Util::executeCmd(std::string("rm -rf ") + kLogDir);
+}
+BENCHMARK(BM_SegmentGetEntries)
+    ->Args({1024, 1, 0})
+    ->Args({1024, 100, 0})
+    ->Args({1024, 100, 1})
+    ->Args({16 * 1024, 100, 1});
+
+}  /// namespace gringofts::storage::benchmark
@@ -0,0 +1,93 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "../../../../src/infra/raft/storage/SegmentLog.h"
+#include "../../../../src/infra/util/Util.h"
+
+namespace gringofts::storage::benchmark {
+
+namespace {
+constexpr const char *kLogDir = "../benchmark/data/segment_log";
+/// small segments so that appending rolls often
+constexpr uint64_t kSegmentDataSizeLimit = 1024 * 1024;
+constexpr uint64_t kSegmentMetaSizeLimit = 64 * 1024;
+constexpr uint64_t kPayloadSize = 1024;
+constexpr uint64_t kBatchSize = 100;
+
+void resetLogDir() {
+  Util::executeCmd(std::string("rm -rf ") + kLogDir + " && mkdir -p " + kLogDir);
+}
+
+/// append num entries to log in batches, return the index of the next entry
+uint64_t appendBatches(SegmentLog *log, uint64_t nextIndex, uint64_t numBatches) {
+  std::vector<raft::LogEntry> entries(kBatchSize);
+  for (auto &entry : entries) {
+    entry.mutable_version()->set_secret_key_version(log->getLatestSecKeyVersion());
+    entry.set_term(1);
+    entry.set_payload(std::string(kPayloadSize, 'a'));
+  }
+  for (uint64_t i = 0; i < numBatches; ++i) {
+    for (auto &entry : entries) {
+      entry.set_index(nextIndex++);
+    }
+    log->appendEntries(entries);
+  }
+  return nextIndex;
+}
+}  /// namespace
+
+/// append batches to a log which rolls a new segment every ~10 batches
+void BM_SegmentLogAppendWithRoll(::benchmark::State &state) {  // NOLINT[runtime/references]
+  resetLogDir();
+  auto crypto = std::make_shared<CryptoUtil>();
+  auto log = std::make_unique<SegmentLog>(kLogDir, crypto, kSegmentDataSizeLimit, kSegmentMetaSizeLimit);
+
+  uint64_t nextIndex = 1;
+  for (auto _ : state) {
+    nextIndex = appendBatches(log.get(), nextIndex, 1);
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+  state.SetBytesProcessed(state.iterations() * kBatchSize * kPayloadSize);
+
+  log.reset();
+  Util::executeCmd(std::string("rm -rf ") + kLogDir);
+}
+BENCHMARK(BM_SegmentLogAppendWithRoll);
+
+/// re-open a log of about range(0) closed segments
+void BM_SegmentLogRecover(::benchmark::State &state) {  // NOLINT[runtime/references]
+  /// a segment holds 10 batches, the 11th rolls
+  constexpr uint64_t kBatchesPerSegment = 10;
+  auto numSegments = static_cast<uint64_t>(state.range(0));
+
+  resetLogDir();
+  auto crypto = std::make_shared<CryptoUtil>();
+  {
+    SegmentLog log(kLogDir, crypto, kSegmentDataSizeLimit, kSegmentMetaSizeLimit);
+    appendBatches(&log, 1, numSegments * kBatchesPerSegment);
+  }
+
+  for (auto _ : state) {
+    SegmentLog log(kLogDir, crypto, kSegmentDataSizeLimit, kSegmentMetaSizeLimit);
+    ::benchmark::DoNotOptimize(log.getLastLogIndex());
+  }
+  state.SetItemsProcessed(state.iterations() * numSegments);
+
+  Util::executeCmd(std::string("rm -rf ") + kLogDir);
+}
+BENCHMARK(BM_SegmentLogRecover)->Arg(10)->Arg(100)->Unit(::benchmark::kMillisecond);
+
+}  /// namespace gringofts::storage::benchmark
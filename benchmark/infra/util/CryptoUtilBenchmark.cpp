@@ -0,0 +1,70 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "../../../src/infra/util/CryptoUtil.h"
+
+namespace gringofts::benchmark {
+
+namespace {
+constexpr SecKeyVersion kSecKeyVersion = 1;
+
+std::unique_ptr<CryptoUtil> createCrypto() {
+  auto crypto = std::make_unique<CryptoUtil>();
+  crypto->init(kSecKeyVersion, "01234567890123456789012345678901");
+  return crypto;
+}
+}  /// namespace
+
+/// in-place encryption of range(0) bytes, including the copy of the plain text
+void BM_CryptoUtilEncrypt(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto crypto = createCrypto();
+  const std::string plain(state.range(0), 'a');
+
+  for (auto _ : state) {
+    auto payload = plain;
+    ::benchmark::DoNotOptimize(crypto->encrypt(&payload, kSecKeyVersion));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CryptoUtilEncrypt)->Arg(256)->Arg(4 * 1024)->Arg(64 * 1024);
+
+/// in-place decryption of range(0) bytes, including the copy of the cipher text
+void BM_CryptoUtilDecrypt(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto crypto = createCrypto();
+  std::string cipher(state.range(0), 'a');
+  crypto->encrypt(&cipher, kSecKeyVersion);
+
+  for (auto _ : state) {
+    auto payload = cipher;
+    ::benchmark::DoNotOptimize(crypto->decrypt(&payload, kSecKeyVersion));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CryptoUtilDecrypt)->Arg(256)->Arg(4 * 1024)->Arg(64 * 1024);
+
+/// HMAC of range(0) bytes, as computed for every log entry appended or read
+void BM_CryptoUtilHmac(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto crypto = createCrypto();
+  const std::string data(state.range(0), 'a');
+
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(crypto->hmac(data, kSecKeyVersion));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CryptoUtilHmac)->Arg(256)->Arg(4 * 1024)->Arg(64 * 1024);
+
+}  /// namespace gringofts::benchmark
@@ -0,0 +1,69 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../../../src/infra/util/BigDecimal.h"
+#include "../../../src/infra/util/Money.h"
+
+namespace gringofts::benchmark {
+
+namespace {
+constexpr uint32_t kCurrencyCode = 156;
+
+std::vector<uint64_t> randomAmounts(std::size_t num) {
+  /// spread over the whole uint64 range of amounts on the wire
+  std::mt19937_64 generator(num);
+  std::vector<uint64_t> amounts(num);
+  for (auto &amount : amounts) {
+    amount = generator();
+  }
+  return amounts;
+}
+}  /// namespace
+
+/// sum range(0) amounts one by one in Money, as done for the lines of a journal entry
+void BM_MoneyTryAdd(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto amounts = randomAmounts(state.range(0));
+
+  for (auto _ : state) {
+    Money sum(0, kCurrencyCode);
+    for (auto amount : amounts) {
+      sum.tryAdd(Money(amount, kCurrencyCode));
+    }
+    ::benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MoneyTryAdd)->Arg(16)->Arg(1024);
+
+/// the same sum in BigDecimal, the arbitrary precision alternative
+void BM_BigDecimalAdd(::benchmark::State &state) {  // NOLINT[runtime/references]
+  auto amounts = randomAmounts(state.range(0));
+
+  for (auto _ : state) {
+    BigDecimal sum(0);
+    for (auto amount : amounts) {
+      sum = sum + BigDecimal(amount);
+    }
+    ::benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BigDecimalAdd)->Arg(16)->Arg(1024);
+
+}  /// namespace gringofts::benchmark
@@ -55,9 +55,15 @@ endfunction(ADD_PROTO_RESOURCE)
 #       execution_proto_library  # dependency-1
 #       account_proto_library  # dependency-2
 #       )
+# Protos importing files outside their own dir list those dirs in PROTO_IMPORT_PATHS before the call.
 function(ADD_PROTO_SET LIB_NAME FILE_SET GEN_DIR)
     set(GEN_FILES "")
 
+    set(IMPORT_ARGS "")
+    foreach(import_path ${PROTO_IMPORT_PATHS})
+        list(APPEND IMPORT_ARGS -I "${import_path}")
+    endforeach(import_path)
+
     foreach(filename ${FILE_SET})
         get_filename_component(PROTO_NAME "${filename}" NAME_WE)
         get_filename_component(${PROTO_NAME}_proto "${filename}" ABSOLUTE)
@@ -81,6 +87,7 @@ function(ADD_PROTO_SET LIB_NAME FILE_SET GEN_DIR)
                 ARGS --grpc_out "${GEN_DIR}"
                 --cpp_out "${GEN_DIR}"
                 -I "${${PROTO_NAME}_proto_path}"
+                ${IMPORT_ARGS}
                 --plugin=protoc-gen-grpc="${_GRPC_CPP_PLUGIN_EXECUTABLE}"
                 "${${PROTO_NAME}_proto}"
                 DEPENDS ${${PROTO_NAME}_proto}
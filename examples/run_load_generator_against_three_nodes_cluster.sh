@@ -0,0 +1,9 @@
+#!/bin/bash
+
+WORKING_DIR=$(pwd)
+echo "working dir=${WORKING_DIR}"
+
+set -x
+
+# start the cluster by examples/run_demo_backed_by_three_nodes_cluster.sh first
+./build/LedgerLoadGenerator conf/loadgen.ini
@@ -0,0 +1,33 @@
+#!/bin/bash
+# this script fails if any metric is looked up by name outside of initialization.
+#
+# getGauge()/getCounter()/getSummary()/getHistogram() build a label map and take registry locks,
+# so they should only be called where handles are initialized, i.e., member initializer lists and
+# function-local statics, and the handles are kept. A lookup that is known to be off the hot path,
+# e.g., during startup, can be marked with a "metric-lookup: <reason>" comment on the same line.
+
+ROOT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+
+LOOKUP='(\bget(Gauge|Counter|Summary|Histogram)|\.(gauge|counter|summary|histogram))\('
+GET='(gringofts::)?get(Gauge|Counter|Summary|Histogram)\('
+# grep -n prefix, i.e., "path:line:" followed by indentation
+LINE='^[^:]+:[0-9]+:[[:space:]]*'
+# initializer list entry, e.g., ": mMember(getGauge(...))," or "Foo() : mMember(getGauge(...)) {",
+# a statement such as "someCall(getGauge(...));" ends with a semicolon instead
+INIT_LIST="(${LINE}|\)[[:space:]]*:[[:space:]]*)[:,]?[[:space:]]*[a-zA-Z_][a-zA-Z0-9_]*\(${GET}.*[^;[:space:]][[:space:]]*\$"
+# function-local static initialized by the lookup, e.g., "static auto handle = getGauge(...)"
+STATIC_DECL="${LINE}static (const )?auto &?[a-zA-Z_][a-zA-Z0-9_]* = ${GET}"
+INIT="(${INIT_LIST})|(${STATIC_DECL})"
+
+VIOLATIONS=$(grep -rnE "$LOOKUP" "$ROOT_DIR/src" \
+    --include=*.h --include=*.hpp --include=*.cpp --include=*.cc \
+    | grep -v "^$ROOT_DIR/src/infra/monitor/" \
+    | grep -vE "$INIT" \
+    | grep -v "metric-lookup:")
+
+if [ -n "$VIOLATIONS" ]; then
+  echo "metric lookups outside of initialization, keep the handle instead:"
+  echo "$VIOLATIONS" | sed "s|^$ROOT_DIR/||"
+  exit 1
+fi
+echo "no metric lookup outside of initialization"
@@ -59,6 +59,11 @@ cd ~/temp &&
   cd rocksdb &&
   git checkout v6.5.2 &&
   git submodule update --init --recursive
+# download google benchmark
+cd ~/temp &&
+  git clone https://github.com/google/benchmark.git &&
+  cd benchmark &&
+  git checkout v1.5.0
 # download and install tools for code coverage
 sudo apt-get install -y lcov
 # download and install tools required by gringofts
@@ -68,6 +68,17 @@ if [ -z "$ROCKSDB" ]; then
 else
   echo "RocksDB has been installed, skip"
 fi
+# install google benchmark
+BENCHMARK=$(find /usr/local/lib -name '*libbenchmark*')
+if [ -z "$BENCHMARK" ]; then
+  cd ~/temp/benchmark &&
+    mkdir -p build && cd build &&
+    CXX=g++-9 CC=gcc-9 cmake -DBENCHMARK_ENABLE_TESTING=OFF -DCMAKE_BUILD_TYPE=Release .. &&
+    make && sudo make install
+  checkLastSuccess "install google benchmark fails"
+else
+  echo "google benchmark has been installed, skip"
+fi
 # give read access to cmake modules
 sudo chmod o+rx -R /usr/local/lib/cmake
 sudo chmod o+rx -R /usr/local/include/
@@ -0,0 +1,313 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "LoadGenerator.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <spdlog/spdlog.h>
+
+#include "../../infra/util/HttpCode.h"
+#include "../should_be_generated/domain/BusinessCode.h"
+#include "../should_be_generated/domain/TransactionType.h"
+
+namespace gringofts::ledger::loadgen {
+
+namespace {
+constexpr uint64_t kNanosPerSecond = 1'000'000'000;
+constexpr uint64_t kRpcTimeoutInSec = 10;
+}  /// namespace
+
+LoadConfig LoadConfig::fromIni(const INIReader &reader) {
+  LoadConfig config;
+
+  auto mode = reader.Get("loadgen", "mode", "closed");
+  if (mode != "closed" && mode != "open") {
+    SPDLOG_ERROR("unknown mode {}, should be either closed or open", mode);
+    exit(1);
+  }
+  config.mMode = mode == "open" ? Mode::Open : Mode::Closed;
+  config.mConcurrency = reader.GetInteger("loadgen", "concurrency", config.mConcurrency);
+  config.mRatePerSecond = reader.GetInteger("loadgen", "rate.per.second", config.mRatePerSecond);
+  config.mDurationInSec = reader.GetInteger("loadgen", "duration.in.sec", config.mDurationInSec);
+  config.mReportIntervalInSec = reader.GetInteger("loadgen", "report.interval.in.sec", config.mReportIntervalInSec);
+  config.mNumAccounts = reader.GetInteger("loadgen", "num.accounts", config.mNumAccounts);
+  config.mFirstNominalCode = reader.GetInteger("loadgen", "first.nominal.code", config.mFirstNominalCode);
+  config.mCurrencyCode = reader.GetInteger("loadgen", "iso4217.currency.code", config.mCurrencyCode);
+  config.mZipfTheta = reader.GetReal("loadgen", "zipf.theta", config.mZipfTheta);
+  config.mLinesPerEntry = reader.GetInteger("loadgen", "lines.per.entry", config.mLinesPerEntry);
+  config.mAmount = reader.GetInteger("loadgen", "amount", config.mAmount);
+
+  if (config.mConcurrency == 0 || config.mRatePerSecond == 0 || config.mReportIntervalInSec == 0) {
+    SPDLOG_ERROR("concurrency, rate.per.second and report.interval.in.sec should be positive");
+    exit(1);
+  }
+  if (config.mNumAccounts < 2 || config.mLinesPerEntry < 2 || config.mLinesPerEntry % 2 != 0) {
+    SPDLOG_ERROR("num.accounts should be at least 2, lines.per.entry should be even and at least 2");
+    exit(1);
+  }
+  if (config.mZipfTheta < 0 || config.mZipfTheta >= 1) {
+    SPDLOG_ERROR("zipf.theta should be in [0, 1)");
+    exit(1);
+  }
+
+  /// e.g., 1@0.0.0.0:50055,2@0.0.0.0:50056,3@0.0.0.0:50057
+  auto gateways = reader.Get("loadgen", "gateways", "1@0.0.0.0:50055");
+  for (std::string_view gateway : absl::StrSplit(gateways, ",")) {
+    std::pair<std::string, std::string> idWithAddress = absl::StrSplit(gateway, "@");
+    config.mGateways[std::stoi(idWithAddress.first)] = idWithAddress.second;
+  }
+
+  SPDLOG_INFO("load: mode={}, concurrency={}, rate.per.second={}, duration.in.sec={}, num.accounts={}, "
+              "zipf.theta={}, lines.per.entry={}, gateways={}",
+              mode, config.mConcurrency, config.mRatePerSecond, config.mDurationInSec, config.mNumAccounts,
+              config.mZipfTheta, config.mLinesPerEntry, gateways);
+  return config;
+}
+
+LoadGenerator::LoadGenerator(const LoadConfig &config)
+    : mConfig(config),
+      mLeaderId(config.mGateways.begin()->first),
+      mAssetPicker(config.mNumAccounts / 2, config.mZipfTheta, 1),
+      mLiabilityPicker(config.mNumAccounts / 2, config.mZipfTheta, 2),
+      mRunId(std::to_string(TimeUtil::currentTimeInNanos())) {
+  for (const auto &[nodeId, address] : mConfig.mGateways) {
+    auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    mStubs[nodeId] = protos::LedgerService::NewStub(channel);
+  }
+}
+
+void LoadGenerator::createAccounts() {
+  /// account i is an asset if i is even, a liability otherwise
+  for (uint64_t i = 0; i < mConfig.mNumAccounts; ++i) {
+    protos::CreateAccount::Request request;
+    auto *account = request.mutable_account();
+    account->set_version(1);
+    account->set_type(i % 2 == 0 ? protos::AccountType::Asset : protos::AccountType::Liability);
+    account->set_nominal_code(mConfig.mFirstNominalCode + i);
+    account->set_name("loadgen");
+    account->set_desc("account created by load generator");
+    account->set_iso4217_currency_code(mConfig.mCurrencyCode);
+    account->mutable_balance()->set_version(1);
+    account->mutable_balance()->set_value(0);
+
+    while (true) {
+      grpc::ClientContext context;
+      context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(kRpcTimeoutInSec));
+      protos::CreateAccount::Response response;
+      NodeId nodeId = mLeaderId;
+      auto status = mStubs.at(nodeId)->CreateAccount(&context, request, &response);
+      if (status.ok() && (response.code() == HttpCode::OK
+          || response.code() == BusinessCode::ACCOUNT_ALREADY_EXISTS)) {
+        break;
+      }
+      if (status.ok() && response.code() == HttpCode::MOVED_PERMANENTLY) {
+        onRedirected(response.reserved());
+        continue;
+      }
+      SPDLOG_WARN("failed to create account {}, status={}, code={}, message={}, retry in 1s",
+                  account->nominal_code(), status.error_message(), response.code(), response.message());
+      if (!status.ok()) {
+        /// node is down or unreachable, try the next one
+        rotateGateway(nodeId);
+      }
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+  }
+  SPDLOG_INFO("{} accounts are ready", mConfig.mNumAccounts);
+}
+
+protos::RecordJournalEntry::Request LoadGenerator::nextRequest() {
+  auto now = TimeUtil::currentTimeInNanos();
+  protos::RecordJournalEntry::Request request;
+  auto *journalEntry = request.mutable_journal_entry();
+  journalEntry->set_version(1);
+  journalEntry->set_id(mRunId + "-" + std::to_string(mNextEntryId++));
+  journalEntry->set_valid_time(now);
+  journalEntry->set_record_time(now);
+  journalEntry->set_purpose("loadgen");
+  for (uint32_t i = 0; i < mConfig.mLinesPerEntry; ++i) {
+    /// debiting an asset or crediting a liability both increase the balance
+    auto isDebit = i % 2 == 0;
+    auto rank = isDebit ? mAssetPicker.next() : mLiabilityPicker.next();
+    auto *journalLine = journalEntry->add_journal_lines();
+    journalLine->set_version(1);
+    journalLine->set_nominal_code(mConfig.mFirstNominalCode + rank * 2 + (isDebit ? 0 : 1));
+    journalLine->set_transaction_type(TransactionTypeUtil::toType(isDebit ? TransactionType::Debit
+                                                                          : TransactionType::Credit));
+    journalLine->mutable_amount()->set_version(1);
+    journalLine->mutable_amount()->set_value(mConfig.mAmount);
+    journalLine->set_iso4217_currency_code(mConfig.mCurrencyCode);
+  }
+  return request;
+}
+
+void LoadGenerator::onRedirected(const std::string &leaderHint) {
+  NodeId leaderId = 0;
+  if (!absl::SimpleAtoi(leaderHint, &leaderId) || mStubs.find(leaderId) == mStubs.end()) {
+    /// leader unknown yet, try the next node
+    rotateGateway(mLeaderId);
+    return;
+  }
+  mLeaderId = leaderId;
+}
+
+void LoadGenerator::rotateGateway(NodeId failedNodeId) {
+  auto next = mStubs.upper_bound(failedNodeId);
+  NodeId nextId = next == mStubs.end() ? mStubs.begin()->first : next->first;
+  /// in-flight calls to the same node fail together, rotate once for them
+  mLeaderId.compare_exchange_strong(failedNodeId, nextId);
+}
+
+void LoadGenerator::send(TimestampInNanos dueTimeInNanos) {
+  auto *call = new Call;
+  call->mDueTimeInNanos = dueTimeInNanos;
+  call->mContext.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(kRpcTimeoutInSec));
+  call->mNodeId = mLeaderId;
+
+  ++mInFlight;
+  call->mResponseReader = mStubs.at(call->mNodeId)->PrepareAsyncRecordJournalEntry(&call->mContext,
+                                                                                  nextRequest(),
+                                                                                  &mCompletionQueue);
+  call->mResponseReader->StartCall();
+  call->mResponseReader->Finish(&call->mResponse, &call->mStatus, call);
+}
+
+void LoadGenerator::sendAtRate(TimestampInNanos deadlineInNanos) {
+  auto intervalInNanos = kNanosPerSecond / mConfig.mRatePerSecond;
+  auto dueTimeInNanos = TimeUtil::currentTimeInNanos();
+  while (dueTimeInNanos < deadlineInNanos) {
+    auto now = TimeUtil::currentTimeInNanos();
+    if (now < dueTimeInNanos) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(dueTimeInNanos - now));
+    }
+    /// beyond concurrency, wait rather than pile up; the wait still counts in latency
+    while (mInFlight >= mConfig.mConcurrency) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    send(dueTimeInNanos);
+    dueTimeInNanos += intervalInNanos;
+  }
+  mSending = false;
+}
+
+void LoadGenerator::run() {
+  auto startTimeInNanos = TimeUtil::currentTimeInNanos();
+  auto deadlineInNanos = startTimeInNanos + mConfig.mDurationInSec * kNanosPerSecond;
+
+  mSending = true;
+  std::thread openLoop;
+  if (mConfig.mMode == LoadConfig::Mode::Open) {
+    openLoop = std::thread([this, deadlineInNanos] {
+      pthread_setname_np(pthread_self(), "OpenLoop");
+      sendAtRate(deadlineInNanos);
+    });
+  } else {
+    for (uint64_t i = 0; i < mConfig.mConcurrency; ++i) {
+      send(startTimeInNanos);
+    }
+  }
+
+  HdrHistogram intervalLatency;
+  HdrHistogram totalLatency;
+  uint64_t succeeded = 0, redirected = 0, failed = 0;
+  uint64_t totalSucceeded = 0, totalRedirected = 0, totalFailed = 0;
+  auto intervalStartInNanos = startTimeInNanos;
+
+  /// until the duration is over and every reply is in
+  while (true) {
+    auto now = TimeUtil::currentTimeInNanos();
+    if (mConfig.mMode == LoadConfig::Mode::Closed && now >= deadlineInNanos) {
+      mSending = false;
+    }
+    if (!mSending && mInFlight == 0) {
+      break;
+    }
+    if (now - intervalStartInNanos >= mConfig.mReportIntervalInSec * kNanosPerSecond) {
+      report("interval", intervalLatency, succeeded, redirected, failed, now - intervalStartInNanos);
+      totalLatency.merge(intervalLatency);
+      totalSucceeded += succeeded;
+      totalRedirected += redirected;
+      totalFailed += failed;
+      intervalLatency.reset();
+      succeeded = redirected = failed = 0;
+      intervalStartInNanos = now;
+    }
+
+    void *tag = nullptr;
+    bool ok = false;
+    auto status = mCompletionQueue.AsyncNext(&tag, &ok,
+                                             std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+    if (status != grpc::CompletionQueue::GOT_EVENT) {
+      continue;
+    }
+
+    std::unique_ptr<Call> call(static_cast<Call *>(tag));
+    --mInFlight;
+    auto completedTimeInNanos = TimeUtil::currentTimeInNanos();
+    if (ok && call->mStatus.ok() && call->mResponse.code() == HttpCode::OK) {
+      ++succeeded;
+      intervalLatency.record(completedTimeInNanos - call->mDueTimeInNanos);
+    } else if (ok && call->mStatus.ok() && call->mResponse.code() == HttpCode::MOVED_PERMANENTLY) {
+      ++redirected;
+      onRedirected(call->mResponse.reserved());
+    } else {
+      ++failed;
+      SPDLOG_WARN("request failed, status={}, code={}, message={}",
+                  call->mStatus.error_message(), call->mResponse.code(), call->mResponse.message());
+      if (!ok || !call->mStatus.ok()) {
+        /// node is down or unreachable, try the next one
+        rotateGateway(call->mNodeId);
+      }
+    }
+
+    if (mConfig.mMode == LoadConfig::Mode::Closed && mSending) {
+      send(completedTimeInNanos);
+    }
+  }
+
+  if (openLoop.joinable()) {
+    openLoop.join();
+  }
+  mCompletionQueue.Shutdown();
+  void *tag = nullptr;
+  bool ok = false;
+  while (mCompletionQueue.Next(&tag, &ok)) {}
+
+  totalLatency.merge(intervalLatency);
+  report("total", totalLatency, totalSucceeded + succeeded, totalRedirected + redirected, totalFailed + failed,
+         TimeUtil::currentTimeInNanos() - startTimeInNanos);
+}
+
+void LoadGenerator::report(const std::string &title, const HdrHistogram &latency,
+                           uint64_t succeeded, uint64_t redirected, uint64_t failed,
+                           uint64_t elapsedInNanos) const {
+  auto toMs = [](uint64_t nanos) { return nanos / 1'000'000.0; };
+  SPDLOG_INFO("[{}] throughput={:.1f}/s, succeeded={}, redirected={}, failed={}, "
+              "latency(ms): mean={:.3f}, p50={:.3f}, p90={:.3f}, p99={:.3f}, p99.9={:.3f}, p99.99={:.3f}, max={:.3f}",
+              title, succeeded * 1.0 * kNanosPerSecond / std::max<uint64_t>(elapsedInNanos, 1),
+              succeeded, redirected, failed,
+              latency.mean() / 1'000'000.0,
+              toMs(latency.valueAtPercentile(50)),
+              toMs(latency.valueAtPercentile(90)),
+              toMs(latency.valueAtPercentile(99)),
+              toMs(latency.valueAtPercentile(99.9)),
+              toMs(latency.valueAtPercentile(99.99)),
+              toMs(latency.max()));
+}
+
+}  /// namespace gringofts::ledger::loadgen
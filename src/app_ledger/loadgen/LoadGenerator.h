@@ -0,0 +1,127 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_APP_LEDGER_LOADGEN_LOADGENERATOR_H_
+#define SRC_APP_LEDGER_LOADGEN_LOADGENERATOR_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include <INIReader.h>
+#include <grpcpp/grpcpp.h>
+
+#include "../../infra/util/ClusterInfo.h"
+#include "../../infra/util/HdrHistogram.h"
+#include "../../infra/util/TimeUtil.h"
+#include "../generated/grpc/ledger.grpc.pb.h"
+#include "ZipfianGenerator.h"
+
+namespace gringofts::ledger::loadgen {
+
+/**
+ * Configurations of the load, read from section [loadgen].
+ */
+struct LoadConfig {
+  enum class Mode {
+    /// keep concurrency requests in flight, the next is sent once one replies
+    Closed,
+    /// send rate requests per second whatever the replies, at most concurrency in flight
+    Open,
+  };
+
+  Mode mMode = Mode::Closed;
+  uint64_t mConcurrency = 64;
+  uint64_t mRatePerSecond = 1000;
+  uint64_t mDurationInSec = 60;
+  uint64_t mReportIntervalInSec = 5;
+
+  /// half assets which are debited, half liabilities which are credited, so that balances only grow
+  uint64_t mNumAccounts = 10000;
+  uint64_t mFirstNominalCode = 1000000;
+  uint64_t mCurrencyCode = 156;
+  /// skew of accounts picked by journal lines, 0 is uniform
+  double mZipfTheta = 0.99;
+  /// lines per journal entry, half debit and half credit
+  uint32_t mLinesPerEntry = 2;
+  uint64_t mAmount = 1;
+
+  /// gateway of each node
+  std::map<NodeId, std::string> mGateways;
+
+  static LoadConfig fromIni(const INIReader &reader);
+};
+
+/**
+ * Drive RecordJournalEntry over gRPC as a client would, follow leader redirects,
+ * and report throughput and latency percentiles.
+ *
+ * Latency is measured from when a request was due to be sent rather than when it was sent,
+ * so that in open loop a stalled server is not hidden by requests piling up in the client.
+ */
+class LoadGenerator {
+ public:
+  explicit LoadGenerator(const LoadConfig &config);
+
+  /// create the chart of accounts, accounts created by a previous run are kept
+  void createAccounts();
+
+  /// send journal entries for the configured duration, then report
+  void run();
+
+ private:
+  struct Call {
+    grpc::ClientContext mContext;
+    protos::RecordJournalEntry::Response mResponse;
+    grpc::Status mStatus;
+    TimestampInNanos mDueTimeInNanos = 0;
+    NodeId mNodeId = 0;
+    std::unique_ptr<grpc::ClientAsyncResponseReader<protos::RecordJournalEntry::Response>> mResponseReader;
+  };
+
+  /// send a journal entry which was due at dueTimeInNanos
+  void send(TimestampInNanos dueTimeInNanos);
+
+  /// send rate journal entries per second until deadline
+  void sendAtRate(TimestampInNanos deadlineInNanos);
+
+  protos::RecordJournalEntry::Request nextRequest();
+
+  /// follow the leader hint of a redirect
+  void onRedirected(const std::string &leaderHint);
+
+  /// move on to the node after failedNodeId, unless another call already did
+  void rotateGateway(NodeId failedNodeId);
+
+  void report(const std::string &title, const HdrHistogram &latency,
+              uint64_t succeeded, uint64_t redirected, uint64_t failed, uint64_t elapsedInNanos) const;
+
+  LoadConfig mConfig;
+  std::map<NodeId, std::unique_ptr<protos::LedgerService::Stub>> mStubs;
+  std::atomic<NodeId> mLeaderId;
+
+  /// calls are sent by the open loop thread in open loop, by the completion thread otherwise
+  grpc::CompletionQueue mCompletionQueue;
+  std::atomic<bool> mSending = false;
+  std::atomic<uint64_t> mInFlight = 0;
+
+  ZipfianGenerator mAssetPicker;
+  ZipfianGenerator mLiabilityPicker;
+  std::string mRunId;
+  uint64_t mNextEntryId = 0;
+};
+
+}  /// namespace gringofts::ledger::loadgen
+
+#endif  // SRC_APP_LEDGER_LOADGEN_LOADGENERATOR_H_
@@ -0,0 +1,34 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <spdlog/spdlog.h>
+
+#include "../../infra/util/LogUtil.h"
+#include "LoadGenerator.h"
+
+int main(int argc, char **argv) {
+  assert(argc == 2);
+
+  INIReader reader(argv[1]);
+  gringofts::LogUtil::initLogger(reader, "[%D %H:%M:%S.%F] [%l] %v");
+  if (reader.ParseError() < 0) {
+    SPDLOG_ERROR("Cannot load config file {}, exiting", argv[1]);
+    return 1;
+  }
+
+  gringofts::ledger::loadgen::LoadGenerator loadGenerator(gringofts::ledger::loadgen::LoadConfig::fromIni(reader));
+  loadGenerator.createAccounts();
+  loadGenerator.run();
+  gringofts::LogUtil::shutdown();
+}
@@ -0,0 +1,74 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_APP_LEDGER_LOADGEN_ZIPFIANGENERATOR_H_
+#define SRC_APP_LEDGER_LOADGEN_ZIPFIANGENERATOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+namespace gringofts::ledger::loadgen {
+
+/**
+ * Draw ranks in [0, n) where rank i is drawn with probability proportional to 1 / (i + 1)^theta,
+ * i.e., a few ranks are hot. theta = 0 is uniform, YCSB uses 0.99.
+ * Algorithm from "Quickly Generating Billion-Record Synthetic Databases", Gray et al.
+ */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t n, double theta, uint64_t seed)
+      : mN(n), mTheta(theta), mGenerator(seed) {
+    assert(n > 0);
+    assert(theta >= 0 && theta < 1);
+    mZetaN = zeta(n, theta);
+    mAlpha = 1 / (1 - theta);
+    mEta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / mZetaN);
+  }
+
+  uint64_t next() {
+    auto u = mUniform(mGenerator);
+    auto uz = u * mZetaN;
+    if (uz < 1) {
+      return 0;
+    }
+    if (mN > 1 && uz < 1 + std::pow(0.5, mTheta)) {
+      return 1;
+    }
+    auto rank = static_cast<uint64_t>(mN * std::pow(mEta * u - mEta + 1, mAlpha));
+    return std::min(rank, mN - 1);
+  }
+
+ private:
+  static double zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; ++i) {
+      sum += 1 / std::pow(i, theta);
+    }
+    return sum;
+  }
+
+  uint64_t mN;
+  double mTheta;
+  double mZetaN;
+  double mAlpha;
+  double mEta;
+  std::mt19937_64 mGenerator;
+  std::uniform_real_distribution<double> mUniform{0, 1};
+};
+
+}  /// namespace gringofts::ledger::loadgen
+
+#endif  // SRC_APP_LEDGER_LOADGEN_ZIPFIANGENERATOR_H_
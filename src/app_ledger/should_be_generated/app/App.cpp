@@ -16,9 +16,11 @@ limitations under the License.
 
 #include "../../../infra/es/store/RaftCommandEventStore.h"
 #include "../../../infra/es/store/ReadonlyRaftCommandEventStore.h"
+#include "../../../infra/monitor/CommandTracer.h"
 #include "../../../infra/monitor/Monitorable.h"
 #include "../../../infra/raft/RaftBuilder.h"
 #include "../../../infra/raft/metrics/RaftMonitorAdaptor.h"
+#include "../../../infra/util/ThreadPlacement.h"
 
 namespace gringofts {
 namespace ledger {
@@ -32,6 +34,9 @@ App::App(const char *configPath) : mIsShutdown(false) {
     throw std::runtime_error("Cannot load config file");
   }
 
+  /// before any thread is spawned, so that they inherit shared.cpus
+  ThreadPlacement::getInstance().init(reader);
+
   app::AppInfo::init(reader);
 
   mCrypto = std::make_shared<gringofts::CryptoUtil>();
@@ -56,7 +61,7 @@ App::App(const char *configPath) : mIsShutdown(false) {
   assert(appVersion == "v2");
   mEventApplyLoop =
       std::make_shared<app::EventApplyLoop<v2::RocksDBBackedAppStateMachine>>(
-          reader, commandEventDecoder, std::move(mReadonlyCommandEventStoreForEventApplyLoop), snapshotDir);
+          reader, commandEventDecoder, std::move(mReadonlyCommandEventStoreForEventApplyLoop), snapshotDir, mFactory);
   mCommandProcessLoop = std::make_unique<CommandProcessLoop<v2::MemoryBackedAppStateMachine>>(
       reader,
       commandEventDecoder,
@@ -68,7 +73,7 @@ App::App(const char *configPath) : mIsShutdown(false) {
       snapshotDir,
       mFactory);
 
-  mRequestReceiver = ::std::make_unique<RequestReceiver>(reader, app::AppInfo::gatewayPort(), mCommandQueue);
+  mRequestReceiver = ::std::make_unique<RequestReceiver>(reader, app::AppInfo::gatewayPort(), mCommandQueue, mRaftImpl);
   mNetAdminServer = ::std::make_unique<app::NetAdminServer>(reader, mEventApplyLoop);
 }
 
@@ -96,7 +101,7 @@ void App::initMonitor(const INIReader &reader) {
   appInfo.setAppInfo(appName, appVersion, appEnv);
 
   auto startTime = TimeUtil::currentTimeInNanos();
-  appInfo.gauge("start_time_gauge", {}).set(startTime);
+  appInfo.gauge("start_time_gauge", {}).set(startTime);  /// metric-lookup: once on startup
 
   server.Registry(appInfo);
   server.Registry(gringofts::Singleton<gringofts::MonitorCenter>::getInstance());
@@ -105,15 +110,30 @@ void App::initMonitor(const INIReader &reader) {
               appVersion,
               appEnv,
               startTime);
+
+  auto &tracer = gringofts::CommandTracer::getInstance();
+  tracer.setSampleEveryN(reader.GetInteger("monitor", "trace.sample.every.n", 0));
+  tracer.setMaxKeptTraces(reader.GetInteger("monitor", "trace.max.kept", 1000));
 }
 
 void App::initMemoryPool(const INIReader &reader) {
-  if (gringofts::PerfConfig::getInstance().getMemoryPoolType() == "monotonic") {
+  auto &perfConfig = gringofts::PerfConfig::getInstance();
+  perfConfig.setMemoryPoolType(reader.Get("memory", "pool.type", perfConfig.getMemoryPoolType()));
+  perfConfig.setMaxMemoryPoolSizeInMB(
+      reader.GetInteger("memory", "max.pool.size.in.mb", perfConfig.getMaxMemoryPoolSizeInMB()));
+
+  if (perfConfig.getMemoryPoolType() == "monotonic") {
     mFactory = std::make_shared<gringofts::PMRContainerFactory>(
         "PMRFactory",
         std::make_unique<gringofts::MonotonicPMRMemoryPool>(
             "monotonicPool",
-            gringofts::PerfConfig::getInstance().getMaxMemoryPoolSizeInMB()));
+            perfConfig.getMaxMemoryPoolSizeInMB()));
+  } else if (perfConfig.getMemoryPoolType() == "pool") {
+    SPDLOG_INFO("memory pool type pool is unbounded, max.pool.size.in.mb is ignored");
+    mFactory = std::make_shared<gringofts::PMRContainerFactory>(
+        "PMRFactory",
+        std::make_unique<gringofts::PoolPMRMemoryPool>(
+            "pool"));
   } else {
     mFactory = std::make_shared<gringofts::PMRContainerFactory>(
         "PMRFactory",
@@ -164,6 +184,7 @@ void App::startRequestReceiver() {
 void App::startNetAdminServer() {
   mNetAdminServerThread = std::thread([this]() {
     pthread_setname_np(pthread_self(), "NetAdmin");
+    ThreadPlacement::getInstance().place("NetAdmin");
     mNetAdminServer->run();
   });
 }
@@ -171,6 +192,7 @@ void App::startNetAdminServer() {
 void App::startProcessCommandLoop() {
   mCommandProcessLoopThread = std::thread([this]() {
     pthread_setname_np(pthread_self(), "CommandProcLoop");
+    ThreadPlacement::getInstance().place("CommandProcLoop");
     assert(mDeploymentMode == DeploymentMode::Distributed);
     mCommandProcessLoop->runDistributed();
   });
@@ -179,6 +201,7 @@ void App::startProcessCommandLoop() {
 void App::startEventApplyLoop() {
   mEventApplyLoopThread = std::thread([this]() {
     pthread_setname_np(pthread_self(), "EventApplyLoop");
+    ThreadPlacement::getInstance().place("EventApplyLoop");
     mEventApplyLoop->run();
   });
 }
@@ -186,6 +209,7 @@ void App::startEventApplyLoop() {
 void App::startPersistLoop() {
   mPersistLoopThread = std::thread([this]() {
     pthread_setname_np(pthread_self(), "CmdEvtStoreMain");
+    ThreadPlacement::getInstance().place("CmdEvtStoreMain");
     mCommandEventStore->run();
   });
 }
@@ -13,15 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 **************************************************************************/
 
-#include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include "../../../infra/util/LogUtil.h"
 #include "App.h"
 
 int main(int argc, char **argv) {
-  spdlog::stdout_logger_mt("console");
-  spdlog::set_pattern("[%D %H:%M:%S.%F] [%s:%# %!] [%l] [thread %t] %v");
-  SPDLOG_INFO("pid={}", getpid());
   assert(argc == 2);
+  gringofts::LogUtil::initLogger(INIReader(argv[1]), "[%D %H:%M:%S.%F] [%s:%# %!] [%l] [thread %t] %v");
+  SPDLOG_INFO("pid={}", getpid());
   gringofts::ledger::App(argv[1]).run();
+  gringofts::LogUtil::shutdown();
 }
@@ -14,6 +14,9 @@ limitations under the License.
 
 #include "RequestReceiver.h"
 
+#include "../../../infra/grpc/AdmissionController.h"
+#include "../../../infra/util/ThreadPlacement.h"
+#include "calldatas/BatchCallData.h"
 #include "calldatas/RequestCallData.h"
 
 namespace gringofts {
@@ -21,11 +24,17 @@ namespace ledger {
 
 RequestReceiver::RequestReceiver(const INIReader &reader,
                                  uint32_t port,
-                                 BlockingQueue<std::shared_ptr<Command>> &commandQueue)  // NOLINT(runtime/references)
-    : mCommandQueue(commandQueue) {
+                                 BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT(runtime/references)
+                                 std::shared_ptr<raft::RaftInterface> raftImpl)
+    : mCommandQueue(commandQueue),
+      mForwarder(std::make_unique<app::LeaderForwarder>(reader, std::move(raftImpl))) {
   mIpPort = "0.0.0.0:" + std::to_string(port);
   assert(mIpPort != "UNKNOWN");
   mTlsConfOpt = TlsUtil::parseTlsConf(reader, "tls");
+  /// one completion queue per receive thread
+  mConcurrency = reader.GetInteger("threads", "receiver.concurrency", 1);
+  assert(mConcurrency > 0);
+  AdmissionController::getInstance().init(reader);
 }
 
 void RequestReceiver::startListen() {
@@ -43,6 +52,7 @@ void RequestReceiver::startListen() {
   // Register "service" as the instance through which we'll communicate with
   // clients. In this case it corresponds to an *synchronous* service.
   builder.RegisterService(&mService);
+  builder.RegisterService(&mBatchService);
 
   for (uint64_t i = 0; i < mConcurrency; ++i) {
     mCompletionQueues.emplace_back(builder.AddCompletionQueue());
@@ -54,8 +64,13 @@ void RequestReceiver::startListen() {
   // Spawn a new CallData instance to serve new clients.
   for (uint64_t i = 0; i < mPreSpawn; ++i) {
     for (uint64_t j = 0; j < mConcurrency; ++j) {
-      new ConfigureAccountMetadataCallData(&mService, mCompletionQueues[j].get(), mCommandQueue);
-      new CreateAccountCallData(&mService, mCompletionQueues[j].get(), mCommandQueue);
+      auto *completionQueue = mCompletionQueues[j].get();
+      auto *forwarder = mForwarder.get();
+      new ConfigureAccountMetadataCallData(&mService, completionQueue, mCommandQueue, forwarder);
+      new CreateAccountCallData(&mService, completionQueue, mCommandQueue, forwarder);
+      new RecordJournalEntryCallData(&mService, completionQueue, mCommandQueue, forwarder);
+      new BatchRecordJournalEntriesCallData(&mBatchService, completionQueue, mCommandQueue, forwarder);
+      new StreamRecordJournalEntriesCallData(&mBatchService, completionQueue, mCommandQueue, forwarder);
     }
   }
 }
@@ -67,6 +82,7 @@ void RequestReceiver::start() {
     mRcvThreads.emplace_back([this, i]() {
       std::string threadName = (std::string("RcvThread_") + std::to_string(i));
       pthread_setname_np(pthread_self(), threadName.c_str());
+      ThreadPlacement::getInstance().place(threadName);
       handleRpcs(i);
     });
   }
@@ -17,10 +17,12 @@ limitations under the License.
 #include <INIReader.h>
 #include <grpcpp/grpcpp.h>
 
+#include "../../../app_util/LeaderForwarder.h"
 #include "../../../app_util/Service.h"
 #include "../../../infra/es/Command.h"
 #include "../../../infra/util/TlsUtil.h"
 #include "../../generated/grpc/ledger.grpc.pb.h"
+#include "../../generated/grpc/ledger_batch.grpc.pb.h"
 
 using ::grpc::ServerCompletionQueue;
 
@@ -41,7 +43,8 @@ class RequestReceiver final : public app::Service {
 
   explicit RequestReceiver(const INIReader &reader,
                            uint32_t port,
-                           BlockingQueue<std::shared_ptr<Command>> &commandQueue);  // NOLINT(runtime/references)
+                           BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT(runtime/references)
+                           std::shared_ptr<raft::RaftInterface> raftImpl);
 
   void startListen();
 
@@ -57,11 +60,15 @@ class RequestReceiver final : public app::Service {
   std::string mIpPort;
   std::optional<TlsConf> mTlsConfOpt;
   BlockingQueue<std::shared_ptr<Command>> &mCommandQueue;
+  /// relays writes to leader when this node is a follower in proxy mode
+  std::unique_ptr<app::LeaderForwarder> mForwarder;
   std::unique_ptr<::grpc::Server> mServer;
   std::atomic<bool> mIsShutdown = false;
   std::vector<std::unique_ptr<ServerCompletionQueue>> mCompletionQueues;
   std::vector<std::thread> mRcvThreads;
   protos::LedgerService::AsyncService mService;
+  /// many journal entries per call
+  protos::LedgerBatchService::AsyncService mBatchService;
 };
 
 }  /// namespace ledger
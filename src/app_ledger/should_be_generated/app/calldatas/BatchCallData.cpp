@@ -0,0 +1,273 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "BatchCallData.h"
+
+#include "../../../../app_util/AppInfo.h"
+#include "../../../../infra/util/HttpCode.h"
+#include "../../../../infra/util/LogUtil.h"
+#include "../../domain/commands/RecordJournalEntryCommand.h"
+
+namespace gringofts {
+namespace ledger {
+
+void BatchEntryHandle::fillResultAndReply(uint32_t code,
+                                          const std::string &message,
+                                          std::optional<uint64_t> leaderId) {
+  mBatch->onEntryReplied(mSlot, code, message, leaderId);
+}
+
+void BatchCallDataBase::fillResultAndReply(uint32_t code,
+                                           const std::string &message,
+                                           std::optional<uint64_t> leaderId) {
+  mResponse.set_code(code);
+  mResponse.set_message(message);
+  if (code == HttpCode::MOVED_PERMANENTLY && leaderId) {
+    mResponse.set_reserved(std::to_string(*leaderId));
+  }
+  finish();
+}
+
+void BatchCallDataBase::onEntryReplied(int slot,
+                                       uint32_t code,
+                                       const std::string &message,
+                                       std::optional<uint64_t> leaderId) {
+  auto *result = mResponse.mutable_results(slot);
+  result->set_code(code);
+  result->set_message(message);
+  if (code == HttpCode::MOVED_PERMANENTLY && leaderId) {
+    result->set_reserved(std::to_string(*leaderId));
+  }
+  onEntryDone();
+}
+
+void BatchCallDataBase::onEntryDone() {
+  /// the last one sees results of all the others
+  if (mPendingEntries.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    summarizeAndFinish();
+  }
+}
+
+void BatchCallDataBase::summarizeAndFinish() {
+  mResponse.set_code(HttpCode::OK);
+  mResponse.set_message("Success");
+  for (const auto &result : mResponse.results()) {
+    if (result.code() == HttpCode::OK) {
+      continue;
+    }
+    if (mResponse.code() == HttpCode::OK) {
+      mResponse.set_code(result.code());
+      mResponse.set_message(result.message());
+    }
+    if (result.code() == HttpCode::MOVED_PERMANENTLY) {
+      mResponse.set_reserved(result.reserved());
+    }
+  }
+  finish();
+}
+
+void BatchCallDataBase::processEntries(EntryRequests *entries) {
+  if (entries->empty()) {
+    fillResultAndReply(HttpCode::BAD_REQUEST, "At least one journal entry is required", std::nullopt);
+    return;
+  }
+  if (entries->size() > kMaxEntriesPerCall) {
+    fillResultAndReply(HttpCode::BAD_REQUEST,
+                       "At most " + std::to_string(kMaxEntriesPerCall) + " journal entries per call",
+                       std::nullopt);
+    return;
+  }
+
+  if (forwardToLeader(entries)) {
+    return;
+  }
+
+  const int size = entries->size();
+  if (!admit(mContext.client_metadata(), mCommandQueue.estimateTotalSize(), size)) {
+    return;
+  }
+
+  mPendingEntries = size + 1;
+  mEntryHandles.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    mResponse.add_results();
+    mEntryHandles.push_back(std::make_unique<BatchEntryHandle>(this, i));
+  }
+
+  auto createdTimeInNanos = TimeUtil::currentTimeInNanos();
+  std::vector<std::shared_ptr<Command>> commands;
+  commands.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    auto command = std::allocate_shared<RecordJournalEntryCommand>(PoolAllocator<RecordJournalEntryCommand>(),
+                                                                   createdTimeInNanos,
+                                                                   std::move(*entries->Mutable(i)));
+    command->setRequestHandle(mEntryHandles[i].get());
+    command->setCreatorId(app::AppInfo::subsystemId());
+    command->setGroupId(app::AppInfo::groupId());
+    command->setGroupVersion(app::AppInfo::groupVersion());
+    const std::string verifyResult = command->verifyCommand();
+    if (verifyResult != Command::kVerifiedSuccess) {
+      SPDLOG_WARN_EVERY_MS(1000, "Batch entry can not pass validation due to Error: {} Request: {}",
+                           verifyResult, command->origRequest().DebugString());
+      onEntryReplied(i, HttpCode::BAD_REQUEST, verifyResult, std::nullopt);
+      continue;
+    }
+    /// one trace per call, carried by its first entry
+    if (commands.empty()) {
+      command->setTrace(getTrace());
+    }
+    commands.push_back(std::move(command));
+  }
+
+  try {
+    mCommandQueue.enqueueBatch(commands);
+  }
+  catch (const QueueStoppedException &e) {
+    SPDLOG_WARN(e.what());
+    for (auto &command : commands) {
+      command->getRequestHandle()->fillResultAndReply(HttpCode::SERVICE_UNAVAILABLE,
+                                                      std::string(e.what()), std::nullopt);
+    }
+  }
+
+  /// all entries are out of our hands
+  onEntryDone();
+}
+
+bool BatchCallDataBase::forwardToLeader(EntryRequests *entries) {
+  auto leader = mForwarder->leaderToForward(mContext.client_metadata());
+  if (!leader) {
+    return false;
+  }
+
+  protos::BatchRecordJournalEntries::Request request;
+  request.mutable_entries()->Swap(entries);
+  mForwarder->forward(
+      *leader, mContext.client_metadata(), mContext.deadline(), std::move(request),
+      &protos::LedgerBatchService::Stub::PrepareAsyncBatchRecordJournalEntries,
+      [this, leader](const grpc::Status &status, const protos::BatchRecordJournalEntries::Response &response) {
+        if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+          /// outcome unknown, leader may still commit it, unlike a 301 client retries as is
+          fillResultAndReply(HttpCode::GATEWAY_TIMEOUT, "Leader did not reply in time", std::nullopt);
+          return;
+        }
+        if (!status.ok()) {
+          /// leave it to client
+          fillResultAndReply(HttpCode::MOVED_PERMANENTLY, "Not a leader any longer", *leader);
+          return;
+        }
+        mResponse = response;
+        finish();
+      });
+  return true;
+}
+
+void BatchRecordJournalEntriesCallData::proceed() {
+  if (mCallStatus == CallStatus::CREATE) {
+    mCallStatus = CallStatus::PROCESS;
+    mService->RequestBatchRecordJournalEntries(&mContext, &mRequest, &mResponder,
+                                               mCompletionQueue, mCompletionQueue, this);
+  } else if (mCallStatus == CallStatus::PROCESS) {
+    onRequestReceived();
+    new BatchRecordJournalEntriesCallData(mService, mCompletionQueue, mCommandQueue, mForwarder);
+    processEntries(mRequest.mutable_entries());
+  } else {
+    GPR_ASSERT(mCallStatus == CallStatus::FINISH);
+    delete this;
+  }
+}
+
+void BatchRecordJournalEntriesCallData::failOver() {
+  SPDLOG_WARN("Fail over for BatchRecordJournalEntriesCallData");
+  new BatchRecordJournalEntriesCallData(mService, mCompletionQueue, mCommandQueue, mForwarder);
+  delete this;
+}
+
+void BatchRecordJournalEntriesCallData::finish() {
+  mCallStatus = CallStatus::FINISH;
+  mResponder.Finish(mResponse, grpc::Status::OK, this);
+}
+
+void StreamRecordJournalEntriesCallData::proceed() {
+  if (mCallStatus == CallStatus::CREATE) {
+    mCallStatus = CallStatus::PROCESS;
+    mContext.AsyncNotifyWhenDone(&mDoneTag);
+    mService->RequestStreamRecordJournalEntries(&mContext, &mReader,
+                                                mCompletionQueue, mCompletionQueue, this);
+  } else if (mCallStatus == CallStatus::PROCESS) {
+    onRequestReceived();
+    new StreamRecordJournalEntriesCallData(mService, mCompletionQueue, mCommandQueue, mForwarder);
+    mCallStatus = CallStatus::READ;
+    mReader.Read(&mEntry, this);
+  } else if (mCallStatus == CallStatus::READ) {
+    *mEntries.Add() = std::move(mEntry);
+    if (mEntries.size() > kMaxEntriesPerCall) {
+      /// no read is pending, safe to finish early
+      fillResultAndReply(HttpCode::BAD_REQUEST,
+                         "At most " + std::to_string(kMaxEntriesPerCall) + " journal entries per call",
+                         std::nullopt);
+      return;
+    }
+    mReader.Read(&mEntry, this);
+  } else {
+    GPR_ASSERT(mCallStatus == CallStatus::FINISH);
+    mFinished = true;
+    releaseIfDone();
+  }
+}
+
+void StreamRecordJournalEntriesCallData::failOver() {
+  if (mCallStatus == CallStatus::READ) {
+    /// done tag comes before our Finish only if the call is cancelled
+    if (mDone && mContext.IsCancelled()) {
+      SPDLOG_WARN("Drop {} entries of cancelled StreamRecordJournalEntries", mEntries.size());
+      mCallStatus = CallStatus::FINISH;
+      mFinished = true;
+      releaseIfDone();
+      return;
+    }
+    /// client has sent all entries
+    mCallStatus = CallStatus::PROCESS;
+    processEntries(&mEntries);
+    return;
+  }
+  if (mCallStatus == CallStatus::FINISH) {
+    /// response not sent, e.g., client has gone
+    mFinished = true;
+    releaseIfDone();
+    return;
+  }
+  SPDLOG_WARN("Fail over for StreamRecordJournalEntriesCallData");
+  new StreamRecordJournalEntriesCallData(mService, mCompletionQueue, mCommandQueue, mForwarder);
+  delete this;
+}
+
+void StreamRecordJournalEntriesCallData::finish() {
+  mCallStatus = CallStatus::FINISH;
+  mReader.Finish(mResponse, grpc::Status::OK, this);
+}
+
+void StreamRecordJournalEntriesCallData::onDone() {
+  mDone = true;
+  releaseIfDone();
+}
+
+void StreamRecordJournalEntriesCallData::releaseIfDone() {
+  if (mDone && mFinished) {
+    delete this;
+  }
+}
+
+}  /// namespace ledger
+}  /// namespace gringofts
@@ -0,0 +1,178 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_APP_LEDGER_SHOULD_BE_GENERATED_APP_CALLDATAS_BATCHCALLDATA_H_
+#define SRC_APP_LEDGER_SHOULD_BE_GENERATED_APP_CALLDATAS_BATCHCALLDATA_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "../../../../app_util/LeaderForwarder.h"
+#include "../../../../infra/grpc/RequestHandle.h"
+#include "../../../generated/grpc/ledger_batch.grpc.pb.h"
+#include "../../domain/common_types.h"
+
+namespace gringofts {
+namespace ledger {
+
+//////////////////////////// BatchCallData ////////////////////////////
+
+struct BatchCallDataBase;
+
+/**
+ * Stands for one entry of a batch call, so that its command replies as a single request does.
+ * Owned by the batch call, which outlives every entry.
+ */
+struct BatchEntryHandle final : public RequestHandle {
+  BatchEntryHandle(BatchCallDataBase *batch, int slot) : mBatch(batch), mSlot(slot) {}
+
+  void proceed() override { assert(0); }
+  void failOver() override { assert(0); }
+
+  void fillResultAndReply(uint32_t code,
+                          const std::string &message,
+                          std::optional<uint64_t> leaderId) override;
+
+  BatchCallDataBase *mBatch;
+  int mSlot;
+};
+
+/**
+ * Common part of the batch calls.
+ * Entries are enqueued into the command queue as one unit, then processed and replied
+ * independently. The call is finished once the last entry gets its result.
+ */
+struct BatchCallDataBase : public RequestHandle {
+  using EntryRequests = google::protobuf::RepeatedPtrField<protos::RecordJournalEntry::Request>;
+
+  /// bounds the memory and the latency of a single call
+  static constexpr int kMaxEntriesPerCall = 1000;
+
+  BatchCallDataBase(protos::LedgerBatchService::AsyncService *service,
+                    grpc::ServerCompletionQueue *completionQueue,
+                    BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT[runtime/references]
+                    app::LeaderForwarder *forwarder)
+      : mService(service), mCompletionQueue(completionQueue), mCommandQueue(commandQueue), mForwarder(forwarder) {}
+
+  /// reply the whole call at once, e.g., the batch is rejected before any entry is processed
+  void fillResultAndReply(uint32_t code,
+                          const std::string &message,
+                          std::optional<uint64_t> leaderId) override;
+
+  /// called concurrently by reply threads, each on its own slot
+  void onEntryReplied(int slot, uint32_t code, const std::string &message, std::optional<uint64_t> leaderId);
+
+ protected:
+  void processEntries(EntryRequests *entries);
+
+  /// in proxy mode, relay entries to leader as one BatchRecordJournalEntries call
+  bool forwardToLeader(EntryRequests *entries);
+
+  /// send mResponse to client, the next event on completion queue deletes the call
+  virtual void finish() = 0;
+
+  enum class CallStatus { CREATE, PROCESS, READ, FINISH };
+  CallStatus mCallStatus = CallStatus::CREATE;
+
+  protos::LedgerBatchService::AsyncService *mService;
+  grpc::ServerCompletionQueue *mCompletionQueue;
+  BlockingQueue<std::shared_ptr<Command>> &mCommandQueue;
+  app::LeaderForwarder *mForwarder;
+
+  grpc::ServerContext mContext;
+  protos::BatchRecordJournalEntries::Response mResponse;
+
+ private:
+  void onEntryDone();
+  void summarizeAndFinish();
+
+  std::vector<std::unique_ptr<BatchEntryHandle>> mEntryHandles;
+  /// entries without result, plus one held by processEntries until all are enqueued
+  std::atomic<int> mPendingEntries = 0;
+};
+
+struct BatchRecordJournalEntriesCallData final : public BatchCallDataBase {
+  BatchRecordJournalEntriesCallData(protos::LedgerBatchService::AsyncService *service,
+                                    grpc::ServerCompletionQueue *completionQueue,
+                                    BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT[runtime/references]
+                                    app::LeaderForwarder *forwarder)
+      : BatchCallDataBase(service, completionQueue, commandQueue, forwarder), mResponder(&mContext) {
+    proceed();
+  }
+
+  void proceed() override;
+  void failOver() override;
+
+ private:
+  void finish() override;
+
+  protos::BatchRecordJournalEntries::Request mRequest;
+  grpc::ServerAsyncResponseWriter<protos::BatchRecordJournalEntries::Response> mResponder;
+};
+
+/**
+ * Client-streaming variant, entries are buffered until the client half-closes,
+ * then handled as one batch. A stream cancelled before half-close is dropped as a whole.
+ */
+struct StreamRecordJournalEntriesCallData final : public BatchCallDataBase {
+  StreamRecordJournalEntriesCallData(protos::LedgerBatchService::AsyncService *service,
+                                     grpc::ServerCompletionQueue *completionQueue,
+                                     BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT[runtime/references]
+                                     app::LeaderForwarder *forwarder)
+      : BatchCallDataBase(service, completionQueue, commandQueue, forwarder), mReader(&mContext), mDoneTag(this) {
+    proceed();
+  }
+
+  void proceed() override;
+  /// ok is false when the client half-closes or cancels during READ
+  void failOver() override;
+
+ private:
+  /// tag of AsyncNotifyWhenDone, delivered once the call is finished or cancelled
+  struct DoneTag final : public RequestHandle {
+    explicit DoneTag(StreamRecordJournalEntriesCallData *call) : mCall(call) {}
+
+    void proceed() override { mCall->onDone(); }
+    void failOver() override { mCall->onDone(); }
+    void fillResultAndReply(uint32_t, const std::string &, std::optional<uint64_t>) override { assert(0); }
+
+    StreamRecordJournalEntriesCallData *mCall;
+  };
+
+  void finish() override;
+  void onDone();
+  /// both the final tag and the done tag hold this call
+  void releaseIfDone();
+
+  protos::RecordJournalEntry::Request mEntry;
+  EntryRequests mEntries;
+  grpc::ServerAsyncReader<protos::BatchRecordJournalEntries::Response,
+                          protos::RecordJournalEntry::Request> mReader;
+
+  DoneTag mDoneTag;
+  /// done tag delivered, IsCancelled() is meaningful only after it
+  bool mDone = false;
+  /// final tag delivered, i.e., Finish completed or the call is dropped
+  bool mFinished = false;
+};
+
+//////////////////////////// BatchCallData ////////////////////////////
+
+}  /// namespace ledger
+}  /// namespace gringofts
+
+#endif  // SRC_APP_LEDGER_SHOULD_BE_GENERATED_APP_CALLDATAS_BATCHCALLDATA_H_
@@ -24,14 +24,20 @@ void CallData<protos::ConfigureAccountMetadata::Request, protos::ConfigureAccoun
     mService->RequestConfigureAccountMetadata(&mContext, &mRequest, &mResponder,
                                               mCompletionQueue, mCompletionQueue, this);
   } else if (mCallStatus == CallStatus::PROCESS) {
+    onRequestReceived();
     new ConfigureAccountMetadataCallData(mService,
                                          mCompletionQueue,
-                                         mCommandQueue);
+                                         mCommandQueue,
+                                         mForwarder);
+    if (forwardToLeader(&protos::LedgerService::Stub::PrepareAsyncConfigureAccountMetadata)) {
+      return;
+    }
 
     auto createdTimeInNanos = TimeUtil::currentTimeInNanos();
     auto command = std::make_shared<ConfigureAccountMetadataCommand>(createdTimeInNanos,
                                                                      mRequest);
     command->setRequestHandle(this);
+    command->setTrace(getTrace());
     command->setCreatorId(app::AppInfo::subsystemId());
     command->setGroupId(app::AppInfo::groupId());
     command->setGroupVersion(app::AppInfo::groupVersion());
@@ -43,6 +49,9 @@ void CallData<protos::ConfigureAccountMetadata::Request, protos::ConfigureAccoun
       return;
     }
     // if the command is verified
+    if (!admit(mContext.client_metadata(), mCommandQueue.estimateTotalSize())) {
+      return;
+    }
     try {
       mCommandQueue.enqueue(command);
     }
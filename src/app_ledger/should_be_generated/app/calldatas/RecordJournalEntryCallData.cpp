@@ -24,25 +24,35 @@ void CallData<protos::RecordJournalEntry::Request, protos::RecordJournalEntry::R
     mService->RequestRecordJournalEntry(&mContext, &mRequest, &mResponder,
                                         mCompletionQueue, mCompletionQueue, this);
   } else if (mCallStatus == CallStatus::PROCESS) {
+    onRequestReceived();
     new RecordJournalEntryCallData(mService,
                                    mCompletionQueue,
-                                   mCommandQueue);
+                                   mCommandQueue,
+                                   mForwarder);
+    if (forwardToLeader(&protos::LedgerService::Stub::PrepareAsyncRecordJournalEntry)) {
+      return;
+    }
 
     auto createdTimeInNanos = TimeUtil::currentTimeInNanos();
-    auto command = std::make_shared<RecordJournalEntryCommand>(createdTimeInNanos,
-                                                               mRequest);
+    auto command = std::allocate_shared<RecordJournalEntryCommand>(PoolAllocator<RecordJournalEntryCommand>(),
+                                                                   createdTimeInNanos,
+                                                                   std::move(mRequest));
     command->setRequestHandle(this);
+    command->setTrace(getTrace());
     command->setCreatorId(app::AppInfo::subsystemId());
     command->setGroupId(app::AppInfo::groupId());
     command->setGroupVersion(app::AppInfo::groupVersion());
     const std::string verifyResult = command->verifyCommand();
     if (verifyResult != Command::kVerifiedSuccess) {
       SPDLOG_WARN("Request can not pass validation due to Error: {} Request: {}",
-                  verifyResult, mRequest.DebugString());
+                  verifyResult, command->origRequest().DebugString());
       fillResultAndReply(HttpCode::BAD_REQUEST, verifyResult, std::nullopt);
       return;
     }
     // if the command is verified
+    if (!admit(mContext.client_metadata(), mCommandQueue.estimateTotalSize())) {
+      return;
+    }
     try {
       mCommandQueue.enqueue(command);
     }
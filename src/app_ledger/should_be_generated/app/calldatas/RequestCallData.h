@@ -17,6 +17,7 @@ limitations under the License.
 #include <grpcpp/grpcpp.h>
 
 #include "../../../../app_util/AppInfo.h"
+#include "../../../../app_util/LeaderForwarder.h"
 #include "../../../../infra/grpc/RequestHandle.h"
 #include "../../../../infra/util/HttpCode.h"
 #include "../../domain/common_types.h"
@@ -49,9 +50,11 @@ template<typename RequestType, typename ResponseType>
 struct CallData : public CallDataBase {
   CallData(protos::LedgerService::AsyncService *service,
            grpc::ServerCompletionQueue *completionQueue,
-           BlockingQueue<std::shared_ptr<Command>> &commandQueue)  // NOLINT[runtime/references]
+           BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT[runtime/references]
+           app::LeaderForwarder *forwarder)
       : CallDataBase(service, completionQueue),
         mCommandQueue(commandQueue),
+        mForwarder(forwarder),
         mResponder(&mContext) {
     /// Attention, call virtual function in Ctor/Dtor is not recommended.
     /// However, we do not rely on polymorphism here.
@@ -62,7 +65,7 @@ struct CallData : public CallDataBase {
 
   void failOver() override {
     SPDLOG_WARN("Fail over for CallData");
-    new CallData<RequestType, ResponseType>(mService, mCompletionQueue, mCommandQueue);
+    new CallData<RequestType, ResponseType>(mService, mCompletionQueue, mCommandQueue, mForwarder);
     delete this;
   }
 
@@ -79,7 +82,35 @@ struct CallData : public CallDataBase {
     mResponder.Finish(mResponse, grpc::Status::OK, this);
   }
 
+  /// in proxy mode, relay the request to leader instead of replying 301
+  bool forwardToLeader(std::unique_ptr<grpc::ClientAsyncResponseReader<ResponseType>> (
+      protos::LedgerService::Stub::*rpc)(grpc::ClientContext *, const RequestType &, grpc::CompletionQueue *)) {
+    auto leader = mForwarder->leaderToForward(mContext.client_metadata());
+    if (!leader) {
+      return false;
+    }
+
+    mForwarder->forward(*leader, mContext.client_metadata(), mContext.deadline(), std::move(mRequest), rpc,
+                        [this, leader](const grpc::Status &status, const ResponseType &response) {
+                          if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+                            /// outcome unknown, leader may still commit it, unlike a 301 client retries as is
+                            fillResultAndReply(HttpCode::GATEWAY_TIMEOUT, "Leader did not reply in time", std::nullopt);
+                            return;
+                          }
+                          if (!status.ok()) {
+                            /// leave it to client
+                            fillResultAndReply(HttpCode::MOVED_PERMANENTLY, "Not a leader any longer", *leader);
+                            return;
+                          }
+                          mResponse = response;
+                          mCallStatus = CallStatus::FINISH;
+                          mResponder.Finish(mResponse, grpc::Status::OK, this);
+                        });
+    return true;
+  }
+
   BlockingQueue<std::shared_ptr<Command>> &mCommandQueue;
+  app::LeaderForwarder *mForwarder;
   RequestType mRequest;
   ResponseType mResponse;
 
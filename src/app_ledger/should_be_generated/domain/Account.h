@@ -14,9 +14,11 @@ limitations under the License.
 #ifndef SRC_APP_LEDGER_SHOULD_BE_GENERATED_DOMAIN_ACCOUNT_H_
 #define SRC_APP_LEDGER_SHOULD_BE_GENERATED_DOMAIN_ACCOUNT_H_
 
+#include "../../../infra/util/Money.h"
 #include "AccountType.h"
 #include "Amount.h"
 #include "Balance.h"
+#include "TransactionType.h"
 
 namespace gringofts {
 namespace ledger {
@@ -160,6 +162,35 @@ class Account {
     }
   }
 
+  const Balance &balance() const {
+    return mBalance;
+  }
+
+  /// signed change of the balance if amount is debited or credited, see applyDebit() and applyCredit()
+  Money::ValueType balanceChangeOf(TransactionType type, const Amount &amount) const {
+    bool isIncrease = false;
+    switch (mAccountType) {
+      case AccountType::Asset:
+      case AccountType::Capital:
+      case AccountType::CostOfGoodsSold:
+      case AccountType::Expense: {
+        isIncrease = type == TransactionType::Debit;
+        break;
+      }
+      case AccountType::Income:
+      case AccountType::Liability: {
+        isIncrease = type == TransactionType::Credit;
+        break;
+      }
+      default: {
+        SPDLOG_ERROR("If it goes here, it means account type is not validated beforehand");
+        exit(1);
+      }
+    }
+    Money::ValueType value = amount.value();
+    return isIncrease ? value : -value;
+  }
+
   void applyDebit(Amount amount) {
     switch (mAccountType) {
       case AccountType::Asset: {
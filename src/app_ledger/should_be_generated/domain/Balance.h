@@ -16,6 +16,8 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <limits>
+
 #include "../../generated/grpc/ledger.pb.h"
 
 namespace gringofts {
@@ -76,20 +78,28 @@ class Balance {
     return true;
   }
 
+  /// never wraps, the resulting balance has been checked when the journal entry is processed
   Balance &operator+=(const Amount &amount) {
     /// later to support multiple versions
+    assert(mValue <= std::numeric_limits<uint64_t>::max() - amount.value());
     mValue += amount.value();
 
     return *this;
   }
 
+  /// never wraps, the resulting balance has been checked when the journal entry is processed
   Balance &operator-=(const Amount &amount) {
     /// later to support multiple versions
+    assert(mValue >= amount.value());
     mValue -= amount.value();
 
     return *this;
   }
 
+  uint64_t value() const {
+    return mValue;
+  }
+
  private:
   uint64_t mVersion;  // keep every version for backward-compatibility
   uint64_t mValue;
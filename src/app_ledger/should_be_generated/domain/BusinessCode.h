@@ -30,6 +30,7 @@ class BusinessCode {
   static constexpr int CREDIT_NOT_EQUAL_TO_DEBIT = 1007;
   static constexpr int INVALID_TRANSACTION_TYPE = 1008;
   static constexpr int JOURNAL_LINE_ISO_CURRENCY_CODE_DOES_NOT_MATCH_ACCOUNT = 1009;
+  static constexpr int BALANCE_OUT_OF_RANGE = 1010;
 };
 
 }  // namespace ledger
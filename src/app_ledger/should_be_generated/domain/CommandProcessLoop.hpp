@@ -27,12 +27,14 @@ void CommandProcessLoop<StateMachineType>::processCommand(std::shared_ptr<Comman
   auto ts1InNano = TimeUtil::currentTimeInNanos();
   std::vector<std::shared_ptr<Event>> events;
   auto hint = this->mAppStateMachine->processCommandAndApply(*command, &events);
+  command->stampTrace(TraceStage::Process);
 
   if (events.empty()) {
-    SPDLOG_WARN("Error processing command {}, error code: {}, error message: {}",
-                command->getId(),
-                hint.mCode,
-                hint.mMessage);
+    /// rejections come with the request rate, e.g. under a bad client
+    SPDLOG_WARN_EVERY_MS(1000, "Error processing command {}, error code: {}, error message: {}",
+                         command->getId(),
+                         hint.mCode,
+                         hint.mMessage);
     this->mCommandEventStore->persistAsync(command, {}, hint.mCode, hint.mMessage);
     return;
   }
@@ -48,11 +50,13 @@ void CommandProcessLoop<StateMachineType>::processCommand(std::shared_ptr<Comman
 
   auto ts3InNano = TimeUtil::currentTimeInNanos();
 
-  SPDLOG_INFO("Process Command {}, applied {} events, "
-              "processCost={}us, persistCost={}us",
-              command->getId(), events.size(),
-              (ts2InNano - ts1InNano) / 1000.0,
-              (ts3InNano - ts2InNano) / 1000.0);
+  this->process_latency_histogram.observe((ts2InNano - ts1InNano) / 1000000.0);
+  this->persist_latency_histogram.observe((ts3InNano - ts2InNano) / 1000000.0);
+  SPDLOG_DEBUG("Process Command {}, applied {} events, "
+               "processCost={}us, persistCost={}us",
+               command->getId(), events.size(),
+               (ts2InNano - ts1InNano) / 1000.0,
+               (ts3InNano - ts2InNano) / 1000.0);
 }
 
 }  /// namespace ledger
@@ -25,6 +25,12 @@ RecordJournalEntryCommand::RecordJournalEntryCommand(TimestampInNanos createdTim
   tryInitJournalEntry();
 }
 
+RecordJournalEntryCommand::RecordJournalEntryCommand(TimestampInNanos createdTimeInNanos,
+                                                     protos::RecordJournalEntry::Request &&origRequest)
+    : Command(RECORD_JOURNAL_ENTRY_COMMAND, createdTimeInNanos), mOrigRequest(std::move(origRequest)) {
+  tryInitJournalEntry();
+}
+
 RecordJournalEntryCommand::RecordJournalEntryCommand(TimestampInNanos createdTimeInNanos, const std::string &commandStr)
     : Command(RECORD_JOURNAL_ENTRY_COMMAND, createdTimeInNanos) {
   decodeFromString(commandStr);
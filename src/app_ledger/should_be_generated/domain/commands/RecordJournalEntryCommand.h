@@ -17,15 +17,20 @@ limitations under the License.
 
 #include "../../../../infra/es/Command.h"
 #include "../../../../infra/es/ProcessCommandStateMachine.h"
+#include "../../../../infra/util/ObjectPool.h"
 #include "../JournalEntry.h"
 
 namespace gringofts {
 namespace ledger {
 
-class RecordJournalEntryCommand : public Command {
+/// one per request, recycled to keep the write path free of heap allocations
+class RecordJournalEntryCommand : public Command, public PooledObject<RecordJournalEntryCommand> {
  public:
   RecordJournalEntryCommand(TimestampInNanos, const protos::RecordJournalEntry::Request &origRequest);
 
+  /// takes over the request received from gRPC instead of copying it
+  RecordJournalEntryCommand(TimestampInNanos, protos::RecordJournalEntry::Request &&origRequest);
+
   RecordJournalEntryCommand(TimestampInNanos, const std::string &commandStr);
 
   std::string encodeToString() const override {
@@ -43,6 +48,10 @@ class RecordJournalEntryCommand : public Command {
     return kVerifiedSuccess;
   }
 
+  const protos::RecordJournalEntry::Request &origRequest() const {
+    return mOrigRequest;
+  }
+
   const std::optional<JournalEntry> &journalEntryOpt() const {
     return mJournalEntryOpt;
   }
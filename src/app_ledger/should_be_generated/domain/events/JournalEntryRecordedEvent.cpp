@@ -17,13 +17,16 @@ limitations under the License.
 #include <spdlog/spdlog.h>
 
 #include "../common_types.h"
+#include "../commands/RecordJournalEntryCommand.h"
 
 namespace gringofts {
 namespace ledger {
 
 JournalEntryRecordedEvent::JournalEntryRecordedEvent(TimestampInNanos createdTimeInNanos,
-                                                     const JournalEntry &journalEntry)
+                                                     const JournalEntry &journalEntry,
+                                                     bool compact)
     : Event(JOURNAL_ENTRY_RECORDED_EVENT, createdTimeInNanos) {
+  mVersion = compact ? kCompactVersion : 1;
   mJournalEntry = journalEntry;
 }
 
@@ -40,6 +43,10 @@ std::string JournalEntryRecordedEvent::encodeToString() const {
       mJournalEntry.encodeTo(*eventProto.mutable_journal_entry());
       break;
     }
+    case kCompactVersion: {
+      /// journal entry is persisted once, in the originating command
+      break;
+    }
     default: {
       SPDLOG_ERROR("Cannot recognize this version {}, exiting now", mVersion);
       exit(1);
@@ -57,6 +64,12 @@ void JournalEntryRecordedEvent::decodeFromString(std::string_view payload) {
   switch (mVersion) {
     case 1: {
       mJournalEntry.initWith(eventProto.journal_entry());
+      mRestored = true;
+      break;
+    }
+    case kCompactVersion: {
+      /// journal entry will be restored from the originating command
+      mRestored = false;
       break;
     }
     default: {
@@ -66,5 +79,17 @@ void JournalEntryRecordedEvent::decodeFromString(std::string_view payload) {
   }
 }
 
+void JournalEntryRecordedEvent::restoreFromCommand(const Command &command) {
+  if (mVersion != kCompactVersion) {
+    return;
+  }
+  const auto *recordCommand = dynamic_cast<const RecordJournalEntryCommand *>(&command);
+  assert(recordCommand != nullptr);
+  const auto &journalEntryOpt = recordCommand->journalEntryOpt();
+  assert(journalEntryOpt);
+  mJournalEntry = *journalEntryOpt;
+  mRestored = true;
+}
+
 }  /// namespace ledger
 }  /// namespace gringofts
@@ -16,15 +16,22 @@ limitations under the License.
 #define SRC_APP_LEDGER_SHOULD_BE_GENERATED_DOMAIN_EVENTS_JOURNALENTRYRECORDEDEVENT_H_
 
 #include "../../../../infra/es/Event.h"
+#include "../../../../infra/util/ObjectPool.h"
 #include "../../../generated/grpc/ledger.pb.h"
 #include "../JournalEntry.h"
 
 namespace gringofts {
 namespace ledger {
 
-class JournalEntryRecordedEvent : public Event {
+/// one per request, recycled to keep the write and apply paths free of heap allocations
+class JournalEntryRecordedEvent : public Event, public PooledObject<JournalEntryRecordedEvent> {
  public:
-  explicit JournalEntryRecordedEvent(TimestampInNanos createdTimeInNanos, const JournalEntry &journalEntry);
+  /**
+   * @param compact if true, the journal entry is not encoded since it is identical to
+   *                the one in the originating RecordJournalEntryCommand, see #restoreFromCommand
+   */
+  JournalEntryRecordedEvent(TimestampInNanos createdTimeInNanos, const JournalEntry &journalEntry,
+                            bool compact = false);
 
   JournalEntryRecordedEvent(TimestampInNanos createdTimeInNanos, std::string_view eventStr);
 
@@ -32,12 +39,21 @@ class JournalEntryRecordedEvent : public Event {
 
   void decodeFromString(std::string_view payload) override;
 
+  void restoreFromCommand(const Command &command) override;
+
+  bool needsCommandToRestore() const override { return mVersion == kCompactVersion && !mRestored; }
+
   const JournalEntry &journalEntry() const {
     return mJournalEntry;
   }
 
  private:
+  /// version 1 carries the journal entry, version 2 references the command's
+  static constexpr uint64_t kCompactVersion = 2;
+
   uint64_t mVersion = 1;
+  /// false until a compact event gets its journal entry back from the command
+  bool mRestored = true;
   JournalEntry mJournalEntry;
 };
 
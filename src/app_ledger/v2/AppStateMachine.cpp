@@ -14,8 +14,12 @@ limitations under the License.
 
 #include "AppStateMachine.h"
 
+#include <absl/container/inlined_vector.h>
 #include <absl/strings/str_format.h>
 
+#include <algorithm>
+
+#include "../../app_util/AppInfo.h"
 #include "../../infra/util/HttpCode.h"
 #include "../should_be_generated/domain/BusinessCode.h"
 
@@ -117,25 +121,32 @@ ProcessHint AppStateMachine::process(const RecordJournalEntryCommand &command,
   assert(journalEntryOpt);  // request needs to pass the validation before it can be processed here
   const auto &journalEntry = *journalEntryOpt;
   const auto &entryId = journalEntry.id();
-  if (mDoneMap.find(entryId) != mDoneMap.end()) {
+  if (mDoneMap.find(std::string_view(entryId)) != mDoneMap.end()) {
     hint.mCode = BusinessCode::JOURNAL_ENTRY_ALREADY_PROCESSED;
     hint.mMessage = "journal entry has already been processed";
     return hint;
   } else {
     /// see if it is persisted in rocksdb
     std::string value;
-    auto status = mRocksDB->Get(mReadOptions, mColumnFamilyHandles[RocksDBConf::DONE_MAP], entryId, &value);
+    auto status = getFromRocksDB(RocksDBConf::DONE_MAP, entryId, &value);
     if (!status.IsNotFound()) {
       hint.mCode = BusinessCode::JOURNAL_ENTRY_ALREADY_PROCESSED;
       hint.mMessage = "journal entry has already been processed";
       return hint;
     }
   }
-  /// TODO(ISSUE-22): add multi-currency support, for now, will only consider same currency
+  /// amounts are summed per currency in 128-bit fixed point, so that nothing wraps
   const auto &journalLines = journalEntry.journalLines();
   uint32_t debitCnt = 0;
   uint32_t creditCnt = 0;
-  Amount debitSum, creditSum;
+  /// debit and credit totals of each currency, kept on stack for the usual handful of currencies
+  struct CurrencyTotals {
+    Money mDebits;
+    Money mCredits;
+  };
+  absl::InlinedVector<CurrencyTotals, 4> totalsPerCurrency;
+  /// balance of each account after this journal entry
+  absl::InlinedVector<std::pair<const Account *, Money>, 8> newBalances;
   for (const auto &journalLine : journalLines) {
     auto nominalCode = journalLine.nominalCode();
     /// 2. every account must exist
@@ -162,14 +173,41 @@ ProcessHint AppStateMachine::process(const RecordJournalEntryCommand &command,
       hint.mMessage = absl::StrFormat("transaction type should be either debit or credit");
       return hint;
     }
+
+    auto totals = std::find_if(totalsPerCurrency.begin(), totalsPerCurrency.end(),
+                               [currencyCodeInJournalLine](const auto &totals) {
+                                 return totals.mDebits.currencyCode() == currencyCodeInJournalLine;
+                               });
+    if (totals == totalsPerCurrency.end()) {
+      totals = totalsPerCurrency.insert(totalsPerCurrency.end(),
+                                        CurrencyTotals{Money(0, currencyCodeInJournalLine),
+                                                       Money(0, currencyCodeInJournalLine)});
+    }
+    /// totals cannot overflow 128 bits with uint64 amounts
+    Money amount(journalLine.amount().value(), currencyCodeInJournalLine);
     if (type == TransactionType::Debit) {
       debitCnt++;
-      debitSum += journalLine.amount();
+      [[maybe_unused]] auto added = totals->mDebits.tryAdd(amount);
+      assert(added);
     }
     if (type == TransactionType::Credit) {
       creditCnt++;
-      creditSum += journalLine.amount();
+      [[maybe_unused]] auto added = totals->mCredits.tryAdd(amount);
+      assert(added);
     }
+
+    const auto &account = iter->second;
+    auto newBalance = std::find_if(newBalances.begin(), newBalances.end(),
+                                   [&account](const auto &balance) { return balance.first == &account; });
+    if (newBalance == newBalances.end()) {
+      newBalance = newBalances.emplace(newBalances.end(),
+                                       &account,
+                                       Money(account.balance().value(), currencyCodeInAccount));
+    }
+    /// balances cannot overflow 128 bits with uint64 amounts
+    [[maybe_unused]] auto added = newBalance->second.tryAdd(
+        Money(account.balanceChangeOf(type, journalLine.amount()), currencyCodeInAccount));
+    assert(added);
   }
   /// 4. at least one credit and one debit journal lines
   if (debitCnt == 0) {
@@ -182,14 +220,28 @@ ProcessHint AppStateMachine::process(const RecordJournalEntryCommand &command,
     hint.mMessage = absl::StrFormat("no credit in journal entry");
     return hint;
   }
-  /// 5. sum of credits' amount == sum of debits' amount
-  if (debitSum != creditSum) {
-    hint.mCode = BusinessCode::CREDIT_NOT_EQUAL_TO_DEBIT;
-    hint.mMessage = absl::StrFormat("credit amount not equal to debit amount");
-    return hint;
+  /// 5. sum of credits' amount == sum of debits' amount, in every currency
+  for (const auto &totals : totalsPerCurrency) {
+    if (totals.mDebits != totals.mCredits) {
+      hint.mCode = BusinessCode::CREDIT_NOT_EQUAL_TO_DEBIT;
+      hint.mMessage = absl::StrFormat("credit amount not equal to debit amount");
+      return hint;
+    }
+  }
+  /// 6. balances can neither go below zero nor overflow
+  for (const auto &[account, newBalance] : newBalances) {
+    if (!newBalance.fitsInUint64()) {
+      hint.mCode = BusinessCode::BALANCE_OUT_OF_RANGE;
+      hint.mMessage = absl::StrFormat("balance of account %u would be %s",
+                                      account->nominalCode(), newBalance.toString());
+      return hint;
+    }
   }
   auto now = TimeUtil::currentTimeInNanos();
-  auto event = std::make_shared<JournalEntryRecordedEvent>(now, journalEntry);
+  auto event = std::allocate_shared<JournalEntryRecordedEvent>(PoolAllocator<JournalEntryRecordedEvent>(),
+                                                               now,
+                                                               journalEntry,
+                                                               app::AppInfo::compactPayloadEnabled());
   events->push_back(std::move(event));
 
   return hint;
@@ -200,8 +252,8 @@ StateMachine &AppStateMachine::apply(const JournalEntryRecordedEvent &event) {
   const auto &journalEntry = event.journalEntry();
   const auto &id = journalEntry.id();
   auto validTime = journalEntry.validTime();
-  assert(mDoneMap.find(id) == mDoneMap.end());
-  mDoneMap[id] = validTime;
+  assert(mDoneMap.find(std::string_view(id)) == mDoneMap.end());
+  mDoneMap.emplace(std::string_view(id), validTime);
   onBookkeepingProcessed(id, validTime);
   /// 2. update every account's balance
   for (const auto &journalLine : journalEntry.journalLines()) {
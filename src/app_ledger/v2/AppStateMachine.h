@@ -15,9 +15,15 @@ limitations under the License.
 #ifndef SRC_APP_LEDGER_V2_APPSTATEMACHINE_H_
 #define SRC_APP_LEDGER_V2_APPSTATEMACHINE_H_
 
+#include <map>
+#include <string>
+#include <unordered_map>
+
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
+#include <rocksdb/utilities/write_batch_with_index.h>
 
+#include "../../infra/util/PMRContainerFactory.h"
 #include "../AppStateMachine.h"
 
 namespace gringofts {
@@ -26,6 +32,16 @@ namespace v2 {
 
 class AppStateMachine : public ledger::AppStateMachine {
  public:
+  /**
+   * Containers allocate from containerFactory if given, otherwise from the default memory resource.
+   * State machines whose states are swapped must share the same factory.
+   */
+  explicit AppStateMachine(const std::shared_ptr<PMRContainerFactory> &containerFactory = nullptr)
+      : mContainerFactory(containerFactory),
+        mDoneMap(memoryResourceOf(containerFactory, "done_map")),
+        mCoA(memoryResourceOf(containerFactory, "chart_of_accounts")),
+        mAccountMetadata(memoryResourceOf(containerFactory, "account_metadata")) {}
+
   struct RocksDBConf {
     /**
      * You should obey following order when preparing columnFamilyDescriptors,
@@ -114,6 +130,23 @@ class AppStateMachine : public ledger::AppStateMachine {
   virtual void onBookkeepingProcessed(std::string dedupId, uint64_t validTime) {}
   virtual void onAccountUpdated(const Account &account) {}
 
+  /// read from RocksDB through mPendingWriteBatch if it exists
+  rocksdb::Status getFromRocksDB(RocksDBConf::ColumnFamilyIndices columnFamilyIndex,
+                                 const std::string &key,
+                                 std::string *value) const {
+    if (mPendingWriteBatch) {
+      return mPendingWriteBatch->GetFromBatchAndDB(mRocksDB.get(), mReadOptions,
+                                                   mColumnFamilyHandles[columnFamilyIndex], key, value);
+    }
+    return mRocksDB->Get(mReadOptions, mColumnFamilyHandles[columnFamilyIndex], key, value);
+  }
+
+ private:
+  static std::pmr::memory_resource *memoryResourceOf(const std::shared_ptr<PMRContainerFactory> &containerFactory,
+                                                     const std::string &containerName) {
+    return containerFactory ? containerFactory->getMemoryResource(containerName) : std::pmr::get_default_resource();
+  }
+
  protected:
   /// read-only rocksDB
   std::shared_ptr<rocksdb::DB> mRocksDB;
@@ -121,14 +154,21 @@ class AppStateMachine : public ledger::AppStateMachine {
   std::vector<rocksdb::ColumnFamilyHandle *> mColumnFamilyHandles;
   /// ReadOptions hold a snapshot
   rocksdb::ReadOptions mReadOptions;
+  /// updates not yet flushed when mReadOptions.snapshot was taken, read-only here
+  std::shared_ptr<rocksdb::WriteBatchWithIndex> mPendingWriteBatch;
+  /// must outlive the containers below
+  std::shared_ptr<PMRContainerFactory> mContainerFactory;
   /// state owned by both Memory-backed SM and RocksDB-backed SM
   /// key: dedupId, value: validTime
   /// TODO(ISSUE-20): only keep dedupIds no older than 6 months to make the rocksdb size consistent
-  std::map<std::string, uint64_t> mDoneMap;
+  /// keys are pmr strings so that ids longer than SSO are allocated from done_map as well,
+  /// std::less<> allows looking up by std::string_view without a copy
+  std::pmr::map<std::pmr::string, uint64_t, std::less<>> mDoneMap;
   /// key: account's nominalCode, value: account
-  std::map<uint64_t, Account> mCoA;  /// Chart of Accounts
+  /// hash map since CoA is only looked up by key, and can be bulk-built when loaded from RocksDB
+  std::pmr::unordered_map<uint64_t, Account> mCoA;  /// Chart of Accounts
   /// key: accountType, value: metaData
-  std::map<AccountType, AccountMetadata> mAccountMetadata;
+  std::pmr::map<AccountType, AccountMetadata> mAccountMetadata;
 };
 
 }  /// namespace v2
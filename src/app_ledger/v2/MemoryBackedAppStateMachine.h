@@ -28,26 +28,34 @@ namespace v2 {
 class MemoryBackedAppStateMachine : public v2::AppStateMachine {
  public:
   explicit MemoryBackedAppStateMachine(
-      std::shared_ptr<gringofts::PMRContainerFactory> containerFactory) {}
+      std::shared_ptr<gringofts::PMRContainerFactory> containerFactory)
+      : v2::AppStateMachine(containerFactory) {}
 
   /**
    * integration
    */
   void swapState(StateMachine *anotherStateMachine) override {
     auto &another = dynamic_cast<RocksDBBackedAppStateMachine &>(*anotherStateMachine);
+    /// swapping pmr containers is only defined when they share the memory resource
+    assert(mContainerFactory == another.mContainerFactory);
     std::swap(mDoneMap, another.mDoneMap);
     std::swap(mCoA, another.mCoA);
     std::swap(mAccountMetadata, another.mAccountMetadata);
 
+    /// release the snapshot taken in previous term
+    if (mReadOptions.snapshot != nullptr) {
+      mRocksDB->ReleaseSnapshot(mReadOptions.snapshot);
+    }
+
     /// refresh ptr of RocksDB if needed.
     mRocksDB = another.mRocksDB;
 
     /// refresh column family handles if needed
     mColumnFamilyHandles = another.mColumnFamilyHandles;
-    /// explicitly trigger a flush in RocksDB
-    another.flushToRocksDB();
-    /// take a snapshot
+    /// take a snapshot, updates not flushed yet are read through the pending write batch,
+    /// which will be flushed by the other state machine when it recovers.
     mReadOptions.snapshot = mRocksDB->GetSnapshot();
+    mPendingWriteBatch = another.handOverWriteBatch();
   }
 };
 
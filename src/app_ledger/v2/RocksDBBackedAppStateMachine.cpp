@@ -14,13 +14,37 @@ limitations under the License.
 
 #include "RocksDBBackedAppStateMachine.h"
 
+#include <thread>
+
+#include "../../infra/monitor/MonitorTypes.h"
+#include "../../infra/util/MetricReporter.h"
+
 namespace gringofts {
 namespace ledger {
 namespace v2 {
 
+std::shared_ptr<rocksdb::WriteBatchWithIndex> RocksDBBackedAppStateMachine::handOverWriteBatch() {
+  /// the previous handed-over batch should have been flushed in recoverSelf()
+  assert(!mHandedOverWriteBatch);
+  mHandedOverWriteBatch = mWriteBatch;
+  mWriteBatch = newWriteBatch();
+  return mHandedOverWriteBatch;
+}
+
 uint64_t RocksDBBackedAppStateMachine::recoverSelf() {
+  /// flush the batch handed over during swapState()
+  if (mHandedOverWriteBatch) {
+    auto ts1InNano = TimeUtil::currentTimeInNanos();
+    /// do not clear the handed-over batch, it may be still read by others
+    writeToRocksDB(mHandedOverWriteBatch->GetWriteBatch());
+    mHandedOverWriteBatch.reset();
+    auto ts2InNano = TimeUtil::currentTimeInNanos();
+    static auto flushLatency = getHistogram("leader_transition_flush_latency_in_ms", {});
+    MetricReporter::reportLatency(flushLatency, "leader_transition_flush_latency_in_ms", ts1InNano, ts2InNano);
+  }
+
   /// write batch should be empty.
-  assert(mWriteBatch.Count() == 0);
+  assert(mWriteBatch->GetWriteBatch()->Count() == 0);
 
   /// reload state from RocksDB
   clearState();
@@ -31,7 +55,7 @@ uint64_t RocksDBBackedAppStateMachine::recoverSelf() {
 }
 
 void RocksDBBackedAppStateMachine::commit(uint64_t appliedIndex) {
-  auto status = mWriteBatch.Put(mColumnFamilyHandles[RocksDBConf::DEFAULT],
+  auto status = mWriteBatch->Put(mColumnFamilyHandles[RocksDBConf::DEFAULT],
                                 RocksDBConf::kLastAppliedIndexKey, std::to_string(appliedIndex));
   if (!status.ok()) {
     SPDLOG_ERROR("Error writing RocksDB: {}. Exiting...", status.ToString());
@@ -107,17 +131,21 @@ void RocksDBBackedAppStateMachine::closeRocksDB(std::shared_ptr<rocksdb::DB> *db
 }
 
 void RocksDBBackedAppStateMachine::flushToRocksDB() {
+  writeToRocksDB(mWriteBatch->GetWriteBatch());
+
+  /// clear write batch since we will reuse it.
+  mWriteBatch->Clear();
+}
+
+void RocksDBBackedAppStateMachine::writeToRocksDB(rocksdb::WriteBatch *writeBatch) {
   rocksdb::WriteOptions writeOptions;
   writeOptions.sync = true;
 
-  auto status = mRocksDB->Write(writeOptions, &mWriteBatch);
+  auto status = mRocksDB->Write(writeOptions, writeBatch);
   if (!status.ok()) {
     SPDLOG_ERROR("failed to write RocksDB, reason: {}", status.ToString());
     assert(0);
   }
-
-  /// clear write batch since we will reuse it.
-  mWriteBatch.Clear();
 }
 
 void RocksDBBackedAppStateMachine::loadFromRocksDB() {
@@ -137,31 +165,18 @@ void RocksDBBackedAppStateMachine::loadFromRocksDB() {
   }
 
   /// load CoA
-  rocksdb::Iterator *accountsIter = mRocksDB->NewIterator(rocksdb::ReadOptions(),
-                                                          mColumnFamilyHandles[RocksDBConf::CHART_OF_ACCOUNTS]);
-  for (accountsIter->SeekToFirst(); accountsIter->Valid(); accountsIter->Next()) {
-    const auto &key = accountsIter->key();
-    const auto &val = accountsIter->value();
-    protos::Account accountProto;
-    accountProto.ParseFromString(val.ToString());
-    Account account;
-    account.initWith(accountProto);
-    auto nominalCode = account.nominalCode();
-    assert(nominalCode == std::stoull(key.ToString()));
-    assert(mCoA.find(nominalCode) == mCoA.end());
-    mCoA[nominalCode] = account;
-  }
-  assert(accountsIter->status().ok());
-  delete accountsIter;
+  auto ts1InNano = TimeUtil::currentTimeInNanos();
+  loadChartOfAccounts();
 
   /// load AccountMetadata
+  auto ts2InNano = TimeUtil::currentTimeInNanos();
   rocksdb::Iterator *accountMetadataIter = mRocksDB->NewIterator(rocksdb::ReadOptions(),
                                                                  mColumnFamilyHandles[RocksDBConf::ACCOUNT_METADATA]);
   for (accountMetadataIter->SeekToFirst(); accountMetadataIter->Valid(); accountMetadataIter->Next()) {
     const auto &key = accountMetadataIter->key();
     const auto &val = accountMetadataIter->value();
     protos::AccountMetadata accountMetadataProto;
-    accountMetadataProto.ParseFromString(val.ToString());
+    accountMetadataProto.ParseFromArray(val.data(), static_cast<int>(val.size()));
     AccountMetadata accountMetadata;
     accountMetadata.initWith(accountMetadataProto);
     auto type = accountMetadata.accountType();
@@ -173,6 +188,115 @@ void RocksDBBackedAppStateMachine::loadFromRocksDB() {
   delete accountMetadataIter;
 
   /// do not load doneMap as it may become too large and cost more time
+  auto ts3InNano = TimeUtil::currentTimeInNanos();
+  getGauge("startup_phase_cost_in_ms", {{"phase", "load_chart_of_accounts"}})  /// metric-lookup: once on startup
+      .set((ts2InNano - ts1InNano) / 1000000.0);
+  getGauge("startup_phase_cost_in_ms", {{"phase", "load_account_metadata"}})  /// metric-lookup: once on startup
+      .set((ts3InNano - ts2InNano) / 1000000.0);
+  SPDLOG_INFO("load {} accounts cost {}ms, load {} account metadata cost {}ms",
+              mCoA.size(), (ts2InNano - ts1InNano) / 1000000.0,
+              mAccountMetadata.size(), (ts3InNano - ts2InNano) / 1000000.0);
+}
+
+void RocksDBBackedAppStateMachine::loadChartOfAccounts() {
+  auto *columnFamilyHandle = mColumnFamilyHandles[RocksDBConf::CHART_OF_ACCOUNTS];
+  const auto &splitKeys = splitKeyRange(columnFamilyHandle, mLoadConcurrency);
+  auto partitionNum = splitKeys.size() + 1;
+
+  /// all partitions should read from the same point-in-time view
+  const auto *snapshot = mRocksDB->GetSnapshot();
+
+  std::vector<std::vector<Account>> partitions(partitionNum);
+  std::vector<std::thread> loaders;
+  for (std::size_t i = 0; i < partitionNum; ++i) {
+    loaders.emplace_back([this, i, snapshot, columnFamilyHandle, &splitKeys, &partitions]() {
+      pthread_setname_np(pthread_self(), "CoALoader");
+      rocksdb::ReadOptions readOptions;
+      readOptions.snapshot = snapshot;
+      /// one-pass full scan, do not pollute block cache
+      readOptions.fill_cache = false;
+      readOptions.readahead_size = 2 << 20;
+
+      rocksdb::Slice lowerBound;
+      rocksdb::Slice upperBound;
+      if (i > 0) {
+        lowerBound = splitKeys[i - 1];
+        readOptions.iterate_lower_bound = &lowerBound;
+      }
+      if (i < splitKeys.size()) {
+        upperBound = splitKeys[i];
+        readOptions.iterate_upper_bound = &upperBound;
+      }
+
+      std::unique_ptr<rocksdb::Iterator> iter(mRocksDB->NewIterator(readOptions, columnFamilyHandle));
+      if (i > 0) {
+        iter->Seek(lowerBound);
+      } else {
+        iter->SeekToFirst();
+      }
+
+      auto &accounts = partitions[i];
+      protos::Account accountProto;
+      for (; iter->Valid(); iter->Next()) {
+        const auto &val = iter->value();
+        /// parse from the slice directly rather than copying it into a temporary string
+        accountProto.ParseFromArray(val.data(), static_cast<int>(val.size()));
+        accounts.emplace_back(accountProto);
+        assert(accounts.back().nominalCode() == std::stoull(iter->key().ToString()));
+      }
+      assert(iter->status().ok());
+    });
+  }
+  for (auto &loader : loaders) {
+    loader.join();
+  }
+  mRocksDB->ReleaseSnapshot(snapshot);
+
+  /// bulk-build CoA, partitions are disjoint so no key will be inserted twice
+  std::size_t accountNum = 0;
+  for (const auto &accounts : partitions) {
+    accountNum += accounts.size();
+  }
+  mCoA.reserve(accountNum);
+  for (auto &accounts : partitions) {
+    for (auto &account : accounts) {
+      auto nominalCode = account.nominalCode();
+      assert(mCoA.find(nominalCode) == mCoA.end());
+      mCoA.emplace(nominalCode, std::move(account));
+    }
+  }
+  SPDLOG_INFO("loaded {} accounts with {} partitions", accountNum, partitionNum);
+}
+
+std::vector<std::string> RocksDBBackedAppStateMachine::splitKeyRange(
+    rocksdb::ColumnFamilyHandle *columnFamilyHandle,
+    uint32_t maxPartitions) const {
+  std::vector<std::string> splitKeys;
+  if (maxPartitions <= 1) {
+    return splitKeys;
+  }
+
+  std::vector<rocksdb::LiveFileMetaData> fileMetas;
+  mRocksDB->GetLiveFilesMetaData(&fileMetas);
+  std::vector<std::string> smallestKeys;
+  for (const auto &meta : fileMetas) {
+    if (meta.column_family_name == columnFamilyHandle->GetName()) {
+      smallestKeys.push_back(meta.smallestkey);
+    }
+  }
+  std::sort(smallestKeys.begin(), smallestKeys.end());
+  smallestKeys.erase(std::unique(smallestKeys.begin(), smallestKeys.end()), smallestKeys.end());
+  if (smallestKeys.size() <= 1) {
+    return splitKeys;
+  }
+
+  /// pick boundaries evenly from the files, the first file's smallest key is skipped
+  /// as everything before it belongs to the first range anyway
+  auto partitionNum = std::min<std::size_t>(maxPartitions, smallestKeys.size());
+  for (std::size_t i = 1; i < partitionNum; ++i) {
+    splitKeys.push_back(smallestKeys[i * smallestKeys.size() / partitionNum]);
+  }
+  return splitKeys;
 }
 
 void RocksDBBackedAppStateMachine::onAccountMetadataUpdated(const AccountMetadata &accountMetadata) {
@@ -181,7 +305,7 @@ void RocksDBBackedAppStateMachine::onAccountMetadataUpdated(const AccountMetadat
   auto type = static_cast<int>(accountMetadata.accountType());
   protos::AccountMetadata accountMetadataProto;
   accountMetadata.encodeTo(accountMetadataProto);
-  auto status = mWriteBatch.Put(mColumnFamilyHandles[RocksDBConf::ACCOUNT_METADATA],
+  auto status = mWriteBatch->Put(mColumnFamilyHandles[RocksDBConf::ACCOUNT_METADATA],
                                 std::to_string(type),
                                 rocksdb::Slice(accountMetadataProto.SerializeAsString()));
   if (!status.ok()) {
@@ -196,7 +320,7 @@ void RocksDBBackedAppStateMachine::onAccountInserted(const Account &account) {
   auto nominalCode = account.nominalCode();
   protos::Account accountProto;
   account.encodeTo(accountProto);
-  auto status = mWriteBatch.Put(mColumnFamilyHandles[RocksDBConf::CHART_OF_ACCOUNTS],
+  auto status = mWriteBatch->Put(mColumnFamilyHandles[RocksDBConf::CHART_OF_ACCOUNTS],
                                 std::to_string(nominalCode),
                                 rocksdb::Slice(accountProto.SerializeAsString()));
   if (!status.ok()) {
@@ -212,7 +336,7 @@ void RocksDBBackedAppStateMachine::onAccountUpdated(const gringofts::ledger::Acc
   /// account must exist either in write batch or on-disk rocksdb
   protos::Account accountProto;
   account.encodeTo(accountProto);
-  auto status = mWriteBatch.Put(mColumnFamilyHandles[RocksDBConf::CHART_OF_ACCOUNTS],
+  auto status = mWriteBatch->Put(mColumnFamilyHandles[RocksDBConf::CHART_OF_ACCOUNTS],
                                 std::to_string(nominalCode),
                                 rocksdb::Slice(accountProto.SerializeAsString()));
   if (!status.ok()) {
@@ -224,7 +348,7 @@ void RocksDBBackedAppStateMachine::onAccountUpdated(const gringofts::ledger::Acc
 void RocksDBBackedAppStateMachine::onBookkeepingProcessed(std::string dedupId, uint64_t validTime) {
   rocksdb::ReadOptions readOptions;
 
-  auto status = mWriteBatch.Put(mColumnFamilyHandles[RocksDBConf::DONE_MAP],
+  auto status = mWriteBatch->Put(mColumnFamilyHandles[RocksDBConf::DONE_MAP],
                                 dedupId,
                                 std::to_string(validTime));
   if (!status.ok()) {
@@ -15,15 +15,25 @@ limitations under the License.
 #ifndef SRC_APP_LEDGER_V2_ROCKSDBBACKEDAPPSTATEMACHINE_H_
 #define SRC_APP_LEDGER_V2_ROCKSDBBACKEDAPPSTATEMACHINE_H_
 
+#include <algorithm>
+
 #include "AppStateMachine.h"
 
 namespace gringofts {
 namespace ledger {
+
+/// test that inspects the SST layout of chart_of_accounts
+class LedgerAppStateMachineTest_RecoverManyAccounts_Test;
+
 namespace v2 {
 
 class RocksDBBackedAppStateMachine : public v2::AppStateMachine {
  public:
-  RocksDBBackedAppStateMachine(const std::string &walDir, const std::string &dbDir) {
+  RocksDBBackedAppStateMachine(const std::string &walDir,
+                               const std::string &dbDir,
+                               uint32_t loadConcurrency = kDefaultLoadConcurrency,
+                               std::shared_ptr<PMRContainerFactory> containerFactory = nullptr)
+      : v2::AppStateMachine(containerFactory), mLoadConcurrency(std::max(loadConcurrency, 1u)) {
     openRocksDB(walDir,
                 dbDir,
                 &mRocksDB,
@@ -38,6 +48,13 @@ class RocksDBBackedAppStateMachine : public v2::AppStateMachine {
   /// write WriteBatch to RocksDB synchronously
   void flushToRocksDB();
 
+  /**
+   * Hand over the unflushed write batch and start a new one, so that swapState() does not
+   * wait for the flush. The handed-over batch will be flushed in recoverSelf(),
+   * caller can keep reading through it until then and after.
+   */
+  std::shared_ptr<rocksdb::WriteBatchWithIndex> handOverWriteBatch();
+
   /// invoked after swapState() is called, return lastFlushedIndex
   uint64_t recoverSelf();
 
@@ -58,6 +75,7 @@ class RocksDBBackedAppStateMachine : public v2::AppStateMachine {
 
  private:
   friend class MemoryBackedAppStateMachine;
+  friend class ledger::LedgerAppStateMachineTest_RecoverManyAccounts_Test;
 
   /// open RocksDB
   void openRocksDB(const std::string &walDir,
@@ -68,13 +86,41 @@ class RocksDBBackedAppStateMachine : public v2::AppStateMachine {
   /// close RocksDB
   void closeRocksDB(std::shared_ptr<rocksdb::DB> *dbPtr);
 
+  /// write the given batch to RocksDB synchronously
+  void writeToRocksDB(rocksdb::WriteBatch *writeBatch);
+
   /// read value/lastAppliedIndex from RocksDB
   void loadFromRocksDB();
 
+  /// load CoA with up to mLoadConcurrency threads, each scanning a disjoint key range
+  void loadChartOfAccounts();
+
+  /**
+   * Split the key space of the given column family into at most maxPartitions ranges,
+   * using the smallest keys of its live SST files as boundaries.
+   * @return sorted split keys, range i is [splitKeys[i-1], splitKeys[i])
+   */
+  std::vector<std::string> splitKeyRange(rocksdb::ColumnFamilyHandle *columnFamilyHandle,
+                                         uint32_t maxPartitions) const;
+
+  /// the default num of threads used to load CoA during recovery
+  static constexpr uint32_t kDefaultLoadConcurrency = 4;
+
+  /// the num of threads used to load CoA during recovery
+  const uint32_t mLoadConcurrency;
+
   /// the max num of bundles batched in write batch
   const uint64_t mMaxBatchSize = 500;
 
-  rocksdb::WriteBatch mWriteBatch;
+  /// write batch is indexed so that it can be read by CPL after being handed over
+  static std::shared_ptr<rocksdb::WriteBatchWithIndex> newWriteBatch() {
+    return std::make_shared<rocksdb::WriteBatchWithIndex>(rocksdb::BytewiseComparator(), 0, true);
+  }
+
+  std::shared_ptr<rocksdb::WriteBatchWithIndex> mWriteBatch = newWriteBatch();
+
+  /// write batch handed over by handOverWriteBatch(), not yet flushed
+  std::shared_ptr<rocksdb::WriteBatchWithIndex> mHandedOverWriteBatch;
 
   /// latest index that have been flushed to RocksDB
   uint64_t mLastFlushedIndex = 0;
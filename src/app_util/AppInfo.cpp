@@ -38,12 +38,14 @@ void AppInfo::init(const INIReader &reader) {
   appInfo.setGroupVersion(reader.GetInteger("app", "group.version", 0));
   appInfo.enableStressTest(reader.GetBoolean("app", "stress.test.enabled", false));
   appInfo.setAppVersion(reader.Get("app", "version", "v2"));
+  appInfo.enableCompactPayload(reader.GetBoolean("app", "compact.payload.enabled", false));
 
   SPDLOG_INFO("Global settings: subsystem.id={}, "
               "group.id={}, "
               "group.version={}, "
               "stress.test.enabled={}, "
-              "app.version={}"
+              "app.version={}, "
+              "compact.payload.enabled={}, "
               "app.clusterid={}"
               "app.nodeid={}",
               appInfo.mSubsystemId,
@@ -51,6 +53,7 @@ void AppInfo::init(const INIReader &reader) {
               appInfo.mGroupVersion,
               appInfo.mStressTestEnabled,
               appInfo.mAppVersion,
+              appInfo.mCompactPayloadEnabled,
               appInfo.mMyClusterId,
               appInfo.mMyNodeId);
 }
@@ -43,6 +43,7 @@ class AppInfo final {
   static uint64_t groupVersion() { return getInstance().mGroupVersion; }
   static bool stressTestEnabled() { return getInstance().mStressTestEnabled; }
   static std::string appVersion() { return getInstance().mAppVersion; }
+  static bool compactPayloadEnabled() { return getInstance().mCompactPayloadEnabled; }
 
   static ClusterInfo getMyClusterInfo() {
     return getInstance().mAllClusterInfo[getInstance().mMyClusterId];
@@ -102,6 +103,8 @@ class AppInfo final {
 
   inline void setAppVersion(const std::string &appVersion) { mAppVersion = appVersion; }
 
+  inline void enableCompactPayload(bool enabled) { mCompactPayloadEnabled = enabled; }
+
   std::atomic<bool> initialized = false;
   /**
    * Uniquely identifies the system
@@ -120,6 +123,11 @@ class AppInfo final {
    * App version
    */
   std::string mAppVersion = "v2";
+  /**
+   * True if events omit the fields they share with their originating command
+   * when persisted. Only enable once every node is able to decode compact events.
+   */
+  bool mCompactPayloadEnabled = false;
   /**
    * Cluster Info
    */
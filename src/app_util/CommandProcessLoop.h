@@ -25,7 +25,10 @@ limitations under the License.
 #include "../infra/es/ProcessCommandStateMachine.h"
 #include "../infra/es/ReadonlyCommandEventStore.h"
 #include "../infra/es/Recoverable.h"
+#include "../infra/grpc/AdmissionController.h"
 #include "../infra/monitor/MonitorTypes.h"
+#include "../infra/util/LogUtil.h"
+#include "../infra/util/MetricReporter.h"
 #include "../infra/util/PMRContainerFactory.h"
 #include "../infra/util/PerfConfig.h"
 
@@ -133,6 +136,8 @@ class CommandProcessLoopBase : public CommandProcessLoopInterface {
   santiago::MetricsCenter::CounterType applied_event_total;
   santiago::MetricsCenter::GaugeType consumer_queue_size;
   santiago::MetricsCenter::GaugeType transition_gauge;
+  santiago::MetricsCenter::HistogramType process_latency_histogram;
+  santiago::MetricsCenter::HistogramType persist_latency_histogram;
 };
 
 template<typename StateMachineType>
@@ -163,7 +168,9 @@ CommandProcessLoopBase<StateMachineType>::CommandProcessLoopBase(
           {"OldLeaderToNewLeader", std::to_string(static_cast<double>(Transition::OldLeaderToNewLeader))},
           {"SameFollower", std::to_string(static_cast<double>(Transition::SameFollower))},
           {"SameLeader", std::to_string(static_cast<double>(Transition::SameLeader))},
-      })) {
+      })),
+      process_latency_histogram(getHistogram("cpl_process_latency_in_ms", {})),
+      persist_latency_histogram(getHistogram("cpl_persist_latency_in_ms", {})) {
   assert(mEventApplyLoop);
 
   mCrypto.init(reader);
@@ -177,6 +184,7 @@ void CommandProcessLoopBase<StateMachineType>::runDistributed() {
   while (!mShouldExit) {
     try {
       auto command = mInputCommandQueue.dequeue();
+      command->stampTrace(TraceStage::CplDequeue);
       consumer_queue_size.set(mInputCommandQueue.estimateTotalSize());
       auto startTime = TimeUtil::currentTimeInNanos();
       command->setProcessTimeInNanos(startTime);
@@ -205,10 +213,10 @@ void CommandProcessLoopBase<StateMachineType>::runDistributed() {
       }
       auto endTime = TimeUtil::currentTimeInNanos();
       command->setFinishTimeInNanos(endTime);
+      /// drain rate of the command queue, for projecting the queue wait of new requests
+      AdmissionController::getInstance().observeServiceTime(endTime - startTime);
       auto latency = (endTime - startTime) / 1000000.0;
-      if (latency > gringofts::PerfConfig::getInstance().getProcessOutlierTime()) {
-        command->reportMetrics();
-      }
+      command->reportMetrics(latency > gringofts::PerfConfig::getInstance().getProcessOutlierTime());
     } catch (const QueueStoppedException &e) {
       SPDLOG_WARN("input command queue has been closed: {}", e.what());
       shutdown();
@@ -244,6 +252,10 @@ void CommandProcessLoopBase<StateMachineType>::onBecomeLeader(std::shared_ptr<Co
               "Processing new command",
               (ts2InNano - ts1InNano) / 1000000.0,
               (ts3InNano - ts2InNano) / 1000000.0);
+  static auto waitReadyLatency = getHistogram("leader_transition_wait_ready_latency_in_ms", {});
+  static auto swapLatency = getHistogram("leader_transition_swap_latency_in_ms", {});
+  MetricReporter::reportLatency(waitReadyLatency, "leader_transition_wait_ready_latency_in_ms", ts1InNano, ts2InNano);
+  MetricReporter::reportLatency(swapLatency, "leader_transition_swap_latency_in_ms", ts2InNano, ts3InNano);
   command->setLeaderReadyTimeInNanos(ts3InNano);
 
   /// Start processing command
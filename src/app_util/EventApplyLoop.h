@@ -21,7 +21,10 @@ limitations under the License.
 #include "../infra/es/ReadonlyCommandEventStore.h"
 #include "../infra/es/StateMachine.h"
 #include "../infra/es/store/SnapshotUtil.h"
+#include "../infra/monitor/MonitorTypes.h"
 #include "../infra/util/CryptoUtil.h"
+#include "../infra/util/LogUtil.h"
+#include "../infra/util/PMRContainerFactory.h"
 
 #include "CommandEventDecoderImpl.h"
 #include "NetAdminServiceProvider.h"
@@ -81,7 +84,9 @@ class EventApplyLoopBase : public EventApplyLoopInterface {
       : mReadonlyCommandEventStore(std::move(readonlyCommandEventStore)),
         mCommandEventDecoder(decoder),
         mSnapshotDir(snapshotDir),
-        mLastAppliedIndexGauge(getGauge("eal_last_applied_index", {})) { mCrypto.init(reader); }
+        mLastAppliedIndexGauge(getGauge("eal_last_applied_index", {})),
+        mLoadLatencyHistogram(getHistogram("eal_load_latency_in_ms", {})),
+        mApplyLatencyHistogram(getHistogram("eal_apply_latency_in_ms", {})) { mCrypto.init(reader); }
 
   ~EventApplyLoopBase() override = default;
 
@@ -150,6 +155,8 @@ class EventApplyLoopBase : public EventApplyLoopInterface {
 
   /// metrics
   santiago::MetricsCenter::GaugeType mLastAppliedIndexGauge;
+  santiago::MetricsCenter::HistogramType mLoadLatencyHistogram;
+  santiago::MetricsCenter::HistogramType mApplyLatencyHistogram;
 };
 
 /**
@@ -186,16 +193,15 @@ void EventApplyLoopBase<StateMachineType>::run() {
     mLastAppliedLogEntryIndex = commandId;
     mLastAppliedIndexGauge.set(mLastAppliedLogEntryIndex);
 
-    /// TODO: remove below if-block once log cutoff is supported
-    if (commandId % 10 == 0) {
-      SPDLOG_INFO("Apply Events, CommandId={}, EventNum={}, "
-                  "totalCost={}us, loadCost={}us, applyCost={}us",
-                  commandId,
-                  events.size(),
-                  (ts3InNano - ts1InNano) / 1000.0,
-                  (ts2InNano - ts1InNano) / 1000.0,
-                  (ts3InNano - ts2InNano) / 1000.0);
-    }
+    mLoadLatencyHistogram.observe((ts2InNano - ts1InNano) / 1000000.0);
+    mApplyLatencyHistogram.observe((ts3InNano - ts2InNano) / 1000000.0);
+    SPDLOG_INFO_EVERY_MS(1000, "Apply Events, CommandId={}, EventNum={}, "
+                         "totalCost={}us, loadCost={}us, applyCost={}us",
+                         commandId,
+                         events.size(),
+                         (ts3InNano - ts1InNano) / 1000.0,
+                         (ts2InNano - ts1InNano) / 1000.0,
+                         (ts3InNano - ts2InNano) / 1000.0);
   }
 }
 
@@ -295,6 +301,10 @@ class EventApplyLoop<MemoryBackedStateMachineType, false>
     }
 
     auto ts4InNano = TimeUtil::currentTimeInNanos();
+    getGauge("startup_phase_cost_in_ms", {{"phase", "load_snapshot"}})  /// metric-lookup: once on recovery
+        .set((ts3InNano - ts2InNano) / 1000000.0);
+    getGauge("startup_phase_cost_in_ms", {{"phase", "init_readonly_ces"}})  /// metric-lookup: once on recovery
+        .set((ts4InNano - ts3InNano) / 1000000.0);
     SPDLOG_INFO("clear state cost {}ms, reload snapshot cost {}ms, "
                 "re-init Readonly CES cost {}ms, will start apply events after {}",
                 (ts2InNano - ts1InNano) / 1000000.0,
@@ -313,12 +323,13 @@ class EventApplyLoop<RocksDBBackedStateMachineType, true>
   EventApplyLoop(const INIReader &reader,
                  const std::shared_ptr<CommandEventDecoder> &decoder,
                  std::unique_ptr<ReadonlyCommandEventStore> readonlyCommandEventStore,
-                 const std::string &snapshotDir)
+                 const std::string &snapshotDir,
+                 std::shared_ptr<PMRContainerFactory> containerFactory = nullptr)
           : EventApplyLoopBase<RocksDBBackedStateMachineType>(reader,
                                                               decoder,
                                                               std::move(readonlyCommandEventStore),
                                                               snapshotDir) {
-    initStateMachine(reader);
+    initStateMachine(reader, containerFactory);
     /// recover state
     recoverSelf();
   }
@@ -341,26 +352,45 @@ class EventApplyLoop<RocksDBBackedStateMachineType, true>
   }
 
  protected:
-  void initStateMachine(const INIReader &iniReader) {
+  /// containerFactory must be the one of the state machine this one swaps states with
+  void initStateMachine(const INIReader &iniReader, std::shared_ptr<PMRContainerFactory> containerFactory) {
     std::string walDir = iniReader.Get("rocksdb", "wal.dir", "");
     std::string dbDir  = iniReader.Get("rocksdb", "db.dir", "");
     assert(!walDir.empty() && !dbDir.empty());
+    auto loadConcurrency = iniReader.GetInteger("rocksdb", "load.concurrency", 4);
+    assert(loadConcurrency > 0);
 
-    this->mAppStateMachine = std::make_unique<RocksDBBackedStateMachineType>(walDir, dbDir);
+    this->mAppStateMachine = std::make_unique<RocksDBBackedStateMachineType>(walDir,
+                                                                             dbDir,
+                                                                             loadConcurrency,
+                                                                             containerFactory);
   }
 
   void recoverSelf() override {
     SPDLOG_INFO("Start recovering.");
 
     /// recover StateMachine
+    auto ts1InNano = TimeUtil::currentTimeInNanos();
     this->mLastAppliedLogEntryIndex = this->mAppStateMachine->recoverSelf();
 
     /// re-init Readonly CES, unit test CAN ignore this step.
+    auto ts2InNano = TimeUtil::currentTimeInNanos();
     if (this->mReadonlyCommandEventStore) {
       this->mReadonlyCommandEventStore->setCurrentOffset(this->mLastAppliedLogEntryIndex);
       this->mReadonlyCommandEventStore->init();
     }
 
+    auto ts3InNano = TimeUtil::currentTimeInNanos();
+    getGauge("startup_phase_cost_in_ms", {{"phase", "recover_state_machine"}})  /// metric-lookup: once on recovery
+        .set((ts2InNano - ts1InNano) / 1000000.0);
+    getGauge("startup_phase_cost_in_ms", {{"phase", "init_readonly_ces"}})  /// metric-lookup: once on recovery
+        .set((ts3InNano - ts2InNano) / 1000000.0);
+    SPDLOG_INFO("recover state machine cost {}ms, re-init Readonly CES cost {}ms, "
+                "will start apply events after {}",
+                (ts2InNano - ts1InNano) / 1000000.0,
+                (ts3InNano - ts2InNano) / 1000000.0,
+                this->mLastAppliedLogEntryIndex);
+
     this->mShouldRecover = false;
   }
 };
@@ -0,0 +1,164 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "LeaderForwarder.h"
+
+#include <algorithm>
+
+#include <absl/strings/numbers.h>
+#include <spdlog/spdlog.h>
+
+#include "../infra/util/LogUtil.h"
+#include "../infra/util/ThreadPlacement.h"
+#include "AppInfo.h"
+
+namespace gringofts {
+namespace app {
+
+LeaderForwarder::LeaderForwarder(const INIReader &reader, std::shared_ptr<raft::RaftInterface> raftImpl)
+    : mRaftImpl(std::move(raftImpl)),
+      mForwardedCounter(getCounter("forwarded_request_total", {{"status", "ok"}})),
+      mForwardFailedCounter(getCounter("forwarded_request_total", {{"status", "failed"}})),
+      mForwardLatencyHistogram(getHistogram("forward_latency_in_ms", {})) {
+  mEnabled = reader.GetBoolean("proxy", "enable", false);
+  mChannelsPerLeader = reader.GetInteger("proxy", "channels.per.leader", 2);
+  mTimeoutInMs = reader.GetInteger("proxy", "timeout.in.ms", 1000);
+  mTlsConfOpt = TlsUtil::parseTlsConf(reader, "tls");
+
+  if (mEnabled && mRaftImpl == nullptr) {
+    SPDLOG_ERROR("proxy mode requires raft, exiting");
+    exit(1);
+  }
+  if (mChannelsPerLeader == 0) {
+    SPDLOG_ERROR("channels.per.leader should be positive, exiting");
+    exit(1);
+  }
+  SPDLOG_INFO("proxy mode enabled={}, channels.per.leader={}, timeout={}ms",
+              mEnabled, mChannelsPerLeader, mTimeoutInMs);
+
+  mCompletionThread = std::thread([this]() {
+    pthread_setname_np(pthread_self(), "ForwardThread");
+    ThreadPlacement::getInstance().place("ForwardThread");
+    handleCompletions();
+  });
+}
+
+LeaderForwarder::~LeaderForwarder() {
+  mCompletionQueue.Shutdown();
+  if (mCompletionThread.joinable()) {
+    mCompletionThread.join();
+  }
+}
+
+std::optional<NodeId> LeaderForwarder::leaderToForward(const Metadata &metadata) const {
+  if (!mEnabled || metadata.find("x-forwarded-by") != metadata.end()) {
+    return std::nullopt;
+  }
+  if (mRaftImpl->getRaftRole() == raft::RaftRole::Leader) {
+    return std::nullopt;
+  }
+
+  auto leaderHint = mRaftImpl->getLeaderHint();
+  if (!leaderHint || *leaderHint == AppInfo::getMyNodeId()) {
+    return std::nullopt;
+  }
+  return static_cast<NodeId>(*leaderHint);
+}
+
+std::optional<std::string> LeaderForwarder::gatewayAddressOf(NodeId leader) const {
+  auto members = mRaftImpl->getClusterMembers();
+  auto member = std::find_if(members.begin(), members.end(),
+                             [leader](const raft::MemberInfo &member) { return member.mId == leader; });
+  if (member == members.end()) {
+    return std::nullopt;
+  }
+  auto colon = member->mAddress.rfind(':');
+  uint32_t raftPort = 0;
+  if (colon == std::string::npos || !absl::SimpleAtoi(member->mAddress.substr(colon + 1), &raftPort)) {
+    return std::nullopt;
+  }
+  auto host = member->mAddress.substr(0, colon);
+
+  auto nodes = AppInfo::getMyClusterInfo().getAllNodeInfo();
+  auto node = nodes.find(leader);
+  if (node != nodes.end()) {
+    return host + ":" + std::to_string(node->second.mPortForGateway);
+  }
+  auto self = nodes.find(AppInfo::getMyNodeId());
+  if (self == nodes.end()) {
+    return std::nullopt;
+  }
+  auto port = static_cast<int64_t>(raftPort) + self->second.mPortForGateway - self->second.mPortForRaft;
+  return host + ":" + std::to_string(port);
+}
+
+std::shared_ptr<grpc::Channel> LeaderForwarder::channelTo(NodeId leader) {
+  auto address = gatewayAddressOf(leader);
+  if (!address) {
+    SPDLOG_WARN_EVERY_MS(1000, "leader {} is not in current configuration, not forwarding", leader);
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(mChannelMutex);
+  auto &channels = mChannels[*address];
+  auto i = mNextChannel++ % mChannelsPerLeader;
+  if (channels.empty()) {
+    channels.resize(mChannelsPerLeader);
+  }
+  if (!channels[i]) {
+    grpc::ChannelArguments channelArgs;
+    /// otherwise channels with the same args share one connection
+    channelArgs.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    channels[i] = grpc::CreateCustomChannel(*address, TlsUtil::buildChannelCredentials(mTlsConfOpt), channelArgs);
+    SPDLOG_INFO("forwarding channel {} to leader {} at {}", i, leader, *address);
+  }
+  return channels[i];
+}
+
+void LeaderForwarder::prepareContext(const Metadata &metadata,
+                                     std::chrono::system_clock::time_point clientDeadline,
+                                     CallBase *call) const {
+  for (const auto &[key, value] : metadata) {
+    std::string name(key.data(), key.length());
+    if (name.rfind("x-", 0) == 0) {
+      call->mContext.AddMetadata(name, std::string(value.data(), value.length()));
+    }
+  }
+  call->mContext.AddMetadata("x-forwarded-by", std::to_string(AppInfo::getMyNodeId()));
+  /// no point in waiting for leader once the client has given up
+  call->mContext.set_deadline(
+      std::min(clientDeadline, std::chrono::system_clock::now() + std::chrono::milliseconds(mTimeoutInMs)));
+  call->mStartTime = TimeUtil::currentTimeInNanos();
+}
+
+void LeaderForwarder::handleCompletions() {
+  void *tag;
+  bool ok;
+  while (mCompletionQueue.Next(&tag, &ok)) {
+    auto *call = static_cast<CallBase *>(tag);
+    mForwardLatencyHistogram.observe((TimeUtil::currentTimeInNanos() - call->mStartTime) / 1000000.0);
+    if (call->mStatus.ok()) {
+      mForwardedCounter.increase();
+    } else {
+      mForwardFailedCounter.increase();
+      SPDLOG_WARN_EVERY_MS(1000, "forward to leader failed, code={}, message={}",
+                           call->mStatus.error_code(), call->mStatus.error_message());
+    }
+    call->onDone();
+    delete call;
+  }
+}
+
+}  /// namespace app
+}  /// namespace gringofts
@@ -0,0 +1,167 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_APP_UTIL_LEADERFORWARDER_H_
+#define SRC_APP_UTIL_LEADERFORWARDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <INIReader.h>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/async_unary_call.h>
+
+#include "../infra/monitor/MonitorTypes.h"
+#include "../infra/raft/RaftInterface.h"
+#include "../infra/util/ClusterInfo.h"
+#include "../infra/util/TimeUtil.h"
+#include "../infra/util/TlsUtil.h"
+
+namespace gringofts {
+namespace app {
+
+/**
+ * Proxy mode of a follower: write RPCs are relayed to the current leader over pooled channels
+ * and the leader's response is relayed back, so clients see a failover as a latency blip
+ * instead of a 301 to follow.
+ *
+ * A forwarded request carries x-forwarded-by, and is never forwarded again, e.g., when
+ * two nodes disagree on who is leader. Calls run on a dedicated completion queue thread.
+ *
+ * Supported keys in [proxy]:
+ *   enable              - true|false, default false
+ *   channels.per.leader - connections to leader, calls are spread round robin, default 2
+ *   timeout.in.ms       - deadline of a forwarded call, capped by the deadline of the original one,
+ *                         default 1000
+ */
+class LeaderForwarder final {
+ public:
+  using Metadata = std::multimap<grpc::string_ref, grpc::string_ref>;
+
+  LeaderForwarder(const INIReader &reader, std::shared_ptr<raft::RaftInterface> raftImpl);
+  ~LeaderForwarder();
+
+  LeaderForwarder(const LeaderForwarder &) = delete;
+  LeaderForwarder &operator=(const LeaderForwarder &) = delete;
+
+  /**
+   * Leader the request should be forwarded to, nullopt if it should be handled here, i.e.,
+   * proxy mode is off, this node is leader, leader is unknown, or it has been forwarded once.
+   */
+  std::optional<NodeId> leaderToForward(const Metadata &metadata) const;
+
+  /**
+   * Relay request to leader by rpc, e.g., &Service::Stub::PrepareAsyncFoo,
+   * done is called on the forwarder thread with the leader's response.
+   * clientDeadline is the deadline of the original request, i.e., ServerContext::deadline().
+   * If leader is not in the current raft configuration, done is called right away with UNAVAILABLE.
+   */
+  template<typename Stub, typename Request, typename Response, typename Callback>
+  void forward(NodeId leader,
+               const Metadata &metadata,
+               std::chrono::system_clock::time_point clientDeadline,
+               Request request,
+               std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> (Stub::*rpc)(
+                   grpc::ClientContext *, const Request &, grpc::CompletionQueue *),
+               Callback done);
+
+ private:
+  struct CallBase {
+    virtual ~CallBase() = default;
+    virtual void onDone() = 0;
+
+    grpc::ClientContext mContext;
+    grpc::Status mStatus;
+    TimestampInNanos mStartTime = 0;
+  };
+
+  template<typename Stub, typename Request, typename Response>
+  struct Call : public CallBase {
+    void onDone() override { mDone(mStatus, mResponse); }
+
+    std::unique_ptr<Stub> mStub;
+    Request mRequest;
+    Response mResponse;
+    std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> mReader;
+    std::function<void(const grpc::Status &, const Response &)> mDone;
+  };
+
+  /**
+   * Gateway address of leader, host from the current raft configuration, so that members added
+   * at runtime are reachable too. Port from cluster.conf, or for a member not listed there, its raft
+   * port shifted as ours is, e.g., nodes sharing a host. nullopt if leader is not a member.
+   */
+  std::optional<std::string> gatewayAddressOf(NodeId leader) const;
+  /// next channel to leader, connected on first use, nullptr if its address is unknown
+  std::shared_ptr<grpc::Channel> channelTo(NodeId leader);
+  /// x- headers of the original request plus x-forwarded-by, and the earlier of both deadlines
+  void prepareContext(const Metadata &metadata,
+                      std::chrono::system_clock::time_point clientDeadline,
+                      CallBase *call) const;
+  void handleCompletions();
+
+  bool mEnabled = false;
+  uint64_t mChannelsPerLeader = 2;
+  uint64_t mTimeoutInMs = 1000;
+  std::optional<TlsConf> mTlsConfOpt;
+  std::shared_ptr<raft::RaftInterface> mRaftImpl;
+
+  std::mutex mChannelMutex;
+  /// by address, a member re-added with another address gets new channels
+  std::map<std::string, std::vector<std::shared_ptr<grpc::Channel>>> mChannels;
+  std::atomic<uint64_t> mNextChannel = 0;
+
+  grpc::CompletionQueue mCompletionQueue;
+  std::thread mCompletionThread;
+
+  santiago::MetricsCenter::CounterType mForwardedCounter;
+  santiago::MetricsCenter::CounterType mForwardFailedCounter;
+  santiago::MetricsCenter::HistogramType mForwardLatencyHistogram;
+};
+
+template<typename Stub, typename Request, typename Response, typename Callback>
+void LeaderForwarder::forward(NodeId leader,
+                              const Metadata &metadata,
+                              std::chrono::system_clock::time_point clientDeadline,
+                              Request request,
+                              std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> (Stub::*rpc)(
+                                  grpc::ClientContext *, const Request &, grpc::CompletionQueue *),
+                              Callback done) {
+  auto channel = channelTo(leader);
+  if (!channel) {
+    mForwardFailedCounter.increase();
+    done(grpc::Status(grpc::StatusCode::UNAVAILABLE, "address of leader is unknown"), Response());
+    return;
+  }
+  auto *call = new Call<Stub, Request, Response>();
+  prepareContext(metadata, clientDeadline, call);
+  call->mStub = std::make_unique<Stub>(std::move(channel));
+  call->mRequest = std::move(request);
+  call->mDone = std::move(done);
+  call->mReader = ((*call->mStub).*rpc)(&call->mContext, call->mRequest, &mCompletionQueue);
+  call->mReader->StartCall();
+  call->mReader->Finish(&call->mResponse, &call->mStatus, call);
+}
+
+}  /// namespace app
+}  /// namespace gringofts
+
+#endif  // SRC_APP_UTIL_LEADERFORWARDER_H_
@@ -21,6 +21,7 @@ limitations under the License.
 #include <grpcpp/server_context.h>
 #include <grpcpp/support/status.h>
 
+#include "../infra/monitor/CommandTracer.h"
 #include "../infra/util/TlsUtil.h"
 #include "../infra/util/Signal.h"
 #include "../infra/raft/RaftSignal.h"
@@ -58,6 +59,14 @@ using gringofts::app::protos::ScaleControl_StartupResponse;
 using gringofts::app::protos::TruncatePrefix_Request;
 using gringofts::app::protos::TruncatePrefix_Response;
 using gringofts::app::protos::TruncatePrefix_ResponseType;
+using gringofts::app::protos::TransferLeadership_Request;
+using gringofts::app::protos::TransferLeadership_Response;
+using gringofts::app::protos::AddMember_Request;
+using gringofts::app::protos::AddMember_Response;
+using gringofts::app::protos::RemoveMember_Request;
+using gringofts::app::protos::RemoveMember_Response;
+using gringofts::app::protos::DumpTrace_Request;
+using gringofts::app::protos::DumpTrace_Response;
 using gringofts::raft::RaftRole;
 /**
  * A server class which exposes some management functionalities to external clients, e.g., pubuddy.
@@ -72,7 +81,11 @@ class NetAdminServer final : public AppNetAdmin::Service {
       mPrefixTruncatedCounter(getCounter("prefix_truncated_counter", {})),
       mPrefixTruncateFailedCounter(getCounter("prefix_truncate_failed_counter", {})),
       mHotfixAppliedCounter(getCounter("hotfix_applied_counter", {})),
-      mHotfixFailedCounter(getCounter("hotfix_failed_counter", {})) {
+      mHotfixFailedCounter(getCounter("hotfix_failed_counter", {})),
+      mLeadershipTransferredCounter(getCounter("leadership_transferred_counter", {})),
+      mLeadershipTransferFailedCounter(getCounter("leadership_transfer_failed_counter", {})),
+      mMembershipChangedCounter(getCounter("membership_changed_counter", {})),
+      mMembershipChangeFailedCounter(getCounter("membership_change_failed_counter", {})) {
     mIpPort = absl::StrFormat("0.0.0.0:%d", port);
     assert(mIpPort != "UNKNOWN");
 
@@ -272,6 +285,71 @@ class NetAdminServer final : public AppNetAdmin::Service {
     return Status::OK;
   }
 
+  /**
+   * leadership transfer service, when invoked, leader will hand leadership over to target node,
+   * used before a planned restart of leader.
+   */
+  Status TransferLeadership(ServerContext *context,
+                            const TransferLeadership_Request *request,
+                            TransferLeadership_Response *reply) override {
+    SPDLOG_INFO("Start transferring leadership to node {}", request->targetid());
+    auto transferSignal = std::make_shared<raft::TransferLeadershipSignal>(request->targetid());
+    Signal::hub << transferSignal;
+    auto result = transferSignal->getFuture().get();
+    if (result.mSuccess) {
+      SPDLOG_INFO("Leadership has been transferred, {}", result.mMessage);
+      mLeadershipTransferredCounter.increase();
+      reply->mutable_header()->set_code(200);
+    } else {
+      SPDLOG_WARN("Failed to transfer leadership, {}", result.mMessage);
+      mLeadershipTransferFailedCounter.increase();
+      reply->mutable_header()->set_code(503);
+    }
+    reply->mutable_header()->set_message(result.mMessage);
+    return Status::OK;
+  }
+
+  /**
+   * add member service, when invoked, leader will replicate log to the new node
+   * as a learner, and make it a voter once it catches up.
+   */
+  Status AddMember(ServerContext *context,
+                   const AddMember_Request *request,
+                   AddMember_Response *reply) override {
+    SPDLOG_INFO("Start adding member {}@{}", request->id(), request->address());
+    auto result = changeMembership(raft::ChangeMembershipRequest::Type::AddMember,
+                                   {request->id(), request->address()});
+    reply->mutable_header()->set_code(result.mSuccess ? 200 : 503);
+    reply->mutable_header()->set_message(result.mMessage);
+    return Status::OK;
+  }
+
+  /**
+   * remove member service, when invoked, leader will drop the node from cluster,
+   * and step down if the node is itself.
+   */
+  Status RemoveMember(ServerContext *context,
+                      const RemoveMember_Request *request,
+                      RemoveMember_Response *reply) override {
+    SPDLOG_INFO("Start removing member {}", request->id());
+    auto result = changeMembership(raft::ChangeMembershipRequest::Type::RemoveMember, {request->id(), ""});
+    reply->mutable_header()->set_code(result.mSuccess ? 200 : 503);
+    reply->mutable_header()->set_message(result.mMessage);
+    return Status::OK;
+  }
+
+  /**
+   * trace dump service, when invoked, returns the recent sampled command traces in Chrome trace format.
+   */
+  Status DumpTrace(ServerContext *context,
+                   const DumpTrace_Request *request,
+                   DumpTrace_Response *reply) override {
+    reply->set_chrometracejson(CommandTracer::getInstance().dumpChromeTrace(request->maxtraces()));
+    reply->mutable_header()->set_code(200);
+    reply->mutable_header()->set_message("ok");
+    return Status::OK;
+  }
+
   /**
    * The main function of the dedicated thread
    */
@@ -318,6 +396,21 @@ class NetAdminServer final : public AppNetAdmin::Service {
   std::atomic<bool> mTruncatePrefixIsRunning = false;
   std::atomic<bool> mHotfixIsRunning = false;
 
+  raft::RaftAdminResult changeMembership(raft::ChangeMembershipRequest::Type type,
+                                         raft::MemberInfo member) {
+    auto changeSignal = std::make_shared<raft::ChangeMembershipSignal>(type, std::move(member));
+    Signal::hub << changeSignal;
+    auto result = changeSignal->getFuture().get();
+    if (result.mSuccess) {
+      SPDLOG_INFO("Membership has been changed, {}", result.mMessage);
+      mMembershipChangedCounter.increase();
+    } else {
+      SPDLOG_WARN("Failed to change membership, {}", result.mMessage);
+      mMembershipChangeFailedCounter.increase();
+    }
+    return result;
+  }
+
   /// metrics start
   mutable santiago::MetricsCenter::CounterType mSnapshotTakenCounter;
   mutable santiago::MetricsCenter::CounterType mSnapshotFailedCounter;
@@ -325,6 +418,10 @@ class NetAdminServer final : public AppNetAdmin::Service {
   mutable santiago::MetricsCenter::CounterType mPrefixTruncateFailedCounter;
   mutable santiago::MetricsCenter::CounterType mHotfixAppliedCounter;
   mutable santiago::MetricsCenter::CounterType mHotfixFailedCounter;
+  mutable santiago::MetricsCenter::CounterType mLeadershipTransferredCounter;
+  mutable santiago::MetricsCenter::CounterType mLeadershipTransferFailedCounter;
+  mutable santiago::MetricsCenter::CounterType mMembershipChangedCounter;
+  mutable santiago::MetricsCenter::CounterType mMembershipChangeFailedCounter;
   /// metrics end
 };
 
@@ -94,6 +94,6 @@ void CtrlState::recoverForEAL(std::string_view str) {
       SPDLOG_INFO("stopped start raft");
     }
   }
-  getGauge("epoch_gauge", {}).set(mEpoch);
+  getGauge("epoch_gauge", {}).set(mEpoch);  /// metric-lookup: on ctrl events only
 }
 }  // namespace gringofts::app::ctrl
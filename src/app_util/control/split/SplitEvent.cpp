@@ -44,7 +44,7 @@ void SplitEvent::apply(CtrlState *state) const {
     state->setEpoch(mRequest.epoch());
     state->setPlanId(mRequest.planid());
     SPDLOG_INFO("after apply split event state is \n {}", state->prettyPrint());
-    getGauge("epoch_gauge", {}).set(mRequest.epoch());
+    getGauge("epoch_gauge", {}).set(mRequest.epoch());  /// metric-lookup: on split only
   } else {
     SPDLOG_INFO("NO Impact");
   }
@@ -18,6 +18,7 @@ limitations under the License.
 #include "../Decodable.h"
 #include "../Encodable.h"
 #include "../grpc/RequestHandle.h"
+#include "../monitor/CommandTracer.h"
 #include "../util/MetricReporter.h"
 #include "../util/TimeUtil.h"
 #include "CommandMetaData.h"
@@ -56,20 +57,38 @@ class Command : public Encodable, Decodable {
   void setRequestHandle(RequestHandle *requestHandle) {
     mMetaData.setRequestHandle(requestHandle);
   }
-  virtual void reportMetrics() const {
+  /// sampled trace, its id is persisted as the tracking context
+  void setTrace(CommandTracePtr trace) {
+    if (trace) {
+      setTrackingContext(trace->toTrackingContext());
+    }
+    mTrace = std::move(trace);
+  }
+  /// stamp the trace, if this command is sampled
+  void stampTrace(TraceStage stage) const {
+    if (mTrace) {
+      mTrace->stamp(stage);
+    }
+  }
+  /// observed for every command, \p reportLog logs the latencies as well, e.g., for an outlier
+  virtual void reportMetrics(bool reportLog = false) const {
+    static auto queueLatency = gringofts::getHistogram("queue_latency_in_ms", {});
+    static auto becomeLeaderLatency = gringofts::getHistogram("becomeLeader_latency_in_ms", {});
+    static auto processLatency = gringofts::getHistogram("process_latency_in_ms", {});
+
     /// Created->Process->LeaderReady(optional)->Finish
-    gringofts::MetricReporter::reportLatency("queue_latency_in_ms",
-        mMetaData.getCreatedTimeInNanos(), mMetaData.getProcessTimeInNanos(), false, true, true);
-    gringofts::MetricReporter::reportLatency("becomeLeader_latency_in_ms",
-        mMetaData.getProcessTimeInNanos(), mMetaData.getLeaderReadyTimeInNanos(), false, true, true);
+    gringofts::MetricReporter::reportLatency(queueLatency, "queue_latency_in_ms",
+        mMetaData.getCreatedTimeInNanos(), mMetaData.getProcessTimeInNanos(), reportLog);
     if (mMetaData.getLeaderReadyTimeInNanos() == 0) {
       /// no leader election
-      gringofts::MetricReporter::reportLatency("process_latency_in_ms",
-          mMetaData.getProcessTimeInNanos(), mMetaData.getFinishTimeInNanos(), false, true, true);
+      gringofts::MetricReporter::reportLatency(processLatency, "process_latency_in_ms",
+          mMetaData.getProcessTimeInNanos(), mMetaData.getFinishTimeInNanos(), reportLog);
     } else {
       /// has leader election
-      gringofts::MetricReporter::reportLatency("process_latency_in_ms",
-          mMetaData.getLeaderReadyTimeInNanos(), mMetaData.getFinishTimeInNanos(), false, true, true);
+      gringofts::MetricReporter::reportLatency(becomeLeaderLatency, "becomeLeader_latency_in_ms",
+          mMetaData.getProcessTimeInNanos(), mMetaData.getLeaderReadyTimeInNanos(), reportLog);
+      gringofts::MetricReporter::reportLatency(processLatency, "process_latency_in_ms",
+          mMetaData.getLeaderReadyTimeInNanos(), mMetaData.getFinishTimeInNanos(), reportLog);
     }
   }
 
@@ -94,6 +113,7 @@ class Command : public Encodable, Decodable {
   uint64_t getGroupVersion() const { return mMetaData.getGroupVersion(); }
   std::string getTrackingContext() const { return mMetaData.getTrackingContext(); }
   RequestHandle *getRequestHandle() const { return mMetaData.getRequestHandle(); }
+  const CommandTracePtr &getTrace() const { return mTrace; }
   const CommandMetaData &getMetaData() const { return mMetaData; }
 
   static constexpr char kVerifiedSuccess[] = "Success";
@@ -146,6 +166,9 @@ class Command : public Encodable, Decodable {
    * Holds all the meta data-related info. MetaData can be changed after command is created.
    */
   CommandMetaData mMetaData;
+
+  /// not persisted, only lives on the node that received the request
+  CommandTracePtr mTrace;
 };
 
 }  /// namespace gringofts
@@ -23,6 +23,8 @@ limitations under the License.
 
 namespace gringofts {
 
+class Command;
+
 /**
  * A tag interface representing any immutable events as the result of
  * the execution of #gringofts::Command
@@ -82,6 +84,16 @@ class Event : public Encodable, Decodable {
     return encodeToString() == another.encodeToString();
   }
 
+  /**
+   * Events encoded in compact form omit the fields they share with the command
+   * that produced them. Called right after decoding with that command so that
+   * those fields can be restored. No-op by default.
+   */
+  virtual void restoreFromCommand(const Command &command) {}
+
+  /// true if the event is decoded from compact form and waits for #restoreFromCommand
+  virtual bool needsCommandToRestore() const { return false; }
+
  protected:
   /**
    * Holds all the meta data-related info. MetaData can be changed after event is created.
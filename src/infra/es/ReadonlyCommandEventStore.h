@@ -106,7 +106,7 @@ class ReadonlyCommandEventStore {
    * @return an optional to a pair of command and events. The optional will be *nullopt*
    * if no command and events are available.
    */
-  using CommandEvents = std::pair<std::unique_ptr<Command>, std::list<std::unique_ptr<Event>>>;
+  using CommandEvents = std::pair<std::unique_ptr<Command>, std::vector<std::unique_ptr<Event>>>;
   using CommandEventsOpt = std::optional<CommandEvents>;
   using CommandEventsList = std::list<CommandEvents>;
 
@@ -15,6 +15,10 @@ limitations under the License.
 #ifndef SRC_INFRA_ES_STORE_COMMANDEVENTDECODEWRAPPER_H_
 #define SRC_INFRA_ES_STORE_COMMANDEVENTDECODEWRAPPER_H_
 
+#include <functional>
+
+#include <spdlog/spdlog.h>
+
 #include "../CommandDecoder.h"
 #include "../EventDecoder.h"
 #include "generated/store.pb.h"
@@ -24,9 +28,15 @@ namespace gringofts {
 /**
  * This class wraps the decoding process for CommandEntry->Command, and EventEntry->Event.
  * It will be used in both raft-backed store and snapshot.
+ *
+ * Events in compact form omit the fields they share with their originating command,
+ * they are restored here so that every reader gets complete events.
  */
 class CommandEventDecodeWrapper {
  public:
+  /// originating command of a compact event by command id, nullptr if not found
+  using CommandLoader = std::function<const Command *(Id)>;
+
   static std::unique_ptr<Command> decodeCommand(const es::CommandEntry &commandEntry,
                                                 const CommandDecoder &commandDecoder) {
     return commandDecoder.decodeCommandFromString(CommandMetaData{commandEntry},
@@ -35,8 +45,35 @@ class CommandEventDecodeWrapper {
 
   static std::unique_ptr<Event> decodeEvent(const es::EventEntry &eventEntry,
                                             const EventDecoder &eventDecoder) {
-    return eventDecoder.decodeEventFromString(EventMetaData{eventEntry},
-                                              std::string_view{eventEntry.entry()});
+    return decodeEvent(EventMetaData{eventEntry}, std::string_view{eventEntry.entry()}, eventDecoder, nullptr);
+  }
+
+  /// decode an event persisted in the same payload as its originating command
+  static std::unique_ptr<Event> decodeEvent(const es::EventEntry &eventEntry,
+                                            const EventDecoder &eventDecoder,
+                                            const Command &command) {
+    return decodeEvent(EventMetaData{eventEntry}, std::string_view{eventEntry.entry()}, eventDecoder,
+                       [&command](Id) { return &command; });
+  }
+
+  /// for stores keeping commands and events apart, loadCommand is only called for compact events
+  static std::unique_ptr<Event> decodeEvent(const EventMetaData &metaData,
+                                            std::string_view payload,
+                                            const EventDecoder &eventDecoder,
+                                            const CommandLoader &loadCommand) {
+    auto event = eventDecoder.decodeEventFromString(metaData, payload);
+    if (event == nullptr || !event->needsCommandToRestore()) {
+      return event;
+    }
+
+    const Command *command = loadCommand ? loadCommand(event->getCommandId()) : nullptr;
+    if (command == nullptr) {
+      SPDLOG_ERROR("Cannot restore compact event {} without its command {}, exiting now",
+                   event->getId(), event->getCommandId());
+      exit(1);
+    }
+    event->restoreFromCommand(*command);
+    return event;
   }
 };
 
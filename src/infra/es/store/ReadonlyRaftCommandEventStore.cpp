@@ -14,6 +14,10 @@ limitations under the License.
 
 #include "ReadonlyRaftCommandEventStore.h"
 
+#include <google/protobuf/arena.h>
+
+#include "../../util/LogUtil.h"
+#include "../../util/ThreadPlacement.h"
 #include "store.grpc.pb.h"
 #include "CommandEventDecodeWrapper.h"
 
@@ -34,7 +38,8 @@ ReadonlyRaftCommandEventStore::ReadonlyRaftCommandEventStore(const std::shared_p
     mCommandDecoder(commandDecoder),
     mEventDecoder(eventDecoder),
     mCrypto(crypto),
-    mAsyncLoad(asyncLoad) {
+    mAsyncLoad(asyncLoad),
+    mArenaAllocatedBytesCounter(getCounter("arena_allocated_bytes_counter", {{"stage", "event_decode"}})) {
   SPDLOG_INFO("ReadOnly mode: {}", mAsyncLoad ? "Async Load" : "Sync Load");
 }
 
@@ -49,7 +54,7 @@ void ReadonlyRaftCommandEventStore::init() {
   mLoadThread = std::thread(&ReadonlyRaftCommandEventStore::loadEntriesThreadMain, this);
 
   for (std::size_t i = 0; i < kDecryptConcurrency; ++i) {
-    mDecryptThreads.emplace_back(&ReadonlyRaftCommandEventStore::decryptEntriesThreadMain, this);
+    mDecryptThreads.emplace_back(&ReadonlyRaftCommandEventStore::decryptEntriesThreadMain, this, i);
   }
 
   uint64_t ts2InNano = TimeUtil::currentTimeInNanos();
@@ -101,8 +106,9 @@ ReadonlyRaftCommandEventStore::loadNextEvent(const EventDecoder &/*ignored*/) {
   CommandEvents &bundle = mCachedBundles.front();
   auto &events = bundle.second;
   assert(!events.empty());
+  /// a command has only a few events, erasing the front is cheap
   auto event = std::move(events.front());
-  events.pop_front();
+  events.erase(events.begin());
   if (events.empty()) {
     mCachedBundles.pop_front();
   }
@@ -113,7 +119,10 @@ ReadonlyRaftCommandEventStore::loadNextEvent(const EventDecoder &/*ignored*/) {
 ReadonlyRaftCommandEventStore::CommandEventsOpt
 ReadonlyRaftCommandEventStore::loadNextCommandEvents(const CommandDecoder &, const EventDecoder &) {
   /// update applied
-  mAppliedIndex = std::max(mAppliedIndex.load(), mApplyingIndex);
+  if (mApplyingIndex > mAppliedIndex) {
+    mAppliedIndex = mApplyingIndex;
+    notifyProgress();
+  }
 
   if (mCachedBundles.empty()) {
     tryLoadBundles();
@@ -163,11 +172,11 @@ uint64_t ReadonlyRaftCommandEventStore::loadBundles(uint64_t startIndex, uint64_
   decryptEntries(&entries, bundles);
 
   uint64_t ts3InNano = TimeUtil::currentTimeInNanos();
-  SPDLOG_INFO("CommandEventStore Load {} Entry, totalCost={}ms, storageCost={}ms, decodeCost={}ms",
-              size,
-              (ts3InNano - ts1InNano) / 1000000.0,
-              (ts2InNano - ts1InNano) / 1000000.0,
-              (ts3InNano - ts2InNano) / 1000000.0);
+  SPDLOG_INFO_EVERY_MS(1000, "CommandEventStore Load {} Entry, totalCost={}ms, storageCost={}ms, decodeCost={}ms",
+                       size,
+                       (ts3InNano - ts1InNano) / 1000000.0,
+                       (ts2InNano - ts1InNano) / 1000000.0,
+                       (ts3InNano - ts2InNano) / 1000000.0);
   return size;
 }
 
@@ -176,12 +185,25 @@ uint64_t ReadonlyRaftCommandEventStore::waitTillLeaderIsReadyOrStepDown(uint64_t
               "The hint noop is <index,term>=<{},{}>",
               expectedTerm, mRaftImpl->getLastLogIndex(), expectedTerm);
 
+  /// entries between [appliedIndex + 1, verifiedIndex] are known to be no-ops.
+  /// they are committed, so will never change.
+  uint64_t verifiedIndex = 0;
+  uint64_t verifiedTerm = 0;
+  /// a non-noop entry which should be applied before leader is ready
+  uint64_t pendingIndex = 0;
+  uint64_t checkTimes = 0;
+
+  ++mWaiterNum;
   while (1) {
+    ++checkTimes;
+    uint64_t progressSeq = mProgressSeq;
+
     /// step 1
     auto currentTerm = mRaftImpl->getCurrentTerm();
     if (currentTerm != expectedTerm) {
       SPDLOG_WARN("Leader Step Down, since currentTerm {} != expectedTerm {}",
                   currentTerm, expectedTerm);
+      --mWaiterNum;
       return 0;
     }
 
@@ -191,25 +213,56 @@ uint64_t ReadonlyRaftCommandEventStore::waitTillLeaderIsReadyOrStepDown(uint64_t
     uint64_t loadedIndex = mLoadedIndex;
     uint64_t appliedIndex = mAppliedIndex;
 
-    if (loadedIndex != commitIndex || commitIndex != lastIndex) {
-      continue;
-    }
+    if (loadedIndex == commitIndex && commitIndex == lastIndex && appliedIndex >= pendingIndex) {
+      /// step 3 and step 4, resume from where last round stopped
+      for (auto index = std::max(appliedIndex, verifiedIndex) + 1; index <= lastIndex; ++index) {
+        raft::LogEntry entry;
+        assert(mRaftImpl->getEntry(index, &entry));
 
-    /// step 3 and step 4
-    for (auto index = appliedIndex + 1; index <= lastIndex; ++index) {
-      raft::LogEntry entry;
-      assert(mRaftImpl->getEntry(index, &entry));
+        if (!entry.noop()) {
+          pendingIndex = index;
+          break;
+        }
 
-      if (!entry.noop()) {
-        break;
+        verifiedIndex = index;
+        verifiedTerm = entry.term();
       }
 
-      if (index == lastIndex && entry.term() == expectedTerm) {
-        SPDLOG_INFO("Leader Is Ready for expected <index,term>=<{},{}>, appliedIndex={}",
-                    lastIndex, expectedTerm, appliedIndex);
+      if (verifiedIndex == lastIndex && verifiedTerm == expectedTerm && appliedIndex >= pendingIndex) {
+        SPDLOG_INFO("Leader Is Ready for expected <index,term>=<{},{}>, appliedIndex={}, checkTimes={}",
+                    lastIndex, expectedTerm, appliedIndex, checkTimes);
+        --mWaiterNum;
         return lastIndex;
       }
     }
+
+    /// wait for loadedIndex or appliedIndex to advance
+    std::unique_lock<std::mutex> lock(mProgressMutex);
+    mProgressCond.wait_for(lock, std::chrono::milliseconds(kReadyCheckIntervalInMillis),
+                           [this, progressSeq]() { return mProgressSeq != progressSeq; });
+  }
+}
+
+void ReadonlyRaftCommandEventStore::notifyProgress() {
+  ++mProgressSeq;
+  if (mWaiterNum == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mProgressMutex);
+  }
+  mProgressCond.notify_all();
+}
+
+void ReadonlyRaftCommandEventStore::notifyTermChange() {
+  if (mWaiterNum == 0) {
+    return;
+  }
+  auto currentTerm = mRaftImpl->getCurrentTerm();
+  if (currentTerm != mNotifiedTerm) {
+    mNotifiedTerm = currentTerm;
+    notifyProgress();
   }
 }
 
@@ -219,6 +272,7 @@ bool ReadonlyRaftCommandEventStore::isLeader() const {
 
 void ReadonlyRaftCommandEventStore::loadEntriesThreadMain() {
   pthread_setname_np(pthread_self(), "CES_Load");
+  ThreadPlacement::getInstance().place("CES_Load");
   while (mRunning) {
     uint64_t queueSize = 0;
 
@@ -236,6 +290,7 @@ void ReadonlyRaftCommandEventStore::loadEntriesThreadMain() {
     uint64_t commitIndex = mRaftImpl->getCommitIndex();
 
     if (mLoadedIndex >= commitIndex) {
+      notifyTermChange();
       usleep(1000);   /// 1ms
       continue;
     }
@@ -247,10 +302,11 @@ void ReadonlyRaftCommandEventStore::loadEntriesThreadMain() {
                                           commitIndex - mLoadedIndex, &taskPtr->entries);
 
     uint64_t ts2InNano = TimeUtil::currentTimeInNanos();
-    SPDLOG_INFO("Load a Task, queueSize={}, entryNum={}, storageCost={}ms",
-                queueSize, size, (ts2InNano - ts1InNano) / 1000000.0);
+    SPDLOG_INFO_EVERY_MS(1000, "Load a Task, queueSize={}, entryNum={}, storageCost={}ms",
+                         queueSize, size, (ts2InNano - ts1InNano) / 1000000.0);
 
     mLoadedIndex += size;
+    notifyProgress();
 
     {
       /// WRITE LOCK
@@ -262,6 +318,9 @@ void ReadonlyRaftCommandEventStore::loadEntriesThreadMain() {
 
 void ReadonlyRaftCommandEventStore::decryptEntries(std::vector<raft::LogEntry> *entries,
                                                    std::list<CommandEvents> *bundles) {
+  /// payloads only live until their command and events are decoded
+  google::protobuf::Arena arena;
+
   for (auto &entry : *entries) {
     if (entry.noop()) {
       continue;
@@ -279,7 +338,7 @@ void ReadonlyRaftCommandEventStore::decryptEntries(std::vector<raft::LogEntry> *
       }
     }
 
-    RaftPayload payload;
+    auto &payload = *google::protobuf::Arena::CreateMessage<RaftPayload>(&arena);
     assert(payload.ParseFromString(entry.payload()));
 
     if (payload.events_size() == 0) {
@@ -288,19 +347,25 @@ void ReadonlyRaftCommandEventStore::decryptEntries(std::vector<raft::LogEntry> *
     }
 
     std::unique_ptr<Command> command;
-    std::list<std::unique_ptr<Event>> events;
+    std::vector<std::unique_ptr<Event>> events;
+    events.reserve(payload.events_size());
 
     command = CommandEventDecodeWrapper::decodeCommand(payload.command(), *mCommandDecoder);
+    assert(command != nullptr);
     for (const auto &event : payload.events()) {
-      events.push_back(CommandEventDecodeWrapper::decodeEvent(event, *mEventDecoder));
+      events.push_back(CommandEventDecodeWrapper::decodeEvent(event, *mEventDecoder, *command));
     }
 
     bundles->push_back(std::make_pair(std::move(command), std::move(events)));
   }
+
+  mArenaAllocatedBytesCounter.increase(arena.SpaceUsed());
 }
 
-void ReadonlyRaftCommandEventStore::decryptEntriesThreadMain() {
-  pthread_setname_np(pthread_self(), "CES_Decrypt");
+void ReadonlyRaftCommandEventStore::decryptEntriesThreadMain(uint64_t threadIndex) {
+  auto threadName = std::string("CES_Decrypt_") + std::to_string(threadIndex);
+  pthread_setname_np(pthread_self(), threadName.c_str());
+  ThreadPlacement::getInstance().place(threadName);
 
   while (mRunning) {
     TaskPtr taskPtr;
@@ -327,8 +392,8 @@ void ReadonlyRaftCommandEventStore::decryptEntriesThreadMain() {
     decryptEntries(&taskPtr->entries, &taskPtr->bundles);
 
     uint64_t ts2InNano = TimeUtil::currentTimeInNanos();
-    SPDLOG_INFO("Decrypt a Task, entryNum={}, decryptCost={}ms",
-                taskPtr->entries.size(), (ts2InNano - ts1InNano) / 1000000.0);
+    SPDLOG_INFO_EVERY_MS(1000, "Decrypt a Task, entryNum={}, decryptCost={}ms",
+                         taskPtr->entries.size(), (ts2InNano - ts1InNano) / 1000000.0);
 
     taskPtr->flag = 2;
   }
@@ -343,6 +408,7 @@ void ReadonlyRaftCommandEventStore::trySyncLoadBundles() {
   /// mLoadedIndex is a persisted variable set by setCurrentOffset(),
   /// it may be legitimately greater than commitIndex.
   if (mLoadedIndex >= commitIndex) {
+    notifyTermChange();
     if (mSpinTimes >= kSpinLimit) {
       usleep(1000);  /// 1ms
       mSpinTimes = 0;
@@ -356,6 +422,7 @@ void ReadonlyRaftCommandEventStore::trySyncLoadBundles() {
   uint64_t size = loadBundles(mLoadedIndex + 1,
                               commitIndex - mLoadedIndex, &bundles);
   mLoadedIndex += size;
+  notifyProgress();
   mCachedBundles.swap(bundles);
 }
 
@@ -396,8 +463,8 @@ void ReadonlyRaftCommandEventStore::tryAsyncLoadBundles() {
 
   mCachedBundles.swap(taskPtr->bundles);
 
-  SPDLOG_INFO("Apply a Task, queueSize={}, entryNum={}",
-              queueSize, taskPtr->entries.size());
+  SPDLOG_INFO_EVERY_MS(1000, "Apply a Task, queueSize={}, entryNum={}",
+                       queueSize, taskPtr->entries.size());
 }
 
 }  /// namespace gringofts
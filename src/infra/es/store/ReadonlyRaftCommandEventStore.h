@@ -16,8 +16,10 @@ limitations under the License.
 #define SRC_INFRA_ES_STORE_READONLYRAFTCOMMANDEVENTSTORE_H_
 
 #include <atomic>
+#include <condition_variable>
 #include <shared_mutex>
 
+#include "../../monitor/MonitorTypes.h"
 #include "../../raft/RaftInterface.h"
 #include "../../util/CryptoUtil.h"
 #include "../ReadonlyCommandEventStore.h"
@@ -62,6 +64,10 @@ class ReadonlyRaftCommandEventStore final : public ReadonlyCommandEventStore {
    * 2) loadedIndex == commitIndex == lastIndex
    * 3) entry between [appliedIndex + 1, lastIndex - 1] are all no-ops
    * 4) entry at lastIndex is no-op, its logTerm is expectedTerm.
+   *
+   * Instead of spinning, it sleeps until loadedIndex or appliedIndex advances,
+   * and re-checks at least every kReadyCheckIntervalInMillis to detect step down.
+   * Entries already verified as no-ops are not read again.
    */
   uint64_t waitTillLeaderIsReadyOrStepDown(uint64_t expectedTerm) const override;
   bool isLeader() const override;
@@ -113,7 +119,7 @@ class ReadonlyRaftCommandEventStore final : public ReadonlyCommandEventStore {
   void loadEntriesThreadMain();
 
   /// thread function for mDecryptThreads
-  void decryptEntriesThreadMain();
+  void decryptEntriesThreadMain(uint64_t threadIndex);
 
   /// sync load, update mLoadedIndex and mCachedBundles if needed.
   void trySyncLoadBundles();
@@ -121,6 +127,11 @@ class ReadonlyRaftCommandEventStore final : public ReadonlyCommandEventStore {
   /// async load, try to pop one bundles from mTaskQueue to mCachedBundles.
   void tryAsyncLoadBundles();
 
+  /// wake up waitTillLeaderIsReadyOrStepDown() after mLoadedIndex or mAppliedIndex advances
+  void notifyProgress();
+  /// also wake it up on term change, checked by whichever thread loads while it is idle
+  void notifyTermChange();
+
   void tryLoadBundles() {
     if (mAsyncLoad) {
       tryAsyncLoadBundles();
@@ -147,6 +158,23 @@ class ReadonlyRaftCommandEventStore final : public ReadonlyCommandEventStore {
   std::shared_ptr<EventDecoder> mEventDecoder;
   std::shared_ptr<CryptoUtil> mCrypto;
 
+  /// bytes of RaftPayloads decoded on per-batch arenas
+  santiago::MetricsCenter::CounterType mArenaAllocatedBytesCounter;
+
+  /**
+   * notification for waitTillLeaderIsReadyOrStepDown()
+   */
+  /// bumped whenever mLoadedIndex or mAppliedIndex advances
+  std::atomic<uint64_t> mProgressSeq = 0;
+  /// num of threads waiting in waitTillLeaderIsReadyOrStepDown(), skip notify if 0
+  mutable std::atomic<uint64_t> mWaiterNum = 0;
+  mutable std::mutex mProgressMutex;
+  mutable std::condition_variable mProgressCond;
+  /// term last seen by notifyTermChange(), only touched by the loading thread
+  uint64_t mNotifiedTerm = 0;
+  /// fallback only, waiter is woken up by notifyProgress() or notifyTermChange()
+  const uint64_t kReadyCheckIntervalInMillis = 1000;
+
   /**
    * optimize for sync load
    */
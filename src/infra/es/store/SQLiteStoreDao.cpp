@@ -19,10 +19,12 @@ limitations under the License.
 #include <spdlog/spdlog.h>
 
 #include "../../util/FileUtil.h"
+#include "CommandEventDecodeWrapper.h"
 
 namespace gringofts {
 
-SQLiteStoreDao::SQLiteStoreDao(const char *pathToDbFile) {
+SQLiteStoreDao::SQLiteStoreDao(const char *pathToDbFile,
+                               std::shared_ptr<CommandDecoder> commandDecoder) : mCommandDecoder(commandDecoder) {
   if (!FileUtil::fileExists(pathToDbFile)) throw std::runtime_error("Unable to open file");
   sqlite3_open(pathToDbFile, &mDb);
   sqlite3_prepare_v2(
@@ -39,6 +41,13 @@ SQLiteStoreDao::SQLiteStoreDao(const char *pathToDbFile) {
       -1,
       &mSelectNextCommandStmt,
       NULL);
+  sqlite3_prepare_v2(
+      mDb,
+      "SELECT ID, TYPE, CREATEDTIME, CREATORID, GROUPID, GROUPVERSION, PAYLOAD FROM COMMAND "
+      "WHERE ID=?1;",
+      -1,
+      &mSelectCommandByIdStmt,
+      NULL);
   sqlite3_prepare_v2(
       mDb,
       "INSERT INTO EVENT (ID, TYPE, COMMANDID, CREATEDTIME, CREATORID, GROUPID, GROUPVERSION, PAYLOAD) "
@@ -169,10 +178,10 @@ std::unique_ptr<Command> SQLiteStoreDao::findNextCommand(
   }
 }
 
-std::list<std::unique_ptr<Event>> SQLiteStoreDao::getEventsByCommandId(
+std::vector<std::unique_ptr<Event>> SQLiteStoreDao::getEventsByCommandId(
     const gringofts::Id &id,
     const gringofts::EventDecoder &eventDecoder) const {
-  std::list<std::unique_ptr<Event>> events;
+  std::vector<std::unique_ptr<Event>> events;
   if (id >= 0) {
     sqlite3_reset(mSelectEventsByCommandIdStmt);
     sqlite3_bind_int64(mSelectEventsByCommandIdStmt, 1, id);
@@ -213,7 +222,27 @@ std::unique_ptr<Event> SQLiteStoreDao::populateEvent(sqlite3_stmt *selectEventSt
   metaData.setCreatorId(creatorId);
   metaData.setGroupId(groupId);
   metaData.setGroupVersion(groupVersion);
-  return eventDecoder.decodeEventFromString(metaData, std::string(payload).c_str());
+  /// compact events are restored from their commands, which are decoded on demand
+  std::unique_ptr<Command> command;
+  return CommandEventDecodeWrapper::decodeEvent(metaData, std::string(payload).c_str(), eventDecoder,
+                                                [this, &command](Id commandId) {
+                                                  command = findCommandById(commandId);
+                                                  return command.get();
+                                                });
+}
+
+std::unique_ptr<Command> SQLiteStoreDao::findCommandById(const Id &id) const {
+  if (mCommandDecoder == nullptr) {
+    return nullptr;
+  }
+  sqlite3_reset(mSelectCommandByIdStmt);
+  sqlite3_bind_int64(mSelectCommandByIdStmt, 1, id);
+  int rc = sqlite3_step(mSelectCommandByIdStmt);
+  if (rc != SQLITE_ROW) {
+    handleResultCode(rc, nullptr);
+    return nullptr;
+  }
+  return populateCommand(mSelectCommandByIdStmt, *mCommandDecoder);
 }
 
 std::unique_ptr<Command> SQLiteStoreDao::populateCommand(sqlite3_stmt *selectCommandStmt,
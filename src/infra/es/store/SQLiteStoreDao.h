@@ -30,7 +30,11 @@ namespace gringofts {
  */
 class SQLiteStoreDao {
  public:
-  explicit SQLiteStoreDao(const char *);
+  /**
+   * @param commandDecoder decodes the originating commands of compact events,
+   *                       only needed if events may be persisted in compact form
+   */
+  explicit SQLiteStoreDao(const char *, std::shared_ptr<CommandDecoder> commandDecoder = nullptr);
   ~SQLiteStoreDao();
 
   // disallow copy ctor and copy assignment
@@ -55,15 +59,19 @@ class SQLiteStoreDao {
 
   std::unique_ptr<Command> findNextCommand(const Id &, const CommandDecoder &) const;
 
-  std::list<std::unique_ptr<Event>> getEventsByCommandId(const Id &, const EventDecoder &) const;
+  std::vector<std::unique_ptr<Event>> getEventsByCommandId(const Id &, const EventDecoder &) const;
 
  private:
   std::unique_ptr<Command> populateCommand(sqlite3_stmt *, const CommandDecoder &) const;
   std::unique_ptr<Event> populateEvent(sqlite3_stmt *, const EventDecoder &) const;
+  std::unique_ptr<Command> findCommandById(const Id &) const;
+
+  std::shared_ptr<CommandDecoder> mCommandDecoder;
 
   sqlite3 *mDb;
   sqlite3_stmt *mInsertCommandStmt;
   sqlite3_stmt *mSelectNextCommandStmt;
+  sqlite3_stmt *mSelectCommandByIdStmt;
   sqlite3_stmt *mInsertEventStmt;
   sqlite3_stmt *mSelectNextEventStmt;
   sqlite3_stmt *mSelectEventsByCommandIdStmt;
@@ -16,6 +16,7 @@ limitations under the License.
 #define SRC_INFRA_ES_STORE_SNAPSHOTUTIL_H_
 
 #include <optional>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -32,6 +33,7 @@ class SnapshotUtil {
  public:
   static constexpr auto &kSnapshotSuffix = ".snapshot";
   static constexpr auto &kSnapshotSuffixRegex = ".snapshot$";
+  static constexpr std::size_t kSnapshotReadBufferSize = 4 << 20;  /// 4MB
 
   /**
    * Take the snapshot of the state machine and persist it to local disk
@@ -100,7 +102,12 @@ class SnapshotUtil {
 
     const auto &snapshotFilePath = snapshotDir + "/" + snapshotFileOpt.value();
     SPDLOG_INFO("Loading snapshot file {}", snapshotFilePath);
-    std::ifstream ifile{snapshotFilePath, std::ios::binary};
+    /// a large stream buffer turns the many small reads issued while decoding into few sequential ones,
+    /// it must be installed before the file is opened to take effect.
+    std::vector<char> readBuffer(kSnapshotReadBufferSize);
+    std::ifstream ifile;
+    ifile.rdbuf()->pubsetbuf(readBuffer.data(), readBuffer.size());
+    ifile.open(snapshotFilePath, std::ios::binary);
     if (!ifile) {
       SPDLOG_WARN("Failed to open a snapshot file {} due to errno: {}", snapshotFilePath, errno);
       return std::nullopt;
@@ -0,0 +1,135 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "AdmissionController.h"
+
+#include <spdlog/spdlog.h>
+
+#include "../util/StrUtil.h"
+
+namespace gringofts {
+
+AdmissionController &AdmissionController::getInstance() {
+  static AdmissionController instance;
+  return instance;
+}
+
+AdmissionController::AdmissionController()
+    : mInflightGauge(getGauge("admission_inflight_commands", {})),
+      mProjectedWaitGauge(getGauge("admission_projected_queue_wait_in_ms", {})) {
+  /// one per shed reason, Admitted excluded
+  for (uint32_t i = 1; i < static_cast<uint32_t>(Verdict::Count); ++i) {
+    auto reason = reasonOf(static_cast<Verdict>(i));
+    mShedCounters.push_back(getCounter("shed_request_total", {{"reason", reason}}));  /// metric-lookup: in ctor
+  }
+}
+
+void AdmissionController::init(const INIReader &reader) {
+  mEnabled = reader.GetBoolean("admission", "enable", false);
+  mMaxQueueDepth = reader.GetInteger("admission", "max.queue.depth", 0);
+  mQueueWaitBudgetInNanos = reader.GetInteger("admission", "queue.wait.budget.in.ms", 0) * 1000 * 1000;
+  mMaxInflight = reader.GetInteger("admission", "max.inflight", 0);
+  mServiceTimeEwmaInNanos = 0;
+  mDefaultTenantQuota = std::make_unique<TenantQuota>(
+      reader.GetInteger("admission", "tenant.default.max.inflight", 0));
+
+  /// tenant1:quota1,tenant2:quota2
+  mTenantQuotas.clear();
+  for (const auto &item : StrUtil::tokenize(reader.Get("admission", "tenant.max.inflight", ""), ',')) {
+    auto parts = StrUtil::tokenize(item, ':');
+    if (parts.size() != 2) {
+      SPDLOG_ERROR("invalid tenant.max.inflight item {}, should be tenant:quota, exiting", item);
+      exit(1);
+    }
+    mTenantQuotas[parts[0]] = std::make_unique<TenantQuota>(std::stoull(parts[1]));
+  }
+
+  SPDLOG_INFO("admission control enabled={}, max.queue.depth={}, queue.wait.budget={}ms, "
+              "max.inflight={}, tenant.default.max.inflight={}, {} tenant quotas",
+              mEnabled, mMaxQueueDepth, mQueueWaitBudgetInNanos / 1000 / 1000,
+              mMaxInflight, mDefaultTenantQuota->mMaxInflight, mTenantQuotas.size());
+}
+
+namespace {
+/// takes weight from counter unless it goes beyond max, 0 means unlimited
+bool tryAcquire(std::atomic<uint64_t> *counter, uint64_t max, uint64_t weight) {
+  auto prev = counter->fetch_add(weight, std::memory_order_relaxed);
+  if (max > 0 && prev + weight > max) {
+    counter->fetch_sub(weight, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+}  /// namespace
+
+AdmissionController::Verdict AdmissionController::tryAdmit(const std::string &tenant,
+                                                           uint64_t weight,
+                                                           uint64_t queueDepth,
+                                                           TenantQuota **quota) {
+  auto projectedWait = projectedWaitInNanos(queueDepth);
+  mProjectedWaitGauge.set(projectedWait / 1000000.0);
+
+  auto iter = mTenantQuotas.find(tenant);
+  auto *tenantQuota = iter != mTenantQuotas.end() ? iter->second.get() : mDefaultTenantQuota.get();
+
+  auto verdict = Verdict::Admitted;
+  if (mMaxQueueDepth > 0 && queueDepth + weight > mMaxQueueDepth) {
+    verdict = Verdict::QueueDepth;
+  } else if (mQueueWaitBudgetInNanos > 0 && projectedWait > mQueueWaitBudgetInNanos) {
+    verdict = Verdict::QueueWait;
+  } else if (!tryAcquire(&mInflight, mMaxInflight, weight)) {
+    verdict = Verdict::Inflight;
+  } else if (!tryAcquire(&tenantQuota->mInflight, tenantQuota->mMaxInflight, weight)) {
+    mInflight.fetch_sub(weight, std::memory_order_relaxed);
+    verdict = Verdict::TenantQuota;
+  }
+
+  if (verdict != Verdict::Admitted) {
+    mShedCounters[static_cast<uint32_t>(verdict) - 1].increase(weight);
+    return verdict;
+  }
+
+  mInflightGauge.set(mInflight.load(std::memory_order_relaxed));
+  *quota = tenantQuota;
+  return verdict;
+}
+
+void AdmissionController::release(TenantQuota *quota, uint64_t weight) {
+  quota->mInflight.fetch_sub(weight, std::memory_order_relaxed);
+  auto inflight = mInflight.fetch_sub(weight, std::memory_order_relaxed) - weight;
+  mInflightGauge.set(inflight);
+}
+
+void AdmissionController::observeServiceTime(uint64_t timeInNanos) {
+  auto ewma = mServiceTimeEwmaInNanos.load(std::memory_order_relaxed);
+  ewma = ewma == 0 ? timeInNanos : ewma - ewma / 8 + timeInNanos / 8;
+  mServiceTimeEwmaInNanos.store(ewma, std::memory_order_relaxed);
+}
+
+uint64_t AdmissionController::projectedWaitInNanos(uint64_t queueDepth) const {
+  return queueDepth * mServiceTimeEwmaInNanos.load(std::memory_order_relaxed);
+}
+
+const char *AdmissionController::reasonOf(Verdict verdict) {
+  switch (verdict) {
+    case Verdict::Admitted: return "admitted";
+    case Verdict::QueueDepth: return "queue_depth";
+    case Verdict::QueueWait: return "queue_wait";
+    case Verdict::Inflight: return "inflight";
+    case Verdict::TenantQuota: return "tenant_quota";
+    default: return "unknown";
+  }
+}
+
+}  /// namespace gringofts
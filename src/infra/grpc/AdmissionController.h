@@ -0,0 +1,140 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_GRPC_ADMISSIONCONTROLLER_H_
+#define SRC_INFRA_GRPC_ADMISSIONCONTROLLER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <INIReader.h>
+
+#include "../monitor/MonitorTypes.h"
+
+namespace gringofts {
+
+/**
+ * Sheds requests before they are enqueued into the command queue, so that overload
+ * is answered with retryable codes instead of growing queues until the leader OOMs.
+ *
+ * A request is shed if
+ *   1) the command queue is deeper than max.queue.depth, or
+ *   2) the projected wait in the command queue, i.e., depth times the EWMA of CPL service time,
+ *      exceeds queue.wait.budget.in.ms, or
+ *   3) more than max.inflight commands are admitted but not replied yet, which also covers
+ *      raft falling behind, since commands are replied only after commit, or
+ *   4) its tenant, taken from the x-tenant-id header, is over its inflight quota.
+ *      Tenants not listed in tenant.max.inflight share tenant.default.max.inflight.
+ * 0 disables each check.
+ */
+class AdmissionController {
+ public:
+  enum class Verdict {
+    Admitted = 0,
+    QueueDepth,
+    QueueWait,
+    Inflight,
+    TenantQuota,
+    Count
+  };
+
+  /// inflight commands of one tenant, or of all unlisted tenants
+  struct TenantQuota {
+    explicit TenantQuota(uint64_t maxInflight) : mMaxInflight(maxInflight) {}
+
+    const uint64_t mMaxInflight;
+    std::atomic<uint64_t> mInflight = 0;
+  };
+
+  static AdmissionController &getInstance();
+
+  /// reads [admission], called once before serving requests
+  void init(const INIReader &reader);
+
+  bool isEnabled() const { return mEnabled; }
+
+  /// on Admitted, *quota is where the weight is accounted, to be given back by release
+  Verdict tryAdmit(const std::string &tenant, uint64_t weight, uint64_t queueDepth, TenantQuota **quota);
+  void release(TenantQuota *quota, uint64_t weight);
+
+  /// time CPL spent on one command, called by CPL thread only
+  void observeServiceTime(uint64_t timeInNanos);
+  uint64_t projectedWaitInNanos(uint64_t queueDepth) const;
+
+  static const char *reasonOf(Verdict verdict);
+
+ private:
+  AdmissionController();
+
+  bool mEnabled = false;
+  uint64_t mMaxQueueDepth = 0;
+  uint64_t mQueueWaitBudgetInNanos = 0;
+  uint64_t mMaxInflight = 0;
+
+  std::atomic<uint64_t> mInflight = 0;
+  /// weighs the latest sample by 1/8
+  std::atomic<uint64_t> mServiceTimeEwmaInNanos = 0;
+
+  /// never changed after init, so lookups are lock free
+  std::map<std::string, std::unique_ptr<TenantQuota>> mTenantQuotas;
+  std::unique_ptr<TenantQuota> mDefaultTenantQuota;
+
+  std::vector<santiago::MetricsCenter::CounterType> mShedCounters;
+  santiago::MetricsCenter::GaugeType mInflightGauge;
+  santiago::MetricsCenter::GaugeType mProjectedWaitGauge;
+};
+
+/**
+ * Weight admitted for a request, given back when the request is gone.
+ */
+class AdmissionTicket {
+ public:
+  AdmissionTicket() = default;
+  AdmissionTicket(AdmissionController::TenantQuota *quota, uint64_t weight)
+      : mQuota(quota), mWeight(weight), mAdmitted(true) {}
+  ~AdmissionTicket() { release(); }
+
+  AdmissionTicket(const AdmissionTicket &) = delete;
+  AdmissionTicket &operator=(const AdmissionTicket &) = delete;
+
+  AdmissionTicket(AdmissionTicket &&other) noexcept { *this = std::move(other); }
+  AdmissionTicket &operator=(AdmissionTicket &&other) noexcept {
+    if (this != &other) {
+      release();
+      mQuota = other.mQuota;
+      mWeight = other.mWeight;
+      mAdmitted = other.mAdmitted;
+      other.mAdmitted = false;
+    }
+    return *this;
+  }
+
+  void release() {
+    if (mAdmitted) {
+      AdmissionController::getInstance().release(mQuota, mWeight);
+      mAdmitted = false;
+    }
+  }
+
+ private:
+  AdmissionController::TenantQuota *mQuota = nullptr;
+  uint64_t mWeight = 0;
+  bool mAdmitted = false;
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_GRPC_ADMISSIONCONTROLLER_H_
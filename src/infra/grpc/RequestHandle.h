@@ -20,8 +20,12 @@ limitations under the License.
 #include <grpcpp/grpcpp.h>
 #include <spdlog/spdlog.h>
 
+#include "../../infra/util/HttpCode.h"
+#include "../../infra/util/LogUtil.h"
 #include "../../infra/util/TimeUtil.h"
+#include "../monitor/CommandTracer.h"
 #include "../monitor/MonitorTypes.h"
+#include "AdmissionController.h"
 
 namespace gringofts {
 
@@ -34,8 +38,31 @@ class RequestHandle {
   RequestHandle() = default;
 
   virtual ~RequestHandle() {
-    auto summary = getSummary("request_call_latency_in_ms", {});
-    summary.observe((TimeUtil::currentTimeInNanos() - mCommandCreateTime) / 1000000.0);
+    if (mCommandCreateTime == 0) {
+      /// request never received, e.g., server shutting down
+      return;
+    }
+    static auto histogram = getHistogram("request_call_latency_in_ms", {});
+    histogram.observe((TimeUtil::currentTimeInNanos() - mCommandCreateTime) / 1000000.0);
+    if (mTrace) {
+      CommandTracer::getInstance().finishTrace(mTrace);
+    }
+  }
+
+  /**
+   * Should be called once the request arrives, starts the trace if the request is sampled.
+   */
+  void onRequestReceived() {
+    mCommandCreateTime = TimeUtil::currentTimeInNanos();
+    mTrace = CommandTracer::getInstance().maybeStartTrace();
+  }
+
+  const CommandTracePtr &getTrace() const { return mTrace; }
+
+  void stampTrace(TraceStage stage) const {
+    if (mTrace) {
+      mTrace->stamp(stage);
+    }
   }
 
   /**
@@ -68,13 +95,13 @@ class RequestHandle {
     }
 
     if (isTest && !testModeEnabled) {
-      SPDLOG_WARN("Reject test request as this it only takes real traffic.");
+      SPDLOG_WARN_EVERY_MS(1000, "Reject test request as this it only takes real traffic.");
       fillResultAndReply(503, "Test request sent to non-test PU", std::nullopt);
       return false;
     }
 
     if (!isTest && testModeEnabled) {
-      SPDLOG_WARN("Reject real request as this it only takes test traffic.");
+      SPDLOG_WARN_EVERY_MS(1000, "Reject real request as this it only takes test traffic.");
       fillResultAndReply(503, "Real request sent to test PU", std::nullopt);
       return false;
     }
@@ -82,9 +109,50 @@ class RequestHandle {
     return true;
   }
 
+  /**
+   * Admission control, should be called right before enqueueing the command(s) of this request.
+   * Return true if admitted, otherwise, reply with a retryable code and return false.
+   * Weight is the number of commands, the admitted weight is given back once this handle is gone.
+   */
+  bool admit(const std::multimap<grpc::string_ref, grpc::string_ref> &metadata,
+             uint64_t queueDepth,
+             uint64_t weight = 1) {
+    auto &controller = AdmissionController::getInstance();
+    if (!controller.isEnabled()) {
+      return true;
+    }
+
+    std::string tenant;
+    auto iter = metadata.find("x-tenant-id");
+    if (iter != metadata.end()) {
+      tenant.assign((iter->second).data(), (iter->second).length());
+    }
+
+    AdmissionController::TenantQuota *quota = nullptr;
+    auto verdict = controller.tryAdmit(tenant, weight, queueDepth, &quota);
+    if (verdict == AdmissionController::Verdict::Admitted) {
+      mAdmissionTicket = AdmissionTicket(quota, weight);
+      return true;
+    }
+
+    SPDLOG_WARN_EVERY_MS(1000, "Shed request of tenant '{}' due to {}, queueDepth={}",
+                         tenant, AdmissionController::reasonOf(verdict), queueDepth);
+    /// 429 asks the tenant to slow down, 503 asks the client to retry, maybe on another node
+    auto code = verdict == AdmissionController::Verdict::TenantQuota
+        ? HttpCode::TOO_MANY_REQUESTS : HttpCode::SERVICE_UNAVAILABLE;
+    fillResultAndReply(code,
+                       std::string("Overloaded due to ") + AdmissionController::reasonOf(verdict) + ", retry later",
+                       std::nullopt);
+    return false;
+  }
+
  protected:
   // command create time in nanos
-  TimestampInNanos mCommandCreateTime;
+  TimestampInNanos mCommandCreateTime = 0;
+  // sampled trace, nullptr if not sampled
+  CommandTracePtr mTrace;
+  // weight held in admission control, if admitted
+  AdmissionTicket mAdmissionTicket;
 };
 
 }  /// namespace gringofts
@@ -0,0 +1,180 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "CommandTracer.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+namespace gringofts {
+
+std::string CommandTrace::toTrackingContext() const {
+  return "{\"traceId\":" + std::to_string(mTraceId) + "}";
+}
+
+const char *CommandTrace::stageName(TraceStage stage) {
+  switch (stage) {
+    case TraceStage::GrpcReceive: return "grpc_receive";
+    case TraceStage::CplDequeue: return "cpl_dequeue";
+    case TraceStage::Process: return "process";
+    case TraceStage::Encode: return "encode";
+    case TraceStage::Encrypt: return "encrypt";
+    case TraceStage::RaftAppend: return "raft_append";
+    case TraceStage::LocalPersist: return "local_persist";
+    case TraceStage::QuorumCommit: return "quorum_commit";
+    case TraceStage::Reply: return "reply";
+    default: return "unknown";
+  }
+}
+
+CommandTracer &CommandTracer::getInstance() {
+  static CommandTracer instance;
+  return instance;
+}
+
+CommandTracer::CommandTracer()
+    : mTotalHistogram(getHistogram("command_trace_latency_in_ms", {})) {
+  for (uint32_t i = 1; i < CommandTrace::kStageCount; ++i) {
+    mStageHistograms.push_back(getHistogram("command_stage_latency_in_ms",
+                                            {{"stage", CommandTrace::stageName(static_cast<TraceStage>(i))}}));
+  }
+}
+
+void CommandTracer::setSampleEveryN(uint64_t sampleEveryN) {
+  mSampleEveryN = sampleEveryN;
+  SPDLOG_INFO("setting trace sample every n: {}", sampleEveryN);
+}
+
+void CommandTracer::setMaxKeptTraces(uint64_t maxKeptTraces) {
+  std::lock_guard<std::mutex> lock(mFinishedMutex);
+  mMaxKeptTraces = maxKeptTraces;
+  SPDLOG_INFO("setting max kept traces: {}", maxKeptTraces);
+}
+
+CommandTracePtr CommandTracer::maybeStartTrace() {
+  auto sampleEveryN = mSampleEveryN.load(std::memory_order_relaxed);
+  if (sampleEveryN == 0) {
+    return nullptr;
+  }
+  /// per-thread counter, so sampling does not contend on a shared atomic
+  thread_local uint64_t requestCount = 0;
+  if (++requestCount % sampleEveryN != 0) {
+    return nullptr;
+  }
+  auto trace = std::make_shared<CommandTrace>(mNextTraceId++);
+  trace->stamp(TraceStage::GrpcReceive);
+  return trace;
+}
+
+void CommandTracer::bindLogIndex(uint64_t index, const CommandTracePtr &trace) {
+  std::lock_guard<std::mutex> lock(mBoundMutex);
+  if (mBoundTraces.size() >= kMaxBoundTraces) {
+    mBoundTraces.erase(mBoundTraces.begin());
+  }
+  mBoundTraces[index] = trace;
+  mBoundCount = mBoundTraces.size();
+}
+
+void CommandTracer::onRaftAppended(uint64_t firstIndex, uint64_t lastIndex,
+                                   TimestampInNanos appendTime, TimestampInNanos persistTime) {
+  std::lock_guard<std::mutex> lock(mBoundMutex);
+  for (auto it = mBoundTraces.lower_bound(firstIndex);
+       it != mBoundTraces.end() && it->first <= lastIndex; ++it) {
+    it->second->stamp(TraceStage::RaftAppend, appendTime);
+    it->second->stamp(TraceStage::LocalPersist, persistTime);
+  }
+}
+
+void CommandTracer::onCommitted(uint64_t commitIndex) {
+  auto now = TimeUtil::currentTimeInNanos();
+  std::lock_guard<std::mutex> lock(mBoundMutex);
+  auto end = mBoundTraces.upper_bound(commitIndex);
+  for (auto it = mBoundTraces.begin(); it != end; ++it) {
+    it->second->stamp(TraceStage::QuorumCommit, now);
+  }
+  mBoundTraces.erase(mBoundTraces.begin(), end);
+  mBoundCount = mBoundTraces.size();
+}
+
+void CommandTracer::onTruncated(uint64_t lastIndexKept) {
+  std::lock_guard<std::mutex> lock(mBoundMutex);
+  mBoundTraces.erase(mBoundTraces.upper_bound(lastIndexKept), mBoundTraces.end());
+  mBoundCount = mBoundTraces.size();
+}
+
+void CommandTracer::onSteppedDown() {
+  std::lock_guard<std::mutex> lock(mBoundMutex);
+  mBoundTraces.clear();
+  mBoundCount = 0;
+}
+
+void CommandTracer::finishTrace(const CommandTracePtr &trace) {
+  TimestampInNanos previous = trace->stampOf(TraceStage::GrpcReceive);
+  TimestampInNanos last = previous;
+  for (uint32_t i = 1; i < CommandTrace::kStageCount; ++i) {
+    auto ts = trace->stampOf(static_cast<TraceStage>(i));
+    if (ts == 0) {
+      /// not reached, e.g., rejected before persisted
+      continue;
+    }
+    /// stages stamped by different threads might be slightly out of order
+    mStageHistograms[i - 1].observe(ts > previous ? (ts - previous) / 1000000.0 : 0);
+    previous = std::max(previous, ts);
+    last = std::max(last, ts);
+  }
+  mTotalHistogram.observe((last - trace->stampOf(TraceStage::GrpcReceive)) / 1000000.0);
+
+  std::lock_guard<std::mutex> lock(mFinishedMutex);
+  mFinishedTraces.push_back(trace);
+  while (mFinishedTraces.size() > mMaxKeptTraces) {
+    mFinishedTraces.pop_front();
+  }
+}
+
+std::string CommandTracer::dumpChromeTrace(uint64_t maxTraces) const {
+  std::deque<CommandTracePtr> traces;
+  {
+    std::lock_guard<std::mutex> lock(mFinishedMutex);
+    auto count = (maxTraces == 0 || maxTraces > mFinishedTraces.size()) ? mFinishedTraces.size() : maxTraces;
+    traces.assign(mFinishedTraces.end() - count, mFinishedTraces.end());
+  }
+
+  /// one row per command, one complete event per stage spanning from the previous reached stage
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (auto &trace : traces) {
+    TimestampInNanos previous = trace->stampOf(TraceStage::GrpcReceive);
+    for (uint32_t i = 1; i < CommandTrace::kStageCount; ++i) {
+      auto stage = static_cast<TraceStage>(i);
+      auto ts = trace->stampOf(stage);
+      if (ts == 0) {
+        continue;
+      }
+      auto begin = std::min(previous, ts);
+      json += first ? "" : ",";
+      json += "{\"name\":\"" + std::string(CommandTrace::stageName(stage)) + "\""
+          + ",\"cat\":\"command\",\"ph\":\"X\",\"pid\":1"
+          + ",\"tid\":" + std::to_string(trace->getTraceId())
+          + ",\"ts\":" + std::to_string(begin / 1000.0)
+          + ",\"dur\":" + std::to_string((ts - begin) / 1000.0) + "}";
+      first = false;
+      previous = std::max(previous, ts);
+    }
+  }
+  json += "]}";
+  return json;
+}
+
+}  /// namespace gringofts
@@ -0,0 +1,143 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_MONITOR_COMMANDTRACER_H_
+#define SRC_INFRA_MONITOR_COMMANDTRACER_H_
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../util/TimeUtil.h"
+#include "MonitorTypes.h"
+
+namespace gringofts {
+
+/// stages a command goes through on leader, in pipeline order
+enum class TraceStage : uint32_t {
+  GrpcReceive = 0,
+  CplDequeue,
+  Process,
+  Encode,
+  Encrypt,
+  RaftAppend,
+  LocalPersist,
+  QuorumCommit,
+  Reply,
+  Count
+};
+
+/**
+ * Timestamps of one sampled command at each stage it has reached.
+ * Stages are stamped by whichever thread the command is on, so stamps are atomics.
+ */
+class CommandTrace {
+ public:
+  static constexpr uint32_t kStageCount = static_cast<uint32_t>(TraceStage::Count);
+
+  explicit CommandTrace(uint64_t traceId) : mTraceId(traceId) {}
+
+  void stamp(TraceStage stage, TimestampInNanos ts = TimeUtil::currentTimeInNanos()) {
+    mStamps[static_cast<uint32_t>(stage)].store(ts, std::memory_order_relaxed);
+  }
+
+  /// 0 if the stage is not reached
+  TimestampInNanos stampOf(TraceStage stage) const {
+    return mStamps[static_cast<uint32_t>(stage)].load(std::memory_order_relaxed);
+  }
+
+  uint64_t getTraceId() const { return mTraceId; }
+
+  /// json persisted as the tracking context of command, so the trace can be found from the log
+  std::string toTrackingContext() const;
+
+  static const char *stageName(TraceStage stage);
+
+ private:
+  const uint64_t mTraceId;
+  std::array<std::atomic<TimestampInNanos>, kStageCount> mStamps{};
+};
+
+using CommandTracePtr = std::shared_ptr<CommandTrace>;
+
+/**
+ * Samples one of every N requests, aggregates their stage latencies into
+ * command_stage_latency_in_ms histograms, and keeps the most recent ones
+ * to be dumped as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * Raft only knows entries by index, so raft stages are stamped through
+ * the tracer, which maps log index to trace for in-flight sampled commands.
+ */
+class CommandTracer {
+ public:
+  static CommandTracer &getInstance();
+
+  /// 0 disables tracing
+  void setSampleEveryN(uint64_t sampleEveryN);
+  void setMaxKeptTraces(uint64_t maxKeptTraces);
+
+  /// a new trace if this request is sampled, otherwise nullptr
+  CommandTracePtr maybeStartTrace();
+
+  /// trace of command that will be written to log entry at index
+  void bindLogIndex(uint64_t index, const CommandTracePtr &trace);
+  /// entries in [firstIndex, lastIndex] have been appended to raft log
+  void onRaftAppended(uint64_t firstIndex, uint64_t lastIndex,
+                      TimestampInNanos appendTime, TimestampInNanos persistTime);
+  /// entries up to commitIndex have been committed, unbind them
+  void onCommitted(uint64_t commitIndex);
+  /// entries after lastIndexKept have been truncated from raft log, unbind them
+  void onTruncated(uint64_t lastIndexKept);
+  /// no longer leader, bound entries will not be committed by us, unbind all
+  void onSteppedDown();
+
+  /// command is done, the trace must not be stamped any more
+  void finishTrace(const CommandTracePtr &trace);
+
+  /// the most recent maxTraces traces, 0 means all that are kept
+  std::string dumpChromeTrace(uint64_t maxTraces = 0) const;
+
+  /// whether any sampled command is between RaftLogStore and commit, checked by raft before locking
+  bool hasBoundTraces() const { return mBoundCount.load(std::memory_order_relaxed) != 0; }
+
+ private:
+  CommandTracer();
+
+  std::atomic<uint64_t> mSampleEveryN = 0;
+  std::atomic<uint64_t> mNextTraceId = 1;
+
+  /// in-flight sampled commands by log index
+  std::mutex mBoundMutex;
+  std::map<uint64_t, CommandTracePtr> mBoundTraces;
+  std::atomic<uint64_t> mBoundCount = 0;
+  /// safety net in case unbinding on step-down or truncation is missed
+  static constexpr uint64_t kMaxBoundTraces = 10000;
+
+  mutable std::mutex mFinishedMutex;
+  std::deque<CommandTracePtr> mFinishedTraces;
+  uint64_t mMaxKeptTraces = 1000;
+
+  /// time from the previous reached stage to stage i is observed into mStageHistograms[i - 1]
+  std::vector<santiago::MetricsCenter::HistogramType> mStageHistograms;
+  santiago::MetricsCenter::HistogramType mTotalHistogram;
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_MONITOR_COMMANDTRACER_H_
@@ -40,6 +40,11 @@ inline santiago::MetricsCenter::GaugeType getGauge(const std::string &name,
   return getAppInfoMetricsCenter().gauge(name, labels);
 }
 
+inline santiago::MetricsCenter::HistogramType getHistogram(const std::string &name,
+                                                           const std::map<std::string, std::string> &labels) {
+  return getAppInfoMetricsCenter().histogram(name, labels);
+}
+
 }  /// namespace gringofts
 
 #endif  // SRC_INFRA_MONITOR_MONITORTYPES_H_
@@ -14,6 +14,7 @@ limitations under the License.
 
 #include "Metrics.h"
 
+#include "prometheus/PrometheusHistogram.h"
 #include "prometheus/PrometheusMetrics.h"
 
 namespace santiago {
@@ -49,4 +50,9 @@ void Summary<PrometheusSummary>::observe(double val) {
   mImplPtr->observe(val);
 }
 
+template <>
+void Histogram<PrometheusHistogram>::observe(double val) {
+  mImplPtr->observe(val);
+}
+
 }  /// namespace santiago
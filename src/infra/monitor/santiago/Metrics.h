@@ -44,6 +44,8 @@ class Gauge {
   explicit Gauge(ArgT &&...args):
       mImplPtr(std::make_shared<ImplType>(std::forward<ArgT>(args)...)) {}
   Gauge(const Gauge &_c) : mImplPtr(_c.mImplPtr) {}
+  Gauge(Gauge &&_c) : mImplPtr(_c.mImplPtr) {}
+  Gauge &operator=(const Gauge &) = default;
   void set(double value);
   double value();
  private:
@@ -63,6 +65,18 @@ class Summary {
   std::shared_ptr<ImplType> mImplPtr;
 };
 
+template<class Impl>
+class Histogram {
+ public:
+  typedef Impl ImplType;
+  /// the impl is owned by its registry, which hands out the same one for the same name and labels
+  explicit Histogram(std::shared_ptr<ImplType> implPtr) : mImplPtr(std::move(implPtr)) {}
+  Histogram(const Histogram &_c) : mImplPtr(_c.mImplPtr) {}
+  void observe(double);
+ private:
+  std::shared_ptr<ImplType> mImplPtr;
+};
+
 }  /// namespace santiago
 
 #endif  // SRC_INFRA_MONITOR_SANTIAGO_METRICS_H_
@@ -26,7 +26,8 @@ MetricsCenter::MetricsCenter()
     : mRegistryPtr(std::make_shared<prometheus::Registry>()),
       mCouterFactory(std::make_shared<CounterFactory>(*mRegistryPtr)),
       mGaugeFactory(std::make_shared<GaugeFactory>(*mRegistryPtr)),
-      mSummaryFactory(std::make_shared<SummaryFactory>(*mRegistryPtr)) {
+      mSummaryFactory(std::make_shared<SummaryFactory>(*mRegistryPtr)),
+      mHistogramRegistryPtr(std::make_shared<PrometheusHistogramRegistry>()) {
 }
 
 MetricsCenter::CounterType MetricsCenter::counter(const std::string &name,
@@ -47,4 +48,10 @@ MetricsCenter::SummaryType MetricsCenter::summary(const std::string &name,
   return mSummaryFactory->get(name, label, help, SummaryQuantiles);
 }
 
+MetricsCenter::HistogramType MetricsCenter::histogram(const std::string &name,
+                                                      const santiago::MetricsCenter::LabelType &label,
+                                                      const std::string &help) {
+  return HistogramType(mHistogramRegistryPtr->get(name, label, help));
+}
+
 }  /// namespace santiago
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef SRC_INFRA_MONITOR_SANTIAGO_METRICSCENTER_H_
 #define SRC_INFRA_MONITOR_SANTIAGO_METRICSCENTER_H_
 
+#include "prometheus/PrometheusHistogram.h"
 #include "prometheus/PrometheusMetrics.h"
 
 #include "Metrics.h"
@@ -34,6 +35,7 @@ class MetricsCenter {
   typedef Counter<PrometheusCounter> CounterType;
   typedef Gauge<PrometheusGauge> GaugeType;
   typedef Summary<PrometheusSummary> SummaryType;
+  typedef Histogram<PrometheusHistogram> HistogramType;
   typedef PrometheusMetricsFactory<CounterType> CounterFactory;
   typedef PrometheusMetricsFactory<GaugeType> GaugeFactory;
   typedef PrometheusMetricsFactory<SummaryType> SummaryFactory;
@@ -42,12 +44,16 @@ class MetricsCenter {
   CounterType counter(const std::string &name, const LabelType &label, const std::string &help = "");
   GaugeType gauge(const std::string &name, const LabelType &label, const std::string &help = "");
   SummaryType summary(const std::string &name, const LabelType &label, const std::string &help = "");
+  /// latencies in ms, cheap to observe from many threads, keep the returned handle instead of looking it up again
+  HistogramType histogram(const std::string &name, const LabelType &label, const std::string &help = "");
   std::shared_ptr<prometheus::Registry> getRegistryPtr() { return mRegistryPtr; }
+  std::shared_ptr<PrometheusHistogramRegistry> getHistogramRegistryPtr() { return mHistogramRegistryPtr; }
  private:
   std::shared_ptr<prometheus::Registry> mRegistryPtr;
   std::shared_ptr<CounterFactory> mCouterFactory;
   std::shared_ptr<GaugeFactory> mGaugeFactory;
   std::shared_ptr<SummaryFactory> mSummaryFactory;
+  std::shared_ptr<PrometheusHistogramRegistry> mHistogramRegistryPtr;
 };
 
 }  /// namespace santiago
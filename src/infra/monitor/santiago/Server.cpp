@@ -19,6 +19,7 @@ limitations under the License.
 namespace santiago {
 void Server::Registry(santiago::MetricsCenter &center) {
   mExposerPtr->RegisterCollectable(center.getRegistryPtr());
+  mExposerPtr->RegisterCollectable(center.getHistogramRegistryPtr());
 }
 
 Server::Server(const std::string &address, uint16_t port) :
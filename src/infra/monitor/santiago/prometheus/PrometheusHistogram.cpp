@@ -0,0 +1,150 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "PrometheusHistogram.h"
+
+#include <cmath>
+#include <limits>
+
+namespace santiago {
+
+namespace {
+
+std::atomic<uint64_t> gNextHistogramId{0};
+
+/// shards of the calling thread, indexed by PrometheusHistogram::mId
+thread_local std::vector<void *> tlShards;
+
+}  /// namespace
+
+const std::vector<double> PrometheusHistogramRegistry::kDefaultUpperBounds = {
+    0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+
+PrometheusHistogram::PrometheusHistogram() : mId(gNextHistogramId++) {}
+
+PrometheusHistogram::Shard *PrometheusHistogram::myShard() {
+  if (mId < tlShards.size() && tlShards[mId] != nullptr) {
+    return static_cast<Shard *>(tlShards[mId]);
+  }
+  /// first observation of this thread, shards stay with the histogram after the thread exits
+  auto shard = std::make_unique<Shard>();
+  auto *raw = shard.get();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mShards.push_back(std::move(shard));
+  }
+  if (mId >= tlShards.size()) {
+    tlShards.resize(mId + 1, nullptr);
+  }
+  tlShards[mId] = raw;
+  return raw;
+}
+
+void PrometheusHistogram::observe(double valueInMillis) {
+  auto micros = valueInMillis <= 0 ? 0 : static_cast<uint64_t>(std::llround(valueInMillis * 1000));
+  auto *shard = myShard();
+  /// single writer, a load and a store is enough and much cheaper than fetch_add
+  auto &bucket = shard->mCounts[gringofts::HdrHistogram::bucketIndexOf(micros)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  shard->mSumInMicros.store(shard->mSumInMicros.load(std::memory_order_relaxed) + micros,
+                            std::memory_order_relaxed);
+}
+
+PrometheusHistogram::Snapshot PrometheusHistogram::snapshot() const {
+  Snapshot snapshot;
+  snapshot.mCounts.assign(gringofts::HdrHistogram::kNumBuckets, 0);
+  uint64_t sumInMicros = 0;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto &shard : mShards) {
+    for (uint64_t i = 0; i < gringofts::HdrHistogram::kNumBuckets; ++i) {
+      auto count = shard->mCounts[i].load(std::memory_order_relaxed);
+      snapshot.mCounts[i] += count;
+      snapshot.mTotalCount += count;
+    }
+    sumInMicros += shard->mSumInMicros.load(std::memory_order_relaxed);
+  }
+  snapshot.mSumInMillis = sumInMicros / 1000.0;
+  return snapshot;
+}
+
+std::vector<uint64_t> PrometheusHistogram::cumulativeCounts(const Snapshot &snapshot,
+                                                            const std::vector<double> &upperBounds) {
+  std::vector<uint64_t> result;
+  result.reserve(upperBounds.size());
+
+  uint64_t accumulated = 0;
+  uint64_t next = 0;
+  for (auto bound : upperBounds) {
+    /// a bucket belongs to le=bound if the bound falls in or after it, so off by at most the bucket's precision
+    auto last = gringofts::HdrHistogram::bucketIndexOf(static_cast<uint64_t>(std::llround(bound * 1000)));
+    for (; next <= last && next < snapshot.mCounts.size(); ++next) {
+      accumulated += snapshot.mCounts[next];
+    }
+    result.push_back(accumulated);
+  }
+  return result;
+}
+
+PrometheusHistogramRegistry::PrometheusHistogramRegistry(std::vector<double> upperBounds)
+    : mUpperBounds(std::move(upperBounds)) {}
+
+std::shared_ptr<PrometheusHistogram> PrometheusHistogramRegistry::get(const std::string &name,
+                                                                      const LabelType &labels,
+                                                                      const std::string &help) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto &family = mFamilies[name];
+  if (family.mHelp.empty()) {
+    family.mHelp = help;
+  }
+  auto &histogram = family.mHistograms[labels];
+  if (!histogram) {
+    histogram = std::make_shared<PrometheusHistogram>();
+  }
+  return histogram;
+}
+
+std::vector<prometheus::MetricFamily> PrometheusHistogramRegistry::Collect() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::vector<prometheus::MetricFamily> result;
+  result.reserve(mFamilies.size());
+
+  for (auto &[name, family] : mFamilies) {
+    prometheus::MetricFamily metricFamily;
+    metricFamily.name = name;
+    metricFamily.help = family.mHelp;
+    metricFamily.type = prometheus::MetricType::Histogram;
+
+    for (auto &[labels, histogram] : family.mHistograms) {
+      auto snapshot = histogram->snapshot();
+      auto cumulative = PrometheusHistogram::cumulativeCounts(snapshot, mUpperBounds);
+
+      prometheus::ClientMetric metric;
+      for (auto &[labelName, labelValue] : labels) {
+        metric.label.push_back({labelName, labelValue});
+      }
+      metric.histogram.sample_count = snapshot.mTotalCount;
+      metric.histogram.sample_sum = snapshot.mSumInMillis;
+      for (std::size_t i = 0; i < mUpperBounds.size(); ++i) {
+        metric.histogram.bucket.push_back({cumulative[i], mUpperBounds[i]});
+      }
+      metric.histogram.bucket.push_back({snapshot.mTotalCount, std::numeric_limits<double>::infinity()});
+      metricFamily.metric.push_back(std::move(metric));
+    }
+    result.push_back(std::move(metricFamily));
+  }
+  return result;
+}
+
+}  /// namespace santiago
@@ -0,0 +1,111 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_MONITOR_SANTIAGO_PROMETHEUS_PROMETHEUSHISTOGRAM_H_
+#define SRC_INFRA_MONITOR_SANTIAGO_PROMETHEUS_PROMETHEUSHISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "prometheus/collectable.h"
+#include "prometheus/metric_family.h"
+
+#include "../../../util/HdrHistogram.h"
+
+namespace santiago {
+
+/**
+ * Latency histogram whose observe() is cheap enough for the hot path.
+ *
+ * Each observing thread gets its own shard of gringofts::HdrHistogram buckets, found through
+ * a thread_local table, and is the only writer of it, so an observation is two relaxed
+ * stores and never takes a lock. Shards are only merged when the histogram is scraped.
+ * Values are in milliseconds, recorded with microsecond precision.
+ */
+class PrometheusHistogram {
+ public:
+  typedef std::array<std::atomic<uint64_t>, gringofts::HdrHistogram::kNumBuckets> BucketArray;
+
+  struct Snapshot {
+    /// count per gringofts::HdrHistogram bucket
+    std::vector<uint64_t> mCounts;
+    uint64_t mTotalCount = 0;
+    double mSumInMillis = 0;
+  };
+
+  PrometheusHistogram();
+  PrometheusHistogram(const PrometheusHistogram &) = delete;
+  PrometheusHistogram &operator=(const PrometheusHistogram &) = delete;
+
+  void observe(double valueInMillis);
+
+  /// merge all shards, observations racing with it may be partially included
+  Snapshot snapshot() const;
+
+  /// cumulative counts at each of the upper bounds, which must be ascending, in milliseconds
+  static std::vector<uint64_t> cumulativeCounts(const Snapshot &snapshot, const std::vector<double> &upperBounds);
+
+ private:
+  struct Shard {
+    BucketArray mCounts{};
+    std::atomic<uint64_t> mSumInMicros{0};
+  };
+
+  Shard *myShard();
+
+  /// index of this histogram in every thread's shard table, never reused
+  const uint64_t mId;
+  mutable std::mutex mMutex;
+  std::vector<std::unique_ptr<Shard>> mShards;
+};
+
+/**
+ * Holds all PrometheusHistogram and exposes them as prometheus histograms.
+ * Register it to the exposer next to the prometheus::Registry.
+ */
+class PrometheusHistogramRegistry : public prometheus::Collectable {
+ public:
+  typedef std::map<std::string, std::string> LabelType;
+
+  explicit PrometheusHistogramRegistry(std::vector<double> upperBounds = kDefaultUpperBounds);
+
+  /// same name and labels always return the same histogram
+  std::shared_ptr<PrometheusHistogram> get(const std::string &name,
+                                           const LabelType &labels,
+                                           const std::string &help);
+
+  std::vector<prometheus::MetricFamily> Collect() const override;
+
+  /// 1-2.5-5 series from 0.1ms to 10s
+  static const std::vector<double> kDefaultUpperBounds;
+
+ private:
+  struct Family {
+    std::string mHelp;
+    std::map<LabelType, std::shared_ptr<PrometheusHistogram>> mHistograms;
+  };
+
+  const std::vector<double> mUpperBounds;
+  mutable std::mutex mMutex;
+  std::map<std::string, Family> mFamilies;
+};
+
+}  /// namespace santiago
+
+#endif  // SRC_INFRA_MONITOR_SANTIAGO_PROMETHEUS_PROMETHEUSHISTOGRAM_H_
@@ -32,6 +32,27 @@ void MpscDoubleBufferQueue<T>::enqueue(const T &t) {
   }
 }
 
+template<typename T>
+void MpscDoubleBufferQueue<T>::enqueueBatch(const std::vector<T> &ts) {
+  if (mShouldExit) {
+    throw QueueStoppedException();
+  }
+  if (ts.empty()) {
+    return;
+  }
+
+  std::unique_lock lock(mMutex);
+
+  bool isEmpty = mProducerQueue->empty();
+  mProducerQueue->insert(mProducerQueue->end(), ts.begin(), ts.end());
+
+  mQueueSize += ts.size();
+
+  if (isEmpty) {
+    mCondVar.notify_one();
+  }
+}
+
 template<typename T>
 const T MpscDoubleBufferQueue<T>::dequeue() {
   if (mConsumerQueue->empty()) {
@@ -45,6 +45,7 @@ class MpscDoubleBufferQueue final : public MpscQueue<T> {
   ~MpscDoubleBufferQueue() override = default;
 
   void enqueue(const T &) override;
+  void enqueueBatch(const std::vector<T> &) override;
   const T dequeue() override;
 
   uint64_t size() const override { return mConsumerQueue->size(); }
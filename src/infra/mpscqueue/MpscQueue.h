@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <exception>
+#include <vector>
 
 namespace gringofts {
 
@@ -43,6 +44,14 @@ class MpscQueue {
    */
   virtual void enqueue(const T &) = 0;
 
+  /**
+   * Append all items to the tail of the queue as one unit,
+   * items of other producers will not interleave with them.
+   * @throw ::gringofts::QueueStoppedException if queue has been shut down,
+   *        in which case none of the items is appended
+   */
+  virtual void enqueueBatch(const std::vector<T> &) = 0;
+
   /**
    * Remove and return the item at the head of the queue.
    * This method will block until the queue is not empty.
@@ -31,7 +31,8 @@ inline std::shared_ptr<RaftInterface> buildRaftImpl(
     const NodeId &nodeId,
     const ClusterInfo &clusterInfo,
     std::shared_ptr<DNSResolver> dnsResolver = nullptr,
-    RaftRole role = RaftRole::Follower ) {
+    RaftRole role = RaftRole::Follower,
+    std::shared_ptr<v2::RaftClientLoop> clientLoop = nullptr) {
   INIReader iniReader(configPath);
   if (iniReader.ParseError() < 0) {
     SPDLOG_ERROR("Failed to load config file {}.", configPath);
@@ -46,7 +47,8 @@ inline std::shared_ptr<RaftInterface> buildRaftImpl(
       /// use default dns resolver
       dnsResolver = std::make_shared<DNSResolver>();
     }
-    return std::make_shared<v2::RaftCore>(configPath, nodeId, clusterInfo, dnsResolver, role);
+    /// raft groups hosted in one process can share one client loop
+    return std::make_shared<v2::RaftCore>(configPath, nodeId, clusterInfo, dnsResolver, role, clientLoop);
   } else {
     SPDLOG_ERROR("Unknown raft implement version {}.", version);
     exit(1);
@@ -21,15 +21,18 @@ namespace gringofts {
 namespace raft {
 
 struct RaftConstants {
-  /// The minimum/maximum timeout follower will wait before starting a new election
+  /// The minimum/maximum timeout follower will wait before starting a new election,
+  /// default of min.election.timeout.in.ms and max.election.timeout.in.ms
   static constexpr uint64_t kMinElectionTimeoutInMillis = 1000;
   static constexpr uint64_t kMaxElectionTimeoutInMillis = kMinElectionTimeoutInMillis * 2;
 
-  /// heart beat interval that leader will wait before sending a heartbeat to follower
+  /// heart beat interval that leader will wait before sending a heartbeat to follower,
+  /// default of heartbeat.interval.in.ms
   static const uint64_t kHeartBeatIntervalInMillis = 20;
 
   struct AppendEntries { static constexpr uint64_t kRpcTimeoutInMillis = 300; };
   struct RequestVote   { static constexpr uint64_t kRpcTimeoutInMillis = 100; };
+  struct TimeoutNow    { static constexpr uint64_t kRpcTimeoutInMillis = 100; };
 };
 
 }  /// namespace raft
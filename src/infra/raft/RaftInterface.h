@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef SRC_INFRA_RAFT_RAFTINTERFACE_H_
 #define SRC_INFRA_RAFT_RAFTINTERFACE_H_
 
+#include <functional>
 #include <list>
 #include <mutex>
 #include <optional>
@@ -88,6 +89,33 @@ struct SyncRequest {
   std::optional<SyncFinishMeta> mFinishMeta;
 };
 
+//////////////////////////// Leadership Transfer ////////////////////////////
+
+struct TransferLeadershipRequest {
+  /// the peer to hand leadership over to, kBadID means the most up-to-date one
+  MemberId mTargetId = kBadID;
+
+  /// invoked exactly once, with whether leadership has been handed over
+  std::function<void(bool, const std::string &)> mCallback;
+};
+
+//////////////////////////// Membership Change ////////////////////////////
+
+struct ChangeMembershipRequest {
+  enum class Type {
+    AddMember = 0,
+    RemoveMember = 1,
+  };
+
+  Type mType = Type::AddMember;
+
+  /// address is only required by AddMember
+  MemberInfo mMember;
+
+  /// invoked exactly once, with whether the new configuration is committed
+  std::function<void(bool, const std::string &)> mCallback;
+};
+
 //////////////////////////// Raft Interface ////////////////////////////
 
 enum class RaftRole {
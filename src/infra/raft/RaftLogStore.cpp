@@ -17,6 +17,8 @@ limitations under the License.
 #include <unistd.h>
 
 #include "../es/store/CommandEventEncodeWrapper.h"
+#include "../util/LogUtil.h"
+#include "../util/ThreadPlacement.h"
 
 namespace {
 using ::gringofts::es::CommandEntry;
@@ -30,7 +32,16 @@ namespace raft {
 RaftLogStore::RaftLogStore(const std::shared_ptr<RaftInterface> &raftImpl,
                            const std::shared_ptr<CryptoUtil> &crypto)
     : mRaftImpl(raftImpl), mCrypto(crypto),
-      mGaugeRaftBatchSize(gringofts::getGauge("raft_batch_size", {})) {
+      mArenaInitialBlock(kArenaInitialBlockSizeInBytes),
+      mGaugeRaftBatchSize(gringofts::getGauge("raft_batch_size", {})),
+      mArenaAllocatedBytesCounter(gringofts::getCounter("arena_allocated_bytes_counter", {{"stage", "log_store"}})),
+      mEncodeLatencyHistogram(gringofts::getHistogram("log_store_encode_latency_in_ms", {})),
+      mEncryptLatencyHistogram(gringofts::getHistogram("log_store_encrypt_latency_in_ms", {})) {
+  google::protobuf::ArenaOptions options;
+  options.initial_block = mArenaInitialBlock.data();
+  options.initial_block_size = mArenaInitialBlock.size();
+  mArena = std::make_unique<google::protobuf::Arena>(options);
+
   mPersistLoop = std::thread(&RaftLogStore::persistLoopMain, this);
 }
 
@@ -95,20 +106,28 @@ void RaftLogStore::persistAsync(const std::shared_ptr<Command> &command,
   mPersistQueue.enqueue(PersistEntry{command, events, {entry, requestHandle}});
 }
 
+void RaftLogStore::encodePayload(const Command &command,
+                                 const std::vector<std::shared_ptr<Event>> &events,
+                                 google::protobuf::Arena *arena,
+                                 LogEntry *entry) {
+  auto *payload = google::protobuf::Arena::CreateMessage<RaftPayload>(arena);
+
+  CommandEventEncodeWrapper::encodeCommand(command, payload->mutable_command());
+  for (const auto &event : events) {
+    CommandEventEncodeWrapper::encodeEvent(*event, payload->add_events());
+  }
+
+  payload->SerializeToString(entry->mutable_payload());
+}
+
 void RaftLogStore::dequeue() {
   auto[command, events, clientRequest] = mPersistQueue.dequeue();
 
   uint64_t ts1InNano = TimeUtil::currentTimeInNanos();
 
-  /// construct payload
-  RaftPayload payload;
-
-  CommandEventEncodeWrapper::encodeCommand(*command, payload.mutable_command());
-  for (const auto &event : events) {
-    CommandEventEncodeWrapper::encodeEvent(*event, payload.add_events());
-  }
-
-  payload.SerializeToString(clientRequest.mEntry.mutable_payload());
+  /// payload is released with the arena once the batch is sent
+  encodePayload(*command, events, mArena.get(), &clientRequest.mEntry);
+  command->stampTrace(TraceStage::Encode);
 
   uint64_t ts2InNano = TimeUtil::currentTimeInNanos();
 
@@ -117,13 +136,21 @@ void RaftLogStore::dequeue() {
           clientRequest.mEntry.mutable_payload(),
           clientRequest.mEntry.version().secret_key_version()) == 0);
   assert(clientRequest.mEntry.ByteSizeLong() <= kMaxPayLoadSizeInBytes);
+  command->stampTrace(TraceStage::Encrypt);
+
+  /// raft stages are stamped by index
+  if (command->getTrace()) {
+    CommandTracer::getInstance().bindLogIndex(clientRequest.mEntry.index(), command->getTrace());
+  }
 
   uint64_t ts3InNano = TimeUtil::currentTimeInNanos();
 
-  SPDLOG_INFO("Prepare Raft Log Entry, Id {}, applied {} events, encodeCost={}us, encryptCost={}us",
-              command->getId(), events.size(),
-              (ts2InNano - ts1InNano) / 1000.0,
-              (ts3InNano - ts2InNano) / 1000.0);
+  mEncodeLatencyHistogram.observe((ts2InNano - ts1InNano) / 1000000.0);
+  mEncryptLatencyHistogram.observe((ts3InNano - ts2InNano) / 1000000.0);
+  SPDLOG_DEBUG("Prepare Raft Log Entry, Id {}, applied {} events, encodeCost={}us, encryptCost={}us",
+               command->getId(), events.size(),
+               (ts2InNano - ts1InNano) / 1000.0,
+               (ts3InNano - ts2InNano) / 1000.0);
 
   mBatch.emplace_back(std::move(clientRequest));
 }
@@ -141,15 +168,20 @@ void RaftLogStore::maySendBatch() {
   }
 
   mGaugeRaftBatchSize.set(mBatch.size());
-  SPDLOG_INFO("persistLoop send a batch, batchSize={}, elapseTime={}ms",
-              mBatch.size(), elapseInMs);
+  SPDLOG_INFO_EVERY_MS(1000, "persistLoop send a batch, batchSize={}, elapseTime={}ms",
+                       mBatch.size(), elapseInMs);
 
   mRaftImpl->enqueueClientRequests(std::move(mBatch));
   mLastSentTimeInNano = nowInNano;
+
+  /// payloads have been serialized into log entries, release them all at once
+  mArenaAllocatedBytesCounter.increase(mArena->SpaceUsed());
+  mArena->Reset();
 }
 
 void RaftLogStore::persistLoopMain() {
   pthread_setname_np(pthread_self(), "RaftBatchThread");
+  ThreadPlacement::getInstance().place("RaftBatchThread");
 
   while (mRunning) {
     if (mPersistQueue.size() != 0) {
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef SRC_INFRA_RAFT_RAFTLOGSTORE_H_
 #define SRC_INFRA_RAFT_RAFTLOGSTORE_H_
 
+#include <google/protobuf/arena.h>
+
 #include "../es/Command.h"
 #include "../es/Event.h"
 #include "../grpc/RequestHandle.h"
@@ -52,6 +54,15 @@ class RaftLogStore {
                     uint64_t index,
                     RequestHandle *requestHandle);
 
+  /**
+   * Encode command and events into a RaftPayload allocated on arena,
+   * and serialize it, not encrypted yet, as the payload of entry.
+   */
+  static void encodePayload(const Command &command,
+                            const std::vector<std::shared_ptr<Event>> &events,
+                            google::protobuf::Arena *arena,
+                            LogEntry *entry);
+
  private:
   /// thread function of persist thread
   void persistLoopMain();
@@ -83,12 +94,24 @@ class RaftLogStore {
   uint64_t mLastSentTimeInNano = 0;
   ClientRequests mBatch;
 
+  /**
+   * RaftPayloads of the current batch are allocated on this arena,
+   * which is reset once the batch is sent. Its initial block is
+   * kept across resets, so a typical batch does not hit malloc.
+   */
+  std::vector<char> mArenaInitialBlock;
+  std::unique_ptr<google::protobuf::Arena> mArena;
+
   /// configurable vars
   const uint64_t kMaxDelayInMs = 20;
   const uint64_t kMaxBatchSize = 100;
   const uint64_t kMaxPayLoadSizeInBytes = 4000000;   /// less then 4M
+  static constexpr uint64_t kArenaInitialBlockSizeInBytes = 1024 * 1024;
 
   mutable santiago::MetricsCenter::GaugeType mGaugeRaftBatchSize;
+  santiago::MetricsCenter::CounterType mArenaAllocatedBytesCounter;
+  santiago::MetricsCenter::HistogramType mEncodeLatencyHistogram;
+  santiago::MetricsCenter::HistogramType mEncryptLatencyHistogram;
 };
 
 }  /// namespace raft
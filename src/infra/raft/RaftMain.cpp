@@ -15,10 +15,11 @@ limitations under the License.
 #include <memory>
 #include <unistd.h>
 
-#include <spdlog/sinks/stdout_sinks.h>
+#include <spdlog/spdlog.h>
 
 #include "../util/ClusterInfo.h"
 #include "../util/CryptoUtil.h"
+#include "../util/LogUtil.h"
 #include "RaftLogStore.h"
 #include "RaftBuilder.h"
 
@@ -57,8 +58,7 @@ struct DummyEvent final : gringofts::Event {
 };
 
 int main(int argc, char *argv[]) {
-  spdlog::stdout_logger_mt("console");
-  spdlog::set_pattern("[%D %H:%M:%S.%F] [%s:%# %!] [%l] [thread %t] %v");
+  gringofts::LogUtil::initLogger("[%D %H:%M:%S.%F] [%s:%# %!] [%l] [thread %t] %v");
 
   /// create raft impl
   gringofts::NodeId nodeId = 1;
@@ -15,7 +15,9 @@ limitations under the License.
 #include "RaftReplyLoop.h"
 #include "../common_types.h"
 
+#include "../util/LogUtil.h"
 #include "../util/MetricReporter.h"
+#include "../util/ThreadPlacement.h"
 
 namespace gringofts {
 namespace raft {
@@ -25,13 +27,17 @@ RaftReplyLoop::Task::Task() {
 }
 
 RaftReplyLoop::Task::~Task() {
-  auto endTime = TimeUtil::currentTimeInNanos();
-  auto latency = (endTime - mTaskCreateTime) / 1000000.0;
+  /// from pushed to popped, covers waiting for commit and replying
+  static auto replyLatency = gringofts::getHistogram("reply_latency_in_ms", {});
+  MetricReporter::reportLatency(replyLatency, "reply_latency_in_ms",
+                                mTaskCreateTime, TimeUtil::currentTimeInNanos());
 }
 
 RaftReplyLoop::RaftReplyLoop(const std::shared_ptr<RaftInterface> &raftImpl)
     : mRaftImpl(raftImpl),
-      mPendingReplyGauge(gringofts::getGauge("pending_reply_queue_size", {})) {
+      mPendingReplyGauge(gringofts::getGauge("pending_reply_queue_size", {})),
+      mWaitCommitLatencyHistogram(gringofts::getHistogram("wait_commit_latency_in_ms", {})),
+      mReplySendLatencyHistogram(gringofts::getHistogram("reply_send_latency_in_ms", {})) {
   mPopThread = std::thread(&RaftReplyLoop::popThreadMain, this);
 
   for (uint64_t i = 0; i < mConcurrency; ++i) {
@@ -75,6 +81,7 @@ void RaftReplyLoop::pushTask(uint64_t index, uint64_t term,
 
 void RaftReplyLoop::popThreadMain() {
   pthread_setname_np(pthread_self(), "ReplyLoop_pop");
+  ThreadPlacement::getInstance().place("ReplyLoop_pop");
 
   while (mRunning) {
     bool busy = false;
@@ -100,6 +107,7 @@ void RaftReplyLoop::popThreadMain() {
 
 void RaftReplyLoop::replyThreadMain() {
   pthread_setname_np(pthread_self(), "ReplyLoop_reply");
+  ThreadPlacement::getInstance().place("ReplyLoop_reply");
 
   while (mRunning) {
     TaskPtr taskPtr;
@@ -165,7 +173,8 @@ bool RaftReplyLoop::waitTillCommittedOrQuit(uint64_t index, uint64_t term) {
 
     LogEntry entry;
     assert(mRaftImpl->getEntry(index, &entry));
-    return entry.term() == term;
+    /// leader might carry configuration by a noop at the index app layer assigned
+    return entry.term() == term && !entry.noop();
   }
 
   SPDLOG_WARN("Quit since reply loop is stopped.");
@@ -184,15 +193,23 @@ void RaftReplyLoop::replyTask(Task *task) {
   auto ts2InNano = TimeUtil::currentTimeInNanos();
 
   if (task->handle) {
+    /// handle might be released once replied
+    task->handle->stampTrace(TraceStage::Reply);
     task->handle->fillResultAndReply(task->code, task->message.c_str(), mRaftImpl->getLeaderHint());
   }
 
   auto ts3InNano = TimeUtil::currentTimeInNanos();
-  SPDLOG_INFO("received on <index,term>=<{},{}>, replyCode={}, replyMessage={}, "
-              "waitTillCommit cost {}ms, reply cost {}ms.",
-              task->index, task->term, task->code, task->message,
-              (ts2InNano - ts1InNano) / 1000000.0,
-              (ts3InNano - ts2InNano) / 1000000.0);
+  mWaitCommitLatencyHistogram.observe((ts2InNano - ts1InNano) / 1000000.0);
+  mReplySendLatencyHistogram.observe((ts3InNano - ts2InNano) / 1000000.0);
+  if (!isCommitted) {
+    SPDLOG_WARN_EVERY_MS(1000, "<index,term>=<{},{}> is not committed, replyCode={}, replyMessage={}",
+                         task->index, task->term, task->code, task->message);
+  }
+  SPDLOG_DEBUG("received on <index,term>=<{},{}>, replyCode={}, replyMessage={}, "
+               "waitTillCommit cost {}ms, reply cost {}ms.",
+               task->index, task->term, task->code, task->message,
+               (ts2InNano - ts1InNano) / 1000000.0,
+               (ts3InNano - ts2InNano) / 1000000.0);
 
   /// release task
   task->flag = 2;
@@ -99,6 +99,8 @@ class RaftReplyLoop {
   std::vector<std::thread> mReplyThreads;
 
   santiago::MetricsCenter::GaugeType mPendingReplyGauge;
+  santiago::MetricsCenter::HistogramType mWaitCommitLatencyHistogram;
+  santiago::MetricsCenter::HistogramType mReplySendLatencyHistogram;
 };
 
 }  /// namespace raft
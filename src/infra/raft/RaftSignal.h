@@ -36,6 +36,30 @@ struct RaftState {
 
 class QuerySignal : public FutureSignal<RaftState> {};
 
+struct RaftAdminResult {
+  bool mSuccess;
+  std::string mMessage;
+};
+
+class TransferLeadershipSignal : public FutureSignal<RaftAdminResult> {
+ public:
+  explicit TransferLeadershipSignal(MemberId targetId) : mTargetId(targetId) {}
+  MemberId getTargetId() const { return mTargetId; }
+ private:
+  MemberId mTargetId;
+};
+
+class ChangeMembershipSignal : public FutureSignal<RaftAdminResult> {
+ public:
+  ChangeMembershipSignal(ChangeMembershipRequest::Type type, MemberInfo member)
+      : mType(type), mMember(std::move(member)) {}
+  ChangeMembershipRequest::Type getType() const { return mType; }
+  const MemberInfo &getMember() const { return mMember; }
+ private:
+  ChangeMembershipRequest::Type mType;
+  MemberInfo mMember;
+};
+
 }  // namespace gringofts::raft
 
 #endif  // SRC_INFRA_RAFT_RAFTSIGNAL_H_
@@ -17,8 +17,8 @@ limitations under the License.
 #include <vector>
 
 #include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_sinks.h>
 
+#include "../util/LogUtil.h"
 #include "../util/RandomUtil.h"
 #include "storage/InMemoryLog.h"
 #include "storage/SegmentLog.h"
@@ -175,8 +175,7 @@ void storageABTest(uint64_t runCount, const std::string &logDir,
 int main(int argc, char *argv[]) {
   ::srand(::time(NULL));
 
-  spdlog::stdout_logger_mt("console");
-  spdlog::set_pattern("[%H:%M:%S.%F] [%s:%# %!] [%l] [thread %t] %v");
+  gringofts::LogUtil::initLogger("[%H:%M:%S.%F] [%s:%# %!] [%l] [thread %t] %v");
 
   uint64_t runCount = 200 * 1000;
   std::string logDir = "./data";
@@ -19,7 +19,9 @@ limitations under the License.
 
 #include <spdlog/spdlog.h>
 
+#include "../../monitor/MonitorTypes.h"
 #include "../../util/FileUtil.h"
+#include "../../util/LogUtil.h"
 #include "../../util/TimeUtil.h"
 
 namespace {
@@ -287,8 +289,10 @@ void Segment::appendEntries(const std::vector<raft::LogEntry> &entries) {
   mLastIndex += entries.size();
 
   auto end = TimeUtil::currentTimeInNanos();
-  SPDLOG_INFO("Append {} entry, lastIndex={}, dataLen={}KB, metaLen={}KB, timeCost={}ms",
-              entries.size(), mLastIndex, dataLen / 1024.0, metaLen / 1024.0, (end - beg) / 1000000.0);
+  static auto appendLatency = gringofts::getHistogram("segment_append_latency_in_ms", {});
+  appendLatency.observe((end - beg) / 1000000.0);
+  SPDLOG_INFO_EVERY_MS(1000, "Append {} entry, lastIndex={}, dataLen={}KB, metaLen={}KB, timeCost={}ms",
+                       entries.size(), mLastIndex, dataLen / 1024.0, metaLen / 1024.0, (end - beg) / 1000000.0);
 }
 
 bool Segment::isWithInBoundary(uint64_t index) const {
@@ -368,8 +372,10 @@ bool Segment::getEntries(uint64_t index, uint64_t size, raft::LogEntry *entries)
   }
 
   auto end = TimeUtil::currentTimeInNanos();
-  SPDLOG_INFO("getEntries [{}, {}], timeCost={}ms",
-              index, index + size - 1, (end - beg) / 1000000.0);
+  static auto readLatency = gringofts::getHistogram("segment_read_latency_in_ms", {});
+  readLatency.observe((end - beg) / 1000000.0);
+  SPDLOG_DEBUG("getEntries [{}, {}], timeCost={}ms",
+               index, index + size - 1, (end - beg) / 1000000.0);
   return true;
 }
 
@@ -422,8 +428,10 @@ uint64_t Segment::getEntries(const uint64_t startIndex,
   }
 
   auto end = TimeUtil::currentTimeInNanos();
-  SPDLOG_INFO("startIndex={}, batchSize={}, lenInBytes={}, timeCost={}ms",
-              startIndex, batchSize, lenInBytes, (end - beg) / 1000000.0);
+  static auto readLatency = gringofts::getHistogram("segment_read_latency_in_ms", {});
+  readLatency.observe((end - beg) / 1000000.0);
+  SPDLOG_DEBUG("startIndex={}, batchSize={}, lenInBytes={}, timeCost={}ms",
+               startIndex, batchSize, lenInBytes, (end - beg) / 1000000.0);
   return batchSize;
 }
 
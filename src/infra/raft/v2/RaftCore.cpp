@@ -16,11 +16,16 @@ limitations under the License.
 
 #include <absl/strings/str_split.h>
 #include <cassert>
+#include <cstdio>
 #include <limits>
 #include <netinet/in.h>
 #include <regex>
 #include <vector>
 
+#include "../../monitor/CommandTracer.h"
+#include "../../util/FileUtil.h"
+#include "../../util/LogUtil.h"
+#include "../../util/ThreadPlacement.h"
 #include "../RaftSignal.h"
 
 namespace gringofts {
@@ -32,10 +37,16 @@ RaftCore::RaftCore(
     const NodeId &myNodeId,
     const ClusterInfo &clusterInfo,
     std::shared_ptr<DNSResolver> dnsResolver,
-    RaftRole role) :
+    RaftRole role,
+    std::shared_ptr<RaftClientLoop> clientLoop) :
     mRaftRole(role),
+    mClientLoop(std::move(clientLoop)),
     mLeadershipGauge(gringofts::getGauge("leadership_gauge", {{"status", "isLeader"}})),
-    mCommitIndexCounter(gringofts::getCounter("committed_log_counter", {{"status", "committed"}})) {
+    mCommitIndexCounter(gringofts::getCounter("committed_log_counter", {{"status", "committed"}})),
+    mAeUncompressedBytesCounter(gringofts::getCounter("ae_entries_bytes_counter", {{"status", "uncompressed"}})),
+    mAeCompressedBytesCounter(gringofts::getCounter("ae_entries_bytes_counter", {{"status", "compressed"}})),
+    mAeRoundTripHistogram(gringofts::getHistogram("ae_round_trip_latency_in_ms", {})),
+    mAeWriteEntriesHistogram(gringofts::getHistogram("ae_write_entries_latency_in_ms", {})) {
   INIReader iniReader(configPath);
   if (iniReader.ParseError() < 0) {
     SPDLOG_ERROR("Can't load configure file {}, exit", configPath);
@@ -45,6 +56,7 @@ RaftCore::RaftCore(
   initConfigurableVars(iniReader);
   initClusterConf(clusterInfo, myNodeId);
   initStorage(iniReader);
+  loadConfigurations();
   initService(iniReader, dnsResolver);
 
   /// registry signal handler
@@ -61,6 +73,24 @@ RaftCore::RaftCore(
          this->getCommitIndex(),
          this->getRaftRole()});
   });
+  Signal::hub.handle<TransferLeadershipSignal>([this](const Signal &s) {
+    const auto &signal = dynamic_cast<const TransferLeadershipSignal &>(s);
+    SPDLOG_INFO("receive transfer leadership signal, target is Node {}", signal.getTargetId());
+    /// sender holds the signal until its future is ready
+    enqueueTransferLeadership({signal.getTargetId(), [&signal](bool success, const std::string &message) {
+      signal.passValue({success, message});
+    }});
+  });
+  Signal::hub.handle<ChangeMembershipSignal>([this](const Signal &s) {
+    const auto &signal = dynamic_cast<const ChangeMembershipSignal &>(s);
+    SPDLOG_INFO("receive change membership signal, type={}, member={}",
+                static_cast<int>(signal.getType()), signal.getMember().toString());
+    /// sender holds the signal until its future is ready
+    enqueueChangeMembership({signal.getType(), signal.getMember(),
+                             [&signal](bool success, const std::string &message) {
+      signal.passValue({success, message});
+    }});
+  });
 }
 
 void RaftCore::initConfigurableVars(const INIReader &iniReader) {
@@ -69,44 +99,92 @@ void RaftCore::initConfigurableVars(const INIReader &iniReader) {
   mMaxLenInBytes = iniReader.GetInteger("raft.default", "max.len.in.bytes", 0);
   mMaxDecrStep = iniReader.GetInteger("raft.default", "max.decr.step", 0);
   mMaxTailedEntryNum = iniReader.GetInteger("raft.default", "max.tailed.entry.num", 0);
+  mEnablePreVote = iniReader.GetBoolean("raft.default", "enable.pre.vote", false);
+  mCatchUpTimeoutInSec = iniReader.GetInteger("raft.default", "membership.catch.up.timeout.in.sec", 3600);
+  mProposeTimeoutInMillis = iniReader.GetInteger("raft.default", "membership.propose.timeout.in.ms", 3000);
+  mHeartBeatIntervalInMillis = iniReader.GetInteger("raft.default", "heartbeat.interval.in.ms",
+                                                    RaftConstants::kHeartBeatIntervalInMillis);
+  mIdleHeartBeatIntervalInMillis = iniReader.GetInteger("raft.default", "idle.heartbeat.interval.in.ms",
+                                                        mHeartBeatIntervalInMillis);
+  mMinElectionTimeoutInMillis = iniReader.GetInteger("raft.default", "min.election.timeout.in.ms",
+                                                     RaftConstants::kMinElectionTimeoutInMillis);
+  mMaxElectionTimeoutInMillis = iniReader.GetInteger("raft.default", "max.election.timeout.in.ms",
+                                                     mMinElectionTimeoutInMillis * 2);
+  mCompressionMinBytes = iniReader.GetInteger("raft.default", "ae.compression.min.bytes", 4096);
   // @formatter:on
 
+  auto compression = CompressionUtil::parse(iniReader.Get("raft.default", "ae.compression", "none"));
+  assert(compression);
+  mCompression = *compression;
+
   assert(mMaxBatchSize != 0
              && mMaxLenInBytes != 0
              && mMaxDecrStep != 0
              && mMaxTailedEntryNum != 0);
 
+  /// follower should hear from leader several times within an election timeout
+  assert(mHeartBeatIntervalInMillis <= mIdleHeartBeatIntervalInMillis
+             && mIdleHeartBeatIntervalInMillis < mMinElectionTimeoutInMillis
+             && mMinElectionTimeoutInMillis < mMaxElectionTimeoutInMillis);
+
   SPDLOG_INFO("ConfigurableVars: "
               "max.batch.size={}, "
               "max.len.in.bytes={}, "
               "max.decr.step={}, "
-              "max.tailed.entry.num={}.",
-              mMaxBatchSize, mMaxLenInBytes, mMaxDecrStep, mMaxTailedEntryNum);
+              "max.tailed.entry.num={}, "
+              "enable.pre.vote={}, "
+              "membership.catch.up.timeout.in.sec={}, "
+              "membership.propose.timeout.in.ms={}, "
+              "heartbeat.interval.in.ms={}, "
+              "idle.heartbeat.interval.in.ms={}, "
+              "min.election.timeout.in.ms={}, "
+              "max.election.timeout.in.ms={}, "
+              "ae.compression={}, "
+              "ae.compression.min.bytes={}.",
+              mMaxBatchSize, mMaxLenInBytes, mMaxDecrStep, mMaxTailedEntryNum, mEnablePreVote,
+              mCatchUpTimeoutInSec, mProposeTimeoutInMillis, mHeartBeatIntervalInMillis, mIdleHeartBeatIntervalInMillis,
+              mMinElectionTimeoutInMillis, mMaxElectionTimeoutInMillis,
+              CompressionUtil::toString(mCompression), mCompressionMinBytes);
 }
 
 void RaftCore::initClusterConf(const ClusterInfo &clusterInfo, const NodeId &selfId) {
+  /// cluster.conf works as the configuration before any entry
+  Configuration configuration;
+
   auto nodes = clusterInfo.getAllNodeInfo();
   for (auto &[nodeId, node] : nodes) {
     std::string host = node.mHostName;
     std::string port = std::to_string(node.mPortForRaft);
     std::string addr = host + ":" + port;
 
+    auto &member = *configuration.add_members();
+    member.set_id(nodeId);
+    member.set_address(addr);
+    member.set_learner(node.mIsLearner);
+
     if (selfId == nodeId) {
       mSelfInfo.mId = selfId;
       mSelfInfo.mAddress = addr;
       mAddressForRaftSvc = "0.0.0.0:" + port;
       mStreamingPort = node.mPortForStream;
+      mIsLearner = node.mIsLearner;
+      mSelfMatchIndexGauge = gringofts::getGauge("match_index", {{"address", addr}});  /// metric-lookup: on startup
     } else {
       Peer peer;
       peer.mId = nodeId;
       peer.mAddress = addr;
+      peer.mIsLearner = node.mIsLearner;
+      peer.mMatchIndexGauge = gringofts::getGauge("match_index", {{"address", addr}});  /// metric-lookup: on startup
       mPeers[nodeId] = peer;
     }
   }
 
   assert(mSelfInfo.mId != kBadID);
-  SPDLOG_INFO("cluster.size={}, self.id={}, self.address={}",
-              mPeers.size() + 1, mSelfInfo.mId, mSelfInfo.mAddress);
+  mConfigurations[0] = configuration;
+
+  SPDLOG_INFO("cluster.size={}, voter.num={}, self.id={}, self.address={}, self.isLearner={}",
+              mPeers.size() + 1, getVoterNum(),
+              mSelfInfo.mId, mSelfInfo.mAddress, mIsLearner);
 }
 
 void RaftCore::initStorage(const INIReader &iniReader) {
@@ -134,14 +212,21 @@ void RaftCore::initStorage(const INIReader &iniReader) {
   crypto->init(iniReader);
 
   mLog = std::make_unique<storage::SegmentLog>(storageDir, crypto, dataSizeLimit, metaSizeLimit);
+  mConfigurationPath = storageDir + "/configurations";
 }
 
 void RaftCore::initService(const INIReader &iniReader, std::shared_ptr<DNSResolver> dnsResolver) {
   mTlsConfOpt = TlsUtil::parseTlsConf(iniReader, "raft.tls");
+  mDNSResolver = dnsResolver;
   /// init RaftServer
   mServer = std::make_unique<RaftServer>(mAddressForRaftSvc, mTlsConfOpt, &mAeRvQueue, dnsResolver);
 
-  /// init RaftClient
+  /// init RaftClient, they share completion queue and its threads
+  if (!mClientLoop) {
+    auto clientThreadNum = iniReader.GetInteger("raft.default", "client.thread.num", 1);
+    mClientLoop = std::make_shared<RaftClientLoop>(clientThreadNum);
+  }
+
   for (auto &p : mPeers) {
     auto &peer = p.second;
     mClients[peer.mId] = std::make_unique<RaftClient>(
@@ -149,7 +234,8 @@ void RaftCore::initService(const INIReader &iniReader, std::shared_ptr<DNSResolv
         mTlsConfOpt,
         dnsResolver,
         peer.mId,
-        &mAeRvQueue);
+        &mAeRvQueue,
+        mClientLoop);
   }
 
   /// sleep 10s, can we receive any AE_req from current Leader ?
@@ -179,10 +265,16 @@ RaftCore::~RaftCore() {
   if (mRaftLoop.joinable()) {
     mRaftLoop.join();
   }
+
+  for (auto &[peerId, client] : mClients) {
+    mClientLoop->retire(std::move(client));
+  }
+  mClients.clear();
 }
 
 void RaftCore::raftLoopMain() {
   pthread_setname_np(pthread_self(), "RaftMainLoop");
+  ThreadPlacement::getInstance().place("RaftMainLoop");
 
   while (running) {
     /// message interaction
@@ -195,8 +287,11 @@ void RaftCore::raftLoopMain() {
     /// 2) support single-server cluster
     advanceCommitIndex();
     becomeLeader();
+    becomeCandidate();
     electionTimeout();
     leadershipTimeout();
+    transferLeadership();
+    changeMembership();
   }
 }
 
@@ -219,6 +314,12 @@ void RaftCore::receiveMessage() {
     auto ptr = dynamic_cast<AppendEntriesRequestEvent &>(*event).mPayload;
     (*ptr->mRequest.mutable_metrics()).set_request_event_dequeue_time(TimeUtil::currentTimeInNanos());
 
+    if (!decompressEntries(&ptr->mRequest)) {
+      SPDLOG_ERROR("{} cannot decompress AE_req from Leader {}.", selfId(), ptr->mRequest.leader_id());
+      ptr->reply(grpc::Status(grpc::StatusCode::DATA_LOSS, "cannot decompress entries"));
+      return;
+    }
+
     auto s = handleAppendEntriesRequest(ptr->mRequest, &ptr->mResponse);
 
     (*ptr->mResponse.mutable_metrics()).set_response_send_time(TimeUtil::currentTimeInNanos());
@@ -230,14 +331,25 @@ void RaftCore::receiveMessage() {
     auto ptr = std::move(dynamic_cast<AppendEntriesResponseEvent &>(*event).mPayload);
     (*ptr->mResponse.mutable_metrics()).set_response_event_dequeue_time(TimeUtil::currentTimeInNanos());
 
+    auto it = mPeers.find(ptr->mPeerId);
+    if (it == mPeers.end()) {
+      /// peer has been removed from cluster
+      return;
+    }
+
     /// turn on switch
-    auto &peer = mPeers[ptr->mPeerId];
-    auto hbIntervalInNano = RaftConstants::kHeartBeatIntervalInMillis * 1000 * 1000;
+    auto &peer = it->second;
+    auto hbIntervalInNano = mHeartBeatIntervalInMillis * 1000 * 1000;
     peer.mNextRequestTimeInNano = std::max(peer.mLastRequestTimeInNano + hbIntervalInNano,
                                            TimeUtil::currentTimeInNanos());
 
     if (ptr->mStatus.ok()) {
       peer.mLastResponseTimeInNano = TimeUtil::currentTimeInNanos();
+
+      auto &accepted = ptr->mResponse.accepted_compressions();
+      peer.mAcceptCompression = std::find(accepted.begin(), accepted.end(),
+                                          static_cast<int>(mCompression)) != accepted.end();
+
       handleAppendEntriesResponse(ptr->mResponse);
     } else {
       peer.mSuppressBulkData = true;
@@ -254,10 +366,15 @@ void RaftCore::receiveMessage() {
   /// RV_resp
   if (event->mType == RaftEventBase::Type::RequestVoteResponse) {
     auto ptr = std::move(dynamic_cast<RequestVoteResponseEvent &>(*event).mPayload);
-    auto &peer = mPeers[ptr->mPeerId];
+    auto it = mPeers.find(ptr->mPeerId);
+    if (it == mPeers.end()) {
+      /// peer has been removed from cluster
+      return;
+    }
+    auto &peer = it->second;
 
     /// turn on switch
-    auto hbIntervalInNano = RaftConstants::kHeartBeatIntervalInMillis * 1000 * 1000;
+    auto hbIntervalInNano = mHeartBeatIntervalInMillis * 1000 * 1000;
     peer.mNextRequestTimeInNano = std::max(peer.mLastRequestTimeInNano + hbIntervalInNano,
                                            TimeUtil::currentTimeInNanos());
 
@@ -267,6 +384,21 @@ void RaftCore::receiveMessage() {
     }
   }
 
+  /// TN_req
+  if (event->mType == RaftEventBase::Type::TimeoutNowRequest) {
+    auto ptr = dynamic_cast<TimeoutNowRequestEvent &>(*event).mPayload;
+    auto s = handleTimeoutNowRequest(ptr->mRequest, &ptr->mResponse);
+    ptr->reply(std::move(s));
+  }
+
+  /// TN_resp
+  if (event->mType == RaftEventBase::Type::TimeoutNowResponse) {
+    auto ptr = std::move(dynamic_cast<TimeoutNowResponseEvent &>(*event).mPayload);
+    if (ptr->mStatus.ok()) {
+      handleTimeoutNowResponse(ptr->mResponse);
+    }
+  }
+
   /// Cli_req
   if (event->mType == RaftEventBase::Type::ClientRequest) {
     ClientRequests clientRequests = std::move(dynamic_cast<ClientRequestsEvent &>(*event).mPayload);
@@ -278,6 +410,18 @@ void RaftCore::receiveMessage() {
     SyncRequest syncRequest = std::move(dynamic_cast<SyncRequestsEvent &>(*event).mPayload);
     handleSyncRequest(std::move(syncRequest));
   }
+
+  /// transfer leadership
+  if (event->mType == RaftEventBase::Type::TransferLeadership) {
+    auto request = std::move(dynamic_cast<TransferLeadershipEvent &>(*event).mPayload);
+    handleTransferLeadership(std::move(request));
+  }
+
+  /// change membership
+  if (event->mType == RaftEventBase::Type::ChangeMembership) {
+    auto request = std::move(dynamic_cast<ChangeMembershipEvent &>(*event).mPayload);
+    handleChangeMembership(std::move(request));
+  }
 }
 
 void RaftCore::appendEntries() {
@@ -288,13 +432,19 @@ void RaftCore::appendEntries() {
   for (auto &p : mPeers) {
     auto &peer = p.second;
 
-    if (peer.mNextRequestTimeInNano > TimeUtil::currentTimeInNanos()) {
+    auto nowInNano = TimeUtil::currentTimeInNanos();
+    if (peer.mNextRequestTimeInNano > nowInNano) {
+      continue;
+    }
+
+    /// nothing to replicate, heartbeat is not due until idle interval elapses
+    auto idleIntervalInNano = mIdleHeartBeatIntervalInMillis * 1000 * 1000;
+    if (!hasPendingData(peer) && nowInNano < peer.mLastRequestTimeInNano + idleIntervalInNano) {
       continue;
     }
 
     /// build AE_req
     AppendEntries::Request request;
-    (*request.mutable_metrics()).set_request_create_time(TimeUtil::currentTimeInNanos());
 
     auto currentTerm = mLog->getCurrentTerm();
 
@@ -309,10 +459,14 @@ void RaftCore::appendEntries() {
                                    mMaxLenInBytes, mMaxBatchSize, &entries);
     }
 
-    (*request.mutable_metrics()).set_term(currentTerm);
-    (*request.mutable_metrics()).set_leader_id(mSelfInfo.mId);
-    (*request.mutable_metrics()).set_entries_count(batchSize);
-    (*request.mutable_metrics()).set_entries_reading_done_time(TimeUtil::currentTimeInNanos());
+    /// keep heartbeat lightweight, metrics are only for AE_req carrying entries
+    if (batchSize > 0) {
+      (*request.mutable_metrics()).set_request_create_time(nowInNano);
+      (*request.mutable_metrics()).set_term(currentTerm);
+      (*request.mutable_metrics()).set_leader_id(mSelfInfo.mId);
+      (*request.mutable_metrics()).set_entries_count(batchSize);
+      (*request.mutable_metrics()).set_entries_reading_done_time(TimeUtil::currentTimeInNanos());
+    }
 
     auto commitIndex = std::min(mCommitIndex.load(), prevLogIndex + batchSize);
 
@@ -322,11 +476,17 @@ void RaftCore::appendEntries() {
     request.set_prev_log_term(prevLogTerm);
     request.set_commit_index(commitIndex);
 
+    if (batchSize > 0 && mCompression != CompressionType::None && peer.mAcceptCompression) {
+      compressEntries(&entries, &request);
+    }
+
     for (auto &entry : entries) {
       *request.add_entries() = std::move(entry);
     }
 
-    (*request.mutable_metrics()).set_request_send_time(TimeUtil::currentTimeInNanos());
+    if (batchSize > 0) {
+      (*request.mutable_metrics()).set_request_send_time(TimeUtil::currentTimeInNanos());
+    }
 
     /// send AE_req
     auto &client = *mClients[peer.mId];
@@ -334,31 +494,32 @@ void RaftCore::appendEntries() {
 
     /// avoid printing trace for heartbeat.
     if (batchSize > 0) {
-      SPDLOG_INFO("{} send AE_req to Follower {} for term {}, copy {} entries",
-                  selfId(), peer.mId, currentTerm, batchSize);
+      SPDLOG_INFO_EVERY_MS(1000, "{} send AE_req to Follower {} for term {}, copy {} entries",
+                           selfId(), peer.mId, currentTerm, batchSize);
     }
 
     /// turn off switch
     peer.mNextRequestTimeInNano = std::numeric_limits<uint64_t>::max();
     peer.mLastRequestTimeInNano = TimeUtil::currentTimeInNanos();
+    peer.mCommitIndexSent = commitIndex;
   }
 }
 
 void RaftCore::requestVote() {
-  if (mRaftRole != RaftRole::Candidate) {
+  if (mRaftRole != RaftRole::Candidate && !mPreVoting) {
     return;
   }
 
   for (auto &p : mPeers) {
     auto &peer = p.second;
 
-    if (peer.mRequestVoteDone
+    if (peer.mIsLearner || peer.mRequestVoteDone
         || peer.mNextRequestTimeInNano > TimeUtil::currentTimeInNanos()) {
       continue;
     }
 
-    /// build RV_req
-    auto currentTerm = mLog->getCurrentTerm();
+    /// build RV_req, pre-vote asks for the term we would use
+    auto currentTerm = mPreVoting ? mLog->getCurrentTerm() + 1 : mLog->getCurrentTerm();
     auto lastLogIndex = mLog->getLastLogIndex();
     auto lastLogTerm = termOfLogEntryAt(lastLogIndex);
 
@@ -369,14 +530,16 @@ void RaftCore::requestVote() {
     request.set_last_log_index(lastLogIndex);
     request.set_last_log_term(lastLogTerm);
     request.set_create_time_in_nano(TimeUtil::currentTimeInNanos());
+    request.set_pre_vote(mPreVoting);
+    request.set_leadership_transfer(mLeadershipTransferElection);
 
     /// send RV_req
     auto &client = *mClients[peer.mId];
     client.requestVote(request);
 
-    SPDLOG_INFO("{} send RV_req to Node {} for term {} "
+    SPDLOG_INFO("{} send {}RV_req to Node {} for term {} "
                 "with <lastLogIndex, lastLogTerm>=<{}, {}>",
-                selfId(), peer.mId, currentTerm, lastLogIndex, lastLogTerm);
+                selfId(), mPreVoting ? "pre-vote " : "", peer.mId, currentTerm, lastLogIndex, lastLogTerm);
 
     /// turn off switch
     peer.mNextRequestTimeInNano = std::numeric_limits<uint64_t>::max();
@@ -384,6 +547,67 @@ void RaftCore::requestVote() {
   }
 }
 
+void RaftCore::compressEntries(std::vector<LogEntry> *entries, AppendEntries::Request *request) {
+  uint64_t rawSize = 0;
+  for (auto &entry : *entries) {
+    /// payload is encrypted by RaftLogStore before it reaches raft, ciphertext does not compress
+    if (entry.version().secret_key_version() != SecretKey::kInvalidSecKeyVersion) {
+      return;
+    }
+    rawSize += entry.ByteSizeLong();
+  }
+
+  if (rawSize < mCompressionMinBytes) {
+    return;
+  }
+
+  EntryBatch batch;
+  for (auto &entry : *entries) {
+    *batch.add_entries() = std::move(entry);
+  }
+  entries->clear();
+
+  auto raw = batch.SerializeAsString();
+  std::string compressed;
+
+  if (!CompressionUtil::compress(mCompression, raw, &compressed) || compressed.size() >= raw.size()) {
+    /// send them uncompressed
+    for (auto &entry : *batch.mutable_entries()) {
+      entries->push_back(std::move(entry));
+    }
+    return;
+  }
+
+  mAeUncompressedBytesCounter.increase(raw.size());
+  mAeCompressedBytesCounter.increase(compressed.size());
+
+  request->set_compression(static_cast<Compression>(mCompression));
+  request->set_uncompressed_size(raw.size());
+  request->set_compressed_entries(std::move(compressed));
+}
+
+bool RaftCore::decompressEntries(AppendEntries::Request *request) {
+  if (request->compression() == COMPRESSION_NONE) {
+    return true;
+  }
+
+  std::string raw;
+  if (!CompressionUtil::decompress(static_cast<CompressionType>(request->compression()),
+                                   request->compressed_entries(), request->uncompressed_size(), &raw)) {
+    return false;
+  }
+
+  EntryBatch batch;
+  if (!batch.ParseFromString(raw)) {
+    return false;
+  }
+
+  request->mutable_entries()->Swap(batch.mutable_entries());
+  request->clear_compressed_entries();
+  request->set_compression(COMPRESSION_NONE);
+  return true;
+}
+
 grpc::Status RaftCore::handleAppendEntriesRequest(const AppendEntries::Request &request,
                                           AppendEntries::Response *response) {
   auto currentTerm = mLog->getCurrentTerm();
@@ -400,6 +624,8 @@ grpc::Status RaftCore::handleAppendEntriesRequest(const AppendEntries::Request &
   response->set_saved_prev_log_index(request.prev_log_index());
   response->set_last_log_index(mLog->getLastLogIndex());
   response->set_match_index(0);
+  response->add_accepted_compressions(COMPRESSION_LZ4);
+  response->add_accepted_compressions(COMPRESSION_ZSTD);
 
   if (request.term() < currentTerm) {
     SPDLOG_INFO("{} reject AE_req from Node {}, remoteTerm {} < currentTerm {}.",
@@ -427,6 +653,8 @@ grpc::Status RaftCore::handleAppendEntriesRequest(const AppendEntries::Request &
 
   /// receive AE_req from current leader
   updateElectionTimePoint();
+  mLastLeaderContactTimeInNano = TimeUtil::currentTimeInNanos();
+  mPreVoting = false;
 
   if (!mLeaderId) {
     mLeaderId = request.leader_id();
@@ -469,6 +697,11 @@ grpc::Status RaftCore::handleAppendEntriesRequest(const AppendEntries::Request &
       /// truncate conflict entries
       auto lastIndexKept = entry.index() - 1;
       mLog->truncateSuffix(lastIndexKept);
+      truncateConfiguration(lastIndexKept);
+      auto &tracer = CommandTracer::getInstance();
+      if (tracer.hasBoundTraces()) {
+        tracer.onTruncated(lastIndexKept);
+      }
     }
 
     entries.push_back(entry);
@@ -477,16 +710,23 @@ grpc::Status RaftCore::handleAppendEntriesRequest(const AppendEntries::Request &
   assert(mLog->appendEntries(entries));   /// mLog CAN handle empty entries.
   (*response->mutable_metrics()).set_entries_writing_done_time(TimeUtil::currentTimeInNanos());
 
+  /// configuration takes effect once appended, no need to wait for commit
+  for (auto &entry : entries) {
+    if (entry.has_configuration()) {
+      appendConfiguration(entry.configuration());
+    }
+  }
+
   /// adjust AE_resp
   response->set_success(true);
   response->set_last_log_index(mLog->getLastLogIndex());
   response->set_match_index(request.prev_log_index() + request.entries().size());
 
   if (!request.entries().empty()) {
-    SPDLOG_INFO("{} accept AE_req from Leader {} at <prevLogIndex, prevLogTerm>=<{}, {}>, "
-                "receive {} entries, append {} entries",
-                selfId(), request.leader_id(), request.prev_log_index(), request.prev_log_term(),
-                request.entries().size(), entries.size());
+    SPDLOG_INFO_EVERY_MS(1000, "{} accept AE_req from Leader {} at <prevLogIndex, prevLogTerm>=<{}, {}>, "
+                         "receive {} entries, append {} entries",
+                         selfId(), request.leader_id(), request.prev_log_index(), request.prev_log_term(),
+                         request.entries().size(), entries.size());
   }
 
   if (mCommitIndex < request.commit_index()) {
@@ -496,6 +736,7 @@ grpc::Status RaftCore::handleAppendEntriesRequest(const AppendEntries::Request &
 
     mCommitIndex = request.commit_index();
     assert(mCommitIndex <= mLog->getLastLogIndex());
+    commitConfiguration();
 
     printStatus("FollowerIncreaseCommitIndex");
   }
@@ -525,7 +766,13 @@ void RaftCore::handleAppendEntriesResponse(const AppendEntries::Response &respon
     return;
   }
 
-  auto &peer = mPeers[response.id()];
+  auto peerIt = mPeers.find(response.id());
+  if (peerIt == mPeers.end()) {
+    /// late response of a call to a removed member
+    SPDLOG_INFO("{} ignore AE_resp from Node {}, not a member any longer.", selfId(), response.id());
+    return;
+  }
+  auto &peer = peerIt->second;
 
   /// ignore duplicate AE_resp
   if (response.saved_prev_log_index() != peer.mNextIndex - 1) {
@@ -579,21 +826,39 @@ grpc::Status RaftCore::handleRequestVoteRequest(const RequestVote::Request &requ
   response->set_create_time_in_nano(TimeUtil::currentTimeInNanos());
   response->set_id(mSelfInfo.mId);
   response->set_saved_term(request.term());
+  /// candidate tells pre-vote from real vote by it, set before any rejection
+  response->set_pre_vote(request.pre_vote());
 
   if (mRaftRole == RaftRole::Syncer) {
     SPDLOG_WARN("Syncer mode won't process RV request");
     return grpc::Status::CANCELLED;
   }
 
+  if (mIsLearner) {
+    SPDLOG_WARN("{} is learner, reject RV_req from Node {}.", selfId(), request.candidate_id());
+    return grpc::Status::OK;
+  }
+
+  /// candidate removed from cluster should not disrupt the others
+  auto candidate = mPeers.find(request.candidate_id());
+  if (candidate == mPeers.end() || candidate->second.mIsLearner) {
+    SPDLOG_WARN("{} reject RV_req from Node {}, not a voter in current configuration.",
+                selfId(), request.candidate_id());
+    return grpc::Status::OK;
+  }
+
   if (request.term() < currentTerm) {
     SPDLOG_INFO("{} reject RV_req from Node {}, remoteTerm {} < currentTerm {}.",
                 selfId(), request.candidate_id(), request.term(), currentTerm);
     return grpc::Status::OK;
   }
 
-  if (request.term() > currentTerm) {
-    response->set_term(request.term());
-    stepDown(request.term());
+  /// do not let a node that cannot hear from leader disrupt current term
+  if (mEnablePreVote && request.term() > currentTerm
+      && !request.leadership_transfer() && inLeaderLease()) {
+    SPDLOG_INFO("{} reject RV_req from Node {} for term {}, current Leader {} is alive.",
+                selfId(), request.candidate_id(), request.term(), mLeaderId);
+    return grpc::Status::OK;
   }
 
   auto lastLogIndex = mLog->getLastLogIndex();
@@ -602,6 +867,20 @@ grpc::Status RaftCore::handleRequestVoteRequest(const RequestVote::Request &requ
   bool logIsOk = request.last_log_term() > lastLogTerm
       || (request.last_log_term() == lastLogTerm && request.last_log_index() >= lastLogIndex);
 
+  if (request.pre_vote()) {
+    /// neither update term nor record vote for pre-vote
+    response->set_vote_granted(request.term() > currentTerm && logIsOk);
+    SPDLOG_INFO("{} {} pre-vote of Node {} for term {}, logIsOk={}.",
+                selfId(), response->vote_granted() ? "grant" : "reject",
+                request.candidate_id(), request.term(), logIsOk);
+    return grpc::Status::OK;
+  }
+
+  if (request.term() > currentTerm) {
+    response->set_term(request.term());
+    stepDown(request.term());
+  }
+
   auto voteFor = mLog->getVote();
 
   if (logIsOk && (voteFor == 0 || voteFor == request.candidate_id())) {
@@ -623,6 +902,33 @@ grpc::Status RaftCore::handleRequestVoteRequest(const RequestVote::Request &requ
 void RaftCore::handleRequestVoteResponse(const RequestVote::Response &response) {
   auto currentTerm = mLog->getCurrentTerm();
 
+  if (response.pre_vote()) {
+    if (!mPreVoting || currentTerm + 1 != response.saved_term()) {
+      SPDLOG_INFO("{} ignore stale pre-vote RV_resp from Node {} for term {}",
+                  selfId(), response.id(), response.saved_term());
+      return;
+    }
+
+    if (response.term() > currentTerm) {
+      SPDLOG_INFO("{} receive pre-vote RV_resp from Node {}, remoteTerm {} > currentTerm {}",
+                  selfId(), response.id(), response.term(), currentTerm);
+      stepDown(response.term());
+      return;
+    }
+
+    auto peerIt = mPeers.find(response.id());
+    if (peerIt == mPeers.end()) {
+      SPDLOG_INFO("{} ignore pre-vote RV_resp from Node {}, not a member any longer.", selfId(), response.id());
+      return;
+    }
+    auto &peer = peerIt->second;
+    peer.mRequestVoteDone = true;
+    peer.mHaveVote = response.vote_granted();
+    SPDLOG_INFO("{} {} pre-vote from Node {} for term {}.",
+                selfId(), response.vote_granted() ? "got" : "is rejected", response.id(), currentTerm + 1);
+    return;
+  }
+
   if (currentTerm != response.saved_term() || mRaftRole != RaftRole::Candidate) {
     SPDLOG_INFO("{} ignore stale RV_resp from Node {} for term {}",
                 selfId(), response.id(), response.saved_term());
@@ -636,7 +942,12 @@ void RaftCore::handleRequestVoteResponse(const RequestVote::Response &response)
     return;
   }
 
-  auto &peer = mPeers[response.id()];
+  auto peerIt = mPeers.find(response.id());
+  if (peerIt == mPeers.end()) {
+    SPDLOG_INFO("{} ignore RV_resp from Node {}, not a member any longer.", selfId(), response.id());
+    return;
+  }
+  auto &peer = peerIt->second;
   peer.mRequestVoteDone = true;
 
   if (response.vote_granted()) {
@@ -665,6 +976,32 @@ void RaftCore::handleClientRequests(ClientRequests clientRequests) {
     return;
   }
 
+  if (mPendingTransfer) {
+    /// stop accepting client requests, so that transferee can catch up
+    for (auto &clientRequest : clientRequests) {
+      auto handle = clientRequest.mRequestHandle;
+      if (handle != nullptr) {
+        handle->fillResultAndReply(301, "LeadershipTransferring", mPendingTransfer->mTargetId);
+      }
+    }
+    SPDLOG_WARN("{} is transferring leadership to Node {}, discard {} entries.",
+                selfId(), mPendingTransfer->mTargetId, clientRequests.size());
+    return;
+  }
+
+  if (mProposedByNoop) {
+    /// indices app layer assigned collide with the noop, leader steps down once it is committed
+    for (auto &clientRequest : clientRequests) {
+      auto handle = clientRequest.mRequestHandle;
+      if (handle != nullptr) {
+        handle->fillResultAndReply(301, "MembershipChanging", mLeaderId);
+      }
+    }
+    SPDLOG_WARN("{} is committing configuration carried by noop, discard {} entries.",
+                selfId(), clientRequests.size());
+    return;
+  }
+
   /// validate and filter entries that writes to WAL
   auto currentTerm = mLog->getCurrentTerm();
   auto lastLogIndex = mLog->getLastLogIndex();
@@ -687,8 +1024,30 @@ void RaftCore::handleClientRequests(ClientRequests clientRequests) {
     }
   }
 
-  SPDLOG_INFO("{} on term {} append {} entry", selfId(), currentTerm, entries.size());
+  /// piggyback proposed configuration on the first entry. leader must have
+  /// committed an entry of its term, so that no earlier configuration is pending.
+  if (mProposedConfiguration && mProposedConfigurationIndex == 0
+      && !entries.empty() && termOfLogEntryAt(mCommitIndex) == currentTerm) {
+    auto &entry = entries.front();
+    mProposedConfiguration->set_index(entry.index());
+    *entry.mutable_configuration() = *mProposedConfiguration;
+    mProposedConfigurationIndex = entry.index();
+  }
+
+  SPDLOG_INFO_EVERY_MS(1000, "{} on term {} append {} entry", selfId(), currentTerm, entries.size());
+  auto appendTimeInNano = TimeUtil::currentTimeInNanos();
   mLog->appendEntries(entries);
+
+  auto &tracer = CommandTracer::getInstance();
+  if (tracer.hasBoundTraces() && !entries.empty()) {
+    tracer.onRaftAppended(entries.front().index(), entries.back().index(),
+                          appendTimeInNano, TimeUtil::currentTimeInNanos());
+  }
+
+  if (mProposedConfigurationIndex != 0 && !entries.empty()
+      && mProposedConfigurationIndex == entries.front().index()) {
+    appendConfiguration(entries.front().configuration());
+  }
 }
 
 void RaftCore::handleSyncRequest(SyncRequest syncRequest) {
@@ -711,6 +1070,472 @@ void RaftCore::handleSyncRequest(SyncRequest syncRequest) {
   mCommitIndex = mLog->getLastLogIndex();
 }
 
+grpc::Status RaftCore::handleTimeoutNowRequest(const TimeoutNow::Request &request,
+                                              TimeoutNow::Response *response) {
+  auto currentTerm = mLog->getCurrentTerm();
+
+  /// prepare TN_resp
+  response->set_term(currentTerm);
+  response->set_id(mSelfInfo.mId);
+  response->set_saved_term(request.term());
+
+  if (mRaftRole == RaftRole::Syncer) {
+    SPDLOG_WARN("Syncer mode won't process TN request");
+    return grpc::Status::CANCELLED;
+  }
+
+  if (request.term() != currentTerm || mRaftRole != RaftRole::Follower || mIsLearner) {
+    SPDLOG_INFO("{} on term {} ignore TN_req from Node {} for term {}.",
+                selfId(), currentTerm, request.leader_id(), request.term());
+    return grpc::Status::OK;
+  }
+
+  SPDLOG_INFO("{} receive TN_req from Leader {} on term {}, start election now.",
+              selfId(), request.leader_id(), currentTerm);
+  startElection(true);
+  return grpc::Status::OK;
+}
+
+void RaftCore::handleTimeoutNowResponse(const TimeoutNow::Response &response) {
+  auto currentTerm = mLog->getCurrentTerm();
+
+  if (response.term() > currentTerm) {
+    SPDLOG_INFO("{} receive TN_resp from Node {}, remoteTerm {} > currentTerm {}",
+                selfId(), response.id(), response.term(), currentTerm);
+    stepDown(response.term());
+  }
+}
+
+void RaftCore::handleTransferLeadership(TransferLeadershipRequest request) {
+  if (mRaftRole != RaftRole::Leader) {
+    request.mCallback(false, "NotLeader");
+    return;
+  }
+
+  if (mPendingTransfer) {
+    request.mCallback(false, "TransferInProgress");
+    return;
+  }
+
+  /// pick the most up-to-date peer if target is not specified
+  if (request.mTargetId == kBadID) {
+    uint64_t maxMatchIndex = 0;
+    for (auto &[id, peer] : mPeers) {
+      if (peer.mIsLearner) {
+        continue;
+      }
+      if (request.mTargetId == kBadID || peer.mMatchIndex > maxMatchIndex) {
+        request.mTargetId = id;
+        maxMatchIndex = peer.mMatchIndex;
+      }
+    }
+  }
+
+  if (request.mTargetId == mSelfInfo.mId) {
+    request.mCallback(true, "AlreadyLeader");
+    return;
+  }
+
+  auto it = mPeers.find(request.mTargetId);
+  if (it == mPeers.end() || it->second.mIsLearner) {
+    request.mCallback(false, "UnknownTarget");
+    return;
+  }
+
+  SPDLOG_INFO("{} on term {} start transferring leadership to Node {}, "
+              "lastLogIndex={}, matchIndex={}.",
+              selfId(), mLog->getCurrentTerm(), request.mTargetId,
+              mLog->getLastLogIndex(), it->second.mMatchIndex);
+
+  mPendingTransfer = std::move(request);
+  mTransferStartTimeInNano = TimeUtil::currentTimeInNanos();
+  mTimeoutNowSent = false;
+
+  /// send AE_req to transferee right away if no one is in flight
+  auto &peer = it->second;
+  if (peer.mNextRequestTimeInNano != std::numeric_limits<uint64_t>::max()) {
+    peer.mNextRequestTimeInNano = TimeUtil::currentTimeInNanos();
+  }
+}
+
+void RaftCore::transferLeadership() {
+  if (mRaftRole != RaftRole::Leader || !mPendingTransfer) {
+    return;
+  }
+
+  auto elapseInMillis = (TimeUtil::currentTimeInNanos() - mTransferStartTimeInNano) / 1000000.0;
+  if (elapseInMillis > mMaxElectionTimeoutInMillis) {
+    auto currentTerm = mLog->getCurrentTerm();
+    SPDLOG_WARN("{} on term {} fail to transfer leadership to Node {} within {}ms.",
+                selfId(), currentTerm, mPendingTransfer->mTargetId, elapseInMillis);
+    finishTransferLeadership(false, "TransferTimeout");
+
+    /// client requests have been rejected during transfer, which breaks
+    /// the indices app layer assigned afterwards, step down to let it recover.
+    stepDown(currentTerm + 1);
+    return;
+  }
+
+  auto peerIt = mPeers.find(mPendingTransfer->mTargetId);
+  if (peerIt == mPeers.end()) {
+    SPDLOG_WARN("{} on term {} fail to transfer leadership to Node {}, not a member any longer.",
+                selfId(), mLog->getCurrentTerm(), mPendingTransfer->mTargetId);
+    finishTransferLeadership(false, "TargetRemoved");
+    return;
+  }
+
+  auto &peer = peerIt->second;
+  if (mTimeoutNowSent || peer.mMatchIndex < mLog->getLastLogIndex()) {
+    return;
+  }
+
+  /// transferee is up to date, ask it to start election immediately
+  TimeoutNow::Request request;
+  request.set_term(mLog->getCurrentTerm());
+  request.set_leader_id(mSelfInfo.mId);
+
+  /// peer and its client are added and removed together
+  auto &client = *mClients.at(peer.mId);
+  client.timeoutNow(request);
+  mTimeoutNowSent = true;
+
+  SPDLOG_INFO("{} send TN_req to Follower {} for term {}, matchIndex={}, catch up cost {}ms.",
+              selfId(), peer.mId, mLog->getCurrentTerm(), peer.mMatchIndex, elapseInMillis);
+}
+
+void RaftCore::finishTransferLeadership(bool success, const std::string &message) {
+  if (!mPendingTransfer) {
+    return;
+  }
+
+  auto transferCostInMillis = (TimeUtil::currentTimeInNanos() - mTransferStartTimeInNano) / 1000000.0;
+  SPDLOG_INFO("{} finish transferring leadership to Node {}, success={}, message={}, cost={}ms.",
+              selfId(), mPendingTransfer->mTargetId, success, message, transferCostInMillis);
+
+  auto callback = std::move(mPendingTransfer->mCallback);
+  mPendingTransfer.reset();
+  mTimeoutNowSent = false;
+
+  if (callback) {
+    callback(success, message);
+  }
+}
+
+void RaftCore::handleChangeMembership(ChangeMembershipRequest request) {
+  if (mRaftRole != RaftRole::Leader) {
+    request.mCallback(false, "NotLeader");
+    return;
+  }
+
+  if (mPendingMembershipChange) {
+    request.mCallback(false, "ChangeInProgress");
+    return;
+  }
+
+  auto configuration = latestConfiguration();
+  auto &target = request.mMember;
+
+  auto *members = configuration.mutable_members();
+  auto it = std::find_if(members->begin(), members->end(),
+                         [&target](const Member &member) { return member.id() == target.mId; });
+
+  if (request.mType == ChangeMembershipRequest::Type::AddMember) {
+    if (it != members->end() && !it->learner()) {
+      request.mCallback(true, "AlreadyMember");
+      return;
+    }
+
+    if (it == members->end()) {
+      if (target.mId == kBadID || target.mAddress.empty()) {
+        request.mCallback(false, "InvalidMember");
+        return;
+      }
+
+      /// catch up as learner before becoming a voter
+      std::unique_lock<std::shared_mutex> lock(mPeersMutex);
+      addPeer(target.mId, target.mAddress, true);
+    }
+
+    SPDLOG_INFO("{} on term {} start adding Node {}, lastLogIndex={}.",
+                selfId(), mLog->getCurrentTerm(), target.toString(), mLog->getLastLogIndex());
+  } else {
+    if (it == members->end()) {
+      request.mCallback(true, "NotMember");
+      return;
+    }
+
+    auto voterNum = std::count_if(members->begin(), members->end(),
+                                  [](const Member &member) { return !member.learner(); });
+    if (!it->learner() && voterNum == 1) {
+      request.mCallback(false, "LastVoter");
+      return;
+    }
+
+    members->erase(it);
+    mProposedConfiguration = std::move(configuration);
+    mProposeStartTimeInNano = TimeUtil::currentTimeInNanos();
+
+    SPDLOG_INFO("{} on term {} start removing Node {}.",
+                selfId(), mLog->getCurrentTerm(), target.mId);
+  }
+
+  mPendingMembershipChange = std::move(request);
+  mMembershipChangeStartTimeInNano = TimeUtil::currentTimeInNanos();
+}
+
+void RaftCore::changeMembership() {
+  if (mRaftRole != RaftRole::Leader || !mPendingMembershipChange) {
+    return;
+  }
+
+  auto elapseInSec = (TimeUtil::currentTimeInNanos() - mMembershipChangeStartTimeInNano) / 1000000000.0;
+  if (mProposedConfigurationIndex == 0 && elapseInSec > mCatchUpTimeoutInSec) {
+    SPDLOG_WARN("{} fail to change membership within {}s, no entry carries new configuration "
+                "or new member cannot catch up.", selfId(), elapseInSec);
+    finishChangeMembership(false, "ChangeTimeout");
+    return;
+  }
+
+  if (mProposedConfiguration) {
+    proposeConfigurationByNoop();
+    return;
+  }
+
+  /// only AddMember reaches here, wait for new member to catch up
+  auto &target = mPendingMembershipChange->mMember;
+  auto peerIt = mPeers.find(target.mId);
+  if (peerIt == mPeers.end()) {
+    SPDLOG_WARN("{} fail to change membership, Node {} is not a peer any longer.", selfId(), target.mId);
+    finishChangeMembership(false, "TargetRemoved");
+    return;
+  }
+
+  auto &peer = peerIt->second;
+  if (peer.mMatchIndex < mCommitIndex) {
+    return;
+  }
+
+  auto configuration = latestConfiguration();
+  auto *members = configuration.mutable_members();
+  auto it = std::find_if(members->begin(), members->end(),
+                         [&target](const Member &member) { return member.id() == target.mId; });
+  auto &member = it != members->end() ? *it : *configuration.add_members();
+  member.set_id(peer.mId);
+  member.set_address(peer.mAddress);
+  member.set_learner(false);
+
+  mProposedConfiguration = std::move(configuration);
+  mProposeStartTimeInNano = TimeUtil::currentTimeInNanos();
+
+  SPDLOG_INFO("{} Node {} catches up with matchIndex={}, commitIndex={}, cost {}s, "
+              "propose it as voter.", selfId(), peer.mId, peer.mMatchIndex, mCommitIndex, elapseInSec);
+}
+
+void RaftCore::proposeConfigurationByNoop() {
+  auto currentTerm = mLog->getCurrentTerm();
+  if (mProposedConfigurationIndex != 0 || termOfLogEntryAt(mCommitIndex) != currentTerm) {
+    return;
+  }
+
+  auto elapseInMillis = (TimeUtil::currentTimeInNanos() - mProposeStartTimeInNano) / 1000000.0;
+  if (elapseInMillis <= mProposeTimeoutInMillis) {
+    return;
+  }
+
+  /// no client entry on an idle cluster, carry configuration by a noop of leader
+  LogEntry entry;
+
+  entry.mutable_version()->set_secret_key_version(mLog->getLatestSecKeyVersion());
+  entry.set_term(currentTerm);
+  entry.set_index(mLog->getLastLogIndex() + 1);
+  entry.set_noop(true);
+  entry.set_checksum(TimeUtil::currentTimeInNanos());
+
+  mProposedConfiguration->set_index(entry.index());
+  *entry.mutable_configuration() = *mProposedConfiguration;
+  mProposedConfigurationIndex = entry.index();
+  mProposedByNoop = true;
+
+  SPDLOG_INFO("{} on term {} no client entry carries configuration within {}ms, append noop at index {}.",
+              selfId(), currentTerm, elapseInMillis, entry.index());
+
+  assert(mLog->appendEntry(entry));
+  appendConfiguration(entry.configuration());
+}
+
+void RaftCore::finishChangeMembership(bool success, const std::string &message) {
+  if (!mPendingMembershipChange) {
+    return;
+  }
+
+  auto changeCostInSec = (TimeUtil::currentTimeInNanos() - mMembershipChangeStartTimeInNano) / 1000000000.0;
+  SPDLOG_INFO("{} finish changing membership of Node {}, success={}, message={}, cost={}s.",
+              selfId(), mPendingMembershipChange->mMember.mId, success, message, changeCostInSec);
+
+  auto callback = std::move(mPendingMembershipChange->mCallback);
+  mPendingMembershipChange.reset();
+  mProposedConfiguration.reset();
+  mProposedConfigurationIndex = 0;
+  mProposedByNoop = false;
+
+  /// drop the learner that did not make it into configuration
+  applyConfiguration(latestConfiguration());
+
+  if (callback) {
+    callback(success, message);
+  }
+}
+
+void RaftCore::appendConfiguration(const Configuration &configuration) {
+  SPDLOG_INFO("{} append configuration at index {}: {}",
+              selfId(), configuration.index(), configuration.ShortDebugString());
+
+  mConfigurations[configuration.index()] = configuration;
+  persistConfigurations();
+  applyConfiguration(configuration);
+}
+
+void RaftCore::truncateConfiguration(uint64_t lastIndexKept) {
+  if (mConfigurations.rbegin()->first <= lastIndexKept) {
+    return;
+  }
+
+  mConfigurations.erase(mConfigurations.upper_bound(lastIndexKept), mConfigurations.end());
+  /// the latest committed configuration is never truncated
+  assert(!mConfigurations.empty());
+
+  SPDLOG_INFO("{} truncate configurations after index {}, fall back to the one at index {}.",
+              selfId(), lastIndexKept, mConfigurations.rbegin()->first);
+
+  persistConfigurations();
+  applyConfiguration(latestConfiguration());
+}
+
+void RaftCore::commitConfiguration() {
+  auto it = mConfigurations.upper_bound(mCommitIndex);
+  if (it == mConfigurations.begin() || std::prev(it) == mConfigurations.begin()) {
+    return;
+  }
+
+  /// keep the latest committed one
+  mConfigurations.erase(mConfigurations.begin(), std::prev(it));
+  persistConfigurations();
+}
+
+void RaftCore::applyConfiguration(const Configuration &configuration) {
+  std::map<uint64_t, const Member *> members;
+  bool isMember = false;
+
+  for (auto &member : configuration.members()) {
+    if (member.id() == mSelfInfo.mId) {
+      mIsLearner = member.learner();
+      isMember = true;
+    } else {
+      members[member.id()] = &member;
+    }
+  }
+
+  /// removed from cluster, never start election again
+  if (!isMember) {
+    mIsLearner = true;
+  }
+
+  /// new member catching up is not in configuration yet
+  auto catchingUpId = mPendingMembershipChange
+      && mPendingMembershipChange->mType == ChangeMembershipRequest::Type::AddMember
+      ? mPendingMembershipChange->mMember.mId : kBadID;
+
+  std::unique_lock<std::shared_mutex> lock(mPeersMutex);
+
+  for (auto it = mPeers.begin(); it != mPeers.end();) {
+    if (members.count(it->first) == 0 && it->first != catchingUpId) {
+      SPDLOG_INFO("{} remove Node {} from peers.", selfId(), it->first);
+      /// do not wait for its in-flight calls on raft main thread
+      mClientLoop->retire(std::move(mClients[it->first]));
+      mClients.erase(it->first);
+      it = mPeers.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto &[id, member] : members) {
+    auto it = mPeers.find(id);
+    if (it != mPeers.end()) {
+      it->second.mIsLearner = member->learner();
+    } else {
+      SPDLOG_INFO("{} add Node {}@{} to peers, isLearner={}.",
+                  selfId(), id, member->address(), member->learner());
+      addPeer(id, member->address(), member->learner());
+    }
+  }
+}
+
+void RaftCore::addPeer(uint64_t id, const std::string &address, bool isLearner) {
+  Peer peer;
+  peer.mId = id;
+  peer.mAddress = address;
+  peer.mIsLearner = isLearner;
+  peer.mNextIndex = mLog->getLastLogIndex() + 1;
+  peer.mMatchIndexGauge = gringofts::getGauge("match_index", {{"address", address}});  /// metric-lookup: new peer
+
+  /// turn on switch
+  peer.mNextRequestTimeInNano = TimeUtil::currentTimeInNanos();
+  mPeers[id] = peer;
+
+  /// before raft service is up, initService() creates the client
+  if (mDNSResolver) {
+    mClients[id] = std::make_unique<RaftClient>(address, mTlsConfOpt, mDNSResolver, id, &mAeRvQueue, mClientLoop);
+  }
+}
+
+void RaftCore::persistConfigurations() const {
+  if (mConfigurationPath.empty()) {
+    return;
+  }
+
+  ConfigurationHistory history;
+  for (auto &[index, configuration] : mConfigurations) {
+    *history.add_configurations() = configuration;
+  }
+
+  /// write then rename, never leave a partial file behind
+  auto tmpPath = mConfigurationPath + ".tmp";
+  FileUtil::setFileContentWithSync(tmpPath, history.SerializeAsString());
+  assert(std::rename(tmpPath.c_str(), mConfigurationPath.c_str()) == 0);
+}
+
+void RaftCore::loadConfigurations() {
+  if (mConfigurationPath.empty() || !FileUtil::fileExists(mConfigurationPath)) {
+    return;
+  }
+
+  ConfigurationHistory history;
+  assert(history.ParseFromString(FileUtil::getFileContent(mConfigurationPath)));
+
+  /// configuration is persisted after its entry, drop the one whose entry is lost
+  auto lastLogIndex = mLog->getLastLogIndex();
+  std::map<uint64_t, Configuration> configurations;
+  for (auto &configuration : history.configurations()) {
+    if (configuration.index() <= lastLogIndex) {
+      configurations[configuration.index()] = configuration;
+    }
+  }
+
+  if (configurations.empty()) {
+    SPDLOG_WARN("No configuration in {} is within lastLogIndex {}, use cluster.conf.",
+                mConfigurationPath, lastLogIndex);
+    return;
+  }
+
+  mConfigurations = std::move(configurations);
+  applyConfiguration(latestConfiguration());
+
+  SPDLOG_INFO("Load configuration at index {} from {}, it overrides cluster.conf: {}",
+              mConfigurations.rbegin()->first, mConfigurationPath,
+              latestConfiguration().ShortDebugString());
+}
+
 void RaftCore::advanceCommitIndex() {
   if (mRaftRole != RaftRole::Leader) {
     return;
@@ -719,17 +1544,20 @@ void RaftCore::advanceCommitIndex() {
   /// calculate the largest entry stored on a quorum of servers
   /// work for single-server cluster as well
   std::vector<uint64_t> indices;
-  indices.push_back(mLog->getLastLogIndex());
+  /// leader being removed still replicates, but is not counted
+  if (!mIsLearner) {
+    indices.push_back(mLog->getLastLogIndex());
+  }
 
   for (auto &p : mPeers) {
     auto &peer = p.second;
-    indices.push_back(peer.mMatchIndex);
+    if (!peer.mIsLearner) {
+      indices.push_back(peer.mMatchIndex);
+    }
     /// followers match index & lag
-    gringofts::getGauge("match_index", {{"address", peer.mAddress}})
-        .set(peer.mMatchIndex);
+    peer.mMatchIndexGauge->set(peer.mMatchIndex);
   }
-  gringofts::getGauge("match_index", {{"address", mSelfInfo.mAddress}})
-      .set(mCommitIndex);
+  mSelfMatchIndexGauge->set(mCommitIndex);
 
   std::sort(indices.begin(), indices.end(),
             [](uint64_t x, uint64_t y) { return x > y; });
@@ -751,8 +1579,16 @@ void RaftCore::advanceCommitIndex() {
     mCommitIndexCounter.increase(majorityIndex - mCommitIndex);
   }
 
+  assert(majorityIndex <= mLog->getLastLogIndex());
+
+  /// stamp before publishing, once mCommitIndex moves, reply loop
+  /// may finish these traces before QuorumCommit is stamped.
+  auto &tracer = CommandTracer::getInstance();
+  if (tracer.hasBoundTraces()) {
+    tracer.onCommitted(majorityIndex);
+  }
+
   mCommitIndex = majorityIndex;
-  assert(mCommitIndex <= mLog->getLastLogIndex());
 
   printStatus("advanceCommitIndex");
 
@@ -773,6 +1609,26 @@ void RaftCore::advanceCommitIndex() {
 
     mPendingClientRequests.pop_front();
   }
+
+  commitConfiguration();
+
+  /// membership change is done once new configuration is committed
+  if (mProposedConfigurationIndex != 0 && mProposedConfigurationIndex <= mCommitIndex) {
+    auto proposedByNoop = mProposedByNoop;
+    finishChangeMembership(true, "Success");
+
+    /// leader removed from cluster hands over to the others
+    if (mIsLearner) {
+      auto currentTerm = mLog->getCurrentTerm();
+      SPDLOG_INFO("{} on term {} stepDown, since it is removed from cluster.", selfId(), currentTerm);
+      stepDown(currentTerm + 1);
+    } else if (proposedByNoop) {
+      /// app layer recovers its indices on the next term
+      auto currentTerm = mLog->getCurrentTerm();
+      SPDLOG_INFO("{} on term {} stepDown, since noop breaks indices app layer assigned.", selfId(), currentTerm);
+      stepDown(currentTerm + 1);
+    }
+  }
 }
 
 void RaftCore::becomeLeader() {
@@ -791,7 +1647,7 @@ void RaftCore::becomeLeader() {
     }
   }
 
-  auto quorumNum = getMajorityNumber(mPeers.size() + 1);
+  auto quorumNum = getMajorityNumber(getVoterNum());
   if (voteNum < quorumNum) {
     return;
   }
@@ -800,6 +1656,7 @@ void RaftCore::becomeLeader() {
               selfId(), mLog->getCurrentTerm(), voteNum, quorumNum);
 
   mRaftRole = RaftRole::Leader;
+  mLeadershipTransferElection = false;
 
   /// schedule a round of AE_req (heartbeat) immediately
   for (auto &p : mPeers) {
@@ -808,6 +1665,7 @@ void RaftCore::becomeLeader() {
     peer.mNextIndex = mLog->getLastLogIndex() + 1;
     peer.mMatchIndex = 0;
     peer.mSuppressBulkData = true;
+    peer.mCommitIndexSent = 0;
 
     /// turn on switch
     peer.mNextRequestTimeInNano = TimeUtil::currentTimeInNanos();
@@ -831,8 +1689,8 @@ void RaftCore::becomeLeader() {
 }
 
 void RaftCore::electionTimeout() {
-  /// syncer also won't raise a election
-  if (mRaftRole == RaftRole::Leader || mRaftRole == RaftRole::Syncer) {
+  /// syncer and learner also won't raise a election
+  if (mRaftRole == RaftRole::Leader || mRaftRole == RaftRole::Syncer || mIsLearner) {
     return;
   }
 
@@ -843,8 +1701,69 @@ void RaftCore::electionTimeout() {
     return;
   }
 
+  SPDLOG_INFO("{} on term {} election timeout.", selfId(), mLog->getCurrentTerm());
+  if (mEnablePreVote) {
+    startPreVote();
+  } else {
+    startElection();
+  }
+}
+
+void RaftCore::startPreVote() {
+  /// Candidate of current term goes back to Follower, keep the term
+  mRaftRole = RaftRole::Follower;
+  mPreVoting = true;
+  mLeadershipTransferElection = false;
+  /// clear leaderHint
+  mLeaderId = 0;
+  /// reset election timer, pre-vote starts over if it times out
+  updateElectionTimePoint();
+
+  SPDLOG_INFO("{} on term {} start pre-vote for term {}.",
+              selfId(), mLog->getCurrentTerm(), mLog->getCurrentTerm() + 1);
+
+  /// schedule a round of pre-vote RV_req immediately
+  for (auto &p : mPeers) {
+    auto &peer = p.second;
+    peer.mRequestVoteDone = false;
+    peer.mHaveVote = false;
+
+    /// turn on switch
+    peer.mNextRequestTimeInNano = TimeUtil::currentTimeInNanos();
+  }
+}
+
+void RaftCore::becomeCandidate() {
+  if (!mPreVoting) {
+    return;
+  }
+
+  /// always grant pre-vote to himself
+  /// work for single-server cluster as well
+  uint64_t voteNum = 1;
+
+  for (const auto &p : mPeers) {
+    auto &peer = p.second;
+    if (peer.mHaveVote) {
+      ++voteNum;
+    }
+  }
+
+  auto quorumNum = getMajorityNumber(getVoterNum());
+  if (voteNum < quorumNum) {
+    return;
+  }
+
+  SPDLOG_INFO("{} on term {} pre-vote succeed, voteNum={}, quorumNum={}.",
+              selfId(), mLog->getCurrentTerm(), voteNum, quorumNum);
+  startElection();
+}
+
+void RaftCore::startElection(bool leadershipTransfer) {
   auto currentTerm = mLog->getCurrentTerm();
-  SPDLOG_INFO("{} on term {} election timeout.", selfId(), currentTerm);
+
+  mPreVoting = false;
+  mLeadershipTransferElection = leadershipTransfer;
 
   /// become Candidate
   mRaftRole = RaftRole::Candidate;
@@ -877,11 +1796,15 @@ void RaftCore::leadershipTimeout() {
 
   /// work for single-server cluster as well
   std::vector<uint64_t> timePoints;
-  timePoints.push_back(nowInNano);
+  if (!mIsLearner) {
+    timePoints.push_back(nowInNano);
+  }
 
   for (const auto &p : mPeers) {
     auto &peer = p.second;
-    timePoints.push_back(peer.mLastResponseTimeInNano);
+    if (!peer.mIsLearner) {
+      timePoints.push_back(peer.mLastResponseTimeInNano);
+    }
   }
 
   /// sort by descending order
@@ -889,7 +1812,7 @@ void RaftCore::leadershipTimeout() {
             [](uint64_t x, uint64_t y) { return x > y; });
 
   auto timeElapseInNano = nowInNano - timePoints[timePoints.size() >> 1];
-  if (timeElapseInNano / 1000000.0 < RaftConstants::kMaxElectionTimeoutInMillis) {
+  if (timeElapseInNano / 1000000.0 < mMaxElectionTimeoutInMillis) {
     return;
   }
 
@@ -898,7 +1821,7 @@ void RaftCore::leadershipTimeout() {
   SPDLOG_INFO("{} on term {} stepDown due to lost authority, "
               "timeElapse={}ms, maxElectionTimeout={}ms",
               selfId(), currentTerm,
-              timeElapseInNano / 1000000.0, RaftConstants::kMaxElectionTimeoutInMillis);
+              timeElapseInNano / 1000000.0, mMaxElectionTimeoutInMillis);
 
   stepDown(currentTerm + 1);
 }
@@ -910,6 +1833,8 @@ void RaftCore::stepDown(uint64_t newTerm) {
   /// Attention, must change role before update term.
   auto prevRole = mRaftRole;
   mRaftRole = RaftRole::Follower;
+  mPreVoting = false;
+  mLeadershipTransferElection = false;
 
   if (currentTerm < newTerm) {
     mLog->setCurrentTerm(newTerm);
@@ -924,6 +1849,11 @@ void RaftCore::stepDown(uint64_t newTerm) {
 
   /// step down from Leader
   if (prevRole == RaftRole::Leader) {
+    /// transferee has started its election if TN_req was sent
+    finishTransferLeadership(mTimeoutNowSent, mTimeoutNowSent ? "Success" : "LeaderStepDown");
+    /// configuration carried by an appended entry may still be committed by next leader
+    finishChangeMembership(false, "LeaderStepDown");
+
     /// cleanup client request
     while (!mPendingClientRequests.empty()) {
       auto &p = mPendingClientRequests.front();
@@ -932,6 +1862,11 @@ void RaftCore::stepDown(uint64_t newTerm) {
       }
       mPendingClientRequests.pop_front();
     }
+    /// only onCommitted on leader unbinds traces otherwise
+    auto &tracer = CommandTracer::getInstance();
+    if (tracer.hasBoundTraces()) {
+      tracer.onSteppedDown();
+    }
 
     /// notify monitor
     mLeadershipGauge.set(0);
@@ -939,11 +1874,9 @@ void RaftCore::stepDown(uint64_t newTerm) {
     for (auto &p : mPeers) {
       auto &peer = p.second;
       /// followers match index & lag
-      gringofts::getGauge("match_index", {{"address", peer.mAddress}})
-          .set(0);
+      peer.mMatchIndexGauge->set(0);
     }
-    gringofts::getGauge("match_index", {{"address", mSelfInfo.mAddress}})
-        .set(0);
+    mSelfMatchIndexGauge->set(0);
 
     /// resume election timer
     updateElectionTimePoint();
@@ -951,6 +1884,7 @@ void RaftCore::stepDown(uint64_t newTerm) {
 }
 
 uint64_t RaftCore::getMemberOffsets(std::vector<MemberOffsetInfo> *mMemberOffsets) const {
+  std::shared_lock<std::shared_mutex> lock(mPeersMutex);
   for (auto &p : mPeers) {
     auto &peer = p.second;
     mMemberOffsets->emplace_back(peer.mId, peer.mAddress, peer.mMatchIndex);
@@ -997,24 +1931,29 @@ void RaftCore::printMetrics(const raft::AppendEntries::Metrics &metrics) {
     return beginInNano > endInNano ? 0.0 : (endInNano - beginInNano) / 1000000.0;
   };
 
-  SPDLOG_INFO("AE_metrics between Leader {} and Follower {}, entries.num={}, "
-              "total.cost={}ms, "
-              "read.entries.cost={}ms, "
-              "request.build.cost={}ms, "
-              "request.network.latency={}ms, "
-              "request.queue.latency={}ms, "
-              "write.entries.cost={}ms, "
-              "response.network.latency={}ms, "
-              "response.queue.latency={}ms.",
-              metrics.leader_id(), metrics.follower_id(), metrics.entries_count(),
-              elapseInMillis(metrics.request_create_time(), metrics.response_event_dequeue_time()),
-              elapseInMillis(metrics.request_create_time(), metrics.entries_reading_done_time()),
-              elapseInMillis(metrics.entries_reading_done_time(), metrics.request_send_time()),
-              elapseInMillis(metrics.request_send_time(), metrics.request_event_enqueue_time()),
-              elapseInMillis(metrics.request_event_enqueue_time(), metrics.request_event_dequeue_time()),
-              elapseInMillis(metrics.response_create_time(), metrics.entries_writing_done_time()),
-              elapseInMillis(metrics.response_send_time(), metrics.response_event_enqueue_time()),
-              elapseInMillis(metrics.response_event_enqueue_time(), metrics.response_event_dequeue_time()));
+  mAeRoundTripHistogram.observe(
+      elapseInMillis(metrics.request_create_time(), metrics.response_event_dequeue_time()));
+  mAeWriteEntriesHistogram.observe(
+      elapseInMillis(metrics.response_create_time(), metrics.entries_writing_done_time()));
+
+  SPDLOG_INFO_EVERY_MS(1000, "AE_metrics between Leader {} and Follower {}, entries.num={}, "
+                       "total.cost={}ms, "
+                       "read.entries.cost={}ms, "
+                       "request.build.cost={}ms, "
+                       "request.network.latency={}ms, "
+                       "request.queue.latency={}ms, "
+                       "write.entries.cost={}ms, "
+                       "response.network.latency={}ms, "
+                       "response.queue.latency={}ms.",
+                       metrics.leader_id(), metrics.follower_id(), metrics.entries_count(),
+                       elapseInMillis(metrics.request_create_time(), metrics.response_event_dequeue_time()),
+                       elapseInMillis(metrics.request_create_time(), metrics.entries_reading_done_time()),
+                       elapseInMillis(metrics.entries_reading_done_time(), metrics.request_send_time()),
+                       elapseInMillis(metrics.request_send_time(), metrics.request_event_enqueue_time()),
+                       elapseInMillis(metrics.request_event_enqueue_time(), metrics.request_event_dequeue_time()),
+                       elapseInMillis(metrics.response_create_time(), metrics.entries_writing_done_time()),
+                       elapseInMillis(metrics.response_send_time(), metrics.response_event_enqueue_time()),
+                       elapseInMillis(metrics.response_event_enqueue_time(), metrics.response_event_dequeue_time()));
 }
 
 /// for UT
@@ -15,15 +15,19 @@ limitations under the License.
 #ifndef SRC_INFRA_RAFT_V2_RAFTCORE_H_
 #define SRC_INFRA_RAFT_V2_RAFTCORE_H_
 
+#include <algorithm>
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <thread>
 
 #include <INIReader.h>
 
 #include "../../util/ClusterInfo.h"
+#include "../../util/CompressionUtil.h"
 #include "../../util/RandomUtil.h"
 #include "../../util/TestPointProcessor.h"
 #include "../../util/TimeUtil.h"
@@ -47,6 +51,12 @@ struct Peer {
   /// ip:port
   std::string mAddress;
 
+  /**
+   * Learner receives AE_req, but is never asked for vote
+   * and does not count toward majority.
+   */
+  bool mIsLearner = false;
+
   /**
    * Set to true if this server has responded to our RV_req
    * in the current term, false otherwise.
@@ -88,6 +98,18 @@ struct Peer {
    */
   bool mSuppressBulkData = true;
 
+  /**
+   * Whether this server can decompress entries with configured compression,
+   * learned from its AE_resp. Only used when leader.
+   */
+  bool mAcceptCompression = false;
+
+  /**
+   * Commit index carried by last AE_req, if it falls behind,
+   * leader sends AE_req without waiting for idle heartbeat interval.
+   */
+  uint64_t mCommitIndexSent = 0;
+
   /**
    * Last sent time of AE_req/RV_req by Leader/Candidate
    */
@@ -105,6 +127,12 @@ struct Peer {
    * communicate with majority within election timeout.
    */
   uint64_t mLastResponseTimeInNano = 0;
+
+  /**
+   * match_index gauge of this server, resolved once when it is added,
+   * so that raft loop never looks it up in metrics registry.
+   */
+  std::optional<santiago::MetricsCenter::GaugeType> mMatchIndexGauge;
 };
 
 class RaftCore : public RaftInterface {
@@ -113,7 +141,8 @@ class RaftCore : public RaftInterface {
       const NodeId &selfId,
       const ClusterInfo &clusterInfo,
       std::shared_ptr<DNSResolver> dnsResolver,
-      RaftRole role = RaftRole::Follower);
+      RaftRole role = RaftRole::Follower,
+      std::shared_ptr<RaftClientLoop> clientLoop = nullptr);
 
   ~RaftCore() override;
 
@@ -131,6 +160,8 @@ class RaftCore : public RaftInterface {
   std::vector<MemberInfo> getClusterMembers() const override {
     std::vector<MemberInfo> cluster;
     cluster.push_back(mSelfInfo);
+
+    std::shared_lock<std::shared_mutex> lock(mPeersMutex);
     for (auto &[id, p] : mPeers) {
       cluster.push_back({id, p.mAddress});
     }
@@ -174,6 +205,34 @@ class RaftCore : public RaftInterface {
     mClientRequestsQueue.enqueue(std::move(event));
   }
 
+  /**
+   * Hand leadership over to another peer. Leader stops accepting client
+   * requests, brings the transferee up to date and sends it TN_req.
+   */
+  void enqueueTransferLeadership(TransferLeadershipRequest request) {
+    auto event = std::make_shared<TransferLeadershipEvent>();
+
+    event->mType = RaftEventBase::Type::TransferLeadership;
+    event->mPayload = std::move(request);
+
+    mClientRequestsQueue.enqueue(std::move(event));
+  }
+
+  /**
+   * Change membership one server at a time. New member catches up as
+   * learner before leader proposes the configuration making it a voter.
+   * Since app layer assigns the indices, new configuration is carried
+   * by the next client entry rather than an entry of its own.
+   */
+  void enqueueChangeMembership(ChangeMembershipRequest request) {
+    auto event = std::make_shared<ChangeMembershipEvent>();
+
+    event->mType = RaftEventBase::Type::ChangeMembership;
+    event->mPayload = std::move(request);
+
+    mClientRequestsQueue.enqueue(std::move(event));
+  }
+
   void truncatePrefix(uint64_t firstIndexKept) override {
     assert(firstIndexKept <= mCommitIndex);
     return mLog->truncatePrefix(firstIndexKept);
@@ -206,6 +265,13 @@ class RaftCore : public RaftInterface {
   grpc::Status handleAppendEntriesRequest(const AppendEntries::Request &request,
                                   AppendEntries::Response *response);
 
+  /// compress entries of AE_req as a whole, leave them as is if it does not pay off
+  /// or if any payload is encrypted
+  void compressEntries(std::vector<LogEntry> *entries, AppendEntries::Request *request);
+
+  /// restore entries of a compressed AE_req, return false if corrupted
+  static bool decompressEntries(AppendEntries::Request *request);
+
   /// receive AE_resp
   void handleAppendEntriesResponse(const AppendEntries::Response &response);
 
@@ -222,6 +288,58 @@ class RaftCore : public RaftInterface {
   /// receive syncRequest
   void handleSyncRequest(SyncRequest syncRequest);
 
+  /// receive TN_req, reply TN_resp
+  grpc::Status handleTimeoutNowRequest(const TimeoutNow::Request &request,
+                                       TimeoutNow::Response *response);
+
+  /// receive TN_resp
+  void handleTimeoutNowResponse(const TimeoutNow::Response &response);
+
+  /// receive TransferLeadershipRequest
+  void handleTransferLeadership(TransferLeadershipRequest request);
+
+  /// send TN_req once transferee catches up,
+  /// give up if it cannot take over within election timeout.
+  void transferLeadership();
+
+  /// reply to the pending leadership transfer and clear it
+  void finishTransferLeadership(bool success, const std::string &message);
+
+  /// receive ChangeMembershipRequest
+  void handleChangeMembership(ChangeMembershipRequest request);
+
+  /// propose new configuration once new member catches up,
+  /// give up if it cannot catch up within catch up timeout.
+  void changeMembership();
+
+  /// append a noop to carry proposed configuration if no client entry does within propose timeout
+  void proposeConfigurationByNoop();
+
+  /// reply to the pending membership change and clear it
+  void finishChangeMembership(bool success, const std::string &message);
+
+  /// the latest configuration in log takes effect, whether committed or not
+  const Configuration &latestConfiguration() const { return mConfigurations.rbegin()->second; }
+
+  /// record configuration carried by a newly appended entry and apply it
+  void appendConfiguration(const Configuration &configuration);
+
+  /// fall back to the latest configuration not after lastIndexKept
+  void truncateConfiguration(uint64_t lastIndexKept);
+
+  /// forget configurations superseded by a committed one
+  void commitConfiguration();
+
+  /// sync mPeers and mClients with configuration
+  void applyConfiguration(const Configuration &configuration);
+
+  /// add a peer and its client, caller should hold mPeersMutex
+  void addPeer(uint64_t id, const std::string &address, bool isLearner);
+
+  /// persist configurations along with raft log, reload them after restart
+  void persistConfigurations() const;
+  void loadConfigurations();
+
   void advanceCommitIndex();
 
   void becomeLeader();
@@ -229,6 +347,25 @@ class RaftCore : public RaftInterface {
   /// transition from Follower/Candidate to Candidate of next term
   void electionTimeout();
 
+  /// become Candidate of next term and schedule a round of RV_req
+  void startElection(bool leadershipTransfer = false);
+
+  /// stay Follower and schedule a round of pre-vote RV_req for next term
+  void startPreVote();
+
+  /// transition to Candidate once pre-vote is granted by majority
+  void becomeCandidate();
+
+  /// whether we have heard from current leader within min election timeout,
+  /// if so, RV_req from others are ignored.
+  bool inLeaderLease() const {
+    if (mRaftRole == RaftRole::Leader) {
+      return true;
+    }
+    auto leaseInNano = mMinElectionTimeoutInMillis * 1000 * 1000;
+    return mLeaderId != kBadID && TimeUtil::currentTimeInNanos() < mLastLeaderContactTimeInNano + leaseInNano;
+  }
+
   /// Leader should step down if can not communicate
   /// with majority within election timeout.
   void leadershipTimeout();
@@ -238,6 +375,18 @@ class RaftCore : public RaftInterface {
   /// be careful that precedence of '>>' is less than '+'
   static uint64_t getMajorityNumber(uint64_t totalNum) { return (totalNum >> 1) + 1; }
 
+  /// num of voting members, including self
+  uint64_t getVoterNum() const {
+    return (mIsLearner ? 0 : 1) + std::count_if(mPeers.begin(), mPeers.end(),
+                             [](const auto &p) { return !p.second.mIsLearner; });
+  }
+
+  /// whether peer is missing entries or commit index
+  bool hasPendingData(const Peer &peer) const {
+    return peer.mNextIndex <= mLog->getLastLogIndex()
+        || std::min(mCommitIndex.load(), peer.mNextIndex - 1) > peer.mCommitIndexSent;
+  }
+
   uint64_t termOfLogEntryAt(uint64_t index) const {
     uint64_t term;
     assert(mLog->getTerm(index, &term));
@@ -250,8 +399,8 @@ class RaftCore : public RaftInterface {
   /// 3) become Follower
   /// 4) become Candidate
   void updateElectionTimePoint() {
-    auto timeIntervalInNano = RandomUtil::randomRange(RaftConstants::kMinElectionTimeoutInMillis * 1000 * 1000,
-                                                      RaftConstants::kMaxElectionTimeoutInMillis * 1000 * 1000);
+    auto timeIntervalInNano = RandomUtil::randomRange(mMinElectionTimeoutInMillis * 1000 * 1000,
+                                                      mMaxElectionTimeoutInMillis * 1000 * 1000);
     mElectionTimePointInNano = TimeUtil::currentTimeInNanos() + timeIntervalInNano;
   }
 
@@ -265,8 +414,8 @@ class RaftCore : public RaftInterface {
   /// for some reason, print status.
   void printStatus(const std::string &reason) const;
 
-  /// metrics
-  static void printMetrics(const AppendEntries::Metrics &metrics);
+  /// metrics, logged and observed into AE latency histograms
+  void printMetrics(const AppendEntries::Metrics &metrics);
 
   /**
    * configurable vars
@@ -278,6 +427,23 @@ class RaftCore : public RaftInterface {
   uint64_t mMaxDecrStep = 2000;
   /// for printStatus()
   uint64_t mMaxTailedEntryNum = 5;
+  /// for electionTimeout(), also enables leader lease on followers
+  bool mEnablePreVote = false;
+  /// for changeMembership()
+  uint64_t mCatchUpTimeoutInSec = 3600;
+  /// for changeMembership(), how long a proposed configuration waits for a client entry
+  /// to carry it before leader appends a noop to carry it
+  uint64_t mProposeTimeoutInMillis = 3000;
+  /// for appendEntries(), AE_req interval while replicating,
+  /// and heartbeat interval when there is nothing to replicate
+  uint64_t mHeartBeatIntervalInMillis = RaftConstants::kHeartBeatIntervalInMillis;
+  uint64_t mIdleHeartBeatIntervalInMillis = RaftConstants::kHeartBeatIntervalInMillis;
+  /// for updateElectionTimePoint(), leadershipTimeout() and leader lease
+  uint64_t mMinElectionTimeoutInMillis = RaftConstants::kMinElectionTimeoutInMillis;
+  uint64_t mMaxElectionTimeoutInMillis = RaftConstants::kMaxElectionTimeoutInMillis;
+  /// for compressEntries(), skip small batches such as a single entry under light load
+  CompressionType mCompression = CompressionType::None;
+  uint64_t mCompressionMinBytes = 4096;
 
   /**
    * raft state
@@ -287,14 +453,38 @@ class RaftCore : public RaftInterface {
 
   std::map<uint64_t, Peer> mPeers;
 
+  /// raft loop is the only writer of mPeers, it locks when adding or
+  /// removing peers, and readers from other threads take a shared lock.
+  mutable std::shared_mutex mPeersMutex;
+
   MemberInfo mSelfInfo;
 
+  /// learner never starts election, nor votes,
+  /// a member removed from cluster turns into a learner.
+  bool mIsLearner = false;
+
+  /// <index, configuration> carried by log entries, index 0 is from cluster.conf.
+  /// the latest committed one and all uncommitted ones are kept.
+  std::map<uint64_t, Configuration> mConfigurations;
+
+  /// where configurations are persisted, empty for in-memory log
+  std::string mConfigurationPath;
+
   std::string mAddressForRaftSvc;
 
   std::atomic<uint64_t> mLeaderId = kBadID;
   /// if now > election time point, incr current term, convert to candidate
   uint64_t mElectionTimePointInNano = 0;
 
+  /// last time receiving AE_req from current leader
+  uint64_t mLastLeaderContactTimeInNano = 0;
+
+  /// Follower is collecting pre-votes for next term
+  bool mPreVoting = false;
+
+  /// current election is triggered by TN_req
+  bool mLeadershipTransferElection = false;
+
   std::atomic<uint64_t> mCommitIndex = 0;
 
   /// for cluster 0, is 1
@@ -309,6 +499,22 @@ class RaftCore : public RaftInterface {
   /// pending client requests, list of <index, handle>
   std::list<std::pair<uint64_t, RequestHandle *>> mPendingClientRequests;
 
+  /// leadership transfer in progress, only used when leader
+  std::optional<TransferLeadershipRequest> mPendingTransfer;
+  uint64_t mTransferStartTimeInNano = 0;
+  bool mTimeoutNowSent = false;
+
+  /// membership change in progress, only used when leader
+  std::optional<ChangeMembershipRequest> mPendingMembershipChange;
+  uint64_t mMembershipChangeStartTimeInNano = 0;
+  /// configuration waiting for the next client entry to carry it
+  std::optional<Configuration> mProposedConfiguration;
+  uint64_t mProposeStartTimeInNano = 0;
+  /// index of the entry carrying proposed configuration, 0 if not appended yet
+  uint64_t mProposedConfigurationIndex = 0;
+  /// carried by a noop of leader, which breaks the indices app layer assigned afterwards
+  bool mProposedByNoop = false;
+
   /**
    * threading model
    */
@@ -321,7 +527,11 @@ class RaftCore : public RaftInterface {
 
   /// raft service: server and clients
   std::unique_ptr<RaftServer> mServer;
+  /// shared by clients, and by raft groups hosted in one process if given
+  std::shared_ptr<RaftClientLoop> mClientLoop;
   std::map<uint64_t, std::unique_ptr<RaftClient>> mClients;
+  /// for clients of peers added at runtime
+  std::shared_ptr<DNSResolver> mDNSResolver;
 
   /// streaming service
   uint64_t mStreamingPort;
@@ -333,10 +543,21 @@ class RaftCore : public RaftInterface {
    */
   santiago::MetricsCenter::GaugeType mLeadershipGauge;
 
+  /// match_index gauge of self, resolved in initClusterConf(), peers hold their own
+  std::optional<santiago::MetricsCenter::GaugeType> mSelfMatchIndexGauge;
+
   /// after restart, Leader/Follower will recover commitIndex from 0,
   /// ignore the flip from 0 to avoid confusing metrics
   santiago::MetricsCenter::CounterType mCommitIndexCounter;
 
+  /// bytes of compressed AE_req entries, before and after compression
+  santiago::MetricsCenter::CounterType mAeUncompressedBytesCounter;
+  santiago::MetricsCenter::CounterType mAeCompressedBytesCounter;
+
+  /// AE_req created to AE_resp dequeued, and the time follower spent writing entries
+  santiago::MetricsCenter::HistogramType mAeRoundTripHistogram;
+  santiago::MetricsCenter::HistogramType mAeWriteEntriesHistogram;
+
   /// UT
   RaftCore(
       const char *configPath,
@@ -347,6 +568,15 @@ class RaftCore : public RaftInterface {
   TestPointProcessor *mTPProcessor = nullptr;
   friend class ClusterTestUtil;
   FRIEND_TEST(RaftCoreTest, BasicTest);
+  FRIEND_TEST(RaftCoreTest, PreVoteTest);
+  FRIEND_TEST(RaftCoreTest, PreVoteRejectedTest);
+  FRIEND_TEST(RaftCoreTest, LearnerTest);
+  FRIEND_TEST(RaftCoreTest, MembershipChangeTest);
+  FRIEND_TEST(RaftCoreTest, RemovedMemberResponseTest);
+  FRIEND_TEST(RaftCoreTest, TransferToRemovedMemberTest);
+  FRIEND_TEST(RaftCoreTest, IdleMembershipChangeTest);
+  FRIEND_TEST(RaftCoreTest, IdleHeartBeatTest);
+  FRIEND_TEST(RaftCoreTest, CompressEntriesTest);
 };
 
 }  /// namespace v2
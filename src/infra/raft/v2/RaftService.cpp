@@ -14,6 +14,10 @@ limitations under the License.
 
 #include "RaftService.h"
 
+#include <algorithm>
+
+#include "../../util/ThreadPlacement.h"
+
 namespace gringofts {
 namespace raft {
 namespace v2 {
@@ -60,10 +64,12 @@ RaftServer::~RaftServer() {
 
 void RaftServer::serverLoopMain() {
   pthread_setname_np(pthread_self(), "RaftServer");
+  ThreadPlacement::getInstance().place("RaftServer");
 
   /// Spawn a new CallData instance to serve new clients.
   new RequestVoteCallData(&mService, mCompletionQueue.get(), mAeRvQueue);
   new AppendEntriesCallData(&mService, mCompletionQueue.get(), mAeRvQueue);
+  new TimeoutNowCallData(&mService, mCompletionQueue.get(), mAeRvQueue);
 
   void *tag;  /// uniquely identifies a request.
   bool ok;
@@ -86,45 +92,126 @@ void RaftServer::serverLoopMain() {
   }
 }
 
+//////////////////////////// RaftClientLoop ////////////////////////////
+
+RaftClientLoop::RaftClientLoop(uint64_t threadNum) {
+  assert(threadNum > 0);
+  for (uint64_t i = 0; i < threadNum; ++i) {
+    mClientLoops.emplace_back(&RaftClientLoop::clientLoopMain, this, i);
+  }
+  SPDLOG_INFO("RaftClientLoop starts {} threads.", threadNum);
+}
+
+RaftClientLoop::~RaftClientLoop() {
+  /// all clients are retired, no new call will be added to CQ
+  mCompletionQueue.Shutdown();
+
+  /// join event loops, they drain in-flight calls before quit.
+  for (auto &clientLoop : mClientLoops) {
+    if (clientLoop.joinable()) {
+      clientLoop.join();
+    }
+  }
+
+  assert(std::all_of(mRetiredClients.begin(), mRetiredClients.end(),
+                     [](const auto &client) { return client->mInflightCalls == 0; }));
+  mRetiredClients.clear();
+}
+
+void RaftClientLoop::retire(std::unique_ptr<RaftClient> client) {
+  if (!client) {
+    return;
+  }
+
+  /// drop responses from now on
+  {
+    std::unique_lock<std::shared_mutex> lock(client->mRunningMutex);
+    client->mRunning = false;
+  }
+  /// break the cycle, this loop owns the client from now on
+  client->mClientLoop.reset();
+
+  {
+    std::lock_guard<std::mutex> lock(mRetiredMutex);
+    mRetiredClients.push_back(std::move(client));
+    ++mRetiredNum;
+  }
+
+  /// release it right away if it is idle
+  reapRetiredClients();
+}
+
+void RaftClientLoop::reapRetiredClients() {
+  if (mRetiredNum == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mRetiredMutex);
+  for (auto it = mRetiredClients.begin(); it != mRetiredClients.end();) {
+    if ((*it)->mInflightCalls == 0) {
+      it = mRetiredClients.erase(it);
+      --mRetiredNum;
+    } else {
+      ++it;
+    }
+  }
+}
+
+void RaftClientLoop::clientLoopMain(uint64_t threadIndex) {
+  auto threadName = std::string("RaftClient_") + std::to_string(threadIndex);
+  pthread_setname_np(pthread_self(), threadName.c_str());
+  ThreadPlacement::getInstance().place(threadName);
+
+  void *tag;  /// The tag is the memory location of the call object
+  bool ok = false;
+
+  /// Block until the next result is available in the completion queue.
+  while (mCompletionQueue.Next(&tag, &ok)) {
+    auto *call = static_cast<AsyncClientCallBase *>(tag);
+    GPR_ASSERT(ok);
+    call->mClient->handleResponse(call);
+    reapRetiredClients();
+  }
+
+  SPDLOG_INFO("Client loop quit.");
+}
+
 //////////////////////////// RaftClient ////////////////////////////
 
 RaftClient::RaftClient(const std::string &peerAddress,
                        std::optional<TlsConf> tlsConfOpt,
                        std::shared_ptr<DNSResolver> dnsResolver,
                        uint64_t peerId,
-                       EventQueue *aeRvQueue) :
+                       EventQueue *aeRvQueue,
+                       std::shared_ptr<RaftClientLoop> clientLoop) :
     mPeerAddress(peerAddress),
     mDNSResolver(dnsResolver),
     mTLSConfOpt(tlsConfOpt),
     mPeerId(peerId),
+    mClientLoop(std::move(clientLoop)),
     mAeRvQueue(aeRvQueue) {
+  mCompletionQueue = mClientLoop->getCompletionQueue();
   refressChannel();
-  /// start AE_resp/RV_resp receiving thread
-  mClientLoop = std::thread(&RaftClient::clientLoopMain, this);
 }
 
 RaftClient::~RaftClient() {
-  mRunning = false;
-
-  /// shut down CQ
-  mCompletionQueue.Shutdown();
-
-  /// join event loop.
-  if (mClientLoop.joinable()) {
-    mClientLoop.join();
-  }
-
-  /// drain completion queue.
-  void *tag;
-  bool ok;
-  while (mCompletionQueue.Next(&tag, &ok)) { ; }
+  /// in-flight calls refer to this client, hand it over to
+  /// RaftClientLoop::retire() instead of destroying it directly.
+  assert(mInflightCalls == 0);
 }
 
 void RaftClient::refressChannel() {
   grpc::ChannelArguments chArgs;
   chArgs.SetMaxReceiveMessageSize(INT_MAX);
   auto newResolvedAddress = mDNSResolver->resolve(mPeerAddress);
-  if (newResolvedAddress != mResolvedPeerAddress) {
+  {
+    /// several client loop threads may refresh at the same time
+    std::shared_lock<std::shared_mutex> lock(mMutex);
+    if (newResolvedAddress == mResolvedPeerAddress) {
+      return;
+    }
+  }
+  {
     std::unique_lock<std::shared_mutex> lock(mMutex);
     if (newResolvedAddress != mResolvedPeerAddress) {
       SPDLOG_INFO("refreshing channel, addr {}, new resolved addr {}, old resolved addr {}",
@@ -141,13 +228,15 @@ void RaftClient::requestVote(const RequestVote::Request &request) {
   auto *call = new RequestVoteClientCall;
 
   call->mPeerId = mPeerId;
+  call->mClient = this;
+  ++mInflightCalls;
 
   std::chrono::time_point deadline = std::chrono::system_clock::now()
       + std::chrono::milliseconds(RaftConstants::RequestVote::kRpcTimeoutInMillis);
   call->mContext.set_deadline(deadline);
 
   std::shared_lock<std::shared_mutex> lock(mMutex);
-  call->mResponseReader = mStub->PrepareAsyncRequestVoteV2(&call->mContext, request, &mCompletionQueue);
+  call->mResponseReader = mStub->PrepareAsyncRequestVoteV2(&call->mContext, request, mCompletionQueue);
   call->mResponseReader->StartCall();
   call->mResponseReader->Finish(&call->mResponse,
                                 &call->mStatus,
@@ -158,75 +247,100 @@ void RaftClient::appendEntries(const AppendEntries::Request &request) {
   auto *call = new AppendEntriesClientCall;
 
   call->mPeerId = mPeerId;
+  call->mClient = this;
+  ++mInflightCalls;
 
   std::chrono::time_point deadline = std::chrono::system_clock::now()
       + std::chrono::milliseconds(RaftConstants::AppendEntries::kRpcTimeoutInMillis);
   call->mContext.set_deadline(deadline);
 
   std::shared_lock<std::shared_mutex> lock(mMutex);
-  call->mResponseReader = mStub->PrepareAsyncAppendEntriesV2(&call->mContext, request, &mCompletionQueue);
+  call->mResponseReader = mStub->PrepareAsyncAppendEntriesV2(&call->mContext, request, mCompletionQueue);
   call->mResponseReader->StartCall();
   call->mResponseReader->Finish(&call->mResponse,
                                 &call->mStatus,
                                 reinterpret_cast<void *>(call));
 }
 
-void RaftClient::clientLoopMain() {
-  auto peerThreadName = std::string("RaftClient_") + std::to_string(mPeerId);
-  pthread_setname_np(pthread_self(), peerThreadName.c_str());
-
-  void *tag;  /// The tag is the memory location of the call object
-  bool ok = false;
+void RaftClient::timeoutNow(const TimeoutNow::Request &request) {
+  auto *call = new TimeoutNowClientCall;
 
-  /// Block until the next result is available in the completion queue.
-  while (mCompletionQueue.Next(&tag, &ok)) {
-    if (!mRunning) {
-      SPDLOG_INFO("Client loop quit.");
-      return;
-    }
-
-    auto *call = static_cast<AsyncClientCallBase *>(tag);
-    GPR_ASSERT(ok);
-
-    if (!call->mStatus.ok()) {
-      SPDLOG_WARN("{} failed., gRpc error_code: {}, error_message: {}, error_details: {}",
-                  call->toString(),
-                  call->mStatus.error_code(),
-                  call->mStatus.error_message(),
-                  call->mStatus.error_details());
-
-      /// collect gRpc error code metrics
-      getCounter("grpc_error_counter", {{"error_code", std::to_string(call->mStatus.error_code())}});
-      refressChannel();
-    }
+  call->mPeerId = mPeerId;
+  call->mClient = this;
+  ++mInflightCalls;
 
-    /// enqueue event
-    if (call->getType() == RaftEventBase::Type::RequestVoteResponse) {
-      using EventType = RaftEvent<std::unique_ptr<RequestVoteClientCall>>;
+  std::chrono::time_point deadline = std::chrono::system_clock::now()
+      + std::chrono::milliseconds(RaftConstants::TimeoutNow::kRpcTimeoutInMillis);
+  call->mContext.set_deadline(deadline);
 
-      auto event = std::make_shared<EventType>();
-      event->mType = RaftEventBase::Type::RequestVoteResponse;
-      event->mPayload = std::unique_ptr<RequestVoteClientCall>(
-          dynamic_cast<RequestVoteClientCall *>(call));
-      mAeRvQueue->enqueue(event);
-    } else if (call->getType() == RaftEventBase::Type::AppendEntriesResponse) {
-      using EventType = RaftEvent<std::unique_ptr<AppendEntriesClientCall>>;
+  std::shared_lock<std::shared_mutex> lock(mMutex);
+  call->mResponseReader = mStub->PrepareAsyncTimeoutNowV2(&call->mContext, request, mCompletionQueue);
+  call->mResponseReader->StartCall();
+  call->mResponseReader->Finish(&call->mResponse,
+                                &call->mStatus,
+                                reinterpret_cast<void *>(call));
+}
 
-      auto event = std::make_shared<EventType>();
-      event->mType = RaftEventBase::Type::AppendEntriesResponse;
-      event->mPayload = std::unique_ptr<AppendEntriesClientCall>(
-          dynamic_cast<AppendEntriesClientCall *>(call));
+void RaftClient::handleResponse(AsyncClientCallBase *call) {
+  std::shared_lock<std::shared_mutex> runningLock(mRunningMutex);
+  if (!mRunning) {
+    runningLock.unlock();
+    delete call;
+    --mInflightCalls;
+    return;
+  }
 
-      (*event->mPayload->mResponse.mutable_metrics())
-          .set_response_event_enqueue_time(TimeUtil::currentTimeInNanos());
+  if (!call->mStatus.ok()) {
+    SPDLOG_WARN("{} failed., gRpc error_code: {}, error_message: {}, error_details: {}",
+                call->toString(),
+                call->mStatus.error_code(),
+                call->mStatus.error_message(),
+                call->mStatus.error_details());
+
+    /// collect gRpc error code metrics
+    getCounter("grpc_error_counter",  /// metric-lookup: error path, keyed by error code
+               {{"error_code", std::to_string(call->mStatus.error_code())}}).increase();
+    refressChannel();
+  }
 
-      mAeRvQueue->enqueue(event);
-    } else {
-      SPDLOG_ERROR("RaftClient receive unknown event type: {}",
-                   static_cast<uint64_t>(call->getType()));
-      assert(0);
-    }
+  /// enqueue event
+  if (call->getType() == RaftEventBase::Type::RequestVoteResponse) {
+    using EventType = RaftEvent<std::unique_ptr<RequestVoteClientCall>>;
+
+    auto event = std::make_shared<EventType>();
+    event->mType = RaftEventBase::Type::RequestVoteResponse;
+    event->mPayload = std::unique_ptr<RequestVoteClientCall>(
+        dynamic_cast<RequestVoteClientCall *>(call));
+    mAeRvQueue->enqueue(event);
+  } else if (call->getType() == RaftEventBase::Type::AppendEntriesResponse) {
+    using EventType = RaftEvent<std::unique_ptr<AppendEntriesClientCall>>;
+
+    auto event = std::make_shared<EventType>();
+    event->mType = RaftEventBase::Type::AppendEntriesResponse;
+    event->mPayload = std::unique_ptr<AppendEntriesClientCall>(
+        dynamic_cast<AppendEntriesClientCall *>(call));
+
+    (*event->mPayload->mResponse.mutable_metrics())
+        .set_response_event_enqueue_time(TimeUtil::currentTimeInNanos());
+
+    mAeRvQueue->enqueue(event);
+  } else if (call->getType() == RaftEventBase::Type::TimeoutNowResponse) {
+    using EventType = RaftEvent<std::unique_ptr<TimeoutNowClientCall>>;
+
+    auto event = std::make_shared<EventType>();
+    event->mType = RaftEventBase::Type::TimeoutNowResponse;
+    event->mPayload = std::unique_ptr<TimeoutNowClientCall>(
+        dynamic_cast<TimeoutNowClientCall *>(call));
+    mAeRvQueue->enqueue(event);
+  } else {
+    SPDLOG_ERROR("RaftClient receive unknown event type: {}",
+                 static_cast<uint64_t>(call->getType()));
+    assert(0);
   }
+
+  runningLock.unlock();
+  /// must be the last access to this client
+  --mInflightCalls;
 }
 
 }  /// namespace v2
@@ -15,10 +15,13 @@ limitations under the License.
 #ifndef SRC_INFRA_RAFT_V2_RAFTSERVICE_H_
 #define SRC_INFRA_RAFT_V2_RAFTSERVICE_H_
 
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <thread>
+#include <vector>
 
 #include <grpcpp/server.h>
 #include <grpcpp/server_builder.h>
@@ -28,6 +31,7 @@ limitations under the License.
 #include "../../util/DNSResolver.h"
 #include "../../util/TimeUtil.h"
 #include "../../util/TlsUtil.h"
+#include "../../util/Util.h"
 #include "../../common_types.h"
 #include "../generated/raft.grpc.pb.h"
 #include "../RaftConstants.h"
@@ -50,7 +54,11 @@ struct RaftEventBase {
     AppendEntriesRequest = 3,
     AppendEntriesResponse = 4,
     ClientRequest = 5,
-    SyncRequest = 6
+    SyncRequest = 6,
+    TimeoutNowRequest = 7,
+    TimeoutNowResponse = 8,
+    TransferLeadership = 9,
+    ChangeMembership = 10
   };
 
   Type mType = Type::Unknown;
@@ -176,8 +184,36 @@ void CallData<RequestVote::Request, RequestVote::Response>::proceed() {
   }
 }
 
+template<>
+inline
+void CallData<TimeoutNow::Request, TimeoutNow::Response>::proceed() {
+  if (mCallStatus == CallStatus::CREATE) {
+    mCallStatus = CallStatus::PROCESS;
+    mService->RequestTimeoutNowV2(&mContext, &mRequest, &mResponder,
+                                  mCompletionQueue, mCompletionQueue, this);
+  } else if (mCallStatus == CallStatus::PROCESS) {
+    new CallData<TimeoutNow::Request,
+                 TimeoutNow::Response>(mService, mCompletionQueue, mAeRvQueue);
+
+    /// payload is a pointer, RaftEvent does not handle
+    /// life cycle of CallData, since CallData will suicide itself
+    using EventType = RaftEvent<CallData<TimeoutNow::Request,
+                                         TimeoutNow::Response> *>;
+
+    auto event = std::make_shared<EventType>();
+    event->mType = RaftEventBase::Type::TimeoutNowRequest;
+    event->mPayload = this;
+
+    mAeRvQueue->enqueue(event);
+  } else {
+    GPR_ASSERT(mCallStatus == CallStatus::FINISH);
+    delete this;
+  }
+}
+
 using AppendEntriesCallData = CallData<AppendEntries::Request, AppendEntries::Response>;
 using RequestVoteCallData = CallData<RequestVote::Request, RequestVote::Response>;
+using TimeoutNowCallData = CallData<TimeoutNow::Request, TimeoutNow::Response>;
 
 //////////////////////////// RaftServer ////////////////////////////
 
@@ -211,6 +247,8 @@ class RaftServer {
 
 //////////////////////////// AsyncClientCall ////////////////////////////
 
+class RaftClient;
+
 struct AsyncClientCallBase {
   virtual ~AsyncClientCallBase() = default;
 
@@ -220,6 +258,10 @@ struct AsyncClientCallBase {
   grpc::ClientContext mContext;
   grpc::Status mStatus;
   uint64_t mPeerId = 0;
+
+  /// the client that issued this call, it outlives the call
+  /// since removed clients are retired to RaftClientLoop
+  RaftClient *mClient = nullptr;
 };
 
 template<typename ResponseType>
@@ -261,8 +303,62 @@ RaftEventBase::Type AsyncClientCall<RequestVote::Response>::getType() const {
   return RaftEventBase::Type::RequestVoteResponse;
 }
 
+template<>
+inline
+std::string AsyncClientCall<TimeoutNow::Response>::toString() const {
+  return "Leader sending TN_req to Follower " + std::to_string(mPeerId);
+}
+
+template<>
+inline
+RaftEventBase::Type AsyncClientCall<TimeoutNow::Response>::getType() const {
+  return RaftEventBase::Type::TimeoutNowResponse;
+}
+
 using AppendEntriesClientCall = AsyncClientCall<AppendEntries::Response>;
 using RequestVoteClientCall = AsyncClientCall<RequestVote::Response>;
+using TimeoutNowClientCall = AsyncClientCall<TimeoutNow::Response>;
+
+//////////////////////////// RaftClientLoop ////////////////////////////
+
+/**
+ * Completion queue and its polling threads, shared by RaftClients of all
+ * peers, or of all raft groups hosted in one process, so that thread num
+ * does not grow with peer num.
+ * Only client side is shared, each RaftCore still runs its own main loop,
+ * RaftServer and log.
+ */
+class RaftClientLoop {
+ public:
+  explicit RaftClientLoop(uint64_t threadNum);
+  ~RaftClientLoop();
+
+  grpc::CompletionQueue *getCompletionQueue() { return &mCompletionQueue; }
+
+  /// take over a client that is no longer used, it is released by
+  /// client loop once its in-flight calls are completed, so that
+  /// caller, e.g., raft main loop, never waits for rpc deadline.
+  void retire(std::unique_ptr<RaftClient> client);
+
+ private:
+  /// thread function of mClientLoops.
+  void clientLoopMain(uint64_t threadIndex);
+
+  /// release retired clients which have no in-flight calls
+  void reapRetiredClients();
+
+  grpc::CompletionQueue mCompletionQueue;
+  std::vector<std::thread> mClientLoops;
+
+  std::mutex mRetiredMutex;
+  std::list<std::unique_ptr<RaftClient>> mRetiredClients;
+  /// size of mRetiredClients, checked before taking mRetiredMutex
+  std::atomic<uint64_t> mRetiredNum = 0;
+
+  FRIEND_TEST(RaftClientLoopTest, RetireIdleClientTest);
+  FRIEND_TEST(RaftClientLoopTest, RetireBusyClientTest);
+  FRIEND_TEST(RaftClientLoopTest, DropResponseOfRetiredClientTest);
+};
 
 //////////////////////////// RaftClient ////////////////////////////
 
@@ -272,16 +368,21 @@ class RaftClient {
              std::optional<TlsConf> tlsConfOpt,
              std::shared_ptr<DNSResolver> dnsResolver,
              uint64_t peerId,
-             EventQueue *aeRvQueue);
+             EventQueue *aeRvQueue,
+             std::shared_ptr<RaftClientLoop> clientLoop);
   ~RaftClient();
 
   void requestVote(const RequestVote::Request &request);
   void appendEntries(const AppendEntries::Request &request);
+  void timeoutNow(const TimeoutNow::Request &request);
+
+  /// called by RaftClientLoop once call is completed, takes ownership of call
+  void handleResponse(AsyncClientCallBase *call);
 
  private:
+  friend class RaftClientLoop;
+
   void refressChannel();
-  /// thread function of mClientLoop.
-  void clientLoopMain();
 
   std::string mPeerAddress;
   std::string mResolvedPeerAddress;
@@ -290,14 +391,24 @@ class RaftClient {
   uint64_t mPeerId = 0;
   std::unique_ptr<Raft::Stub> mStub;
   std::shared_mutex mMutex;  /// the lock to guarantee thread-safe access of mStub
-  grpc::CompletionQueue mCompletionQueue;
+
+  /// shared completion queue, must outlive all calls of this client
+  std::shared_ptr<RaftClientLoop> mClientLoop;
+  grpc::CompletionQueue *mCompletionQueue;
 
   /// event queue
   EventQueue *mAeRvQueue;
 
-  /// flag that notify resp receive thread to quit
+  /// flag that notify client loop to drop responses
   std::atomic<bool> mRunning = true;
-  std::thread mClientLoop;
+  /// held by handleResponse while it may enqueue, so that once retire()
+  /// flips mRunning, mAeRvQueue is no longer accessed
+  std::shared_mutex mRunningMutex;
+  /// calls not completed yet, a retired client is released once it drops to 0
+  std::atomic<uint64_t> mInflightCalls = 0;
+
+  FRIEND_TEST(RaftClientLoopTest, RetireBusyClientTest);
+  FRIEND_TEST(RaftClientLoopTest, DropResponseOfRetiredClientTest);
 };
 
 //////////////////////////// Alias ////////////////////////////
@@ -308,8 +419,13 @@ using AppendEntriesResponseEvent = RaftEvent<std::unique_ptr<AppendEntriesClient
 using RequestVoteRequestEvent = RaftEvent<RequestVoteCallData *>;
 using RequestVoteResponseEvent = RaftEvent<std::unique_ptr<RequestVoteClientCall>>;
 
+using TimeoutNowRequestEvent = RaftEvent<TimeoutNowCallData *>;
+using TimeoutNowResponseEvent = RaftEvent<std::unique_ptr<TimeoutNowClientCall>>;
+
 using ClientRequestsEvent = RaftEvent<ClientRequests>;
 using SyncRequestsEvent = RaftEvent<SyncRequest>;
+using TransferLeadershipEvent = RaftEvent<TransferLeadershipRequest>;
+using ChangeMembershipEvent = RaftEvent<ChangeMembershipRequest>;
 
 }  /// namespace v2
 }  /// namespace raft
@@ -14,22 +14,29 @@ limitations under the License.
 #include "ClusterInfo.h"
 
 #include <absl/strings/str_split.h>
+#include <absl/strings/match.h>
 #include <absl/strings/str_format.h>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
+#include <cstring>
 #include <spdlog/spdlog.h>
 
 #include "Util.h"
 
 namespace gringofts {
 
+namespace {
+/// marks a learner in cluster conf
+constexpr const char *kLearnerSuffix = "/learner";
+}  /// namespace
+
 std::string ClusterInfo::to_string() const {
   std::string str;
   for (const auto &kv : mNodes) {
     auto idx = kv.first;
     auto node = kv.second;
-    str += absl::StrFormat("%d@%s:%d|%d|%d|%d|%d|%d,",
-                           idx, node.mHostName,
+    str += absl::StrFormat("%d%s@%s:%d|%d|%d|%d|%d|%d,",
+                           idx, node.mIsLearner ? kLearnerSuffix : "", node.mHostName,
                            node.mPortForRaft, node.mPortForGateway, node.mPortForFetcher,
                            node.mPortForStream, node.mPortForNetAdmin, node.mPortForScale);
   }
@@ -166,6 +173,10 @@ std::map<ClusterId, ClusterInfo> ClusterInfo::parseToClusterInfo(const std::stri
       Node node;
       std::pair<std::string, std::string> hostWithPort = absl::StrSplit(n, ":");
       std::pair<std::string, std::string> idWithHost = absl::StrSplit(hostWithPort.first, "@");
+      if (absl::EndsWith(idWithHost.first, kLearnerSuffix)) {
+        node.mIsLearner = true;
+        idWithHost.first.resize(idWithHost.first.size() - std::strlen(kLearnerSuffix));
+      }
       node.mNodeId = std::stoi(idWithHost.first);
       node.mHostName = idWithHost.second;
       if (hostWithPort.second.empty()) {
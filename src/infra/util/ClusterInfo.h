@@ -52,6 +52,8 @@ class ClusterInfo final {
     Port mPortForStream = kDefaultStreamingPort;
     Port mPortForNetAdmin = kDefaultNetAdminPort;
     Port mPortForScale = kDefaultScalePort;
+    /// learner replicates log but neither votes nor counts toward majority
+    bool mIsLearner = false;
   };
 
   /**
@@ -74,6 +76,7 @@ class ClusterInfo final {
   /// 3@node03.ebay.com:5245|50055|50056|5678|50065|61203;
   /// 1#1@node11.ebay.com:5245|50055|50056|5678|50065|61203,2@node12.ebay.com:5245|50055|50056|5678|50065|61203,
   /// 3@node13.ebay.com:5245|50055|50056|5678|50065|61203
+  /// a learner is marked after its node id, e.g., 4/learner@node04.ebay.com:5245|50055|50056|5678|50065|61203
   static std::map<ClusterId, ClusterInfo> parseToClusterInfo(const std::string &infoStr);
 
   ClusterId mClusterId;
@@ -0,0 +1,100 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "CompressionUtil.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <absl/strings/ascii.h>
+#include <spdlog/spdlog.h>
+
+namespace gringofts {
+
+std::optional<CompressionType> CompressionUtil::parse(const std::string &name) {
+  auto lowerName = absl::AsciiStrToLower(name);
+  if (lowerName == "none") {
+    return CompressionType::None;
+  } else if (lowerName == "lz4") {
+    return CompressionType::LZ4;
+  } else if (lowerName == "zstd") {
+    return CompressionType::Zstd;
+  }
+  return std::nullopt;
+}
+
+std::string CompressionUtil::toString(CompressionType type) {
+  switch (type) {
+    case CompressionType::None: return "none";
+    case CompressionType::LZ4: return "lz4";
+    case CompressionType::Zstd: return "zstd";
+  }
+  return "unknown";
+}
+
+bool CompressionUtil::compress(CompressionType type, const std::string &src, std::string *dst) {
+  if (type == CompressionType::LZ4) {
+    dst->resize(LZ4_compressBound(src.size()));
+    auto size = LZ4_compress_default(src.data(), dst->data(), src.size(), dst->size());
+    if (size <= 0) {
+      SPDLOG_ERROR("Failed to compress {} bytes with lz4.", src.size());
+      return false;
+    }
+    dst->resize(size);
+    return true;
+  }
+
+  if (type == CompressionType::Zstd) {
+    dst->resize(ZSTD_compressBound(src.size()));
+    auto size = ZSTD_compress(dst->data(), dst->size(), src.data(), src.size(), kZstdLevel);
+    if (ZSTD_isError(size)) {
+      SPDLOG_ERROR("Failed to compress {} bytes with zstd, {}.", src.size(), ZSTD_getErrorName(size));
+      return false;
+    }
+    dst->resize(size);
+    return true;
+  }
+
+  *dst = src;
+  return true;
+}
+
+bool CompressionUtil::decompress(CompressionType type, const std::string &src,
+                                 uint64_t originalSize, std::string *dst) {
+  if (type == CompressionType::LZ4) {
+    dst->resize(originalSize);
+    auto size = LZ4_decompress_safe(src.data(), dst->data(), src.size(), dst->size());
+    if (size < 0 || static_cast<uint64_t>(size) != originalSize) {
+      SPDLOG_ERROR("Failed to decompress {} bytes with lz4, expect {} bytes, got {}.",
+                   src.size(), originalSize, size);
+      return false;
+    }
+    return true;
+  }
+
+  if (type == CompressionType::Zstd) {
+    dst->resize(originalSize);
+    auto size = ZSTD_decompress(dst->data(), dst->size(), src.data(), src.size());
+    if (ZSTD_isError(size) || size != originalSize) {
+      SPDLOG_ERROR("Failed to decompress {} bytes with zstd, expect {} bytes.", src.size(), originalSize);
+      return false;
+    }
+    return true;
+  }
+
+  *dst = src;
+  return true;
+}
+
+}  /// namespace gringofts
@@ -0,0 +1,60 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_UTIL_COMPRESSIONUTIL_H_
+#define SRC_INFRA_UTIL_COMPRESSIONUTIL_H_
+
+#include <optional>
+#include <string>
+
+namespace gringofts {
+
+/// values are kept the same as raft::Compression on the wire
+enum class CompressionType {
+  None = 0,
+  LZ4 = 1,
+  Zstd = 2,
+};
+
+/**
+ * A thin wrapper of lz4 and zstd, both of which are linked for rocksdb.
+ */
+class CompressionUtil final {
+ public:
+  /**
+   * Parse "none", "lz4" or "zstd", return nullopt if unknown.
+   */
+  static std::optional<CompressionType> parse(const std::string &name);
+
+  static std::string toString(CompressionType type);
+
+  /**
+   * Compress src into dst, return false if failed.
+   */
+  static bool compress(CompressionType type, const std::string &src, std::string *dst);
+
+  /**
+   * Decompress src into dst, whose size is originalSize, return false if failed.
+   */
+  static bool decompress(CompressionType type, const std::string &src,
+                         uint64_t originalSize, std::string *dst);
+
+ private:
+  /// zstd trades ratio for speed at level 1, good enough for journal entries
+  static constexpr int kZstdLevel = 1;
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_UTIL_COMPRESSIONUTIL_H_
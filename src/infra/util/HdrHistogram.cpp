@@ -0,0 +1,87 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "HdrHistogram.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace gringofts {
+
+uint64_t HdrHistogram::bucketIndexOf(uint64_t value) {
+  if (value < kSubBucketCount) {
+    return value;
+  }
+  /// shift so that the top kSignificantBits bits remain, i.e., the result is in [kSubBucketHalfCount, kSubBucketCount)
+  uint64_t shift = 64 - __builtin_clzll(value) - kSignificantBits;
+  return kSubBucketCount + (shift - 1) * kSubBucketHalfCount + ((value >> shift) - kSubBucketHalfCount);
+}
+
+uint64_t HdrHistogram::highestValueOf(uint64_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  uint64_t shift = (index - kSubBucketCount) / kSubBucketHalfCount + 1;
+  uint64_t subBucket = (index - kSubBucketCount) % kSubBucketHalfCount + kSubBucketHalfCount;
+  /// computed as lowest + (width - 1), the bucket of the largest values would overflow otherwise
+  return (subBucket << shift) + ((1ull << shift) - 1);
+}
+
+void HdrHistogram::record(uint64_t value, uint64_t count) {
+  mCounts[bucketIndexOf(value)] += count;
+  mTotalCount += count;
+  mMin = std::min(mMin, value);
+  mMax = std::max(mMax, value);
+  mSum += static_cast<unsigned __int128>(value) * count;
+}
+
+void HdrHistogram::merge(const HdrHistogram &other) {
+  for (uint64_t i = 0; i < kNumBuckets; ++i) {
+    mCounts[i] += other.mCounts[i];
+  }
+  mTotalCount += other.mTotalCount;
+  mMin = std::min(mMin, other.mMin);
+  mMax = std::max(mMax, other.mMax);
+  mSum += other.mSum;
+}
+
+void HdrHistogram::reset() {
+  std::fill(mCounts.begin(), mCounts.end(), 0);
+  mTotalCount = 0;
+  mMin = UINT64_MAX;
+  mMax = 0;
+  mSum = 0;
+}
+
+uint64_t HdrHistogram::valueAtPercentile(double percentile) const {
+  assert(percentile >= 0 && percentile <= 100);
+  if (mTotalCount == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(std::ceil(percentile / 100 * mTotalCount));
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t accumulated = 0;
+  for (uint64_t i = 0; i < kNumBuckets; ++i) {
+    accumulated += mCounts[i];
+    if (accumulated >= rank) {
+      /// never report beyond what was actually recorded
+      return std::min(highestValueOf(i), mMax);
+    }
+  }
+  return mMax;
+}
+
+}  /// namespace gringofts
@@ -0,0 +1,74 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_UTIL_HDRHISTOGRAM_H_
+#define SRC_INFRA_UTIL_HDRHISTOGRAM_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace gringofts {
+
+/**
+ * High dynamic range histogram of uint64 values, e.g., latencies in nanoseconds.
+ *
+ * Values below 2^kSignificantBits are counted exactly. Above that, each power of two
+ * is split into 2^(kSignificantBits - 1) linear buckets, so any recorded value, and any
+ * percentile, is off by less than 1/64 of itself, whatever its magnitude.
+ * Recording is O(1) and never allocates. Not thread-safe.
+ */
+class HdrHistogram {
+ public:
+  static constexpr uint32_t kSignificantBits = 7;
+  static constexpr uint64_t kSubBucketCount = 1ull << kSignificantBits;
+  static constexpr uint64_t kSubBucketHalfCount = kSubBucketCount / 2;
+  static constexpr uint64_t kNumBuckets = kSubBucketCount + (64 - kSignificantBits) * kSubBucketHalfCount;
+
+  /// the bucket value is counted in, buckets are ordered by the values they hold
+  static uint64_t bucketIndexOf(uint64_t value);
+  /// the largest value counted in bucket index
+  static uint64_t highestValueOf(uint64_t index);
+
+  HdrHistogram() : mCounts(kNumBuckets, 0) {}
+
+  void record(uint64_t value, uint64_t count = 1);
+
+  /// add all values recorded by other
+  void merge(const HdrHistogram &other);
+
+  void reset();
+
+  /**
+   * The smallest recorded value that percentile% of values are less than or equal to,
+   * within the precision of its bucket. 0 if nothing is recorded.
+   */
+  uint64_t valueAtPercentile(double percentile) const;
+
+  uint64_t count() const { return mTotalCount; }
+  uint64_t min() const { return mTotalCount == 0 ? 0 : mMin; }
+  uint64_t max() const { return mMax; }
+  double mean() const { return mTotalCount == 0 ? 0 : static_cast<double>(mSum) / mTotalCount; }
+
+ private:
+  std::vector<uint64_t> mCounts;
+  uint64_t mTotalCount = 0;
+  uint64_t mMin = UINT64_MAX;
+  uint64_t mMax = 0;
+  /// 128 bits so that sums of uint64 values do not wrap in practice
+  unsigned __int128 mSum = 0;
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_UTIL_HDRHISTOGRAM_H_
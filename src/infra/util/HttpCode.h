@@ -25,8 +25,10 @@ class HttpCode {
   static constexpr int BAD_REQUEST = 400;
   static constexpr int FORBIDDEN = 403;
   static constexpr int CONFLICT = 409;
+  static constexpr int TOO_MANY_REQUESTS = 429;
 
   static constexpr int SERVICE_UNAVAILABLE = 503;
+  static constexpr int GATEWAY_TIMEOUT = 504;
   static constexpr int INTERNAL_SERVER_ERROR = 500;
 };
 
@@ -0,0 +1,127 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "LogUtil.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_sinks.h>
+
+#include "TimeUtil.h"
+
+namespace gringofts {
+
+namespace {
+/**
+ * Front of two async loggers sharing one worker, so lines stay in order.
+ * Info and below go through the configured overflow policy, warn and above always block,
+ * so that a full queue never drops them.
+ */
+class LevelSplitLogger final : public spdlog::logger {
+ public:
+  LevelSplitLogger(std::string name,
+                   std::shared_ptr<spdlog::logger> lossyLogger,
+                   std::shared_ptr<spdlog::logger> blockingLogger)
+      : spdlog::logger(std::move(name)),
+        mLossyLogger(std::move(lossyLogger)), mBlockingLogger(std::move(blockingLogger)) {}
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg &msg) override {
+    auto &logger = msg.level >= spdlog::level::warn ? mBlockingLogger : mLossyLogger;
+    logger->log(msg.time, msg.source, msg.level, msg.payload);
+  }
+
+  void flush_() override {
+    mLossyLogger->flush();
+    mBlockingLogger->flush();
+  }
+
+ private:
+  std::shared_ptr<spdlog::logger> mLossyLogger;
+  std::shared_ptr<spdlog::logger> mBlockingLogger;
+};
+}  /// namespace
+
+void LogUtil::initLogger(const INIReader &reader, const std::string &pattern) {
+  bool asyncEnabled = reader.GetBoolean("log", "async.enabled", true);
+  auto queueSize = reader.GetInteger("log", "async.queue.size", 65536);
+  auto overflowPolicy = reader.Get("log", "async.overflow.policy", "overrun_oldest");
+  auto level = reader.Get("log", "level", "info");
+  auto flushIntervalInSec = reader.GetInteger("log", "flush.interval.in.sec", 1);
+
+  if (!asyncEnabled) {
+    initLogger(pattern);
+  } else {
+    if (queueSize <= 0) {
+      SPDLOG_ERROR("async.queue.size should be positive, got {}, exiting", queueSize);
+      exit(1);
+    }
+    spdlog::async_overflow_policy policy;
+    if (overflowPolicy == "block") {
+      policy = spdlog::async_overflow_policy::block;
+    } else if (overflowPolicy == "overrun_oldest") {
+      policy = spdlog::async_overflow_policy::overrun_oldest;
+    } else {
+      SPDLOG_ERROR("unknown async.overflow.policy {}, exiting", overflowPolicy);
+      exit(1);
+    }
+
+    /// a single worker keeps lines in order
+    spdlog::init_thread_pool(queueSize, 1);
+    auto sink = std::make_shared<spdlog::sinks::stdout_sink_mt>();
+    auto lossyLogger = std::make_shared<spdlog::async_logger>("console.lossy", sink, spdlog::thread_pool(), policy);
+    auto blockingLogger = std::make_shared<spdlog::async_logger>("console.blocking", sink, spdlog::thread_pool(),
+                                                                 spdlog::async_overflow_policy::block);
+    for (auto &asyncLogger : {lossyLogger, blockingLogger}) {
+      /// level is checked by the front logger
+      asyncLogger->set_level(spdlog::level::trace);
+      asyncLogger->set_pattern(pattern);
+    }
+    auto logger = std::make_shared<LevelSplitLogger>("console", lossyLogger, blockingLogger);
+    spdlog::register_logger(logger);
+    spdlog::set_default_logger(logger);
+    spdlog::set_pattern(pattern);
+    if (flushIntervalInSec > 0) {
+      spdlog::flush_every(std::chrono::seconds(flushIntervalInSec));
+    }
+    /// errors are written and flushed by the worker right after everything queued before them,
+    /// but a crash may still kill the process before that, shutdown() drains the queue otherwise
+    spdlog::flush_on(spdlog::level::err);
+  }
+
+  spdlog::set_level(spdlog::level::from_str(level));
+  SPDLOG_INFO("logger initialized, async={}, queueSize={}, overflowPolicy={}, level={}",
+              asyncEnabled, queueSize, overflowPolicy, level);
+}
+
+void LogUtil::initLogger(const std::string &pattern) {
+  auto logger = spdlog::stdout_logger_mt("console");
+  spdlog::set_default_logger(logger);
+  spdlog::set_pattern(pattern);
+}
+
+void LogUtil::shutdown() {
+  spdlog::shutdown();
+}
+
+bool LogUtil::shouldLog(std::atomic<uint64_t> *lastLogTimeInNanos, uint64_t intervalInMs) {
+  auto now = TimeUtil::currentTimeInNanos();
+  auto last = lastLogTimeInNanos->load(std::memory_order_relaxed);
+  if (last != 0 && now - last < intervalInMs * 1000 * 1000) {
+    return false;
+  }
+  /// losers of the race skip this round
+  return lastLogTimeInNanos->compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+}  /// namespace gringofts
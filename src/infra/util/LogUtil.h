@@ -0,0 +1,86 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_UTIL_LOGUTIL_H_
+#define SRC_INFRA_UTIL_LOGUTIL_H_
+
+#include <atomic>
+#include <string>
+
+#include <INIReader.h>
+#include <spdlog/spdlog.h>
+
+namespace gringofts {
+
+/**
+ * Logger setup shared by all mains, plus helpers to keep logging off the critical path.
+ *
+ * With [log] async.enabled = true (the default), log lines are formatted and written by
+ * a background spdlog thread, so a slow stdout never stalls raft or CPL threads.
+ * Supported keys in [log]:
+ *   async.enabled         - true|false, default true
+ *   async.queue.size      - max pending log lines, default 65536
+ *   async.overflow.policy - block|overrun_oldest, default overrun_oldest,
+ *                           i.e. drop the oldest line instead of blocking the caller.
+ *                           Only for info and below, warn and above always block
+ *   level                 - trace|debug|info|warn|err|critical|off, default info
+ *   flush.interval.in.sec - periodic flush for the async logger, default 1
+ */
+class LogUtil final {
+ public:
+  static void initLogger(const INIReader &reader, const std::string &pattern);
+
+  /// sync stdout logger, for tools without config
+  static void initLogger(const std::string &pattern);
+
+  /// flush pending lines and stop the async thread, call before main returns
+  static void shutdown();
+
+  /**
+   * Returns true if at least intervalInMs has passed since the last time it returned
+   * true for this lastLogTimeInNanos. Only one of the concurrent callers wins.
+   */
+  static bool shouldLog(std::atomic<uint64_t> *lastLogTimeInNanos, uint64_t intervalInMs);
+
+  /// Returns true for the 1st, (n+1)th, (2n+1)th... call on this counter.
+  static bool shouldLogEveryN(std::atomic<uint64_t> *counter, uint64_t n) {
+    return n <= 1 || counter->fetch_add(1, std::memory_order_relaxed) % n == 0;
+  }
+};
+
+}  /// namespace gringofts
+
+/// per-callsite rate limited logging, the state is a static owned by the callsite
+#define GRINGOFTS_LOG_EVERY_MS(LOG_MACRO, intervalInMs, ...)                                \
+  do {                                                                                     \
+    static std::atomic<uint64_t> gringoftsLastLogTimeInNanos{0};                           \
+    if (gringofts::LogUtil::shouldLog(&gringoftsLastLogTimeInNanos, (intervalInMs))) {     \
+      LOG_MACRO(__VA_ARGS__);                                                              \
+    }                                                                                      \
+  } while (0)
+
+#define GRINGOFTS_LOG_EVERY_N(LOG_MACRO, n, ...)                                            \
+  do {                                                                                     \
+    static std::atomic<uint64_t> gringoftsLogCounter{0};                                   \
+    if (gringofts::LogUtil::shouldLogEveryN(&gringoftsLogCounter, (n))) {                 \
+      LOG_MACRO(__VA_ARGS__);                                                              \
+    }                                                                                      \
+  } while (0)
+
+#define SPDLOG_INFO_EVERY_MS(intervalInMs, ...) GRINGOFTS_LOG_EVERY_MS(SPDLOG_INFO, intervalInMs, __VA_ARGS__)
+#define SPDLOG_WARN_EVERY_MS(intervalInMs, ...) GRINGOFTS_LOG_EVERY_MS(SPDLOG_WARN, intervalInMs, __VA_ARGS__)
+#define SPDLOG_INFO_EVERY_N(n, ...) GRINGOFTS_LOG_EVERY_N(SPDLOG_INFO, n, __VA_ARGS__)
+#define SPDLOG_WARN_EVERY_N(n, ...) GRINGOFTS_LOG_EVERY_N(SPDLOG_WARN, n, __VA_ARGS__)
+
+#endif  // SRC_INFRA_UTIL_LOGUTIL_H_
@@ -26,6 +26,12 @@ NewDeleteMemoryPool::NewDeleteMemoryPool(const std::string &name):
   mMemoryResource = std::make_unique<TrackingMemoryResource>(name, std::pmr::new_delete_resource());
 }
 
+PoolPMRMemoryPool::PoolPMRMemoryPool(const std::string &name):
+  PMRMemoryPool(name) {
+  mInternalMemoryResource = std::make_unique<std::pmr::synchronized_pool_resource>(std::pmr::new_delete_resource());
+  mMemoryResource = std::make_unique<TrackingMemoryResource>(name, mInternalMemoryResource.get());
+}
+
 MonotonicPMRMemoryPool::MonotonicPMRMemoryPool(
     const std::string &name,
     uint64_t reserveSizeInMB):
@@ -46,7 +52,8 @@ void MonotonicPMRMemoryPool::init() {
   SPDLOG_INFO("pool {}: init memory pool", mName);
   mInternalMemoryResource = std::make_unique<std::pmr::monotonic_buffer_resource>(
       mBuffer, mReserveSize, std::pmr::null_memory_resource());
-  mMemoryResource = std::make_unique<TrackingMemoryResource>(mName, mInternalMemoryResource.get());
+  /// monotonic_buffer_resource is not thread-safe
+  mMemoryResource = std::make_unique<TrackingMemoryResource>(mName, mInternalMemoryResource.get(), true);
 }
 
 void MonotonicPMRMemoryPool::release() {
@@ -46,6 +46,18 @@ class NewDeleteMemoryPool: public PMRMemoryPool {
   virtual ~NewDeleteMemoryPool() = default;
 };
 
+/// size-classed pools on top of new/delete, freed memory is reused.
+/// unbounded, max.pool.size.in.mb only applies to MonotonicPMRMemoryPool
+class PoolPMRMemoryPool: public PMRMemoryPool {
+ public:
+  explicit PoolPMRMemoryPool(const std::string &name);
+  virtual ~PoolPMRMemoryPool() = default;
+
+ private:
+  std::unique_ptr<std::pmr::memory_resource> mInternalMemoryResource;
+};
+
+/// bump allocation in a reserved buffer, freed memory is only reclaimed by reset()
 class MonotonicPMRMemoryPool: public PMRMemoryPool {
  public:
   MonotonicPMRMemoryPool(const std::string &name, uint64_t reserveSizeInMB);
@@ -24,6 +24,10 @@ namespace gringofts {
 
 class MetricReporter final {
  public:
+  /**
+   * Looks the metrics up by name on every call, on hot paths prefer the overload below
+   * with a histogram handle kept by the caller.
+   */
   static void reportLatency(
       const std::string &metricName,
       TimestampInNanos start,
@@ -37,17 +41,34 @@ class MetricReporter final {
     }
     auto latency = (end - start) / 1000000.0;
     if (reportSummary) {
-      auto summary = gringofts::getSummary(metricName, {});
+      auto summary = gringofts::getSummary(metricName, {});  /// metric-lookup: by-name API
       summary.observe(latency);
     }
     if (reportDetail) {
-      auto gauge = gringofts::getGauge("detail_" + metricName, {});
+      auto gauge = gringofts::getGauge("detail_" + metricName, {});  /// metric-lookup: by-name API
       gauge.set(latency);
     }
     if (reportLog) {
       SPDLOG_INFO("latency report of {}: {}", metricName, latency);
     }
   }
+
+  static void reportLatency(
+      santiago::MetricsCenter::HistogramType &histogram,
+      const std::string &metricName,
+      TimestampInNanos start,
+      TimestampInNanos end,
+      bool reportLog = false) {
+    if (start > end) {
+      SPDLOG_WARN("invalid latency of {}, {} vs {}", metricName, start, end);
+      return;
+    }
+    auto latency = (end - start) / 1000000.0;
+    histogram.observe(latency);
+    if (reportLog) {
+      SPDLOG_INFO("latency report of {}: {}", metricName, latency);
+    }
+  }
 };
 
 }  /// namespace gringofts
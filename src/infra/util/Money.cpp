@@ -0,0 +1,149 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "Money.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace gringofts {
+
+namespace {
+/// numeric_limits is not specialized for __int128 in strict ISO mode
+constexpr Money::ValueType kMaxValue =
+    static_cast<Money::ValueType>((static_cast<unsigned __int128>(1) << 127) - 1);
+}
+
+uint32_t Money::scaleOf(uint32_t iso4217CurrencyCode) {
+  switch (iso4217CurrencyCode) {
+    /// no minor unit
+    case 152:   /// CLP
+    case 352:   /// ISK
+    case 392:   /// JPY
+    case 410:   /// KRW
+    case 704:   /// VND
+    case 952:   /// XOF
+    case 953:   /// XPF
+      return 0;
+    /// three-digit minor unit
+    case 48:    /// BHD
+    case 368:   /// IQD
+    case 400:   /// JOD
+    case 414:   /// KWD
+    case 434:   /// LYD
+    case 512:   /// OMR
+    case 788:   /// TND
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+std::optional<Money> Money::parse(const std::string &decimal, uint32_t iso4217CurrencyCode) {
+  auto scale = scaleOf(iso4217CurrencyCode);
+  std::size_t pos = 0;
+  bool negative = false;
+  if (pos < decimal.size() && (decimal[pos] == '-' || decimal[pos] == '+')) {
+    negative = decimal[pos] == '-';
+    ++pos;
+  }
+
+  ValueType value = 0;
+  bool hasDigit = false;
+  bool hasPoint = false;
+  uint32_t fractionDigits = 0;
+  for (; pos < decimal.size(); ++pos) {
+    auto c = decimal[pos];
+    if (c == '.' && !hasPoint) {
+      hasPoint = true;
+      continue;
+    }
+    if (c < '0' || c > '9') {
+      return std::nullopt;
+    }
+    if (hasPoint && ++fractionDigits > scale) {
+      return std::nullopt;
+    }
+    if (value > (kMaxValue - (c - '0')) / 10) {
+      return std::nullopt;
+    }
+    value = value * 10 + (c - '0');
+    hasDigit = true;
+  }
+  if (!hasDigit) {
+    return std::nullopt;
+  }
+
+  for (; fractionDigits < scale; ++fractionDigits) {
+    if (value > kMaxValue / 10) {
+      return std::nullopt;
+    }
+    value *= 10;
+  }
+  return Money(negative ? -value : value, iso4217CurrencyCode);
+}
+
+bool Money::tryAdd(const Money &other) {
+  if (mCurrencyCode != other.mCurrencyCode) {
+    return false;
+  }
+  ValueType result;
+  if (__builtin_add_overflow(mMinorUnits, other.mMinorUnits, &result)) {
+    return false;
+  }
+  mMinorUnits = result;
+  return true;
+}
+
+bool Money::trySub(const Money &other) {
+  if (mCurrencyCode != other.mCurrencyCode) {
+    return false;
+  }
+  ValueType result;
+  if (__builtin_sub_overflow(mMinorUnits, other.mMinorUnits, &result)) {
+    return false;
+  }
+  mMinorUnits = result;
+  return true;
+}
+
+bool Money::fitsInUint64() const {
+  return mMinorUnits >= 0 && mMinorUnits <= std::numeric_limits<uint64_t>::max();
+}
+
+std::string Money::toString() const {
+  /// print the magnitude digit by digit, the minimum value has no positive counterpart
+  std::string digits;
+  auto value = mMinorUnits;
+  do {
+    auto digit = static_cast<int>(value % 10);
+    digits.push_back(static_cast<char>('0' + (digit < 0 ? -digit : digit)));
+    value /= 10;
+  } while (value != 0);
+
+  auto scale = this->scale();
+  while (digits.size() <= scale) {
+    digits.push_back('0');
+  }
+  std::reverse(digits.begin(), digits.end());
+  if (scale > 0) {
+    digits.insert(digits.size() - scale, ".");
+  }
+  if (mMinorUnits < 0) {
+    digits.insert(0, "-");
+  }
+  return digits;
+}
+
+}  /// namespace gringofts
@@ -0,0 +1,81 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_UTIL_MONEY_H_
+#define SRC_INFRA_UTIL_MONEY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace gringofts {
+
+/**
+ * Fixed-point amount of money in minor units (e.g., cents) of an iso-4217 currency,
+ * whose scale is the number of digits of its minor unit, e.g., 2 for USD, 0 for JPY.
+ *
+ * 128 bits leave plenty of headroom above the uint64 amounts and balances on the wire,
+ * and, unlike BigDecimal, never allocate.
+ */
+class Money {
+ public:
+  using ValueType = __int128;
+
+  Money() = default;
+  Money(ValueType minorUnits, uint32_t iso4217CurrencyCode)
+      : mMinorUnits(minorUnits), mCurrencyCode(iso4217CurrencyCode) {}
+
+  /**
+   * Parse a decimal such as "-12.3" into minor units of the currency,
+   * return nullopt if malformed, overflowed or more precise than the currency.
+   */
+  static std::optional<Money> parse(const std::string &decimal, uint32_t iso4217CurrencyCode);
+
+  /// digits of the minor unit of the currency, 2 for unknown ones
+  static uint32_t scaleOf(uint32_t iso4217CurrencyCode);
+
+  ValueType minorUnits() const { return mMinorUnits; }
+  uint32_t currencyCode() const { return mCurrencyCode; }
+  uint32_t scale() const { return scaleOf(mCurrencyCode); }
+
+  /**
+   * Add or subtract another amount of the same currency.
+   * Return false and leave this untouched if currencies differ or the result overflows.
+   */
+  bool tryAdd(const Money &other);
+  bool trySub(const Money &other);
+
+  /// true if representable as a non-negative uint64 amount or balance
+  bool fitsInUint64() const;
+
+  /// decimal with exactly scale() fractional digits, e.g., "-12.30"
+  std::string toString() const;
+
+  bool operator==(const Money &rhs) const {
+    return mMinorUnits == rhs.mMinorUnits && mCurrencyCode == rhs.mCurrencyCode;
+  }
+
+  bool operator!=(const Money &rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  ValueType mMinorUnits = 0;
+  uint32_t mCurrencyCode = 0;
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_UTIL_MONEY_H_
@@ -0,0 +1,229 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_UTIL_OBJECTPOOL_H_
+#define SRC_INFRA_UTIL_OBJECTPOOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../monitor/MonitorTypes.h"
+
+namespace gringofts {
+
+/**
+ * Recycles memory blocks of kBlockSize bytes.
+ *
+ * Each thread allocates from and frees to its own cache without locking.
+ * Once a cache exceeds kMaxCachedBlocks, e.g., the cache of a thread destroying
+ * objects created by another thread, half of it is handed over to a shared depot,
+ * from which threads with an empty cache refill. Batches beyond kMaxDepotBatches
+ * go back to the heap, so a burst does not pin its peak memory forever.
+ */
+template<std::size_t kBlockSize>
+class BlockPool final {
+ public:
+  static constexpr std::size_t kMaxCachedBlocks = 1024;
+  static constexpr std::size_t kMaxDepotBatches = 32;
+
+  static void *allocate() {
+    auto &cache = localCache();
+    if (cache.mHead == nullptr) {
+      refill(&cache);
+    }
+    if (cache.mHead == nullptr) {
+      heapAllocationCounter().increase();
+      return ::operator new(kBlockSize);
+    }
+    auto *node = cache.mHead;
+    cache.mHead = node->mNext;
+    --cache.mSize;
+    return node;
+  }
+
+  static void deallocate(void *ptr) {
+    auto &cache = localCache();
+    auto *node = static_cast<Node *>(ptr);
+    node->mNext = cache.mHead;
+    cache.mHead = node;
+    if (++cache.mSize > kMaxCachedBlocks) {
+      spill(&cache, kMaxCachedBlocks / 2);
+    }
+  }
+
+ private:
+  struct Node {
+    Node *mNext;
+  };
+  static_assert(kBlockSize >= sizeof(Node), "block is too small to be linked");
+
+  struct Batch {
+    Node *mHead;
+    std::size_t mSize;
+  };
+
+  struct Cache {
+    Node *mHead = nullptr;
+    std::size_t mSize = 0;
+
+    /// thread exits, give its blocks to other threads
+    ~Cache() { spill(this, mSize); }
+  };
+
+  struct Depot {
+    std::mutex mMutex;
+    std::vector<Batch> mBatches;
+  };
+
+  static Cache &localCache() {
+    static thread_local Cache cache;
+    return cache;
+  }
+
+  static Depot &depot() {
+    /// never destroyed, thread caches may spill into it during exit
+    static auto *depot = new Depot;
+    return *depot;
+  }
+
+  static santiago::MetricsCenter::CounterType &heapAllocationCounter() {
+    static auto counter = getCounter("object_pool_heap_allocation_counter",
+                                     {{"block_size", std::to_string(kBlockSize)}});
+    return counter;
+  }
+
+  static santiago::MetricsCenter::CounterType &heapReleaseCounter() {
+    static auto counter = getCounter("object_pool_heap_release_counter",
+                                     {{"block_size", std::to_string(kBlockSize)}});
+    return counter;
+  }
+
+  static void refill(Cache *cache) {
+    auto &depot = BlockPool::depot();
+    std::lock_guard<std::mutex> lock(depot.mMutex);
+    if (depot.mBatches.empty()) {
+      return;
+    }
+    auto batch = depot.mBatches.back();
+    depot.mBatches.pop_back();
+    cache->mHead = batch.mHead;
+    cache->mSize = batch.mSize;
+  }
+
+  /// move the first num blocks of cache to the depot
+  static void spill(Cache *cache, std::size_t num) {
+    if (num == 0) {
+      return;
+    }
+    Batch batch{cache->mHead, num};
+    auto *tail = cache->mHead;
+    for (std::size_t i = 1; i < num; ++i) {
+      tail = tail->mNext;
+    }
+    cache->mHead = tail->mNext;
+    cache->mSize -= num;
+    tail->mNext = nullptr;
+
+    {
+      auto &depot = BlockPool::depot();
+      std::lock_guard<std::mutex> lock(depot.mMutex);
+      if (depot.mBatches.size() < kMaxDepotBatches) {
+        depot.mBatches.push_back(batch);
+        return;
+      }
+    }
+    release(batch);
+  }
+
+  /// depot is full, free blocks of batch to the heap
+  static void release(Batch batch) {
+    auto *node = batch.mHead;
+    while (node != nullptr) {
+      auto *next = node->mNext;
+      ::operator delete(node);
+      node = next;
+    }
+    heapReleaseCounter().increase(batch.mSize);
+  }
+};
+
+/// round up to 16 bytes so that types of similar sizes share a pool
+constexpr std::size_t pooledBlockSize(std::size_t size) {
+  return (size + 15) / 16 * 16;
+}
+
+/**
+ * Allocator backed by BlockPool, e.g., std::allocate_shared<T>(PoolAllocator<T>(), args...)
+ * recycles both T and the control block of shared_ptr.
+ */
+template<typename T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+
+  PoolAllocator() = default;
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U> &) {}  // NOLINT(runtime/explicit)
+
+  T *allocate(std::size_t n) {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned type is not supported");
+    if (n != 1) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(BlockPool<pooledBlockSize(sizeof(T))>::allocate());
+  }
+
+  void deallocate(T *ptr, std::size_t n) {
+    if (n != 1) {
+      ::operator delete(ptr);
+      return;
+    }
+    BlockPool<pooledBlockSize(sizeof(T))>::deallocate(ptr);
+  }
+
+  template<typename U>
+  bool operator==(const PoolAllocator<U> &) const { return true; }
+  template<typename U>
+  bool operator!=(const PoolAllocator<U> &) const { return false; }
+};
+
+/**
+ * Derive T from PooledObject<T> to allocate T from BlockPool via new,
+ * which also covers std::make_unique<T>. Classes derived from T fall back to the heap.
+ */
+template<typename T>
+class PooledObject {
+ public:
+  static void *operator new(std::size_t size) {
+    if (size != sizeof(T)) {
+      return ::operator new(size);
+    }
+    return BlockPool<pooledBlockSize(sizeof(T))>::allocate();
+  }
+
+  static void operator delete(void *ptr, std::size_t size) {
+    if (size != sizeof(T)) {
+      ::operator delete(ptr);
+      return;
+    }
+    BlockPool<pooledBlockSize(sizeof(T))>::deallocate(ptr);
+  }
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_UTIL_OBJECTPOOL_H_
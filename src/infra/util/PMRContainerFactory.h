@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef SRC_INFRA_UTIL_PMRCONTAINERFACTORY_H_
 #define SRC_INFRA_UTIL_PMRCONTAINERFACTORY_H_
 
+#include <mutex>
+
 #include "MemoryPool.h"
+#include "TrackingMemoryResource.h"
 
 namespace gringofts {
 class PMRContainerFactory {
@@ -29,9 +32,26 @@ class PMRContainerFactory {
   ~PMRContainerFactory() {
     mMemoryPool->release();
   }
+  /// all containers must have been deleted before resetting the pool
   void resetPool() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mContainerResources.clear();
     mMemoryPool->reset();
   }
+  /**
+   * Memory resource for the container named containerName, which allocates from the pool
+   * and exports its own usage. Containers with the same name share the same resource,
+   * so that they can be swapped with each other.
+   */
+  std::pmr::memory_resource* getMemoryResource(const std::string &containerName) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto &resource = mContainerResources[containerName];
+    if (!resource) {
+      resource = std::make_unique<TrackingMemoryResource>(mName + "." + containerName,
+                                                          mMemoryPool->getMemoryResource());
+    }
+    return resource.get();
+  }
   template <class T, class... Args>
   T* newContainer(Args&&... args) {
     auto memoryResource = mMemoryPool->getMemoryResource();
@@ -54,6 +74,8 @@ class PMRContainerFactory {
  private:
   std::string mName;
   std::unique_ptr<PMRMemoryPool> mMemoryPool;
+  std::mutex mMutex;
+  std::map<std::string, std::unique_ptr<TrackingMemoryResource>> mContainerResources;
 };
 }  // namespace gringofts
 
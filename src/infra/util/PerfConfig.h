@@ -59,8 +59,8 @@ class PerfConfig {
   uint64_t mGCWorkTimeInMills = 2;          /// 2ms by default
   uint64_t mGCIdleTimeInMills = 5;          /// 5ms by default
   uint64_t mMaxGCDataSize = 1000 * 10000;   /// 1000KW items
-  uint64_t mMaxMemoryPoolSizeInMB = 1024 * 2;  /// 2G memory pool reserved
-  std::string mMemoryPoolType = "monotonic";
+  uint64_t mMaxMemoryPoolSizeInMB = 1024 * 2;  /// 2G reserved by monotonic pool, pool|newdelete are unbounded
+  std::string mMemoryPoolType = "pool";       /// pool|monotonic|newdelete
   rocksdb::PerfLevel mRocksdbPerfLevel = rocksdb::PerfLevel::kDisable;
 };
 
@@ -0,0 +1,225 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include "ThreadPlacement.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+#include "FileUtil.h"
+#include "StrUtil.h"
+#include "TimeUtil.h"
+
+namespace gringofts {
+
+ThreadPlacement &ThreadPlacement::getInstance() {
+  static ThreadPlacement instance;
+  return instance;
+}
+
+ThreadPlacement::~ThreadPlacement() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRunning = false;
+  }
+  mCond.notify_all();
+  if (mSampleThread.joinable()) {
+    mSampleThread.join();
+  }
+}
+
+void ThreadPlacement::init(const INIReader &reader) {
+  mEnabled = reader.GetBoolean("threads", "enable", false);
+  mSampleIntervalInSec = reader.GetInteger("threads", "cpu.sample.interval.in.sec", 5);
+  mReader = std::make_unique<INIReader>(reader);
+
+  if (mEnabled) {
+    auto sharedCpus = cpusOfEntry("shared");
+    if (!sharedCpus.empty()) {
+      /// threads spawned from now on inherit it
+      pin("shared", sharedCpus);
+    }
+  }
+  SPDLOG_INFO("thread placement enabled={}, cpu.sample.interval={}s", mEnabled, mSampleIntervalInSec);
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mSampleIntervalInSec > 0 && !mRunning) {
+    mRunning = true;
+    mSampleThread = std::thread([this]() {
+      pthread_setname_np(pthread_self(), "ThreadCpuSample");
+      sampleCpuUtilization();
+    });
+  }
+}
+
+void ThreadPlacement::place(const std::string &name) {
+  if (!mReader) {
+    return;
+  }
+
+  if (mEnabled) {
+    auto cpus = cpusOf(name);
+    if (!cpus.empty()) {
+      pin(name, cpus);
+    }
+  }
+
+  if (mSampleIntervalInSec > 0) {
+    clockid_t clockId;
+    if (pthread_getcpuclockid(pthread_self(), &clockId) != 0) {
+      SPDLOG_WARN("cannot get cpu clock of thread {}", name);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto inUse = [this](const std::string &label) {
+      return std::any_of(mSampledThreads.begin(), mSampledThreads.end(),
+                         [&label](const SampledThread &thread) { return thread.mLabel == label; });
+    };
+    auto label = name;
+    for (uint32_t i = 1; inUse(label); ++i) {
+      label = name + "#" + std::to_string(i);
+    }
+    mSampledThreads.emplace_back(label, clockId);
+  }
+}
+
+std::vector<std::string> ThreadPlacement::sampledThreads() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::vector<std::string> labels;
+  for (const auto &thread : mSampledThreads) {
+    labels.push_back(thread.mLabel);
+  }
+  return labels;
+}
+
+std::optional<std::vector<uint32_t>> ThreadPlacement::parseCpuList(const std::string &cpuList) {
+  std::vector<uint32_t> cpus;
+  for (const auto &item : StrUtil::tokenize(cpuList, ',')) {
+    auto range = StrUtil::tokenize(item, '-');
+    if (range.empty() || range.size() > 2 || item.front() == '-' || item.back() == '-') {
+      return std::nullopt;
+    }
+    for (const auto &bound : range) {
+      if (bound.find_first_not_of("0123456789 ") != std::string::npos) {
+        return std::nullopt;
+      }
+    }
+    uint32_t first = std::stoul(range.front());
+    uint32_t last = std::stoul(range.back());
+    if (first > last) {
+      return std::nullopt;
+    }
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+std::optional<std::pair<std::string, uint32_t>> ThreadPlacement::splitIndex(const std::string &name) {
+  auto pos = name.find_last_of('_');
+  if (pos == std::string::npos || pos == 0 || pos + 1 == name.size()
+      || name.find_first_not_of("0123456789", pos + 1) != std::string::npos) {
+    return std::nullopt;
+  }
+  return std::make_pair(name.substr(0, pos), static_cast<uint32_t>(std::stoul(name.substr(pos + 1))));
+}
+
+std::vector<uint32_t> ThreadPlacement::cpusOf(const std::string &name) const {
+  auto cpus = cpusOfEntry(name);
+  if (!cpus.empty()) {
+    return cpus;
+  }
+
+  auto indexed = splitIndex(name);
+  if (!indexed) {
+    return {};
+  }
+  cpus = cpusOfEntry(indexed->first);
+  if (cpus.empty()) {
+    return {};
+  }
+  return {cpus[indexed->second % cpus.size()]};
+}
+
+std::vector<uint32_t> ThreadPlacement::cpusOfEntry(const std::string &entry) const {
+  auto cpuList = mReader->Get("threads", entry + ".cpus", "");
+  if (cpuList.empty()) {
+    auto node = mReader->Get("threads", entry + ".numa.node", "");
+    if (node.empty()) {
+      return {};
+    }
+    cpuList = FileUtil::getFileContent("/sys/devices/system/node/node" + node + "/cpulist");
+    StrUtil::replace(&cpuList, "\n", "");
+  }
+
+  auto cpus = parseCpuList(cpuList);
+  if (!cpus) {
+    SPDLOG_ERROR("invalid cpus {} of thread {}, exiting", cpuList, entry);
+    exit(1);
+  }
+  return *cpus;
+}
+
+void ThreadPlacement::pin(const std::string &name, const std::vector<uint32_t> &cpus) {
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (auto cpu : cpus) {
+    CPU_SET(cpu, &cpuSet);
+  }
+
+  std::string cpuList;
+  for (auto cpu : cpus) {
+    cpuList += (cpuList.empty() ? "" : ",") + std::to_string(cpu);
+  }
+
+  auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+  if (ret != 0) {
+    /// e.g., the host has fewer cpus than configured, keep running unpinned
+    SPDLOG_WARN("cannot pin thread {} to cpus {}, error: {}", name, cpuList, strerror(ret));
+    return;
+  }
+  SPDLOG_INFO("thread {} pinned to cpus {}", name, cpuList);
+}
+
+void ThreadPlacement::sampleCpuUtilization() {
+  auto lastTimeInNanos = TimeUtil::currentTimeInNanos();
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (!mCond.wait_for(lock, std::chrono::seconds(mSampleIntervalInSec), [this]() { return !mRunning; })) {
+    auto now = TimeUtil::currentTimeInNanos();
+    auto elapsedInNanos = std::max<uint64_t>(now - lastTimeInNanos, 1);
+    lastTimeInNanos = now;
+
+    for (auto it = mSampledThreads.begin(); it != mSampledThreads.end();) {
+      auto &thread = *it;
+      struct timespec ts;
+      if (clock_gettime(thread.mClockId, &ts) != 0) {
+        /// thread has exited, its label can be taken by a new thread of the same name
+        thread.mUtilizationGauge.set(0);
+        it = mSampledThreads.erase(it);
+        continue;
+      }
+      uint64_t cpuTimeInNanos = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+      if (thread.mLastCpuTimeInNanos > 0) {
+        thread.mUtilizationGauge.set((cpuTimeInNanos - thread.mLastCpuTimeInNanos) * 1.0 / elapsedInNanos);
+      }
+      thread.mLastCpuTimeInNanos = cpuTimeInNanos;
+      ++it;
+    }
+  }
+}
+
+}  /// namespace gringofts
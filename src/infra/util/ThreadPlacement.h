@@ -0,0 +1,107 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#ifndef SRC_INFRA_UTIL_THREADPLACEMENT_H_
+#define SRC_INFRA_UTIL_THREADPLACEMENT_H_
+
+#include <pthread.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <INIReader.h>
+
+#include "../monitor/MonitorTypes.h"
+
+namespace gringofts {
+
+/**
+ * Places named pipeline threads on cpus, and exports their cpu utilization.
+ *
+ * Supported keys in [threads]:
+ *   enable                     - pin threads as configured below, default false
+ *   shared.cpus                - cpus of all threads without their own entry, incl. gRPC pollers,
+ *                                e.g., 8-31, empty means unchanged. Leave out the cpus of pinned threads
+ *                                to keep single-threaded stages isolated
+ *   <name>.cpus                - cpus of thread <name>, e.g., CommandProcLoop.cpus = 2
+ *   <name>.numa.node           - all cpus of a NUMA node, used when <name>.cpus is absent
+ *   cpu.sample.interval.in.sec - how often thread_cpu_utilization is updated, 0 disables, default 5
+ *
+ * Indexed threads, e.g., RcvThread_0 and RcvThread_1, fall back to the entry of RcvThread and
+ * take one of its cpus each, round robin.
+ *
+ * Threads sharing a name, e.g., RaftServer of several raft groups, are sampled as
+ * RaftServer, RaftServer#1, ..., so each keeps its own thread_cpu_utilization gauge.
+ */
+class ThreadPlacement {
+ public:
+  static ThreadPlacement &getInstance();
+
+  ~ThreadPlacement();
+
+  /// reads [threads] and applies shared.cpus to calling thread, so call it before spawning any thread
+  void init(const INIReader &reader);
+
+  /// called by a thread right after it is named, no-op before init
+  void place(const std::string &name);
+
+  /// e.g., "0-3,8" is {0, 1, 2, 3, 8}, nullopt if malformed
+  static std::optional<std::vector<uint32_t>> parseCpuList(const std::string &cpuList);
+
+  /// "RcvThread_3" is {"RcvThread", 3}, names without a numeric suffix are not indexed
+  static std::optional<std::pair<std::string, uint32_t>> splitIndex(const std::string &name);
+
+  /// thread labels of thread_cpu_utilization, one per sampled thread that is alive
+  std::vector<std::string> sampledThreads();
+
+ private:
+  ThreadPlacement() = default;
+
+  /// cpus of the thread, empty if it is not configured
+  std::vector<uint32_t> cpusOf(const std::string &name) const;
+  std::vector<uint32_t> cpusOfEntry(const std::string &entry) const;
+  static void pin(const std::string &name, const std::vector<uint32_t> &cpus);
+
+  void sampleCpuUtilization();
+
+  struct SampledThread {
+    SampledThread(const std::string &label, clockid_t clockId)
+        : mLabel(label), mClockId(clockId),
+          mUtilizationGauge(getGauge("thread_cpu_utilization", {{"thread", label}})) {}
+
+    std::string mLabel;
+    clockid_t mClockId;
+    uint64_t mLastCpuTimeInNanos = 0;
+    santiago::MetricsCenter::GaugeType mUtilizationGauge;
+  };
+
+  bool mEnabled = false;
+  uint64_t mSampleIntervalInSec = 5;
+  std::unique_ptr<INIReader> mReader;
+
+  std::mutex mMutex;
+  std::condition_variable mCond;
+  bool mRunning = false;
+  std::vector<SampledThread> mSampledThreads;
+  std::thread mSampleThread;
+};
+
+}  /// namespace gringofts
+
+#endif  // SRC_INFRA_UTIL_THREADPLACEMENT_H_
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef SRC_INFRA_UTIL_TIMEUTIL_H_
 #define SRC_INFRA_UTIL_TIMEUTIL_H_
 
+#include <cassert>
 #include <chrono>
 #include <stdint.h>
 
@@ -19,36 +19,50 @@ limitations under the License.
 
 namespace gringofts {
 
-TrackingMemoryResource::TrackingMemoryResource(const std::string &name, std::pmr::memory_resource* upstream):
-  mName(name), mUpStream(upstream) {
+TrackingMemoryResource::TrackingMemoryResource(const std::string &name,
+                                               std::pmr::memory_resource* upstream,
+                                               bool synchronized):
+  mName(name), mUpStream(upstream), mSynchronized(synchronized),
+  mMemUsageGauge(getGauge("memory_resource_usage_bytes", {{"resource", name}})) {
   }
 
 void* TrackingMemoryResource::do_allocate(size_t bytes, size_t alignment) {
-  mCurMemUsage += bytes;
-  uint64_t diff = (mCurMemUsage > mLastReportMemUsage) ?
-    (mCurMemUsage - mLastReportMemUsage): (mLastReportMemUsage - mCurMemUsage);
-  if (diff > kReportInterval) {
-    SPDLOG_WARN("resource {}: mem usage {}, allocate {}",
-        mName, mCurMemUsage, bytes);
-    mLastReportMemUsage = mCurMemUsage;
+  void *ptr = nullptr;
+  if (mSynchronized) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ptr = mUpStream->allocate(bytes, alignment);
+  } else {
+    ptr = mUpStream->allocate(bytes, alignment);
   }
-  void* ret = mUpStream->allocate(bytes, alignment);
-  return ret;
+  /// only count it once upstream succeeds, a throwing upstream leaves usage untouched
+  report(mCurMemUsage += bytes, "allocate", bytes);
+  return ptr;
 }
 
 void TrackingMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
-  mCurMemUsage -= bytes;
-  uint64_t diff = (mCurMemUsage > mLastReportMemUsage) ?
-    (mCurMemUsage - mLastReportMemUsage): (mLastReportMemUsage - mCurMemUsage);
-  if (diff > kReportInterval) {
-    SPDLOG_WARN("resource {}: mem usage {}, deallocate {}",
-        mName, mCurMemUsage, bytes);
-    mLastReportMemUsage = mCurMemUsage;
+  report(mCurMemUsage -= bytes, "deallocate", bytes);
+  if (mSynchronized) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mUpStream->deallocate(ptr, bytes, alignment);
+    return;
   }
   mUpStream->deallocate(ptr, bytes, alignment);
 }
+
 bool TrackingMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
   return this == &other;
 }
 
+void TrackingMemoryResource::report(uint64_t curMemUsage, const char *op, size_t bytes) {
+  mMemUsageGauge.set(curMemUsage);
+  uint64_t lastReportMemUsage = mLastReportMemUsage;
+  uint64_t diff = (curMemUsage > lastReportMemUsage) ?
+    (curMemUsage - lastReportMemUsage): (lastReportMemUsage - curMemUsage);
+  if (diff > kReportInterval) {
+    SPDLOG_WARN("resource {}: mem usage {}, {} {}",
+        mName, curMemUsage, op, bytes);
+    mLastReportMemUsage = curMemUsage;
+  }
+}
+
 }  // namespace gringofts
@@ -15,25 +15,45 @@ limitations under the License.
 #ifndef SRC_INFRA_UTIL_TRACKINGMEMORYRESOURCE_H_
 #define SRC_INFRA_UTIL_TRACKINGMEMORYRESOURCE_H_
 
+#include <atomic>
 #include <memory_resource>
+#include <mutex>
 #include <string>
 
+#include "../monitor/MonitorTypes.h"
+
 namespace gringofts {
+/**
+ * Forwards to upstream while keeping track of the bytes in use,
+ * which are exported as memory_resource_usage_bytes{resource=name}.
+ */
 class TrackingMemoryResource : public std::pmr::memory_resource {
  public:
+  /**
+   * @param synchronized if true, calls to upstream are serialized,
+   *                     for upstreams that are not thread-safe, e.g., monotonic_buffer_resource
+   */
   TrackingMemoryResource(
       const std::string &name,
-      std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+      bool synchronized = false);
+
+  uint64_t getMemUsage() const { return mCurMemUsage; }
 
   void* do_allocate(size_t bytes, size_t alignment) override;
   void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
   bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
 
  private:
+  void report(uint64_t curMemUsage, const char *op, size_t bytes);
+
   std::string mName;
   std::pmr::memory_resource* mUpStream;
-  uint64_t mCurMemUsage = 0;
-  uint64_t mLastReportMemUsage = 0;
+  bool mSynchronized;
+  std::mutex mMutex;
+  std::atomic<uint64_t> mCurMemUsage = 0;
+  std::atomic<uint64_t> mLastReportMemUsage = 0;
+  santiago::MetricsCenter::GaugeType mMemUsageGauge;
   /// report memory usage every 100MB memory change
   static constexpr uint64_t kReportInterval = (uint64_t)100 * 1024 * 1024;
 };
@@ -16,8 +16,12 @@ limitations under the License.
 #include <INIReader.h>
 
 #include "../../src/app_ledger/should_be_generated/domain/BusinessCode.h"
+#include "../../src/app_ledger/should_be_generated/domain/CommandDecoderImpl.h"
+#include "../../src/app_ledger/should_be_generated/domain/EventDecoderImpl.h"
 #include "../../src/app_ledger/v2/MemoryBackedAppStateMachine.h"
 #include "../../src/app_util/AppInfo.h"
+#include "../../src/infra/es/store/CommandEventDecodeWrapper.h"
+#include "../../src/infra/es/store/SQLiteStoreDao.h"
 #include "../../src/infra/util/HttpCode.h"
 #include "../../src/infra/util/PerfConfig.h"
 
@@ -28,8 +32,12 @@ class LedgerAppStateMachineTest : public ::testing::Test {
  public:
   void SetUp() override {
     gringofts::Util::executeCmd("rm -rf ../test/app_ledger/data && mkdir ../test/app_ledger/data");
+    /// both state machines allocate from the same factory so that their states can be swapped
+    initMemoryPool();
     mRocksDBBackedStateMachine = std::make_unique<v2::RocksDBBackedAppStateMachine>("../test/app_ledger/data/rocksdb",
-                                                                                    "../test/app_ledger/data/rocksdb");
+                                                                                    "../test/app_ledger/data/rocksdb",
+                                                                                    4,
+                                                                                    mFactory);
     auto configPath = "../test/app_ledger/config/app.ini";
     INIReader reader(configPath);
     if (reader.ParseError() < 0) {
@@ -37,7 +45,6 @@ class LedgerAppStateMachineTest : public ::testing::Test {
       assert(1);
     }
     app::AppInfo::init(reader);
-    initMemoryPool();
 
     mInMemoryStateMachine = std::make_unique<v2::MemoryBackedAppStateMachine>(mFactory);
 
@@ -388,6 +395,58 @@ TEST_F(LedgerAppStateMachineTest, BookkeepDeduplicatedJournalEntry) {
   EXPECT_TRUE(events4.empty());
 }
 
+TEST_F(LedgerAppStateMachineTest, HandOverUnflushedWriteBatch) {
+  /// 1. arrange
+  /// create two accounts
+  auto command1 = createSampleCreateAccountCommand(protos::AccountType::Asset, 1000, 156);
+  std::vector<std::shared_ptr<gringofts::Event>> events1;
+  mInMemoryStateMachine->processCommandAndApply(*command1, &events1);
+  for (const auto &event : events1) {
+    mRocksDBBackedStateMachine->applyEvent(*event);
+  }
+  auto command2 = createSampleCreateAccountCommand(protos::AccountType::Liability, 2000, 156);
+  std::vector<std::shared_ptr<gringofts::Event>> events2;
+  mInMemoryStateMachine->processCommandAndApply(*command2, &events2);
+  for (const auto &event : events2) {
+    mRocksDBBackedStateMachine->applyEvent(*event);
+  }
+  /// record a journal entry, which is not flushed to RocksDB yet
+  protos::Amount amountProto;
+  amountProto.set_version(1);
+  amountProto.set_value(500);
+  auto journalLine1 = createSampleV1JournalLine(1000, TransactionType::Debit, Amount(amountProto), 156, "refdata1");
+  auto journalLine2 = createSampleV1JournalLine(2000, TransactionType::Credit, Amount(amountProto), 156, "refdata2");
+  std::vector<JournalLine> journalLines;
+  journalLines.push_back(journalLine1);
+  journalLines.push_back(journalLine2);
+  auto command3 = createSampleV1RecordJournalEntryCommand("handover1", journalLines);
+  std::vector<std::shared_ptr<gringofts::Event>> events3;
+  mInMemoryStateMachine->processCommandAndApply(*command3, &events3);
+  for (const auto &event : events3) {
+    mRocksDBBackedStateMachine->applyEvent(*event);
+  }
+
+  /// 2. act
+  /// a new leader takes over the state without flushing
+  auto newLeaderStateMachine = std::make_unique<v2::MemoryBackedAppStateMachine>(mFactory);
+  newLeaderStateMachine->swapState(mRocksDBBackedStateMachine.get());
+  auto command4 = createSampleV1RecordJournalEntryCommand("handover1", journalLines);
+  std::vector<std::shared_ptr<gringofts::Event>> events4;
+  auto resultBeforeFlush = newLeaderStateMachine->processCommandAndApply(*command4, &events4);
+  /// the handed-over batch is flushed here
+  mRocksDBBackedStateMachine->recoverSelf();
+  std::vector<std::shared_ptr<gringofts::Event>> events5;
+  auto resultAfterFlush = newLeaderStateMachine->processCommandAndApply(*command4, &events5);
+
+  /// 3. assert
+  EXPECT_EQ(resultBeforeFlush.mCode, BusinessCode::JOURNAL_ENTRY_ALREADY_PROCESSED);
+  EXPECT_TRUE(events4.empty());
+  EXPECT_EQ(resultAfterFlush.mCode, BusinessCode::JOURNAL_ENTRY_ALREADY_PROCESSED);
+  EXPECT_TRUE(events5.empty());
+  /// state reloaded from RocksDB should include the handed-over updates
+  EXPECT_TRUE(newLeaderStateMachine->hasSameState(*mRocksDBBackedStateMachine));
+}
+
 TEST_F(LedgerAppStateMachineTest, AccountInJournalLineNotExist) {
   /// 1. arrange
   /// create two journal lines with non-existent accounts
@@ -594,6 +653,42 @@ TEST_F(LedgerAppStateMachineTest, DebitNotEqualToCredit) {
   EXPECT_TRUE(events4.empty());
 }
 
+TEST_F(LedgerAppStateMachineTest, BalanceBelowZero) {
+  /// 1. arrange
+  /// create two accounts, both with balance 100
+  auto command1 = createSampleCreateAccountCommand(protos::AccountType::Asset, 1000, 156);
+  std::vector<std::shared_ptr<gringofts::Event>> events1;
+  mInMemoryStateMachine->processCommandAndApply(*command1, &events1);
+  for (const auto &event : events1) {
+    mRocksDBBackedStateMachine->applyEvent(*event);
+  }
+  auto command2 = createSampleCreateAccountCommand(protos::AccountType::Liability, 2000, 156);
+  std::vector<std::shared_ptr<gringofts::Event>> events2;
+  mInMemoryStateMachine->processCommandAndApply(*command2, &events2);
+  for (const auto &event : events2) {
+    mRocksDBBackedStateMachine->applyEvent(*event);
+  }
+  /// credit the asset account and debit the liability account by more than their balances
+  protos::Amount amountProto;
+  amountProto.set_version(1);
+  amountProto.set_value(500);
+  auto journalLine1 = createSampleV1JournalLine(2000, TransactionType::Debit, Amount(amountProto), 156, "refdata1");
+  auto journalLine2 = createSampleV1JournalLine(1000, TransactionType::Credit, Amount(amountProto), 156, "refdata2");
+  std::vector<JournalLine> journalLines;
+  journalLines.push_back(journalLine1);
+  journalLines.push_back(journalLine2);
+
+  /// 2. act
+  auto command3 = createSampleV1RecordJournalEntryCommand("dedup1", journalLines);
+  std::vector<std::shared_ptr<gringofts::Event>> events3;
+  auto result = mInMemoryStateMachine->processCommandAndApply(*command3, &events3);
+
+  /// 3. assert
+  EXPECT_EQ(result.mCode, BusinessCode::BALANCE_OUT_OF_RANGE);
+  EXPECT_EQ(result.mMessage, "balance of account 2000 would be -4.00");
+  EXPECT_TRUE(events3.empty());
+}
+
 TEST_F(LedgerAppStateMachineTest, InvalidJournalEntry) {
   /// 1. arrange
   /// create two accounts
@@ -633,5 +728,108 @@ TEST_F(LedgerAppStateMachineTest, InvalidJournalEntry) {
   EXPECT_TRUE(events3.empty());
 }
 
+TEST_F(LedgerAppStateMachineTest, RecoverManyAccounts) {
+  /// 1. arrange
+  auto &rocksDB = *mRocksDBBackedStateMachine->mRocksDB;
+  auto *coaHandle = mRocksDBBackedStateMachine->mColumnFamilyHandles[
+      v2::RocksDBBackedAppStateMachine::RocksDBConf::CHART_OF_ACCOUNTS];
+  /// keep every flushed memtable as its own SST, so that CoA is loaded in several partitions
+  ASSERT_TRUE(rocksDB.SetOptions(coaHandle, {{"disable_auto_compactions", "true"}}).ok());
+
+  /// create accounts whose nominal codes spread over keys of different lengths,
+  /// and flush them into SSTs with overlapping key ranges
+  uint64_t created = 0;
+  for (uint64_t nominalCode = 1; nominalCode <= 20000; nominalCode += 7) {
+    auto command = createSampleCreateAccountCommand(protos::AccountType::Asset, nominalCode, 156);
+    std::vector<std::shared_ptr<gringofts::Event>> events;
+    mInMemoryStateMachine->processCommandAndApply(*command, &events);
+    for (const auto &event : events) {
+      mRocksDBBackedStateMachine->applyEvent(*event);
+    }
+    if (++created % 500 == 0) {
+      mRocksDBBackedStateMachine->flushToRocksDB();
+      ASSERT_TRUE(rocksDB.Flush(rocksdb::FlushOptions(), coaHandle).ok());
+    }
+  }
+  mRocksDBBackedStateMachine->flushToRocksDB();
+  ASSERT_TRUE(rocksDB.Flush(rocksdb::FlushOptions(), coaHandle).ok());
+  ASSERT_FALSE(mRocksDBBackedStateMachine->splitKeyRange(coaHandle, 4).empty());
+
+  /// 2. act
+  /// re-init the state from persisted
+  mRocksDBBackedStateMachine->recoverSelf();
+
+  /// 3. assert
+  EXPECT_TRUE(mInMemoryStateMachine->hasSameState(*mRocksDBBackedStateMachine));
+}
+
+
+TEST_F(LedgerAppStateMachineTest, CompactJournalEntryRecordedEventTest) {
+  /// 1. arrange
+  protos::Amount amountProto;
+  amountProto.set_version(1);
+  amountProto.set_value(500);
+  auto journalLine1 = createSampleV1JournalLine(1000, TransactionType::Debit, Amount(amountProto), 156, "refdata1");
+  auto journalLine2 = createSampleV1JournalLine(2000, TransactionType::Credit, Amount(amountProto), 156, "refdata2");
+  std::vector<JournalLine> journalLines;
+  journalLines.push_back(journalLine1);
+  journalLines.push_back(journalLine2);
+  auto command = createSampleV1RecordJournalEntryCommand("dedup1", journalLines);
+  const auto &journalEntry = *command->journalEntryOpt();
+  auto now = TimeUtil::currentTimeInNanos();
+  JournalEntryRecordedEvent fullEvent(now, journalEntry);
+  JournalEntryRecordedEvent compactEvent(now, journalEntry, true);
+
+  /// 2. act
+  /// decode both the command and the event as a follower would
+  RecordJournalEntryCommand decodedCommand(now, command->encodeToString());
+  es::EventEntry eventEntry;
+  eventEntry.set_type(JOURNAL_ENTRY_RECORDED_EVENT);
+  eventEntry.set_createdtimeinnanos(now);
+  eventEntry.set_entry(compactEvent.encodeToString());
+  EventDecoderImpl decoder;
+  auto decodedEvent = CommandEventDecodeWrapper::decodeEvent(eventEntry, decoder, decodedCommand);
+
+  /// 3. assert
+  EXPECT_LT(compactEvent.encodeToString().size(), fullEvent.encodeToString().size());
+  ASSERT_NE(decodedEvent, nullptr);
+  const auto &journalEntryRecordedEvent = dynamic_cast<const JournalEntryRecordedEvent &>(*decodedEvent);
+  EXPECT_TRUE(journalEntry.isSame(journalEntryRecordedEvent.journalEntry()));
+}
+
+TEST_F(LedgerAppStateMachineTest, CompactJournalEntryRecordedEventSQLiteRoundTripTest) {
+  /// 1. arrange
+  protos::Amount amountProto;
+  amountProto.set_version(1);
+  amountProto.set_value(500);
+  auto journalLine1 = createSampleV1JournalLine(1000, TransactionType::Debit, Amount(amountProto), 156, "refdata1");
+  auto journalLine2 = createSampleV1JournalLine(2000, TransactionType::Credit, Amount(amountProto), 156, "refdata2");
+  std::vector<JournalLine> journalLines;
+  journalLines.push_back(journalLine1);
+  journalLines.push_back(journalLine2);
+  auto command = createSampleV1RecordJournalEntryCommand("dedup1", journalLines);
+  command->setId(1);
+  const auto &journalEntry = *command->journalEntryOpt();
+  auto event = std::make_shared<JournalEntryRecordedEvent>(TimeUtil::currentTimeInNanos(), journalEntry, true);
+  event->setId(1);
+  event->setCommandId(1);
+
+  gringofts::Util::executeCmd("cp ../test/infra/es/store/blank.db ../test/app_ledger/data/compact.db");
+  SQLiteStoreDao dao("../test/app_ledger/data/compact.db", std::make_shared<CommandDecoderImpl>());
+  EventDecoderImpl eventDecoder;
+
+  /// 2. act
+  dao.persist({command}, {event});
+  auto nextEvent = dao.findNextEvent(0, eventDecoder);
+  auto eventsOfCommand = dao.getEventsByCommandId(1, eventDecoder);
+
+  /// 3. assert
+  ASSERT_NE(nextEvent, nullptr);
+  EXPECT_TRUE(journalEntry.isSame(dynamic_cast<const JournalEntryRecordedEvent &>(*nextEvent).journalEntry()));
+  ASSERT_EQ(eventsOfCommand.size(), 1);
+  EXPECT_TRUE(journalEntry.isSame(
+      dynamic_cast<const JournalEntryRecordedEvent &>(*eventsOfCommand[0]).journalEntry()));
+}
+
 }  // namespace ledger
 }  // namespace gringofts
@@ -0,0 +1,226 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <future>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../../src/app_util/AppInfo.h"
+#include "../../src/app_util/LeaderForwarder.h"
+#include "../../src/infra/raft/generated/raft.grpc.pb.h"
+
+namespace gringofts::test {
+
+using ::testing::Return;
+
+namespace {
+
+class ForwarderRaftMock : public raft::RaftInterface {
+ public:
+  MOCK_CONST_METHOD0(getRaftRole, raft::RaftRole());
+  MOCK_CONST_METHOD0(getCommitIndex, uint64_t());
+  MOCK_CONST_METHOD0(getCurrentTerm, uint64_t());
+  MOCK_CONST_METHOD0(getFirstLogIndex, uint64_t());
+  MOCK_CONST_METHOD0(getLastLogIndex, uint64_t());
+  MOCK_CONST_METHOD0(getBeginLogIndex, uint64_t());
+  MOCK_CONST_METHOD0(getLeaderHint, std::optional<uint64_t>());
+  MOCK_CONST_METHOD0(getClusterMembers, std::vector<raft::MemberInfo>());
+  MOCK_CONST_METHOD1(getMemberOffsets, uint64_t(std::vector<raft::MemberOffsetInfo> *));
+  // @formatter:off
+  MOCK_CONST_METHOD2(getEntry, bool(uint64_t, raft::LogEntry*));
+  MOCK_CONST_METHOD3(getEntries, uint64_t(uint64_t, uint64_t, std::vector<raft::LogEntry>*));
+  // @formatter:on
+  MOCK_METHOD1(enqueueClientRequests, void(raft::ClientRequests));
+  MOCK_METHOD1(truncatePrefix, void(uint64_t));
+};
+
+/// stands in for the leader's gateway, any generated service would do
+class LeaderServiceStub : public raft::Raft::Service {
+ public:
+  grpc::Status RequestVoteV2(grpc::ServerContext *context,
+                             const raft::RequestVote::Request *request,
+                             raft::RequestVote::Response *response) override {
+    for (const auto &[key, value] : context->client_metadata()) {
+      mMetadata.emplace(std::string(key.data(), key.length()), std::string(value.data(), value.length()));
+    }
+    mDeadline = context->deadline();
+    std::this_thread::sleep_for(mDelay);
+    response->set_term(request->term() + 1);
+    response->set_vote_granted(true);
+    return grpc::Status::OK;
+  }
+
+  std::chrono::milliseconds mDelay{0};
+  std::multimap<std::string, std::string> mMetadata;
+  std::chrono::system_clock::time_point mDeadline;
+};
+
+}  // namespace
+
+class LeaderForwarderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mRaftMock = std::make_shared<::testing::NiceMock<ForwarderRaftMock>>();
+    mForwarder = std::make_unique<app::LeaderForwarder>(INIReader("../test/app_util/config/proxy.ini"), mRaftMock);
+  }
+
+  std::shared_ptr<::testing::NiceMock<ForwarderRaftMock>> mRaftMock;
+  std::unique_ptr<app::LeaderForwarder> mForwarder;
+  app::LeaderForwarder::Metadata mMetadata;
+};
+
+TEST_F(LeaderForwarderTest, FollowerForwardsToLeader) {
+  ON_CALL(*mRaftMock, getRaftRole()).WillByDefault(Return(raft::RaftRole::Follower));
+  ON_CALL(*mRaftMock, getLeaderHint()).WillByDefault(Return(std::optional<uint64_t>(2)));
+
+  auto leader = mForwarder->leaderToForward(mMetadata);
+  ASSERT_TRUE(leader);
+  EXPECT_EQ(*leader, 2);
+}
+
+TEST_F(LeaderForwarderTest, LeaderHandlesItself) {
+  ON_CALL(*mRaftMock, getRaftRole()).WillByDefault(Return(raft::RaftRole::Leader));
+  ON_CALL(*mRaftMock, getLeaderHint()).WillByDefault(Return(std::optional<uint64_t>(2)));
+
+  EXPECT_FALSE(mForwarder->leaderToForward(mMetadata));
+}
+
+TEST_F(LeaderForwarderTest, UnknownLeaderIsLeftToClient) {
+  ON_CALL(*mRaftMock, getRaftRole()).WillByDefault(Return(raft::RaftRole::Candidate));
+  ON_CALL(*mRaftMock, getLeaderHint()).WillByDefault(Return(std::nullopt));
+
+  EXPECT_FALSE(mForwarder->leaderToForward(mMetadata));
+}
+
+TEST_F(LeaderForwarderTest, ForwardedRequestIsNotForwardedAgain) {
+  ON_CALL(*mRaftMock, getRaftRole()).WillByDefault(Return(raft::RaftRole::Follower));
+  ON_CALL(*mRaftMock, getLeaderHint()).WillByDefault(Return(std::optional<uint64_t>(2)));
+
+  mMetadata.emplace("x-forwarded-by", "1");
+  EXPECT_FALSE(mForwarder->leaderToForward(mMetadata));
+}
+
+class LeaderForwarderRpcTest : public LeaderForwarderTest {
+ protected:
+  /// leader is a node of test/app_ledger/config/app.ini, served in-process on its gateway port
+  static constexpr NodeId kLeader = 1;
+  /// member added at runtime, not in cluster.conf
+  static constexpr NodeId kAddedLeader = 5;
+
+  void SetUp() override {
+    app::AppInfo::init(INIReader("../test/app_ledger/config/app.ini"));
+    LeaderForwarderTest::SetUp();
+    ON_CALL(*mRaftMock, getClusterMembers()).WillByDefault(Return(std::vector<raft::MemberInfo>{
+        {kLeader, "0.0.0.0:5253"}, {kAddedLeader, "127.0.0.1:5263"}}));
+  }
+
+  void TearDown() override {
+    if (mServer) {
+      mServer->Shutdown();
+    }
+  }
+
+  void startLeader() {
+    startLeaderAt(app::AppInfo::getMyClusterInfo().getAllNodeInfo()[kLeader].mPortForGateway);
+  }
+
+  void startLeaderAt(Port port) {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("0.0.0.0:" + std::to_string(port), grpc::InsecureServerCredentials());
+    builder.RegisterService(&mLeader);
+    mServer = builder.BuildAndStart();
+    ASSERT_NE(mServer, nullptr);
+  }
+
+  /// forward a RequestVote to leader and wait for what is relayed back
+  std::pair<grpc::Status, raft::RequestVote::Response> forwardAndWait(
+      std::chrono::system_clock::time_point clientDeadline, NodeId leader = kLeader) {
+    raft::RequestVote::Request request;
+    request.set_term(6);
+    std::promise<std::pair<grpc::Status, raft::RequestVote::Response>> relayed;
+    mForwarder->forward(leader, mMetadata, clientDeadline, request, &raft::Raft::Stub::PrepareAsyncRequestVoteV2,
+                        [&relayed](const grpc::Status &status, const raft::RequestVote::Response &response) {
+                          relayed.set_value(std::make_pair(status, response));
+                        });
+    return relayed.get_future().get();
+  }
+
+  LeaderServiceStub mLeader;
+  std::unique_ptr<grpc::Server> mServer;
+};
+
+TEST_F(LeaderForwarderRpcTest, RelaysLeaderResponseWithHeaders) {
+  startLeader();
+  mMetadata.emplace("x-request-id", "req-1");
+  mMetadata.emplace("authorization", "secret");
+
+  auto [status, response] = forwardAndWait(std::chrono::system_clock::time_point::max());
+
+  ASSERT_TRUE(status.ok());
+  EXPECT_EQ(response.term(), 7);
+  EXPECT_TRUE(response.vote_granted());
+
+  auto requestId = mLeader.mMetadata.find("x-request-id");
+  ASSERT_NE(requestId, mLeader.mMetadata.end());
+  EXPECT_EQ(requestId->second, "req-1");
+  auto forwardedBy = mLeader.mMetadata.find("x-forwarded-by");
+  ASSERT_NE(forwardedBy, mLeader.mMetadata.end());
+  EXPECT_EQ(forwardedBy->second, std::to_string(app::AppInfo::getMyNodeId()));
+  /// only x- headers are relayed
+  EXPECT_EQ(mLeader.mMetadata.count("authorization"), 0);
+}
+
+TEST_F(LeaderForwarderRpcTest, UnreachableLeaderFails) {
+  /// leader is not started, call sites reply 301 on a failed status
+  auto [status, response] = forwardAndWait(std::chrono::system_clock::time_point::max());
+
+  EXPECT_FALSE(status.ok());
+}
+
+TEST_F(LeaderForwarderRpcTest, AddedLeaderResolvedFromConfiguration) {
+  /// gateway port is shifted from its raft port as ours is, 5263 + (50055 - 5253)
+  startLeaderAt(50065);
+
+  auto [status, response] = forwardAndWait(std::chrono::system_clock::time_point::max(), kAddedLeader);
+
+  ASSERT_TRUE(status.ok());
+  EXPECT_EQ(response.term(), 7);
+}
+
+TEST_F(LeaderForwarderRpcTest, LeaderNotInConfigurationFailsFast) {
+  ON_CALL(*mRaftMock, getClusterMembers()).WillByDefault(Return(std::vector<raft::MemberInfo>{}));
+
+  auto [status, response] = forwardAndWait(std::chrono::system_clock::time_point::max());
+
+  EXPECT_EQ(status.error_code(), grpc::StatusCode::UNAVAILABLE);
+}
+
+TEST_F(LeaderForwarderRpcTest, ClientDeadlineCapsTimeout) {
+  startLeader();
+  /// timeout.in.ms is 100 in proxy.ini
+  mLeader.mDelay = std::chrono::milliseconds(60);
+  auto clientDeadline = std::chrono::system_clock::now() + std::chrono::milliseconds(20);
+
+  auto [status, response] = forwardAndWait(clientDeadline);
+
+  EXPECT_EQ(status.error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+  /// wait for the handler, leader sees the deadline as a timeout measured on arrival
+  mServer->Shutdown();
+  mServer.reset();
+  EXPECT_LT(mLeader.mDeadline, clientDeadline + std::chrono::milliseconds(10));
+}
+
+}  /// namespace gringofts::test
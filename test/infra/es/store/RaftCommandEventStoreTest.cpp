@@ -12,6 +12,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 **************************************************************************/
 
+#include <future>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -22,6 +24,8 @@ limitations under the License.
 
 namespace gringofts::test {
 
+using ::testing::_;
+using ::testing::Invoke;
 using ::testing::Return;
 
 class RaftInterfaceMock : public RaftInterface {
@@ -150,6 +154,80 @@ TEST(RaftCommandEventStoreSimpleTest, ExceptionTest) {
   EXPECT_THROW(readonlyCommandEventStore.loadCommandAfter(0, commandDecoder), std::runtime_error);
 }
 
+TEST(RaftCommandEventStoreSimpleTest, WaitTillLeaderIsReadyTest) {
+  /// init
+  auto raftInterfaceMock = std::make_shared<RaftInterfaceMock>();
+  DummyCommandDecoder commandDecoder;
+  DummyEventDecoder eventDecoder;
+  ReadonlyRaftCommandEventStore readonlyCommandEventStore{raftInterfaceMock, nullptr, nullptr, nullptr, false};
+
+  /// behavior
+  /// entries [2, 3] are no-ops of term 2, entry 1 has been applied
+  auto fillNoop = [](uint64_t index, raft::LogEntry *entry) {
+    entry->set_index(index);
+    entry->set_term(2);
+    entry->set_noop(true);
+  };
+  ON_CALL((*raftInterfaceMock), getCurrentTerm()).WillByDefault(Return(2));
+  ON_CALL((*raftInterfaceMock), getLastLogIndex()).WillByDefault(Return(3));
+  ON_CALL((*raftInterfaceMock), getCommitIndex()).WillByDefault(Return(3));
+  ON_CALL((*raftInterfaceMock), getEntries(_, _, _)).WillByDefault(Invoke(
+      [fillNoop](uint64_t startIndex, uint64_t size, std::vector<raft::LogEntry> *entries) {
+        for (auto index = startIndex; index < startIndex + size; ++index) {
+          fillNoop(index, &entries->emplace_back());
+        }
+        return size;
+      }));
+  ON_CALL((*raftInterfaceMock), getEntry(_, _)).WillByDefault(Invoke(
+      [fillNoop](uint64_t index, raft::LogEntry *entry) {
+        fillNoop(index, entry);
+        return true;
+      }));
+  readonlyCommandEventStore.setCurrentOffset(1);
+  /// load no-ops to advance loadedIndex
+  EXPECT_TRUE(!readonlyCommandEventStore.loadNextCommandEvents(commandDecoder, eventDecoder));
+
+  /// assert
+  /// every no-op is read only once
+  EXPECT_CALL((*raftInterfaceMock), getEntry(_, _)).Times(2);
+  EXPECT_EQ(3, readonlyCommandEventStore.waitTillLeaderIsReadyOrStepDown(2));
+
+  /// leader of term 2 has stepped down
+  ON_CALL((*raftInterfaceMock), getCurrentTerm()).WillByDefault(Return(3));
+  EXPECT_EQ(0, readonlyCommandEventStore.waitTillLeaderIsReadyOrStepDown(2));
+}
+
+TEST(RaftCommandEventStoreSimpleTest, WaiterWokenUpOnStepDownTest) {
+  /// init
+  auto raftInterfaceMock = std::make_shared<RaftInterfaceMock>();
+  DummyCommandDecoder commandDecoder;
+  DummyEventDecoder eventDecoder;
+  ReadonlyRaftCommandEventStore readonlyCommandEventStore{raftInterfaceMock, nullptr, nullptr, nullptr, false};
+
+  /// behavior
+  /// entry 4 is not committed yet, so leader of term 2 is never ready
+  std::atomic<uint64_t> currentTerm = 2;
+  ON_CALL((*raftInterfaceMock), getCurrentTerm()).WillByDefault(Invoke([&currentTerm]() {
+    return currentTerm.load();
+  }));
+  ON_CALL((*raftInterfaceMock), getLastLogIndex()).WillByDefault(Return(4));
+  ON_CALL((*raftInterfaceMock), getCommitIndex()).WillByDefault(Return(3));
+  readonlyCommandEventStore.setCurrentOffset(3);
+  auto waiter = std::async(std::launch::async, [&readonlyCommandEventStore]() {
+    return readonlyCommandEventStore.waitTillLeaderIsReadyOrStepDown(2);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto stepDownTime = std::chrono::steady_clock::now();
+  currentTerm = 3;
+  /// nothing to load, the loading thread notices the new term
+  EXPECT_TRUE(!readonlyCommandEventStore.loadNextCommandEvents(commandDecoder, eventDecoder));
+
+  /// assert
+  /// woken up by notification, long before the fallback timeout
+  EXPECT_EQ(0, waiter.get());
+  EXPECT_LT(std::chrono::steady_clock::now() - stepDownTime, std::chrono::milliseconds(500));
+}
+
 class RaftCommandEventStoreTest : public ::testing::Test {
  protected:
   virtual void SetUp() {
@@ -0,0 +1,108 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "../../../src/infra/grpc/AdmissionController.h"
+
+namespace gringofts::test {
+
+using Verdict = AdmissionController::Verdict;
+
+class AdmissionControllerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    AdmissionController::getInstance().init(INIReader("../test/infra/grpc/config/admission.ini"));
+  }
+
+  /// admitted weight is held by the returned ticket
+  static Verdict admit(const std::string &tenant, uint64_t weight, uint64_t queueDepth,
+                       std::vector<AdmissionTicket> *tickets) {
+    AdmissionController::TenantQuota *quota = nullptr;
+    auto verdict = AdmissionController::getInstance().tryAdmit(tenant, weight, queueDepth, &quota);
+    if (verdict == Verdict::Admitted) {
+      tickets->emplace_back(quota, weight);
+    }
+    return verdict;
+  }
+};
+
+TEST_F(AdmissionControllerTest, ShedOnQueueDepth) {
+  std::vector<AdmissionTicket> tickets;
+  EXPECT_EQ(admit("payments", 1, 99, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("payments", 1, 100, &tickets), Verdict::QueueDepth);
+  /// a batch counts all its entries
+  EXPECT_EQ(admit("payments", 2, 99, &tickets), Verdict::QueueDepth);
+}
+
+TEST_F(AdmissionControllerTest, ShedOnProjectedQueueWait) {
+  auto &controller = AdmissionController::getInstance();
+  /// 1ms per command
+  controller.observeServiceTime(1000 * 1000);
+  EXPECT_EQ(controller.projectedWaitInNanos(40), 40 * 1000 * 1000);
+
+  std::vector<AdmissionTicket> tickets;
+  EXPECT_EQ(admit("payments", 1, 40, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("payments", 1, 60, &tickets), Verdict::QueueWait);
+
+  /// CPL speeds up
+  for (int i = 0; i < 100; ++i) {
+    controller.observeServiceTime(100 * 1000);
+  }
+  EXPECT_EQ(admit("payments", 1, 60, &tickets), Verdict::Admitted);
+}
+
+TEST_F(AdmissionControllerTest, ShedOnInflightAndReleaseOnTicketGone) {
+  std::vector<AdmissionTicket> tickets;
+  EXPECT_EQ(admit("payments", 6, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("refunds", 2, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("other", 2, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("other", 1, 0, &tickets), Verdict::Inflight);
+
+  tickets.clear();
+  EXPECT_EQ(admit("other", 3, 0, &tickets), Verdict::Admitted);
+}
+
+TEST_F(AdmissionControllerTest, ShedOnTenantQuota) {
+  std::vector<AdmissionTicket> tickets;
+  EXPECT_EQ(admit("refunds", 2, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("refunds", 1, 0, &tickets), Verdict::TenantQuota);
+
+  /// unlisted tenants, including requests without tenant, share the default quota
+  EXPECT_EQ(admit("", 2, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("unknown", 1, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("other", 1, 0, &tickets), Verdict::TenantQuota);
+
+  /// quota of other tenants is not affected
+  EXPECT_EQ(admit("payments", 5, 0, &tickets), Verdict::Admitted);
+
+  /// shed requests take nothing, so the global inflight is 2 + 3 + 5
+  EXPECT_EQ(admit("payments", 1, 0, &tickets), Verdict::Inflight);
+}
+
+TEST_F(AdmissionControllerTest, TicketIsReleasedOnce) {
+  std::vector<AdmissionTicket> tickets;
+  EXPECT_EQ(admit("refunds", 2, 0, &tickets), Verdict::Admitted);
+
+  AdmissionTicket moved = std::move(tickets.back());
+  tickets.clear();
+  EXPECT_EQ(admit("refunds", 1, 0, &tickets), Verdict::TenantQuota);
+
+  moved.release();
+  moved.release();
+  EXPECT_EQ(admit("refunds", 2, 0, &tickets), Verdict::Admitted);
+  EXPECT_EQ(admit("refunds", 1, 0, &tickets), Verdict::TenantQuota);
+}
+
+}  /// namespace gringofts::test
@@ -0,0 +1,148 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+#include <INIReader.h>
+
+#include "../../../src/app_ledger/should_be_generated/app/calldatas/BatchCallData.h"
+#include "../../../src/infra/util/HttpCode.h"
+
+namespace gringofts::test {
+
+using ledger::BatchCallDataBase;
+using ledger::protos::BatchRecordJournalEntries;
+using ledger::protos::RecordJournalEntry;
+
+/// common part of batch calls without grpc, finish only counts
+class TestBatchCallData final : public BatchCallDataBase {
+ public:
+  TestBatchCallData(BlockingQueue<std::shared_ptr<Command>> &commandQueue,  // NOLINT[runtime/references]
+                    app::LeaderForwarder *forwarder)
+      : BatchCallDataBase(nullptr, nullptr, commandQueue, forwarder) {}
+
+  void proceed() override {}
+  void failOver() override {}
+
+  void process(EntryRequests *entries) { processEntries(entries); }
+  const BatchRecordJournalEntries::Response &response() const { return mResponse; }
+
+  int mFinishCount = 0;
+
+ private:
+  void finish() override { mFinishCount++; }
+};
+
+class BatchCallDataTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    INIReader reader("../test/infra/grpc/config/batch.ini");
+    AdmissionController::getInstance().init(reader);
+    mForwarder = std::make_unique<app::LeaderForwarder>(reader, nullptr);
+    mCallData = std::make_unique<TestBatchCallData>(mCommandQueue, mForwarder.get());
+  }
+
+  void addEntry(bool valid) {
+    auto *entry = mEntries.Add();
+    if (valid) {
+      entry->mutable_journal_entry()->set_version(1);
+    }
+  }
+
+  /// reply the command of an enqueued entry as a reply thread does
+  void replyNext(uint32_t code, const std::string &message, std::optional<uint64_t> leaderId = std::nullopt) {
+    auto command = mCommandQueue.dequeue();
+    command->getRequestHandle()->fillResultAndReply(code, message, leaderId);
+  }
+
+  BlockingQueue<std::shared_ptr<Command>> mCommandQueue;
+  std::unique_ptr<app::LeaderForwarder> mForwarder;
+  std::unique_ptr<TestBatchCallData> mCallData;
+  BatchCallDataBase::EntryRequests mEntries;
+};
+
+TEST_F(BatchCallDataTest, EntriesAreRepliedInTheirOwnSlots) {
+  /// init
+  addEntry(true);
+  addEntry(false);
+  addEntry(true);
+
+  /// behavior
+  mCallData->process(&mEntries);
+  /// entry 2 replied before entry 0
+  auto first = mCommandQueue.dequeue();
+  auto second = mCommandQueue.dequeue();
+  second->getRequestHandle()->fillResultAndReply(HttpCode::OK, "second", std::nullopt);
+  first->getRequestHandle()->fillResultAndReply(HttpCode::OK, "first", std::nullopt);
+
+  /// assert
+  const auto &response = mCallData->response();
+  ASSERT_EQ(response.results_size(), 3);
+  EXPECT_EQ(response.results(0).message(), "first");
+  EXPECT_EQ(response.results(1).code(), HttpCode::BAD_REQUEST);
+  EXPECT_EQ(response.results(2).message(), "second");
+  EXPECT_EQ(mCallData->mFinishCount, 1);
+}
+
+TEST_F(BatchCallDataTest, FinishWaitsForAllEntriesEnqueued) {
+  /// init, every entry is rejected while processEntries still holds the call
+  addEntry(false);
+  addEntry(false);
+
+  /// behavior
+  mCallData->process(&mEntries);
+
+  /// assert, finished exactly once, by the hand-off at the end of processEntries
+  EXPECT_EQ(mCallData->mFinishCount, 1);
+  EXPECT_EQ(mCallData->response().code(), HttpCode::BAD_REQUEST);
+  EXPECT_TRUE(mCommandQueue.empty());
+}
+
+TEST_F(BatchCallDataTest, FinishWaitsForLastEntry) {
+  /// init
+  addEntry(true);
+  addEntry(true);
+
+  /// behavior
+  mCallData->process(&mEntries);
+  replyNext(HttpCode::OK, "Success");
+
+  /// assert
+  EXPECT_EQ(mCallData->mFinishCount, 0);
+  replyNext(HttpCode::OK, "Success");
+  EXPECT_EQ(mCallData->mFinishCount, 1);
+  EXPECT_EQ(mCallData->response().code(), HttpCode::OK);
+  EXPECT_EQ(mCallData->response().message(), "Success");
+}
+
+TEST_F(BatchCallDataTest, SummaryTakesFirstFailureAndLeaderHint) {
+  /// init
+  addEntry(true);
+  addEntry(true);
+  addEntry(true);
+
+  /// behavior
+  mCallData->process(&mEntries);
+  replyNext(HttpCode::OK, "Success");
+  replyNext(HttpCode::SERVICE_UNAVAILABLE, "Queue stopped");
+  replyNext(HttpCode::MOVED_PERMANENTLY, "Not a leader", 2);
+
+  /// assert
+  const auto &response = mCallData->response();
+  EXPECT_EQ(response.code(), HttpCode::SERVICE_UNAVAILABLE);
+  EXPECT_EQ(response.message(), "Queue stopped");
+  EXPECT_EQ(response.reserved(), "2");
+  EXPECT_EQ(response.results(2).reserved(), "2");
+}
+
+}  /// namespace gringofts::test
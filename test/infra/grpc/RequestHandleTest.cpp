@@ -51,4 +51,29 @@ TEST(RequestHandleTest, ValidateNonTestTag) {
   EXPECT_TRUE(mock.validateRequest(metadata, false));
 }
 
+TEST(RequestHandleTest, AdmitByTenantQuota) {
+  /// init
+  AdmissionController::getInstance().init(INIReader("../test/infra/grpc/config/admission.ini"));
+  std::multimap<grpc::string_ref, grpc::string_ref> metadata{{"x-tenant-id", "refunds"}};
+  testing::NiceMock<RequestHandleMock> admitted;
+  testing::StrictMock<RequestHandleMock> shed;
+  EXPECT_CALL(shed, fillResultAndReply(HttpCode::TOO_MANY_REQUESTS, testing::_, testing::_)).Times(1);
+
+  /// assert
+  EXPECT_TRUE(admitted.admit(metadata, 0, 2));
+  EXPECT_FALSE(shed.admit(metadata, 0));
+}
+
+TEST(RequestHandleTest, AdmitReleasedWithHandle) {
+  /// init
+  AdmissionController::getInstance().init(INIReader("../test/infra/grpc/config/admission.ini"));
+  std::multimap<grpc::string_ref, grpc::string_ref> metadata{{"x-tenant-id", "refunds"}};
+
+  /// assert
+  for (int i = 0; i < 10; ++i) {
+    testing::NiceMock<RequestHandleMock> mock;
+    EXPECT_TRUE(mock.admit(metadata, 0, 2));
+  }
+}
+
 }  /// namespace gringofts::test
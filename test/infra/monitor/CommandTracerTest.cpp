@@ -0,0 +1,110 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "../../../src/infra/monitor/CommandTracer.h"
+
+namespace gringofts::test {
+
+TEST(CommandTracerTest, SampleEveryN) {
+  auto &tracer = CommandTracer::getInstance();
+
+  tracer.setSampleEveryN(0);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(nullptr, tracer.maybeStartTrace());
+  }
+
+  tracer.setSampleEveryN(4);
+  uint64_t sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    auto trace = tracer.maybeStartTrace();
+    if (trace) {
+      ++sampled;
+      EXPECT_NE(0, trace->stampOf(TraceStage::GrpcReceive));
+      EXPECT_EQ(0, trace->stampOf(TraceStage::Reply));
+    }
+  }
+  EXPECT_EQ(25, sampled);
+  tracer.setSampleEveryN(0);
+}
+
+TEST(CommandTracerTest, RaftStagesStampedByIndex) {
+  auto &tracer = CommandTracer::getInstance();
+  auto trace1 = std::make_shared<CommandTrace>(1);
+  auto trace2 = std::make_shared<CommandTrace>(2);
+
+  tracer.bindLogIndex(10, trace1);
+  tracer.bindLogIndex(12, trace2);
+  EXPECT_TRUE(tracer.hasBoundTraces());
+
+  tracer.onRaftAppended(9, 11, 100, 200);
+  EXPECT_EQ(100, trace1->stampOf(TraceStage::RaftAppend));
+  EXPECT_EQ(200, trace1->stampOf(TraceStage::LocalPersist));
+  EXPECT_EQ(0, trace2->stampOf(TraceStage::RaftAppend));
+
+  tracer.onCommitted(11);
+  EXPECT_NE(0, trace1->stampOf(TraceStage::QuorumCommit));
+  EXPECT_EQ(0, trace2->stampOf(TraceStage::QuorumCommit));
+  EXPECT_TRUE(tracer.hasBoundTraces());
+
+  tracer.onCommitted(12);
+  EXPECT_NE(0, trace2->stampOf(TraceStage::QuorumCommit));
+  EXPECT_FALSE(tracer.hasBoundTraces());
+}
+
+TEST(CommandTracerTest, UnboundOnTruncationAndStepDown) {
+  auto &tracer = CommandTracer::getInstance();
+  auto trace1 = std::make_shared<CommandTrace>(1);
+  auto trace2 = std::make_shared<CommandTrace>(2);
+
+  tracer.bindLogIndex(20, trace1);
+  tracer.bindLogIndex(21, trace2);
+  tracer.onTruncated(20);
+  /// entry 21 is gone, another one at 21 commits without stamping its trace
+  tracer.onCommitted(21);
+  EXPECT_NE(0, trace1->stampOf(TraceStage::QuorumCommit));
+  EXPECT_EQ(0, trace2->stampOf(TraceStage::QuorumCommit));
+  EXPECT_FALSE(tracer.hasBoundTraces());
+
+  tracer.bindLogIndex(22, trace2);
+  tracer.onSteppedDown();
+  EXPECT_FALSE(tracer.hasBoundTraces());
+}
+
+TEST(CommandTracerTest, DumpChromeTrace) {
+  auto &tracer = CommandTracer::getInstance();
+  tracer.setMaxKeptTraces(1);
+
+  auto trace = std::make_shared<CommandTrace>(42);
+  trace->stamp(TraceStage::GrpcReceive, 1000000);
+  trace->stamp(TraceStage::CplDequeue, 3000000);
+  /// not reached stages are skipped, next stage spans from the previous reached one
+  trace->stamp(TraceStage::Reply, 4000000);
+  EXPECT_EQ("{\"traceId\":42}", trace->toTrackingContext());
+
+  tracer.finishTrace(std::make_shared<CommandTrace>(41));
+  tracer.finishTrace(trace);
+
+  EXPECT_EQ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+            "{\"name\":\"cpl_dequeue\",\"cat\":\"command\",\"ph\":\"X\",\"pid\":1,\"tid\":42,"
+            "\"ts\":1000.000000,\"dur\":2000.000000},"
+            "{\"name\":\"reply\",\"cat\":\"command\",\"ph\":\"X\",\"pid\":1,\"tid\":42,"
+            "\"ts\":3000.000000,\"dur\":1000.000000}]}",
+            tracer.dumpChromeTrace());
+
+  tracer.setMaxKeptTraces(1000);
+}
+
+}  /// namespace gringofts::test
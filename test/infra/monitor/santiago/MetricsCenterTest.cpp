@@ -13,6 +13,8 @@ limitations under the License.
 **************************************************************************/
 
 #include <map>
+#include <thread>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -36,3 +38,66 @@ TEST_F(MetricsCenterTest, CounterTest) {
   Counter.increase();
   EXPECT_EQ(11, FirstMetrics(registry).counter.value);
 }
+
+TEST_F(MetricsCenterTest, HistogramTest) {
+  santiago::MetricsCenter metrics_center;
+  std::map<std::string, std::string> labels = {{"name", "hao"}};
+  auto histogram = metrics_center.histogram("latency_in_ms", labels);
+  histogram.observe(0.05);
+  histogram.observe(0.8);
+  histogram.observe(3);
+  /// same name and labels, same histogram
+  metrics_center.histogram("latency_in_ms", labels).observe(20000);
+
+  auto families = metrics_center.getHistogramRegistryPtr()->Collect();
+  ASSERT_EQ(1, families.size());
+  EXPECT_EQ("latency_in_ms", families[0].name);
+  EXPECT_EQ(prometheus::MetricType::Histogram, families[0].type);
+  ASSERT_EQ(1, families[0].metric.size());
+
+  auto &metric = families[0].metric[0];
+  EXPECT_EQ("name", metric.label[0].name);
+  EXPECT_EQ("hao", metric.label[0].value);
+  EXPECT_EQ(4, metric.histogram.sample_count);
+  EXPECT_DOUBLE_EQ(20003.85, metric.histogram.sample_sum);
+
+  auto &buckets = metric.histogram.bucket;
+  ASSERT_EQ(santiago::PrometheusHistogramRegistry::kDefaultUpperBounds.size() + 1, buckets.size());
+  auto cumulativeCountOf = [&buckets](double upperBound) {
+    for (auto &bucket : buckets) {
+      if (bucket.upper_bound == upperBound) {
+        return bucket.cumulative_count;
+      }
+    }
+    return UINT64_MAX;
+  };
+  EXPECT_EQ(1, cumulativeCountOf(0.1));
+  EXPECT_EQ(2, cumulativeCountOf(1));
+  EXPECT_EQ(3, cumulativeCountOf(5));
+  EXPECT_EQ(3, cumulativeCountOf(10000));
+  EXPECT_EQ(4, buckets.back().cumulative_count);
+}
+
+TEST_F(MetricsCenterTest, HistogramObservedByManyThreadsTest) {
+  santiago::MetricsCenter metrics_center;
+  auto histogram = metrics_center.histogram("latency_in_ms", {});
+
+  const uint64_t threadNum = 8;
+  const uint64_t observeNum = 10000;
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < threadNum; ++i) {
+    threads.emplace_back([histogram, observeNum]() mutable {
+      for (uint64_t j = 0; j < observeNum; ++j) {
+        histogram.observe(1);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  auto families = metrics_center.getHistogramRegistryPtr()->Collect();
+  auto &metric = families[0].metric[0];
+  EXPECT_EQ(threadNum * observeNum, metric.histogram.sample_count);
+  EXPECT_DOUBLE_EQ(threadNum * observeNum, metric.histogram.sample_sum);
+}
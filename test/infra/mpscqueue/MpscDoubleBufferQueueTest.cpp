@@ -80,6 +80,47 @@ TEST_F(MpscDoubleBufferQueueTest, DequeuIsBlocked) {
   EXPECT_EQ(consumerId, 1);
 }
 
+TEST_F(MpscDoubleBufferQueueTest, EnqueueBatchIsNotInterleaved) {
+  // behavior
+  auto producerThread = std::thread([this] {
+    for (int i = 0; i < 1000; ++i) {
+      mSpscQueue->enqueue(-1);
+    }
+  });
+  for (int i = 0; i < 100; ++i) {
+    mSpscQueue->enqueueBatch({i * 3, i * 3 + 1, i * 3 + 2});
+  }
+  producerThread.join();
+
+  // assert
+  EXPECT_EQ(mSpscQueue->estimateTotalSize(), 1300);
+  int expected = 0;
+  for (int i = 0; i < 1300; ++i) {
+    auto actual = mSpscQueue->dequeue();
+    if (actual == -1) {
+      continue;
+    }
+    EXPECT_EQ(actual, expected++);
+    if (actual % 3 != 2) {
+      /// the rest of the batch follows immediately
+      EXPECT_EQ(mSpscQueue->dequeue(), expected++);
+      EXPECT_EQ(mSpscQueue->dequeue(), expected++);
+      i += 2;
+    }
+  }
+  EXPECT_EQ(expected, 300);
+  EXPECT_TRUE(mSpscQueue->empty());
+}
+
+TEST_F(MpscDoubleBufferQueueTest, EnqueueBatchAfterShutdownWillThrowException) {
+  // behavior
+  mSpscQueue->shutdown();
+
+  // assert
+  EXPECT_THROW(mSpscQueue->enqueueBatch({1, 2}), QueueStoppedException);
+  EXPECT_THROW(mSpscQueue->dequeue(), QueueStoppedException);  // nothing of the batch is appended
+}
+
 TEST_F(MpscDoubleBufferQueueTest, EnqueueAfterShutdownWillThrowException) {
   // init
   mSpscQueue->enqueue(1);
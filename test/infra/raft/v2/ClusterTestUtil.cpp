@@ -13,6 +13,8 @@ limitations under the License.
 
 #include "ClusterTestUtil.h"
 
+#include <future>
+
 #include <grpc++/grpc++.h>
 #include <grpc++/security/credentials.h>
 
@@ -43,6 +45,9 @@ void ClusterTestUtil::setupAllServers(
 void ClusterTestUtil::killAllServers() {
   mRaftInstConfigs.clear();
   mRaftInsts.clear();
+  for (auto &[member, client] : mRaftInstClients) {
+    mClientLoop->retire(std::move(client));
+  }
   mRaftInstClients.clear();
   SPDLOG_INFO("killing all servers");
   SyncPointProcessor::getInstance().tearDown();
@@ -86,7 +91,8 @@ MemberInfo ClusterTestUtil::setupServer(const std::string &configPath) {
       std::nullopt,
       std::make_shared<DNSResolver>(),
       raftImpl->mSelfInfo.mId,
-      &mAeRvQueue);
+      &mAeRvQueue,
+      mClientLoop);
   return member;
 }
 
@@ -96,6 +102,7 @@ void ClusterTestUtil::killServer(const MemberInfo &member) {
   SPDLOG_INFO("killing server {}", member.toString());
   mRaftInsts.erase(member);
   SPDLOG_INFO("server {} is down", member.toString());
+  mClientLoop->retire(std::move(mRaftInstClients[member]));
   mRaftInstClients.erase(member);
   SPDLOG_INFO("client {} is down", member.toString());
 }
@@ -182,6 +189,19 @@ bool ClusterTestUtil::getDecryptedEntry(const MemberInfo &member, uint64_t index
   return res;
 }
 
+bool ClusterTestUtil::transferLeadership(const MemberInfo &leader, const MemberInfo &target) {
+  assert(mRaftInsts.find(leader) != mRaftInsts.end());
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  mRaftInsts[leader]->enqueueTransferLeadership({target.mId, [promise](bool success, const std::string &message) {
+    SPDLOG_INFO("transfer leadership finished, success: {}, message: {}", success, message);
+    promise->set_value(success);
+  }});
+  /// transfer is given up after election timeout
+  auto maxWait = std::chrono::milliseconds(RaftConstants::kMaxElectionTimeoutInMillis * 2);
+  return future.wait_for(maxWait) == std::future_status::ready && future.get();
+}
+
 MemberInfo ClusterTestUtil::waitAndGetLeader() {
   while (true) {
     for (auto &[member, raftImpl] : mRaftInsts) {
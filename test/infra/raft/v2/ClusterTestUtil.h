@@ -80,6 +80,9 @@ class ClusterTestUtil {
   uint64_t getLastLogIndex(const MemberInfo &member);
   bool getDecryptedEntry(const MemberInfo &member, uint64_t index, raft::LogEntry *entry);
 
+    /// transfer leadership in sync, return whether it succeeds
+    bool transferLeadership(const MemberInfo &leader, const MemberInfo &target);
+
     MemberInfo waitAndGetLeader();
     bool waitLogForAll(uint64_t index);
     bool waitLogForServer(const MemberInfo &member, uint64_t index);
@@ -101,6 +104,8 @@ class ClusterTestUtil {
  protected:
     /// event queue should be destroyed after RaftClient
     EventQueue mAeRvQueue;
+    /// completion queue of clients, retired clients are released by it
+    std::shared_ptr<RaftClientLoop> mClientLoop = std::make_shared<RaftClientLoop>(1);
 
     std::map<MemberInfo, std::string> mRaftInstConfigs;
     std::map<MemberInfo, std::shared_ptr<RaftCore>> mRaftInsts;
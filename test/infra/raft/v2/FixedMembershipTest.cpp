@@ -102,6 +102,38 @@ TEST_F(FixedMembershipTest, NormalTest) {
   mClusterUtil.disableAllSyncPoints();
 }
 
+TEST_F(FixedMembershipTest, TransferLeadershipTest) {
+  mClusterUtil.enableAllSyncPoints();
+  /// only server1 can win an election on timeout, server2 can only be elected via TN_req
+  SyncPointCallBack electServer1CB = createCallBackToSelectLeader({mServer1});
+  std::vector<SyncPoint> point {
+    {TPRegistry::RaftCore_electionTimeout_interceptTimeout, electServer1CB, {}, SyncPointType::Ignore}
+  };
+  mClusterUtil.setupAllServers({mServer1Config, mServer2Config, mServer3Config}, point);
+
+  std::vector<uint32_t> errCodes;
+  std::vector<uint64_t> indexs;
+  ASSERT_EQ(mClusterUtil.sendClientRequest(&errCodes, &indexs, mData), 200);
+  auto leader = mClusterUtil.waitAndGetLeader();
+  ASSERT_EQ(leader.mId, mServer1.mId);
+
+  /// transfer leadership to server2
+  ASSERT_TRUE(mClusterUtil.transferLeadership(mServer1, mServer2));
+  auto newLeader = mClusterUtil.waitAndGetLeader();
+  ASSERT_EQ(newLeader.mId, mServer2.mId);
+
+  /// new leader keeps all the committed entries and accepts new ones
+  for (auto i = 0; i < mData.size(); ++i) {
+    gringofts::raft::LogEntry dataEntry;
+    ASSERT_TRUE(mClusterUtil.getDecryptedEntry(newLeader, indexs[i], &dataEntry));
+    ASSERT_EQ(dataEntry.payload(), mData[i]);
+  }
+  ASSERT_EQ(mClusterUtil.sendClientRequest(&errCodes, &indexs, mData), 200);
+
+  mClusterUtil.killAllServers();
+  mClusterUtil.disableAllSyncPoints();
+}
+
 /// in this set up, server1 has 1 version, server2 has 2 versions, server3 has 3 versions
 /// if we elect server1, then the cluster works fine
 /// if we elect server2, then server1 will crash
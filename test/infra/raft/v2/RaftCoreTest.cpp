@@ -13,6 +13,7 @@ limitations under the License.
 **************************************************************************/
 
 #include <gtest/gtest.h>
+#include <limits>
 
 #include "../../../../src/infra/raft/v2/RaftCore.h"
 #include "../../../../src/infra/util/Util.h"
@@ -200,4 +201,674 @@ TEST_F(RaftCoreTest, BasicTest) {
   }
 }
 
+TEST_F(RaftCoreTest, PreVoteTest) {
+  mRaftImpl->mEnablePreVote = true;
+
+  /// election timeout
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+
+  /// pre-vote does not increase term
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 0);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Follower);
+  ASSERT_TRUE(mRaftImpl->mPreVoting);
+
+  /// send pre-vote RV_req
+  mRaftImpl->requestVote();
+
+  {
+    /// fake pre-vote RV_resp
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(0);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    rvResp.set_pre_vote(true);
+
+    /// handle RV_resp
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+    mRaftImpl->becomeCandidate();
+  }
+
+  /// candidate on term 1
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 1);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Candidate);
+  ASSERT_FALSE(mRaftImpl->mPreVoting);
+
+  {
+    /// fake AE_req from Leader 2 on term 2
+    gringofts::raft::AppendEntries::Request aeReq;
+    gringofts::raft::AppendEntries::Response aeResp;
+
+    aeReq.set_term(2);
+    aeReq.set_leader_id(2);
+    aeReq.set_prev_log_index(0);
+    aeReq.set_prev_log_term(0);
+    aeReq.set_commit_index(0);
+
+    mRaftImpl->handleAppendEntriesRequest(aeReq, &aeResp);
+    ASSERT_TRUE(aeResp.success());
+  }
+
+  /// follower on term 2
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 2);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Follower);
+
+  gringofts::raft::RequestVote::Request rvReq;
+  rvReq.set_term(3);
+  rvReq.set_candidate_id(2);
+  rvReq.set_last_log_index(0);
+  rvReq.set_last_log_term(0);
+
+  {
+    /// reject pre-vote, leader is alive
+    gringofts::raft::RequestVote::Response rvResp;
+    rvReq.set_pre_vote(true);
+    mRaftImpl->handleRequestVoteRequest(rvReq, &rvResp);
+    ASSERT_FALSE(rvResp.vote_granted());
+    ASSERT_EQ(mRaftImpl->getCurrentTerm(), 2);
+  }
+
+  {
+    /// reject RV_req, leader is alive
+    gringofts::raft::RequestVote::Response rvResp;
+    rvReq.set_pre_vote(false);
+    mRaftImpl->handleRequestVoteRequest(rvReq, &rvResp);
+    ASSERT_FALSE(rvResp.vote_granted());
+    ASSERT_EQ(mRaftImpl->getCurrentTerm(), 2);
+  }
+
+  {
+    /// grant RV_req triggered by leadership transfer
+    gringofts::raft::RequestVote::Response rvResp;
+    rvReq.set_leadership_transfer(true);
+    mRaftImpl->handleRequestVoteRequest(rvReq, &rvResp);
+    ASSERT_TRUE(rvResp.vote_granted());
+    ASSERT_EQ(mRaftImpl->getCurrentTerm(), 3);
+  }
+
+  /// drain queue
+  /// previous requestVote() will generate events.
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+}
+
+TEST_F(RaftCoreTest, PreVoteRejectedTest) {
+  mRaftImpl->mEnablePreVote = true;
+
+  {
+    /// fake AE_req from Leader 2 on term 1
+    gringofts::raft::AppendEntries::Request aeReq;
+    gringofts::raft::AppendEntries::Response aeResp;
+
+    aeReq.set_term(1);
+    aeReq.set_leader_id(2);
+    aeReq.set_prev_log_index(0);
+    aeReq.set_prev_log_term(0);
+    aeReq.set_commit_index(0);
+
+    mRaftImpl->handleAppendEntriesRequest(aeReq, &aeResp);
+    ASSERT_TRUE(aeResp.success());
+  }
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 1);
+
+  gringofts::raft::RequestVote::Request rvReq;
+  rvReq.set_candidate_id(2);
+  rvReq.set_last_log_index(0);
+  rvReq.set_last_log_term(0);
+  rvReq.set_pre_vote(true);
+
+  {
+    /// reject stale pre-vote, still answered as pre-vote
+    gringofts::raft::RequestVote::Response rvResp;
+    rvReq.set_term(0);
+    mRaftImpl->handleRequestVoteRequest(rvReq, &rvResp);
+    ASSERT_FALSE(rvResp.vote_granted());
+    ASSERT_TRUE(rvResp.pre_vote());
+  }
+
+  /// reject pre-vote, leader is alive
+  gringofts::raft::RequestVote::Response leaseResp;
+  rvReq.set_term(2);
+  mRaftImpl->handleRequestVoteRequest(rvReq, &leaseResp);
+  ASSERT_FALSE(leaseResp.vote_granted());
+  ASSERT_TRUE(leaseResp.pre_vote());
+  ASSERT_EQ(leaseResp.term(), 1);
+  ASSERT_EQ(leaseResp.saved_term(), 2);
+
+  /// node 1 starts pre-vote for term 2 itself
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  ASSERT_TRUE(mRaftImpl->mPreVoting);
+  mRaftImpl->requestVote();
+
+  /// a lease rejection from node 2 is taken as a rejected pre-vote rather than a stale real vote
+  leaseResp.set_id(2);
+  mRaftImpl->handleRequestVoteResponse(leaseResp);
+  ASSERT_TRUE(mRaftImpl->mPeers[2].mRequestVoteDone);
+  ASSERT_FALSE(mRaftImpl->mPeers[2].mHaveVote);
+  ASSERT_TRUE(mRaftImpl->mPreVoting);
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 1);
+
+  {
+    /// pre-voter steps down on a higher term
+    gringofts::raft::RequestVote::Response rvResp = leaseResp;
+    rvResp.set_term(3);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+  }
+  ASSERT_FALSE(mRaftImpl->mPreVoting);
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 3);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Follower);
+
+  /// drain queue
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+}
+
+TEST_F(RaftCoreTest, LearnerTest) {
+  /// restart node 1 in a cluster where node 2 is a learner
+  mRaftImpl.reset();
+  gringofts::ClusterInfo::Node node1;
+  node1.mNodeId = 1;
+  node1.mHostName = "0.0.0.0";
+  node1.mPortForRaft = 5253;
+  gringofts::ClusterInfo::Node node2;
+  node2.mNodeId = 2;
+  node2.mHostName = "0.0.0.0";
+  node2.mPortForRaft = 5254;
+  node2.mIsLearner = true;
+  gringofts::ClusterInfo clusterInfo;
+  clusterInfo.addNode(node1);
+  clusterInfo.addNode(node2);
+  mRaftImpl = std::make_shared<RaftCore>("../test/infra/raft/config/raft_1.ini",
+                                         1, clusterInfo, std::make_shared<DNSResolver>());
+  ASSERT_EQ(mRaftImpl->getVoterNum(), 1);
+
+  /// election timeout
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Candidate);
+
+  /// learner is not asked for vote
+  mRaftImpl->requestVote();
+  ASSERT_FALSE(mRaftImpl->mPeers[2].mRequestVoteDone);
+
+  /// the only voter is a majority
+  mRaftImpl->becomeLeader();
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  /// noop is committed without ack from learner
+  mRaftImpl->advanceCommitIndex();
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), mRaftImpl->getLastLogIndex());
+
+  /// learner is not counted when checking quorum
+  sleep(2);
+  mRaftImpl->leadershipTimeout();
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  /// drain queue
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+}
+
+TEST_F(RaftCoreTest, MembershipChangeTest) {
+  /// leader on term 1
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  {
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(1);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+    mRaftImpl->becomeLeader();
+  }
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  auto ackEntries = [this](uint64_t peerId, uint64_t prevLogIndex, uint64_t matchIndex) {
+    gringofts::raft::AppendEntries::Response aeResp;
+    aeResp.set_term(1);
+    aeResp.set_success(true);
+    aeResp.set_id(peerId);
+    aeResp.set_saved_term(1);
+    aeResp.set_saved_prev_log_index(prevLogIndex);
+    aeResp.set_last_log_index(matchIndex);
+    aeResp.set_match_index(matchIndex);
+    mRaftImpl->handleAppendEntriesResponse(aeResp);
+    mRaftImpl->advanceCommitIndex();
+  };
+
+  auto appendEntry = [this](uint64_t index) {
+    gringofts::raft::LogEntry entry;
+    entry.mutable_version()->set_secret_key_version(SecretKey::kInvalidSecKeyVersion);
+    entry.set_index(index);
+    entry.set_term(1);
+    entry.set_payload("Hello, John Doe");
+    mRaftImpl->handleClientRequests({ClientRequest{entry, nullptr}});
+  };
+
+  /// commit noop
+  ackEntries(2, 0, 1);
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 1);
+
+  bool done = false;
+  bool succeeded = false;
+  auto callback = [&done, &succeeded](bool success, const std::string &) {
+    done = true;
+    succeeded = success;
+  };
+
+  /// node 3 catches up as learner
+  mRaftImpl->handleChangeMembership({ChangeMembershipRequest::Type::AddMember, {3, "0.0.0.0:5255"}, callback});
+  ASSERT_TRUE(mRaftImpl->mPeers[3].mIsLearner);
+  ASSERT_EQ(mRaftImpl->getVoterNum(), 2);
+
+  /// another change is rejected
+  bool rejected = false;
+  mRaftImpl->handleChangeMembership({ChangeMembershipRequest::Type::RemoveMember, {2, ""},
+                                     [&rejected](bool success, const std::string &) { rejected = !success; }});
+  ASSERT_TRUE(rejected);
+
+  mRaftImpl->changeMembership();
+  ASSERT_FALSE(mRaftImpl->mProposedConfiguration);
+  ackEntries(3, 1, 1);
+  mRaftImpl->changeMembership();
+  ASSERT_TRUE(mRaftImpl->mProposedConfiguration);
+
+  /// next client entry carries the configuration, which takes effect right away
+  appendEntry(2);
+  {
+    gringofts::raft::LogEntry entry;
+    ASSERT_TRUE(mRaftImpl->mLog->getEntry(2, &entry));
+    ASSERT_TRUE(entry.has_configuration());
+    ASSERT_EQ(entry.configuration().members_size(), 3);
+  }
+  ASSERT_FALSE(mRaftImpl->mPeers[3].mIsLearner);
+  ASSERT_EQ(mRaftImpl->getVoterNum(), 3);
+
+  /// not committed until a majority of new configuration has it
+  ackEntries(2, 1, 1);
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 1);
+  ASSERT_FALSE(done);
+  ackEntries(3, 1, 2);
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 2);
+  ASSERT_TRUE(done && succeeded);
+
+  /// remove node 2
+  done = succeeded = false;
+  mRaftImpl->handleChangeMembership({ChangeMembershipRequest::Type::RemoveMember, {2, ""}, callback});
+  appendEntry(3);
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+  ASSERT_EQ(mRaftImpl->getVoterNum(), 2);
+  ackEntries(3, 2, 3);
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 3);
+  ASSERT_TRUE(done && succeeded);
+  ASSERT_EQ(mRaftImpl->mConfigurations.size(), 1);
+
+  /// drain queue
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+
+  /// persisted configuration overrides cluster.conf after restart
+  mRaftImpl.reset();
+  SetUp();
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+  ASSERT_EQ(mRaftImpl->mPeers.count(3), 1);
+  ASSERT_EQ(mRaftImpl->getVoterNum(), 2);
+}
+
+TEST_F(RaftCoreTest, RemovedMemberResponseTest) {
+  /// leader on term 1
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  mRaftImpl->requestVote();
+  {
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(1);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+    mRaftImpl->becomeLeader();
+  }
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  /// commit noop
+  {
+    gringofts::raft::AppendEntries::Response aeResp;
+    aeResp.set_term(1);
+    aeResp.set_success(true);
+    aeResp.set_id(2);
+    aeResp.set_saved_term(1);
+    aeResp.set_saved_prev_log_index(0);
+    aeResp.set_last_log_index(1);
+    aeResp.set_match_index(1);
+    mRaftImpl->handleAppendEntriesResponse(aeResp);
+    mRaftImpl->advanceCommitIndex();
+  }
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 1);
+
+  /// AE_req to node 2 is in flight
+  mRaftImpl->appendEntries();
+
+  /// remove node 2, the entry carrying configuration is committed by leader alone
+  bool done = false;
+  bool succeeded = false;
+  mRaftImpl->handleChangeMembership({ChangeMembershipRequest::Type::RemoveMember, {2, ""},
+                                     [&done, &succeeded](bool success, const std::string &) {
+                                       done = true;
+                                       succeeded = success;
+                                     }});
+  {
+    gringofts::raft::LogEntry entry;
+    entry.mutable_version()->set_secret_key_version(SecretKey::kInvalidSecKeyVersion);
+    entry.set_index(2);
+    entry.set_term(1);
+    entry.set_payload("Hello, John Doe");
+    mRaftImpl->handleClientRequests({ClientRequest{entry, nullptr}});
+  }
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+  ASSERT_EQ(mRaftImpl->mClients.count(2), 0);
+
+  {
+    /// late AE_resp from node 2
+    gringofts::raft::AppendEntries::Response aeResp;
+    aeResp.set_term(1);
+    aeResp.set_success(true);
+    aeResp.set_id(2);
+    aeResp.set_saved_term(1);
+    aeResp.set_saved_prev_log_index(0);
+    aeResp.set_last_log_index(1);
+    aeResp.set_match_index(1);
+    mRaftImpl->handleAppendEntriesResponse(aeResp);
+  }
+
+  {
+    /// late RV_resp from node 2
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(1);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+  }
+
+  /// no ghost peer is brought back
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+  ASSERT_EQ(mRaftImpl->mClients.count(2), 0);
+
+  mRaftImpl->advanceCommitIndex();
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 2);
+  ASSERT_TRUE(done && succeeded);
+
+  /// failed responses of calls to node 2 arrive after its removal
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+  mRaftImpl->appendEntries();
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+}
+
+TEST_F(RaftCoreTest, TransferToRemovedMemberTest) {
+  /// leader on term 1
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  {
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(1);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+    mRaftImpl->becomeLeader();
+  }
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  bool done = false;
+  std::string result;
+  mRaftImpl->handleTransferLeadership({2, [&done, &result](bool success, const std::string &message) {
+    done = !success;
+    result = message;
+  }});
+  ASSERT_TRUE(mRaftImpl->mPendingTransfer);
+
+  /// transferee leaves configuration before it catches up
+  Configuration configuration;
+  auto *member = configuration.add_members();
+  member->set_id(1);
+  member->set_address("0.0.0.0:5253");
+  mRaftImpl->applyConfiguration(configuration);
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+
+  mRaftImpl->transferLeadership();
+  ASSERT_TRUE(done);
+  ASSERT_EQ(result, "TargetRemoved");
+  ASSERT_FALSE(mRaftImpl->mPendingTransfer);
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  /// drain queue
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+}
+
+TEST_F(RaftCoreTest, IdleMembershipChangeTest) {
+  /// leader on term 1
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  {
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(1);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+    mRaftImpl->becomeLeader();
+  }
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  /// commit noop
+  {
+    gringofts::raft::AppendEntries::Response aeResp;
+    aeResp.set_term(1);
+    aeResp.set_success(true);
+    aeResp.set_id(2);
+    aeResp.set_saved_term(1);
+    aeResp.set_saved_prev_log_index(0);
+    aeResp.set_last_log_index(1);
+    aeResp.set_match_index(1);
+    mRaftImpl->handleAppendEntriesResponse(aeResp);
+    mRaftImpl->advanceCommitIndex();
+  }
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 1);
+
+  bool done = false;
+  bool succeeded = false;
+  mRaftImpl->handleChangeMembership({ChangeMembershipRequest::Type::RemoveMember, {2, ""},
+                                     [&done, &succeeded](bool success, const std::string &) {
+                                       done = true;
+                                       succeeded = success;
+                                     }});
+
+  /// wait for a client entry within propose timeout
+  mRaftImpl->mProposeTimeoutInMillis = 60 * 1000;
+  mRaftImpl->changeMembership();
+  ASSERT_EQ(mRaftImpl->getLastLogIndex(), 1);
+
+  /// no client entry comes, leader appends a noop to carry configuration
+  mRaftImpl->mProposeTimeoutInMillis = 0;
+  mRaftImpl->changeMembership();
+  ASSERT_EQ(mRaftImpl->getLastLogIndex(), 2);
+  {
+    gringofts::raft::LogEntry entry;
+    ASSERT_TRUE(mRaftImpl->mLog->getEntry(2, &entry));
+    ASSERT_TRUE(entry.noop());
+    ASSERT_TRUE(entry.has_configuration());
+    ASSERT_EQ(entry.configuration().members_size(), 1);
+  }
+  ASSERT_EQ(mRaftImpl->mPeers.count(2), 0);
+
+  /// index app layer assigned collides with the noop
+  {
+    gringofts::raft::LogEntry entry;
+    entry.mutable_version()->set_secret_key_version(SecretKey::kInvalidSecKeyVersion);
+    entry.set_index(2);
+    entry.set_term(1);
+    entry.set_payload("Hello, John Doe");
+    mRaftImpl->handleClientRequests({ClientRequest{entry, nullptr}});
+  }
+  ASSERT_EQ(mRaftImpl->getLastLogIndex(), 2);
+
+  /// leader steps down once configuration is committed, so that app layer recovers its indices
+  mRaftImpl->advanceCommitIndex();
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 2);
+  ASSERT_TRUE(done && succeeded);
+  ASSERT_FALSE(mRaftImpl->mProposedByNoop);
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Follower);
+  ASSERT_EQ(mRaftImpl->getCurrentTerm(), 2);
+
+  /// drain queue
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+}
+
+TEST_F(RaftCoreTest, IdleHeartBeatTest) {
+  mRaftImpl->mIdleHeartBeatIntervalInMillis = 500;
+
+  /// leader on term 1
+  mRaftImpl->mElectionTimePointInNano = 0;
+  mRaftImpl->electionTimeout();
+  {
+    gringofts::raft::RequestVote::Response rvResp;
+    rvResp.set_term(1);
+    rvResp.set_vote_granted(true);
+    rvResp.set_id(2);
+    rvResp.set_saved_term(1);
+    mRaftImpl->handleRequestVoteResponse(rvResp);
+    mRaftImpl->becomeLeader();
+  }
+  ASSERT_EQ(mRaftImpl->getRaftRole(), RaftRole::Leader);
+
+  auto &peer = mRaftImpl->mPeers[2];
+  auto turnOnSwitch = [&peer]() {
+    peer.mNextRequestTimeInNano = 0;
+  };
+  auto isSent = [&peer]() {
+    return peer.mNextRequestTimeInNano == std::numeric_limits<uint64_t>::max();
+  };
+
+  /// noop is sent right away
+  mRaftImpl->appendEntries();
+  ASSERT_TRUE(isSent());
+
+  /// follower has noop, but does not know it is committed
+  peer.mNextIndex = 2;
+  peer.mMatchIndex = 1;
+  mRaftImpl->advanceCommitIndex();
+  ASSERT_EQ(mRaftImpl->getCommitIndex(), 1);
+  turnOnSwitch();
+  mRaftImpl->appendEntries();
+  ASSERT_TRUE(isSent());
+  ASSERT_EQ(peer.mCommitIndexSent, 1);
+
+  /// nothing to replicate, wait for idle heartbeat interval
+  turnOnSwitch();
+  mRaftImpl->appendEntries();
+  ASSERT_FALSE(isSent());
+
+  /// new entry is sent without waiting
+  gringofts::raft::LogEntry entry;
+  entry.mutable_version()->set_secret_key_version(SecretKey::kInvalidSecKeyVersion);
+  entry.set_index(2);
+  entry.set_term(1);
+  entry.set_payload("Hello, John Doe");
+  mRaftImpl->handleClientRequests({ClientRequest{entry, nullptr}});
+  mRaftImpl->appendEntries();
+  ASSERT_TRUE(isSent());
+
+  /// idle heartbeat
+  peer.mNextIndex = 3;
+  peer.mMatchIndex = 2;
+  peer.mCommitIndexSent = 2;
+  mRaftImpl->advanceCommitIndex();
+  turnOnSwitch();
+  mRaftImpl->appendEntries();
+  ASSERT_FALSE(isSent());
+  usleep(500 * 1000);
+  mRaftImpl->appendEntries();
+  ASSERT_TRUE(isSent());
+
+  /// drain queue
+  for (uint64_t i = 0; i < 10; ++i) {
+    mRaftImpl->receiveMessage();
+  }
+}
+
+TEST_F(RaftCoreTest, CompressEntriesTest) {
+  mRaftImpl->mCompression = CompressionType::LZ4;
+  mRaftImpl->mCompressionMinBytes = 1024;
+
+  auto makeEntries = [](uint64_t num) {
+    std::vector<gringofts::raft::LogEntry> entries;
+    for (uint64_t i = 1; i <= num; ++i) {
+      gringofts::raft::LogEntry entry;
+      entry.set_index(i);
+      entry.set_term(1);
+      entry.set_payload("Hello, John Doe, Hello, John Doe, Hello, John Doe");
+      entries.push_back(std::move(entry));
+    }
+    return entries;
+  };
+
+  /// small batch is sent as is
+  {
+    auto entries = makeEntries(1);
+    gringofts::raft::AppendEntries::Request request;
+    mRaftImpl->compressEntries(&entries, &request);
+    ASSERT_EQ(entries.size(), 1);
+    ASSERT_EQ(request.compression(), gringofts::raft::COMPRESSION_NONE);
+  }
+
+  /// large batch is compressed as a whole
+  auto entries = makeEntries(100);
+  gringofts::raft::AppendEntries::Request request;
+  mRaftImpl->compressEntries(&entries, &request);
+  ASSERT_TRUE(entries.empty());
+  ASSERT_EQ(request.compression(), gringofts::raft::COMPRESSION_LZ4);
+  ASSERT_LT(request.compressed_entries().size(), request.uncompressed_size());
+
+  /// follower restores them
+  ASSERT_TRUE(RaftCore::decompressEntries(&request));
+  ASSERT_EQ(request.entries_size(), 100);
+  ASSERT_EQ(request.entries(99).index(), 100);
+  ASSERT_EQ(request.entries(99).payload(), makeEntries(1)[0].payload());
+  ASSERT_EQ(request.compression(), gringofts::raft::COMPRESSION_NONE);
+
+  /// encrypted payloads are sent as is
+  {
+    auto encrypted = makeEntries(100);
+    for (auto &entry : encrypted) {
+      entry.mutable_version()->set_secret_key_version(1);
+    }
+    gringofts::raft::AppendEntries::Request plain;
+    mRaftImpl->compressEntries(&encrypted, &plain);
+    ASSERT_EQ(encrypted.size(), 100);
+    ASSERT_EQ(plain.compression(), gringofts::raft::COMPRESSION_NONE);
+  }
+
+  /// corrupted AE_req is detected
+  request.set_compression(gringofts::raft::COMPRESSION_ZSTD);
+  request.set_compressed_entries("garbage");
+  request.set_uncompressed_size(1024);
+  ASSERT_FALSE(RaftCore::decompressEntries(&request));
+}
+
 }  /// namespace gringofts::raft::v2
@@ -0,0 +1,113 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../../../../src/infra/raft/v2/RaftService.h"
+
+namespace gringofts::raft::v2 {
+
+namespace {
+
+std::unique_ptr<RaftClient> makeClient(const std::string &address, EventQueue *aeRvQueue,
+                                       std::shared_ptr<RaftClientLoop> clientLoop) {
+  return std::make_unique<RaftClient>(address, std::nullopt, std::make_shared<DNSResolver>(),
+                                      2, aeRvQueue, std::move(clientLoop));
+}
+
+}  /// namespace
+
+TEST(RaftClientLoopTest, RetireIdleClientTest) {
+  auto clientLoop = std::make_shared<RaftClientLoop>(1);
+  EventQueue aeRvQueue;
+
+  auto client = makeClient("0.0.0.0:5255", &aeRvQueue, clientLoop);
+  clientLoop->retire(std::move(client));
+
+  /// released right away since no call is in flight
+  ASSERT_EQ(clientLoop->mRetiredNum, 0);
+  ASSERT_TRUE(clientLoop->mRetiredClients.empty());
+
+  /// retiring nothing is a no-op
+  clientLoop->retire(nullptr);
+  ASSERT_EQ(clientLoop->mRetiredNum, 0);
+}
+
+TEST(RaftClientLoopTest, RetireBusyClientTest) {
+  auto clientLoop = std::make_shared<RaftClientLoop>(1);
+  EventQueue aeRvQueue;
+
+  auto client = makeClient("0.0.0.0:5255", &aeRvQueue, clientLoop);
+  auto *rawClient = client.get();
+
+  /// pretend a call is in flight
+  ++rawClient->mInflightCalls;
+  clientLoop->retire(std::move(client));
+  ASSERT_FALSE(rawClient->mRunning);
+  ASSERT_FALSE(rawClient->mClientLoop);
+  ASSERT_EQ(clientLoop->mRetiredNum, 1);
+
+  /// kept until its call is completed
+  clientLoop->reapRetiredClients();
+  ASSERT_EQ(clientLoop->mRetiredNum, 1);
+
+  --rawClient->mInflightCalls;
+  clientLoop->reapRetiredClients();
+  ASSERT_EQ(clientLoop->mRetiredNum, 0);
+  ASSERT_TRUE(clientLoop->mRetiredClients.empty());
+}
+
+TEST(RaftClientLoopTest, DropResponseOfRetiredClientTest) {
+  /// a peer that accepts connections but never answers, so that AE_req stays in flight till deadline
+  auto fd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  ASSERT_EQ(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+  ASSERT_EQ(listen(fd, 1), 0);
+  socklen_t len = sizeof(addr);
+  ASSERT_EQ(getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len), 0);
+
+  auto clientLoop = std::make_shared<RaftClientLoop>(1);
+  EventQueue aeRvQueue;
+  auto client = makeClient("127.0.0.1:" + std::to_string(ntohs(addr.sin_port)), &aeRvQueue, clientLoop);
+
+  AppendEntries::Request request;
+  request.set_term(1);
+  request.set_leader_id(1);
+  client->appendEntries(request);
+  ASSERT_EQ(client->mInflightCalls, 1);
+
+  clientLoop->retire(std::move(client));
+  ASSERT_EQ(clientLoop->mRetiredNum, 1);
+
+  /// client loop releases it once the call is completed
+  auto waitInMillis = RaftConstants::AppendEntries::kRpcTimeoutInMillis * 10;
+  for (uint64_t i = 0; i < waitInMillis && clientLoop->mRetiredNum != 0; ++i) {
+    usleep(1000);
+  }
+  ASSERT_EQ(clientLoop->mRetiredNum, 0);
+
+  /// its response is dropped rather than handed to raft main loop
+  ASSERT_TRUE(aeRvQueue.empty());
+
+  close(fd);
+}
+
+}  /// namespace gringofts::raft::v2
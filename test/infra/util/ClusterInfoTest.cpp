@@ -39,6 +39,23 @@ TEST(ClusterInfoTest, routeInfoTest) {
       0));
 }
 
+TEST(ClusterInfoTest, learnerTest) {
+  gringofts::ClusterInfo::Node voter;
+  voter.mNodeId = 1;
+  voter.mHostName = "node01.ebay.com";
+  gringofts::ClusterInfo::Node learner;
+  learner.mNodeId = 4;
+  learner.mHostName = "node04.ebay.com";
+  learner.mIsLearner = true;
+  ClusterInfo clusterInfo;
+  clusterInfo.addNode(voter);
+  clusterInfo.addNode(learner);
+
+  EXPECT_EQ(clusterInfo.to_string(),
+            "1@node01.ebay.com:5254|50055|50056|5678|50065|61203,"
+            "4/learner@node04.ebay.com:5254|50055|50056|5678|50065|61203,");
+}
+
 class ExternalClientMock : public gringofts::kv::Client {
  public:
   using Status = gringofts::kv::Status;
@@ -92,4 +109,19 @@ TEST(ClusterInfoTest, resolveAllClustersUsingExternal) {
     Signal::hub << routeSignal;
     EXPECT_TRUE(routeSignal->getFuture().get());
   }
+  {
+    ExternalClientMock::mKv["cluster.conf"] =
+        absl::StrFormat("1#1@node11.ebay.com,2@%s,3@node13.ebay.com,4/learner@node14.ebay.com",
+                        gringofts::Util::getHostname());
+    auto[clusterId, nodeId, allClusterInfo] = ClusterInfo::resolveAllClusters(
+        INIReader("../test/infra/util/config/cluster_external.ini"),
+        std::make_unique<ClientFactory_t<ExternalClientMock>>());
+    EXPECT_EQ(clusterId, 1);
+    EXPECT_EQ(nodeId, 2);
+    auto nodes = allClusterInfo[1].getAllNodeInfo();
+    EXPECT_EQ(nodes.size(), 4);
+    EXPECT_FALSE(nodes[2].mIsLearner);
+    EXPECT_TRUE(nodes[4].mIsLearner);
+    EXPECT_EQ(nodes[4].mHostName, "node14.ebay.com");
+  }
 }
@@ -0,0 +1,61 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "../../../src/infra/util/CompressionUtil.h"
+
+namespace gringofts::test {
+
+TEST(CompressionUtilTest, ParseTest) {
+  EXPECT_EQ(CompressionUtil::parse("none"), CompressionType::None);
+  EXPECT_EQ(CompressionUtil::parse("LZ4"), CompressionType::LZ4);
+  EXPECT_EQ(CompressionUtil::parse("zstd"), CompressionType::Zstd);
+  EXPECT_EQ(CompressionUtil::parse("gzip"), std::nullopt);
+
+  EXPECT_EQ(CompressionUtil::toString(CompressionType::LZ4), "lz4");
+}
+
+TEST(CompressionUtilTest, RoundTripTest) {
+  std::string raw;
+  for (int i = 0; i < 1000; ++i) {
+    raw += "journal entry " + std::to_string(i % 10) + ";";
+  }
+
+  for (auto type : {CompressionType::None, CompressionType::LZ4, CompressionType::Zstd}) {
+    std::string compressed;
+    EXPECT_TRUE(CompressionUtil::compress(type, raw, &compressed));
+    if (type != CompressionType::None) {
+      EXPECT_LT(compressed.size(), raw.size());
+    }
+
+    std::string decompressed;
+    EXPECT_TRUE(CompressionUtil::decompress(type, compressed, raw.size(), &decompressed));
+    EXPECT_EQ(decompressed, raw);
+  }
+}
+
+TEST(CompressionUtilTest, CorruptedInputTest) {
+  std::string raw(4096, 'a');
+  std::string compressed;
+  EXPECT_TRUE(CompressionUtil::compress(CompressionType::Zstd, raw, &compressed));
+
+  std::string decompressed;
+  /// wrong size
+  EXPECT_FALSE(CompressionUtil::decompress(CompressionType::Zstd, compressed, raw.size() - 1, &decompressed));
+  /// garbage
+  EXPECT_FALSE(CompressionUtil::decompress(CompressionType::LZ4, "garbage", raw.size(), &decompressed));
+}
+
+}  /// namespace gringofts::test
@@ -0,0 +1,96 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "../../../src/infra/util/HdrHistogram.h"
+
+namespace gringofts::test {
+
+TEST(HdrHistogramTest, EmptyHistogram) {
+  HdrHistogram histogram;
+
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.min(), 0u);
+  EXPECT_EQ(histogram.max(), 0u);
+  EXPECT_EQ(histogram.mean(), 0);
+  EXPECT_EQ(histogram.valueAtPercentile(99), 0u);
+}
+
+TEST(HdrHistogramTest, SmallValuesAreExact) {
+  HdrHistogram histogram;
+  for (uint64_t value = 1; value <= 100; ++value) {
+    histogram.record(value);
+  }
+
+  EXPECT_EQ(histogram.count(), 100u);
+  EXPECT_EQ(histogram.min(), 1u);
+  EXPECT_EQ(histogram.max(), 100u);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 50.5);
+  EXPECT_EQ(histogram.valueAtPercentile(0), 1u);
+  EXPECT_EQ(histogram.valueAtPercentile(50), 50u);
+  EXPECT_EQ(histogram.valueAtPercentile(99), 99u);
+  EXPECT_EQ(histogram.valueAtPercentile(100), 100u);
+}
+
+TEST(HdrHistogramTest, LargeValuesWithinPrecision) {
+  HdrHistogram histogram;
+  /// 1us to 10s in nanoseconds
+  for (uint64_t value = 1000; value <= 10'000'000'000; value = value * 11 / 10) {
+    histogram.reset();
+    histogram.record(value);
+    auto reported = histogram.valueAtPercentile(50);
+    EXPECT_LE(reported, value);
+    EXPECT_GE(reported, value - value / 64);
+  }
+
+  /// the largest value
+  histogram.reset();
+  histogram.record(UINT64_MAX);
+  EXPECT_EQ(histogram.valueAtPercentile(100), UINT64_MAX);
+}
+
+TEST(HdrHistogramTest, PercentilesOfSkewedDistribution) {
+  HdrHistogram histogram;
+  /// 990 fast calls of 1ms and 10 slow ones of 1s
+  histogram.record(1'000'000, 990);
+  histogram.record(1'000'000'000, 10);
+
+  EXPECT_EQ(histogram.count(), 1000u);
+  EXPECT_NEAR(histogram.valueAtPercentile(50), 1'000'000, 1'000'000 / 64);
+  EXPECT_NEAR(histogram.valueAtPercentile(99), 1'000'000, 1'000'000 / 64);
+  EXPECT_NEAR(histogram.valueAtPercentile(99.9), 1'000'000'000, 1'000'000'000 / 64);
+  EXPECT_EQ(histogram.max(), 1'000'000'000u);
+}
+
+TEST(HdrHistogramTest, MergeAndReset) {
+  HdrHistogram histogram1;
+  HdrHistogram histogram2;
+  histogram1.record(10);
+  histogram2.record(20);
+  histogram2.record(30);
+
+  histogram1.merge(histogram2);
+
+  EXPECT_EQ(histogram1.count(), 3u);
+  EXPECT_EQ(histogram1.min(), 10u);
+  EXPECT_EQ(histogram1.max(), 30u);
+  EXPECT_EQ(histogram1.valueAtPercentile(50), 20u);
+
+  histogram1.reset();
+  EXPECT_EQ(histogram1.count(), 0u);
+  EXPECT_EQ(histogram1.valueAtPercentile(50), 0u);
+}
+
+}  /// namespace gringofts::test
@@ -0,0 +1,88 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../../../src/infra/util/LogUtil.h"
+
+namespace gringofts::test {
+
+namespace {
+uint64_t gLogCount = 0;
+}  /// namespace
+
+#define COUNT_LOG(...) ++gLogCount
+
+TEST(LogUtilTest, ShouldLogOncePerInterval) {
+  std::atomic<uint64_t> lastLogTimeInNanos{0};
+
+  EXPECT_TRUE(LogUtil::shouldLog(&lastLogTimeInNanos, 100));
+  EXPECT_FALSE(LogUtil::shouldLog(&lastLogTimeInNanos, 100));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  EXPECT_TRUE(LogUtil::shouldLog(&lastLogTimeInNanos, 100));
+}
+
+TEST(LogUtilTest, OnlyOneThreadWinsTheInterval) {
+  std::atomic<uint64_t> lastLogTimeInNanos{0};
+  std::atomic<uint64_t> winners{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) {
+        if (LogUtil::shouldLog(&lastLogTimeInNanos, 60 * 1000)) {
+          ++winners;
+        }
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(winners, 1);
+}
+
+TEST(LogUtilTest, EveryNMacroLogsFirstOfEachN) {
+  gLogCount = 0;
+  for (int i = 0; i < 25; ++i) {
+    GRINGOFTS_LOG_EVERY_N(COUNT_LOG, 10, "round {}", i);
+  }
+  /// 1st, 11th and 21st
+  EXPECT_EQ(gLogCount, 3);
+
+  gLogCount = 0;
+  for (int i = 0; i < 5; ++i) {
+    GRINGOFTS_LOG_EVERY_N(COUNT_LOG, 1, "round {}", i);
+  }
+  EXPECT_EQ(gLogCount, 5);
+}
+
+TEST(LogUtilTest, EveryMsMacroKeepsStatePerCallsite) {
+  gLogCount = 0;
+  for (int i = 0; i < 100; ++i) {
+    GRINGOFTS_LOG_EVERY_MS(COUNT_LOG, 60 * 1000, "first callsite {}", i);
+    GRINGOFTS_LOG_EVERY_MS(COUNT_LOG, 60 * 1000, "second callsite {}", i);
+  }
+  EXPECT_EQ(gLogCount, 2);
+
+  /// real spdlog macros compile through the same path
+  SPDLOG_INFO_EVERY_MS(1000, "rate limited info {}", 1);
+  SPDLOG_WARN_EVERY_N(10, "sampled warn {}", 1);
+}
+
+}  /// namespace gringofts::test
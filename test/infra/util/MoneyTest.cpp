@@ -0,0 +1,98 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../../../src/infra/util/Money.h"
+
+namespace gringofts::test {
+
+namespace {
+constexpr uint32_t kCNY = 156;
+constexpr uint32_t kJPY = 392;
+constexpr uint32_t kKWD = 414;
+constexpr uint32_t kUSD = 840;
+}  /// namespace
+
+TEST(MoneyTest, ScaleOfCurrency) {
+  EXPECT_EQ(Money::scaleOf(kCNY), 2u);
+  EXPECT_EQ(Money::scaleOf(kJPY), 0u);
+  EXPECT_EQ(Money::scaleOf(kKWD), 3u);
+  /// unknown currency
+  EXPECT_EQ(Money::scaleOf(999), 2u);
+}
+
+TEST(MoneyTest, ParseDecimal) {
+  EXPECT_EQ(Money::parse("12.3", kUSD), Money(1230, kUSD));
+  EXPECT_EQ(Money::parse("-0.05", kUSD), Money(-5, kUSD));
+  EXPECT_EQ(Money::parse("+7", kJPY), Money(7, kJPY));
+  EXPECT_EQ(Money::parse("1.234", kKWD), Money(1234, kKWD));
+
+  /// malformed
+  EXPECT_FALSE(Money::parse("", kUSD));
+  EXPECT_FALSE(Money::parse("-", kUSD));
+  EXPECT_FALSE(Money::parse("1.2.3", kUSD));
+  EXPECT_FALSE(Money::parse("1e3", kUSD));
+  /// more precise than the currency
+  EXPECT_FALSE(Money::parse("1.234", kUSD));
+  EXPECT_FALSE(Money::parse("1.5", kJPY));
+  /// overflow
+  EXPECT_FALSE(Money::parse(std::string(40, '9'), kUSD));
+}
+
+TEST(MoneyTest, ToString) {
+  EXPECT_EQ(Money(1230, kUSD).toString(), "12.30");
+  EXPECT_EQ(Money(-5, kUSD).toString(), "-0.05");
+  EXPECT_EQ(Money(0, kUSD).toString(), "0.00");
+  EXPECT_EQ(Money(42, kJPY).toString(), "42");
+  EXPECT_EQ(Money(1, kKWD).toString(), "0.001");
+  /// round trip of the extremes
+  auto max = Money::parse("1701411834604692317316873037158841057.27", kUSD);
+  ASSERT_TRUE(max);
+  EXPECT_EQ(max->toString(), "1701411834604692317316873037158841057.27");
+  auto min = Money(-max->minorUnits() - 1, kUSD);
+  EXPECT_EQ(min.toString(), "-1701411834604692317316873037158841057.28");
+}
+
+TEST(MoneyTest, AddAndSubtract) {
+  Money money(100, kUSD);
+  EXPECT_TRUE(money.tryAdd(Money(50, kUSD)));
+  EXPECT_EQ(money, Money(150, kUSD));
+  EXPECT_TRUE(money.trySub(Money(200, kUSD)));
+  EXPECT_EQ(money, Money(-50, kUSD));
+
+  /// currency mismatch leaves money untouched
+  EXPECT_FALSE(money.tryAdd(Money(50, kCNY)));
+  EXPECT_FALSE(money.trySub(Money(50, kCNY)));
+  EXPECT_EQ(money, Money(-50, kUSD));
+
+  /// overflow leaves money untouched
+  auto max = *Money::parse("1701411834604692317316873037158841057.27", kUSD);
+  auto beforeOverflow = max;
+  EXPECT_FALSE(max.tryAdd(Money(1, kUSD)));
+  EXPECT_EQ(max, beforeOverflow);
+  auto min = Money(-max.minorUnits() - 1, kUSD);
+  EXPECT_FALSE(min.trySub(Money(1, kUSD)));
+}
+
+TEST(MoneyTest, FitsInUint64) {
+  EXPECT_TRUE(Money(0, kUSD).fitsInUint64());
+  EXPECT_TRUE(Money(UINT64_MAX, kUSD).fitsInUint64());
+  EXPECT_FALSE(Money(static_cast<Money::ValueType>(UINT64_MAX) + 1, kUSD).fitsInUint64());
+  EXPECT_FALSE(Money(-1, kUSD).fitsInUint64());
+}
+
+}  /// namespace gringofts::test
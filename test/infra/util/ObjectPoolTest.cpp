@@ -0,0 +1,125 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../../../src/infra/util/ObjectPool.h"
+
+namespace gringofts::test {
+
+namespace {
+struct PooledFoo : public PooledObject<PooledFoo> {
+  explicit PooledFoo(uint64_t value) : mValue(value) {}
+  virtual ~PooledFoo() = default;
+
+  uint64_t mValue;
+};
+
+struct DerivedFoo : public PooledFoo {
+  DerivedFoo() : PooledFoo(1) {}
+
+  char mPadding[64] = {0};
+};
+}  /// namespace
+
+TEST(ObjectPoolTest, ReuseOnSameThreadTest) {
+  /// use a block size no other test uses
+  using Pool = BlockPool<1008>;
+  auto *ptr1 = Pool::allocate();
+  Pool::deallocate(ptr1);
+  auto *ptr2 = Pool::allocate();
+  EXPECT_EQ(ptr1, ptr2);
+  Pool::deallocate(ptr2);
+}
+
+TEST(ObjectPoolTest, CrossThreadReturnTest) {
+  using Pool = BlockPool<2032>;
+  const std::size_t num = 4096;
+
+  /// allocate on this thread, free on another one
+  std::vector<void *> blocks;
+  for (std::size_t i = 0; i < num; ++i) {
+    blocks.push_back(Pool::allocate());
+  }
+  std::set<void *> allocated(blocks.begin(), blocks.end());
+  std::thread([&blocks] {
+    for (auto *block : blocks) {
+      Pool::deallocate(block);
+    }
+  }).join();
+
+  /// all of them come back to this thread through the depot
+  for (std::size_t i = 0; i < num; ++i) {
+    auto *block = Pool::allocate();
+    EXPECT_EQ(allocated.count(block), 1u);
+    blocks[i] = block;
+  }
+  for (auto *block : blocks) {
+    Pool::deallocate(block);
+  }
+}
+
+TEST(ObjectPoolTest, DepotIsCappedTest) {
+  using Pool = BlockPool<1040>;
+  const std::size_t num = 2 * Pool::kMaxDepotBatches * Pool::kMaxCachedBlocks;
+  auto released = getCounter("object_pool_heap_release_counter", {{"block_size", "1040"}});
+  auto releasedBefore = released.value();
+
+  std::vector<void *> blocks;
+  for (std::size_t i = 0; i < num; ++i) {
+    blocks.push_back(Pool::allocate());
+  }
+  std::thread([&blocks] {
+    for (auto *block : blocks) {
+      Pool::deallocate(block);
+    }
+  }).join();
+
+  /// only what fits in the depot is kept, the rest goes back to the heap
+  EXPECT_GE(released.value() - releasedBefore, num - Pool::kMaxDepotBatches * Pool::kMaxCachedBlocks);
+}
+
+TEST(ObjectPoolTest, PooledObjectTest) {
+  auto *foo = new PooledFoo(1);
+  delete foo;
+  auto foo2 = std::make_unique<PooledFoo>(2);
+  EXPECT_EQ(foo2.get(), foo);
+  EXPECT_EQ(foo2->mValue, 2u);
+
+  /// derived classes of different size go to heap
+  std::unique_ptr<PooledFoo> derived = std::make_unique<DerivedFoo>();
+  EXPECT_EQ(derived->mValue, 1u);
+}
+
+TEST(ObjectPoolTest, PoolAllocatorTest) {
+  auto foo = std::allocate_shared<PooledFoo>(PoolAllocator<PooledFoo>(), 1);
+  auto *raw = foo.get();
+  foo.reset();
+  auto foo2 = std::allocate_shared<PooledFoo>(PoolAllocator<PooledFoo>(), 2);
+  EXPECT_EQ(foo2.get(), raw);
+  EXPECT_EQ(foo2->mValue, 2u);
+
+  std::vector<PooledFoo, PoolAllocator<PooledFoo>> foos;
+  for (uint64_t i = 0; i < 10; ++i) {
+    foos.emplace_back(i);
+  }
+  EXPECT_EQ(foos[9].mValue, 9u);
+}
+
+}  /// namespace gringofts::test
@@ -0,0 +1,66 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+#include "../../../src/infra/util/PMRContainerFactory.h"
+
+namespace gringofts::test {
+
+TEST(PMRContainerFactoryTest, PerContainerMemoryResourceTest) {
+  PMRContainerFactory factory("TestFactory", std::make_unique<PoolPMRMemoryPool>("testPool"));
+
+  auto *resource = factory.getMemoryResource("container");
+  /// same name, same resource
+  EXPECT_EQ(resource, factory.getMemoryResource("container"));
+  EXPECT_NE(resource, factory.getMemoryResource("another"));
+
+  auto *tracking = dynamic_cast<TrackingMemoryResource *>(resource);
+  ASSERT_NE(tracking, nullptr);
+  EXPECT_EQ(tracking->getMemUsage(), 0u);
+
+  {
+    std::pmr::map<uint64_t, uint64_t> map1(resource);
+    std::pmr::map<uint64_t, uint64_t> map2(factory.getMemoryResource("container"));
+    for (uint64_t i = 0; i < 100; ++i) {
+      map1[i] = i;
+    }
+    EXPECT_GT(tracking->getMemUsage(), 0u);
+
+    /// containers sharing the resource can be swapped
+    std::swap(map1, map2);
+    EXPECT_EQ(map1.size(), 0u);
+    EXPECT_EQ(map2.size(), 100u);
+  }
+
+  EXPECT_EQ(tracking->getMemUsage(), 0u);
+}
+
+TEST(PMRContainerFactoryTest, MonotonicPoolTest) {
+  PMRContainerFactory factory("TestFactory", std::make_unique<MonotonicPMRMemoryPool>("testPool", 1));
+
+  auto *resource = factory.getMemoryResource("buffer");
+  std::pmr::vector<char> buffer(resource);
+  buffer.resize(1024);
+  auto usage = dynamic_cast<TrackingMemoryResource *>(resource)->getMemUsage();
+  /// pool is bounded by its reserved size
+  EXPECT_THROW(buffer.resize(2 * 1024 * 1024), std::bad_alloc);
+  /// failed allocation is not counted
+  EXPECT_EQ(dynamic_cast<TrackingMemoryResource *>(resource)->getMemUsage(), usage);
+}
+
+}  /// namespace gringofts::test
@@ -0,0 +1,118 @@
+/************************************************************************
+Copyright 2019-2020 eBay Inc.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**************************************************************************/
+
+#include <sched.h>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../../../src/infra/util/ThreadPlacement.h"
+
+namespace gringofts::test {
+
+namespace {
+/// cpus the calling thread may run on
+std::vector<uint32_t> affinityOfThisThread() {
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+
+  std::vector<uint32_t> cpus;
+  for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &cpuSet)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+}  /// namespace
+
+TEST(ThreadPlacementTest, ParseCpuList) {
+  EXPECT_EQ(*ThreadPlacement::parseCpuList("0-3,8"), std::vector<uint32_t>({0, 1, 2, 3, 8}));
+  EXPECT_EQ(*ThreadPlacement::parseCpuList("5"), std::vector<uint32_t>({5}));
+  EXPECT_TRUE(ThreadPlacement::parseCpuList("")->empty());
+
+  EXPECT_FALSE(ThreadPlacement::parseCpuList("3-1"));
+  EXPECT_FALSE(ThreadPlacement::parseCpuList("1-"));
+  EXPECT_FALSE(ThreadPlacement::parseCpuList("a,b"));
+}
+
+TEST(ThreadPlacementTest, SplitIndex) {
+  auto indexed = ThreadPlacement::splitIndex("RcvThread_3");
+  ASSERT_TRUE(indexed);
+  EXPECT_EQ(indexed->first, "RcvThread");
+  EXPECT_EQ(indexed->second, 3);
+
+  EXPECT_FALSE(ThreadPlacement::splitIndex("ReplyLoop_reply"));
+  EXPECT_FALSE(ThreadPlacement::splitIndex("CommandProcLoop"));
+  EXPECT_FALSE(ThreadPlacement::splitIndex("RcvThread_"));
+}
+
+TEST(ThreadPlacementTest, PinNamedAndIndexedThreads) {
+  ThreadPlacement::getInstance().init(INIReader("../test/infra/util/config/threads.ini"));
+
+  std::vector<uint32_t> pinned;
+  std::vector<uint32_t> indexed;
+  std::vector<uint32_t> unlisted;
+  std::thread([&pinned]() {
+    ThreadPlacement::getInstance().place("PinnedThread");
+    pinned = affinityOfThisThread();
+  }).join();
+  std::thread([&indexed]() {
+    ThreadPlacement::getInstance().place("IndexedThread_1");
+    indexed = affinityOfThisThread();
+  }).join();
+  std::thread([&unlisted]() {
+    ThreadPlacement::getInstance().place("UnlistedThread");
+    unlisted = affinityOfThisThread();
+  }).join();
+
+  EXPECT_EQ(pinned, std::vector<uint32_t>({0}));
+  EXPECT_EQ(indexed, std::vector<uint32_t>({0}));
+  EXPECT_EQ(unlisted, affinityOfThisThread());
+}
+
+TEST(ThreadPlacementTest, SameNameThreadsDoNotShareGauge) {
+  ThreadPlacement::getInstance().init(INIReader("../test/infra/util/config/threads_sampled.ini"));
+
+  std::promise<void> placed[2];
+  std::promise<void> done;
+  auto doneFuture = done.get_future().share();
+  std::vector<std::thread> threads;
+  for (auto &p : placed) {
+    threads.emplace_back([&p, doneFuture]() {
+      ThreadPlacement::getInstance().place("DupThread");
+      p.set_value();
+      /// stay alive, exited threads are dropped by sampler
+      doneFuture.wait();
+    });
+  }
+  for (auto &p : placed) {
+    p.get_future().wait();
+  }
+
+  auto labels = ThreadPlacement::getInstance().sampledThreads();
+  done.set_value();
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(std::count(labels.begin(), labels.end(), "DupThread"), 1);
+  EXPECT_EQ(std::count(labels.begin(), labels.end(), "DupThread#1"), 1);
+}
+
+}  /// namespace gringofts::test